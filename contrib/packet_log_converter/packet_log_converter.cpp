@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// Converts binary world packet log (WorldLogBinary = 1) to text format of WorldLogFile.
+// Format is described in src/shared/Log.h.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#ifdef WIN32
+#pragma warning (disable:4996)
+typedef unsigned __int64 uint64;
+#else
+#include <stdint.h>
+typedef uint64_t uint64;
+#endif
+
+#define PACKET_LOG_MAGIC                "MPKT"
+#define PACKET_LOG_VERSION              1
+#define PACKET_LOG_RECORD_OPCODE_NAME   1
+#define PACKET_LOG_RECORD_PACKET        2
+#define PACKET_LOG_CLIENT_TO_SERVER     1
+
+bool ReadLE(FILE* in, uint64& value, size_t bytes)
+{
+    value = 0;
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        int c = fgetc(in);
+        if (c == EOF)
+            return false;
+
+        value |= uint64(c & 0xFF) << (i * 8);
+    }
+    return true;
+}
+
+void WriteTimestamp(FILE* out, uint64 timeMs)
+{
+    time_t t = time_t(timeMs / 1000);
+    tm* aTm = localtime(&t);
+    fprintf(out, "%-4d-%02d-%02d %02d:%02d:%02d ", aTm->tm_year + 1900, aTm->tm_mon + 1, aTm->tm_mday, aTm->tm_hour, aTm->tm_min, aTm->tm_sec);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <binary world log> [text log]\n", argv[0]);
+        printf("Text log is written to standard output if not specified.\n");
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if (!in)
+    {
+        printf("Can't open %s\n", argv[1]);
+        return 1;
+    }
+
+    char magic[4];
+    uint64 version;
+    if (fread(magic, 1, 4, in) != 4 || memcmp(magic, PACKET_LOG_MAGIC, 4) != 0 || !ReadLE(in, version, 2))
+    {
+        printf("%s is not binary world log\n", argv[1]);
+        fclose(in);
+        return 1;
+    }
+
+    if (version != PACKET_LOG_VERSION)
+    {
+        printf("Unsupported binary world log version %u\n", unsigned(version));
+        fclose(in);
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (argc > 2)
+    {
+        out = fopen(argv[2], "w");
+        if (!out)
+        {
+            printf("Can't create %s\n", argv[2]);
+            fclose(in);
+            return 1;
+        }
+    }
+
+    std::map<unsigned, std::string> opcodeNames;
+    std::vector<unsigned char> data;
+    unsigned packets = 0;
+    bool truncated = false;
+
+    while (true)
+    {
+        int type = fgetc(in);
+        if (type == EOF)
+            break;
+
+        if (type == PACKET_LOG_RECORD_OPCODE_NAME)
+        {
+            uint64 opcode, length;
+            char name[256];
+            if (!ReadLE(in, opcode, 2) || !ReadLE(in, length, 1) || fread(name, 1, size_t(length), in) != length)
+            {
+                truncated = true;
+                break;
+            }
+
+            opcodeNames[unsigned(opcode)] = std::string(name, size_t(length));
+        }
+        else if (type == PACKET_LOG_RECORD_PACKET)
+        {
+            uint64 timeMs, socket, opcode, direction, length;
+            if (!ReadLE(in, timeMs, 8) || !ReadLE(in, socket, 4) || !ReadLE(in, opcode, 2) ||
+                !ReadLE(in, direction, 1) || !ReadLE(in, length, 4))
+            {
+                truncated = true;
+                break;
+            }
+
+            data.resize(size_t(length));
+            if (length && fread(&data[0], 1, size_t(length), in) != length)
+            {
+                truncated = true;
+                break;
+            }
+
+            std::map<unsigned, std::string>::const_iterator name = opcodeNames.find(unsigned(opcode));
+
+            WriteTimestamp(out, timeMs);
+            fprintf(out, "\n%s:\nSOCKET: %u\nLENGTH: %u\nOPCODE: %s (0x%.4X)\nDATA:\n",
+                direction == PACKET_LOG_CLIENT_TO_SERVER ? "CLIENT" : "SERVER",
+                unsigned(socket), unsigned(length), name != opcodeNames.end() ? name->second.c_str() : "UNKNOWN", unsigned(opcode));
+
+            size_t p = 0;
+            while (p < data.size())
+            {
+                for (size_t j = 0; j < 16 && p < data.size(); ++j)
+                    fprintf(out, "%.2X ", data[p++]);
+
+                fprintf(out, "\n");
+            }
+
+            fprintf(out, "\n\n");
+            ++packets;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown record type %d at offset %ld\n", type, ftell(in) - 1);
+            truncated = true;
+            break;
+        }
+    }
+
+    if (truncated)
+        fprintf(stderr, "Log ends with incomplete record (server stopped while writing?)\n");
+
+    fprintf(stderr, "Converted %u packets\n", packets);
+
+    fclose(in);
+    if (out != stdout)
+        fclose(out);
+
+    return 0;
+}
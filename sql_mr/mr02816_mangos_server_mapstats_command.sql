@@ -0,0 +1,8 @@
+-- Map update scheduler statistics
+
+DELETE FROM `command` WHERE `name` IN ('server mapstats');
+
+INSERT INTO `command`
+    (`name`, `security`, `help`)
+VALUES
+    ('server mapstats',3,'Syntax: .server mapstats [#count]\r\nShow map update cost and queue wait (in microseconds) for #count most expensive maps (default 10).');
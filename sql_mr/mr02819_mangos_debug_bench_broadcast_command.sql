@@ -0,0 +1,8 @@
+-- Broadcast packet copy benchmark
+
+DELETE FROM `command` WHERE `name` IN ('debug bench broadcast');
+
+INSERT INTO `command`
+    (`name`, `security`, `help`)
+VALUES
+    ('debug bench broadcast',3,'Syntax: .debug bench broadcast [#receivers [#size [#count]]]\r\nQueue #count (default 1000) packets of #size bytes (default 1024) to #receivers (default 40) not connected sockets, copied to each socket and with shared payload, and show packet bytes copied and time used per broadcast.');
@@ -0,0 +1,8 @@
+-- Update packets compression statistics
+
+DELETE FROM `command` WHERE `name` IN ('server compression');
+
+INSERT INTO `command`
+    (`name`, `security`, `help`)
+VALUES
+    ('server compression',3,'Syntax: .server compression\r\nShow update packets compression settings, compressed packets count, compression ratio and time used.');
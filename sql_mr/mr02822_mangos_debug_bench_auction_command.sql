@@ -0,0 +1,8 @@
+-- Auction house browse benchmark
+
+DELETE FROM `command` WHERE `name` IN ('debug bench auction');
+
+INSERT INTO `command`
+    (`name`, `security`, `help`)
+VALUES
+    ('debug bench auction',3,'Syntax: .debug bench auction [#auctions [#queries]]\r\nGenerate #auctions (default 20000) not saved auctions and run #queries (default 100) browse queries against them, by full sort of all auctions and by item template indexes, and show time used per query.');
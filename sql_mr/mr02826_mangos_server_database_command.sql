@@ -0,0 +1,8 @@
+-- Async database writers statistics
+
+DELETE FROM `command` WHERE `name` IN ('server database');
+
+INSERT INTO `command`
+    (`name`, `security`, `help`)
+VALUES
+    ('server database',3,'Syntax: .server database\r\nShow queue size, executed operations, group commits and average and max latency in microseconds of async database writers since previous use of command.');
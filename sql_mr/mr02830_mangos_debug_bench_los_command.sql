@@ -0,0 +1,8 @@
+-- Line of sight ray packet benchmark
+
+DELETE FROM `command` WHERE `name` IN ('debug bench los');
+
+INSERT INTO `command`
+    (`name`, `security`, `help`)
+VALUES
+    ('debug bench los',3,'Syntax: .debug bench los [#rays [#radius [#count]]]\r\nTrace #rays (default 32) vmap line of sight rays from your eye level to random points around you up to #radius yards (default 40), #count times (default 100), one by one and in ray packets, and show time per ray and result mismatches.');
@@ -0,0 +1,8 @@
+-- Shared values update blocks benchmark
+
+DELETE FROM `command` WHERE `name` IN ('debug bench values');
+
+INSERT INTO `command`
+    (`name`, `security`, `help`)
+VALUES
+    ('debug bench values',3,'Syntax: .debug bench values [#observers [#step [#count]]]\r\nMark every #step field (default 4) of selected unit or yourself as changed and build its values update for up to #observers (default 200) distinct players of its map, #count times (default 100), block per observer and with shared blocks, and show time per observer, number of visibility classes and block mismatches. Target itself, its owner and group members are used first, as they have own visibility classes.');
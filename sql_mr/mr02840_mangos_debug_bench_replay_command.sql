@@ -0,0 +1,10 @@
+-- Packet capture replay benchmark
+
+DELETE FROM `command` WHERE `name` IN ('debug bench replay start','debug bench replay stats','debug bench replay stop');
+
+INSERT INTO `command`
+    (`name`, `security`, `help`)
+VALUES
+    ('debug bench replay start',3,'Syntax: .debug bench replay start $file [#sessions [#speed [$namePrefix]]]\r\nReplay client packets recorded in binary world log $file (WorldLogBinary = 1) by #sessions (default 10) offline characters with name starting by $namePrefix (default Bench), logged in without client. Recorded times are divided by #speed (default 1.0).'),
+    ('debug bench replay stats',3,'Syntax: .debug bench replay stats [#opcodes]\r\nShow state of packet replay, world update duration percentiles, memory growth and #opcodes (default 10) opcodes with most handler time.'),
+    ('debug bench replay stop',3,'Syntax: .debug bench replay stop\r\nStop packet replay and log out replay characters. Statistics stay available by .debug bench replay stats.');
@@ -402,6 +402,7 @@ bool AchievementCriteriaRequirementSet::Meets(Player const* source, Unit const*
 }
 
 AchievementMgr::AchievementMgr(Player* player)
+    : m_completedCriteria(sAchievementCriteriaStore.GetNumRows(), false)
 {
     m_player = player;
 }
@@ -428,6 +429,7 @@ void AchievementMgr::Reset()
 
     m_completedAchievements.clear();
     m_criteriaProgress.clear();
+    m_completedCriteria.assign(m_completedCriteria.size(), false);
     DeleteFromDB(m_player->GetObjectGuid());
 
     // re-fill data
@@ -642,6 +644,19 @@ void AchievementMgr::LoadFromDB(QueryResult* achievementResult, QueryResult* cri
 
             // Checked in LoadAchievementCriteriaList
 
+            // check integrity with max allowed counter value
+            if (uint32 maxcounter = GetCriteriaProgressMaxCounter(criteria, achievement))
+            {
+                if (progress.counter > maxcounter)
+                {
+                    progress.counter = maxcounter;
+                    progress.changed = true;
+                }
+            }
+
+            // completed criteria bitset must be set before time limit check uses it
+            UpdateCompletedCriteria(criteria, achievement, &progress);
+
             // A failed achievement will be removed on next tick - TODO: Possible that timer 2 is reseted
             if (criteria->timeLimit)
             {
@@ -655,16 +670,6 @@ void AchievementMgr::LoadFromDB(QueryResult* achievementResult, QueryResult* cri
                         progress.timedCriteriaFailed = true;
                 }
             }
-
-            // check integrity with max allowed counter value
-            if (uint32 maxcounter = GetCriteriaProgressMaxCounter(criteria, achievement))
-            {
-                if (progress.counter > maxcounter)
-                {
-                    progress.counter = maxcounter;
-                    progress.changed = true;
-                }
-            }
         }
         while (criteriaResult->NextRow());
         delete criteriaResult;
@@ -814,6 +819,7 @@ void AchievementMgr::StartTimedAchievementCriteria(AchievementCriteriaTypes type
 
         progress->changed = true;
         progress->counter = 0;
+        UpdateCompletedCriteria(achievementCriteria, achievement, progress);
 
         // Start with given startTime or now
         progress->date = startTime ? startTime : time(NULL);
@@ -864,6 +870,7 @@ void AchievementMgr::DoFailedTimedAchievementCriterias()
 
             // Remove failed progress
             m_criteriaProgress.erase(pro_iter);
+            m_completedCriteria[criteria->ID] = false;
         }
 
         m_criteriaFailTimes.erase(iter++);
@@ -880,7 +887,8 @@ void AchievementMgr::UpdateAchievementCriteria(AchievementCriteriaTypes type, ui
     if (!sWorld.getConfig(CONFIG_BOOL_GM_ALLOW_ACHIEVEMENT_GAINS) && m_player->GetSession()->GetSecurity() > SEC_PLAYER)
         return;
 
-    AchievementCriteriaEntryList const& achievementCriteriaList = sAchievementMgr.GetAchievementCriteriaByType(type);
+    // only criteria requiring this misc value for types where it must match, all criteria of type in other cases
+    AchievementCriteriaEntryList const& achievementCriteriaList = sAchievementMgr.GetAchievementCriteriaByType(type, miscvalue1);
     for (AchievementCriteriaEntryList::const_iterator itr = achievementCriteriaList.begin(); itr != achievementCriteriaList.end(); ++itr)
     {
         AchievementCriteriaEntry const* achievementCriteria = *itr;
@@ -2681,15 +2689,20 @@ bool AchievementMgr::IsCompletedCriteria(AchievementCriteriaEntry const* achieve
             return false;
     }
 
-    CriteriaProgressMap::const_iterator itr = m_criteriaProgress.find(achievementCriteria->ID);
-    if (itr == m_criteriaProgress.end())
-        return false;
-
-    CriteriaProgress const* progress = &itr->second;
+    // progress state kept up to date at each counter change, see UpdateCompletedCriteria
+    return m_completedCriteria[achievementCriteria->ID];
+}
 
+bool AchievementMgr::IsCompletedCriteriaProgress(AchievementCriteriaEntry const* achievementCriteria, AchievementEntry const* achievement, uint32 counter)
+{
     uint32 maxcounter = GetCriteriaProgressMaxCounter(achievementCriteria, achievement);
 
-    return progress->counter >= maxcounter || ((achievement->flags & ACHIEVEMENT_FLAG_REQ_COUNT) && progress->counter);
+    return counter >= maxcounter || ((achievement->flags & ACHIEVEMENT_FLAG_REQ_COUNT) && counter);
+}
+
+void AchievementMgr::UpdateCompletedCriteria(AchievementCriteriaEntry const* achievementCriteria, AchievementEntry const* achievement, CriteriaProgress const* progress)
+{
+    m_completedCriteria[achievementCriteria->ID] = IsCompletedCriteriaProgress(achievementCriteria, achievement, progress->counter);
 }
 
 void AchievementMgr::CompletedCriteriaFor(AchievementEntry const* achievement)
@@ -2804,6 +2817,7 @@ void AchievementMgr::SetCriteriaProgress(AchievementCriteriaEntry const* criteri
         {
             m_criteriaFailTimes[criteria->ID] = time_t(progress->date + criteria->timeLimit);
             progress->counter = 0;
+            UpdateCompletedCriteria(criteria, achievement, progress);
             SendCriteriaUpdate(criteria->ID, progress);
         }
 
@@ -2837,6 +2851,7 @@ void AchievementMgr::SetCriteriaProgress(AchievementCriteriaEntry const* criteri
 
     progress->counter = newValue;
     progress->changed = true;
+    UpdateCompletedCriteria(criteria, achievement, progress);
 
     // update client side value
     SendCriteriaUpdate(criteria->ID, progress);
@@ -3044,6 +3059,62 @@ AchievementCriteriaEntryList const& AchievementGlobalMgr::GetAchievementCriteria
     return m_AchievementCriteriasByType[type];
 }
 
+AchievementCriteriaEntryList const& AchievementGlobalMgr::GetAchievementCriteriaByType(AchievementCriteriaTypes type, uint32 miscValue)
+{
+    // 0 used at login/recheck for all criteria of type, and types without required misc value use all criteria
+    AchievementCriteriaListByMiscValue const& byMiscValue = m_AchievementCriteriasByMiscValue[type];
+    if (!miscValue || byMiscValue.empty())
+        return m_AchievementCriteriasByType[type];
+
+    AchievementCriteriaListByMiscValue::const_iterator itr = byMiscValue.find(miscValue);
+    if (itr == byMiscValue.end())
+    {
+        static AchievementCriteriaEntryList const emptyList;
+        return emptyList;
+    }
+
+    return itr->second;
+}
+
+/**
+ * Criteria types for which UpdateAchievementCriteria with non-zero miscvalue1 skips all criteria
+ * with other value in the returned field, so criteria can be selected by it without type list scan
+ */
+bool AchievementGlobalMgr::GetCriteriaMiscValueKey(AchievementCriteriaEntry const* criteria, uint32& key)
+{
+    switch (criteria->requiredType)
+    {
+        case ACHIEVEMENT_CRITERIA_TYPE_KILL_CREATURE:          key = criteria->kill_creature.creatureID;               return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_REACH_SKILL_LEVEL:      key = criteria->reach_skill_level.skillID;              return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_LEARN_SKILL_LEVEL:      key = criteria->learn_skill_level.skillID;              return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_COMPLETE_QUESTS_IN_ZONE: key = criteria->complete_quests_in_zone.zoneID;        return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_KILLED_BY_CREATURE:     key = criteria->killed_by_creature.creatureEntry;       return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_COMPLETE_QUEST:         key = criteria->complete_quest.questID;                 return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_BE_SPELL_TARGET:
+        case ACHIEVEMENT_CRITERIA_TYPE_BE_SPELL_TARGET2:       key = criteria->be_spell_target.spellID;                return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_CAST_SPELL:
+        case ACHIEVEMENT_CRITERIA_TYPE_CAST_SPELL2:            key = criteria->cast_spell.spellID;                     return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_LEARN_SPELL:            key = criteria->learn_spell.spellID;                    return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_LOOT_TYPE:              key = criteria->loot_type.lootType;                     return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_OWN_ITEM:               key = criteria->own_item.itemID;                        return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_WIN_ARENA:              key = criteria->win_arena.mapID;                        return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_PLAY_ARENA:             key = criteria->play_arena.mapID;                       return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_USE_ITEM:               key = criteria->use_item.itemID;                        return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_LOOT_ITEM:              key = criteria->loot_item.itemID;                       return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_GAIN_REPUTATION:        key = criteria->gain_reputation.factionID;              return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_DO_EMOTE:               key = criteria->do_emote.emoteID;                       return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_EQUIP_ITEM:             key = criteria->equip_item.itemID;                      return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_USE_GAMEOBJECT:         key = criteria->use_gameobject.goEntry;                 return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_FISH_IN_GAMEOBJECT:     key = criteria->fish_in_gameobject.goEntry;             return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_LEARN_SKILLLINE_SPELLS: key = criteria->learn_skillline_spell.skillLine;        return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_LEARN_SKILL_LINE:       key = criteria->learn_skill_line.skillLine;             return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_HK_CLASS:               key = criteria->hk_class.classID;                       return true;
+        case ACHIEVEMENT_CRITERIA_TYPE_HK_RACE:                key = criteria->hk_race.raceID;                         return true;
+        default:
+            return false;
+    }
+}
+
 AchievementCriteriaEntryList const* AchievementGlobalMgr::GetAchievementCriteriaByAchievement(uint32 id)
 {
     AchievementCriteriaListByAchievement::const_iterator itr = m_AchievementCriteriaListByAchievement.find(id);
@@ -3107,6 +3178,7 @@ void AchievementGlobalMgr::LoadAchievementCriteriaList()
     }
 
     uint32 count = 0;
+    uint32 keyed = 0;
     BarGoLink bar(sAchievementCriteriaStore.GetNumRows());
     for (uint32 entryId = 0; entryId < sAchievementCriteriaStore.GetNumRows(); ++entryId)
     {
@@ -3129,11 +3201,19 @@ void AchievementGlobalMgr::LoadAchievementCriteriaList()
 
         m_AchievementCriteriasByType[criteria->requiredType].push_back(criteria);
         m_AchievementCriteriaListByAchievement[criteria->referredAchievement].push_back(criteria);
+
+        uint32 miscValueKey;
+        if (GetCriteriaMiscValueKey(criteria, miscValueKey))
+        {
+            ++keyed;
+            m_AchievementCriteriasByMiscValue[criteria->requiredType][miscValueKey].push_back(criteria);
+        }
+
         ++count;
     }
 
     sLog.outString();
-    sLog.outString(">> Loaded %u achievement criteria.", count);
+    sLog.outString(">> Loaded %u achievement criteria (%u indexed by misc value).", count, keyed);
 }
 
 void AchievementGlobalMgr::LoadAchievementReferenceList()
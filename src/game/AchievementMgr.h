@@ -27,6 +27,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 struct AchievementEntry;
 struct AchievementCriteriaEntry;
@@ -35,6 +36,7 @@ typedef std::list<AchievementCriteriaEntry const*> AchievementCriteriaEntryList;
 typedef std::list<AchievementEntry const*>         AchievementEntryList;
 
 typedef std::map<uint32, AchievementCriteriaEntryList> AchievementCriteriaListByAchievement;
+typedef UNORDERED_MAP<uint32, AchievementCriteriaEntryList> AchievementCriteriaListByMiscValue;
 typedef std::map<uint32, AchievementEntryList>         AchievementListByReferencedId;
 typedef std::map<uint32, time_t>                       AchievementCriteriaFailTimeMap;
 
@@ -282,6 +284,7 @@ class AchievementMgr
         bool HasAchievement(uint32 achievement_id) const { return GetCompleteData(achievement_id) != NULL; }
         CompletedAchievementMap const& GetCompletedAchievements() const { return m_completedAchievements; }
         bool IsCompletedCriteria(AchievementCriteriaEntry const* criteria, AchievementEntry const* achievement) const;
+        static bool IsCompletedCriteriaProgress(AchievementCriteriaEntry const* criteria, AchievementEntry const* achievement, uint32 counter);
 
         uint32 GetCriteriaProgressCounter(AchievementCriteriaEntry const* entry) const;
         static uint32 GetCriteriaProgressMaxCounter(AchievementCriteriaEntry const* entry, AchievementEntry const* achievement);
@@ -299,9 +302,11 @@ class AchievementMgr
         void IncompletedAchievement(AchievementEntry const* entry);
         void CompleteAchievementsWithRefs(AchievementEntry const* entry);
         void BuildAllDataPacket(WorldPacket* data);
+        void UpdateCompletedCriteria(AchievementCriteriaEntry const* criteria, AchievementEntry const* achievement, CriteriaProgress const* progress);
 
         Player* m_player;
         CriteriaProgressMap m_criteriaProgress;
+        std::vector<bool> m_completedCriteria;              // by criteria id, progress reached max counter
         CompletedAchievementMap m_completedAchievements;
         AchievementCriteriaFailTimeMap m_criteriaFailTimes;
 };
@@ -310,6 +315,8 @@ class AchievementGlobalMgr
 {
     public:
         AchievementCriteriaEntryList const& GetAchievementCriteriaByType(AchievementCriteriaTypes type);
+        AchievementCriteriaEntryList const& GetAchievementCriteriaByType(AchievementCriteriaTypes type, uint32 miscValue);
+        static bool GetCriteriaMiscValueKey(AchievementCriteriaEntry const* criteria, uint32& key);
         AchievementCriteriaEntryList const* GetAchievementCriteriaByAchievement(uint32 id);
         AchievementEntryList const* GetAchievementByReferencedId(uint32 id) const;
         AchievementReward const* GetAchievementReward(AchievementEntry const* achievement, uint8 gender) const;
@@ -331,6 +338,8 @@ class AchievementGlobalMgr
 
         // store achievement criterias by type to speed up lookup
         AchievementCriteriaEntryList m_AchievementCriteriasByType[ACHIEVEMENT_CRITERIA_TYPE_TOTAL];
+        // store achievement criterias by type and required misc value (creature, spell, item...) for types where update misc value must match it
+        AchievementCriteriaListByMiscValue m_AchievementCriteriasByMiscValue[ACHIEVEMENT_CRITERIA_TYPE_TOTAL];
         // store achievement criterias by achievement to speed up lookup
         AchievementCriteriaListByAchievement m_AchievementCriteriaListByAchievement;
         // store achievements by referenced achievement id to speed up lookup
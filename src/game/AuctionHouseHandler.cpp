@@ -658,17 +658,6 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
     // always return pointer
     AuctionHouseObject* auctionHouse = sAuctionMgr.GetAuctionsMap(auctionHouseEntry);
 
-    // Sort
-    AuctionHouseObject::AuctionEntryMap const& aucs = auctionHouse->GetAuctions();
-    std::vector<AuctionEntry*> auctions;
-    auctions.reserve(aucs.size());
-
-    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = aucs.begin(); itr != aucs.end(); ++itr)
-        auctions.push_back(itr->second);
-
-    AuctionSorter sorter(Sort, GetPlayer());
-    std::sort(auctions.begin(), auctions.end(), sorter);
-
     // remove fake death
     if (GetPlayer()->hasUnitState(UNIT_STAT_DIED))
         GetPlayer()->RemoveSpellsCausingAura(SPELL_AURA_FEIGN_DEATH);
@@ -681,15 +670,34 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
     uint32 totalcount = 0;
     data << uint32(0);
 
+    AuctionSearchFilter filter;
+
     // converting string that we try to find to lower case
-    std::wstring wsearchedname;
-    if (!Utf8toWStr(searchedname, wsearchedname))
+    if (!Utf8toWStr(searchedname, filter.searchedname))
         return;
 
-    wstrToLower(wsearchedname);
+    wstrToLower(filter.searchedname);
 
-    BuildListAuctionItems(auctions, data, wsearchedname, listfrom, levelmin, levelmax, usable,
-                          auctionSlotID, auctionMainCategory, auctionSubCategory, quality, count, totalcount, isFull);
+    // full list request not filtered
+    if (isFull)
+        filter = AuctionSearchFilter();
+    else
+    {
+        filter.locale = GetSessionDbLocaleIndex();
+        filter.levelmin = levelmin;
+        filter.levelmax = levelmax;
+        filter.inventoryType = auctionSlotID;
+        filter.itemClass = auctionMainCategory;
+        filter.itemSubClass = auctionSubCategory;
+        filter.quality = quality;
+    }
+
+    // Select by indexes, sorted only requested page
+    std::vector<AuctionEntry*> auctions;
+    auctionHouse->FindAuctions(filter, auctions);
+
+    AuctionSorter sorter(Sort, GetPlayer());
+    BuildListAuctionItems(auctions, data, sorter, listfrom, usable, count, totalcount, isFull);
 
     data.put<uint32>(0, count);
     data << uint32(totalcount);
@@ -582,6 +582,7 @@ void AuctionHouseObject::Update()
 
                 itr->second->DeleteFromDB();
                 MANGOS_ASSERT(!itr->second->itemGuidLow);   // already removed or send in mail at won
+                RemoveFromIndex(itr->second);
                 delete itr->second;
                 AuctionsMap.erase(itr++);
                 continue;
@@ -600,6 +601,7 @@ void AuctionHouseObject::Update()
                     sAuctionMgr.SendAuctionExpiredMail(itr->second);
 
                     itr->second->DeleteFromDB();
+                    RemoveFromIndex(itr->second);
                     delete itr->second;
                     AuctionsMap.erase(itr++);
                     continue;
@@ -797,62 +799,177 @@ bool AuctionSorter::operator()(const AuctionEntry* auc1, const AuctionEntry* auc
     return false;                                           // "equal" by all sorts
 }
 
-void WorldSession::BuildListAuctionItems(std::vector<AuctionEntry*> const& auctions, WorldPacket& data, std::wstring const& wsearchedname, uint32 listfrom, uint32 levelmin,
-        uint32 levelmax, uint32 usable, uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality, uint32& count, uint32& totalcount, bool isFull)
+void WorldSession::BuildListAuctionItems(std::vector<AuctionEntry*>& auctions, WorldPacket& data, AuctionSorter const& sorter, uint32 listfrom,
+        uint32 usable, uint32& count, uint32& totalcount, bool isFull)
 {
-    int loc_idx = _player->GetSession()->GetSessionDbLocaleIndex();
-
+    // drop auctions without item and not usable by player, all rest counted in total
+    std::vector<AuctionEntry*>::iterator last = auctions.begin();
     for (std::vector<AuctionEntry*>::const_iterator itr = auctions.begin(); itr != auctions.end(); ++itr)
     {
-        AuctionEntry* Aentry = *itr;
-        if (!Aentry || Aentry->moneyDeliveryTime)
-            continue;
-        Item* item = sAuctionMgr.GetAItem(Aentry->itemGuidLow);
+        Item* item = sAuctionMgr.GetAItem((*itr)->itemGuidLow);
         if (!item)
             continue;
 
-        if (isFull)
+        if (!isFull && usable != 0x00 && _player->CanUseItem(item) != EQUIP_ERR_OK)
+            continue;
+
+        *last++ = *itr;
+    }
+    auctions.erase(last, auctions.end());
+
+    totalcount = auctions.size();
+
+    if (isFull)
+    {
+        for (std::vector<AuctionEntry*>::const_iterator itr = auctions.begin(); itr != auctions.end(); ++itr)
         {
             ++count;
-            Aentry->BuildAuctionInfo(data);
+            (*itr)->BuildAuctionInfo(data);
         }
-        else
-        {
-            ItemPrototype const* proto = item->GetProto();
+        return;
+    }
 
-            if (itemClass != 0xffffffff && proto->Class != itemClass)
-                continue;
+    if (listfrom >= auctions.size())
+        return;
 
-            if (itemSubClass != 0xffffffff && proto->SubClass != itemSubClass)
-                continue;
+    // only auctions up to end of requested page must be ordered
+    std::vector<AuctionEntry*>::iterator pageEnd = auctions.begin() + std::min(size_t(listfrom + 50), auctions.size());
+    std::partial_sort(auctions.begin(), pageEnd, auctions.end(), sorter);
 
-            if (inventoryType != 0xffffffff && proto->InventoryType != inventoryType)
-                continue;
+    for (std::vector<AuctionEntry*>::const_iterator itr = auctions.begin() + listfrom; itr != pageEnd; ++itr)
+    {
+        ++count;
+        (*itr)->BuildAuctionInfo(data);
+    }
+}
 
-            if (quality != 0xffffffff && proto->Quality < quality)
-                continue;
+bool AuctionSearchFilter::IsFitTo(AuctionTemplateGroup const& group) const
+{
+    ItemPrototype const* proto = group.proto;
 
-            if (levelmin != 0x00 && (proto->RequiredLevel < levelmin || (levelmax != 0x00 && proto->RequiredLevel > levelmax)))
-                continue;
+    if (itemClass != 0xffffffff && proto->Class != itemClass)
+        return false;
 
-            if (usable != 0x00 && _player->CanUseItem(item) != EQUIP_ERR_OK)
-                continue;
+    if (itemSubClass != 0xffffffff && proto->SubClass != itemSubClass)
+        return false;
 
-            std::string name = proto->Name1;
-            sObjectMgr.GetItemLocaleStrings(proto->ItemId, loc_idx, &name);
+    if (inventoryType != 0xffffffff && proto->InventoryType != inventoryType)
+        return false;
 
-            if (!wsearchedname.empty() && !Utf8FitTo(name, wsearchedname))
-                continue;
+    if (quality != 0xffffffff && proto->Quality < quality)
+        return false;
 
-            if (count < 50 && totalcount >= listfrom)
-            {
-                ++count;
-                Aentry->BuildAuctionInfo(data);
-            }
-        }
+    if (levelmin != 0x00 && (proto->RequiredLevel < levelmin || (levelmax != 0x00 && proto->RequiredLevel > levelmax)))
+        return false;
+
+    if (searchedname.empty())
+        return true;
+
+    // default locale names are cached in lower case at indexing
+    if (locale < 0)
+        return group.lowerName.find(searchedname) != std::wstring::npos;
+
+    std::string name = proto->Name1;
+    sObjectMgr.GetItemLocaleStrings(proto->ItemId, locale, &name);
+
+    return Utf8FitTo(name, searchedname);
+}
+
+static void AddFitAuctions(AuctionSearchFilter const& filter, AuctionTemplateGroup const& group, std::vector<AuctionEntry*>& auctions)
+{
+    if (!filter.IsFitTo(group))
+        return;
+
+    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = group.auctions.begin(); itr != group.auctions.end(); ++itr)
+    {
+        if (itr->second->moneyDeliveryTime)                 // skip pending sell auctions
+            continue;
+
+        auctions.push_back(itr->second);
+    }
+}
+
+void AuctionHouseObject::FindAuctions(AuctionSearchFilter const& filter, std::vector<AuctionEntry*>& auctions) const
+{
+    if (filter.itemClass != 0xffffffff)
+    {
+        // class index ordered by class and subclass, so any subclass of class is continuous range
+        uint32 lowKey = filter.itemClass << 16 | (filter.itemSubClass != 0xffffffff ? filter.itemSubClass : 0x0000);
+        uint32 highKey = filter.itemClass << 16 | (filter.itemSubClass != 0xffffffff ? filter.itemSubClass : 0xFFFF);
+
+        AuctionClassIndex::const_iterator end = m_classIndex.upper_bound(highKey);
+        for (AuctionClassIndex::const_iterator itr = m_classIndex.lower_bound(lowKey); itr != end; ++itr)
+            AddFitAuctions(filter, *itr->second, auctions);
+    }
+    else
+    {
+        for (AuctionTemplateGroupMap::const_iterator itr = m_templateGroups.begin(); itr != m_templateGroups.end(); ++itr)
+            AddFitAuctions(filter, itr->second, auctions);
+    }
+}
+
+void AuctionHouseObject::AddAuction(AuctionEntry* ah)
+{
+    MANGOS_ASSERT(ah);
+    AuctionsMap[ah->Id] = ah;
+    AddToIndex(ah);
+}
+
+bool AuctionHouseObject::RemoveAuction(uint32 id)
+{
+    AuctionEntryMap::iterator itr = AuctionsMap.find(id);
+    if (itr == AuctionsMap.end())
+        return false;
+
+    RemoveFromIndex(itr->second);
+    AuctionsMap.erase(itr);
+    return true;
+}
 
-        ++totalcount;
+void AuctionHouseObject::AddToIndex(AuctionEntry* ah)
+{
+    AuctionTemplateGroupMap::iterator itr = m_templateGroups.find(ah->itemTemplate);
+    if (itr == m_templateGroups.end())
+    {
+        ItemPrototype const* proto = ObjectMgr::GetItemPrototype(ah->itemTemplate);
+        if (!proto)
+            return;
+
+        itr = m_templateGroups.insert(AuctionTemplateGroupMap::value_type(ah->itemTemplate, AuctionTemplateGroup())).first;
+
+        AuctionTemplateGroup& group = itr->second;
+        group.proto = proto;
+        Utf8toWStr(proto->Name1, group.lowerName);
+        wstrToLower(group.lowerName);
+
+        m_classIndex.insert(AuctionClassIndex::value_type(proto->Class << 16 | proto->SubClass, &group));
     }
+
+    itr->second.auctions[ah->Id] = ah;
+}
+
+void AuctionHouseObject::RemoveFromIndex(AuctionEntry* ah)
+{
+    AuctionTemplateGroupMap::iterator itr = m_templateGroups.find(ah->itemTemplate);
+    if (itr == m_templateGroups.end())
+        return;
+
+    AuctionTemplateGroup& group = itr->second;
+    group.auctions.erase(ah->Id);
+    if (!group.auctions.empty())
+        return;
+
+    std::pair<AuctionClassIndex::iterator, AuctionClassIndex::iterator> bounds = m_classIndex.equal_range(group.proto->Class << 16 | group.proto->SubClass);
+    for (AuctionClassIndex::iterator classItr = bounds.first; classItr != bounds.second; ++classItr)
+    {
+        if (classItr->second == &group)
+        {
+            m_classIndex.erase(classItr);
+            break;
+        }
+    }
+
+    m_templateGroups.erase(itr);
 }
 
 void AuctionHouseObject::BuildListPendingSales(WorldPacket& data, Player* player, uint32& count)
@@ -1042,3 +1159,147 @@ bool AuctionEntry::UpdateBid(uint32 newbid, Player* newbidder /*=NULL*/)
         return false;
     }
 }
+
+struct AuctionBenchmarkQuery
+{
+    AuctionSearchFilter filter;
+    uint8 sort[MAX_AUCTION_SORT];
+    uint32 listfrom;
+};
+
+void AuctionHouseObject::BenchmarkSearch(Player* viewPlayer, uint32 auctionsCount, uint32 queriesCount,
+    uint64& sortedTime, uint64& indexedTime, uint64& foundCount, uint32& mismatches)
+{
+    sortedTime = indexedTime = foundCount = 0;
+    mismatches = 0;
+
+    std::vector<ItemPrototype const*> protos;
+    for (uint32 id = 0; id < sItemStorage.GetMaxEntry(); ++id)
+        if (ItemPrototype const* proto = sItemStorage.LookupEntry<ItemPrototype>(id))
+            protos.push_back(proto);
+
+    if (protos.empty() || !auctionsCount || !queriesCount)
+        return;
+
+    // Auctions not linked to items and not saved, only browse data filled
+    AuctionHouseObject house;
+    time_t now = time(NULL);
+    for (uint32 i = 0; i < auctionsCount; ++i)
+    {
+        ItemPrototype const* proto = protos[urand(0, protos.size() - 1)];
+
+        AuctionEntry* ah = new AuctionEntry;
+        ah->Id = i + 1;
+        ah->itemGuidLow = 0;
+        ah->itemTemplate = proto->ItemId;
+        ah->itemCount = urand(1, std::min(proto->GetMaxStackSize(), uint32(20)));
+        ah->itemRandomPropertyId = 0;
+        ah->owner = 0;
+        ah->startbid = urand(1, 100000);
+        ah->bid = urand(0, 1) ? ah->startbid + urand(0, 10000) : 0;
+        ah->buyout = ah->startbid + urand(0, 100000);
+        ah->expireTime = now + urand(1, 48) * HOUR;
+        ah->moneyDeliveryTime = 0;
+        ah->bidder = 0;
+        ah->deposit = 0;
+        ah->auctionHouseEntry = NULL;
+        house.AddAuction(ah);
+    }
+
+    // Browse traffic - category clicks, name searches, level and quality ranges and plain listing
+    std::vector<AuctionBenchmarkQuery> queries(queriesCount);
+    for (uint32 i = 0; i < queriesCount; ++i)
+    {
+        AuctionBenchmarkQuery& query = queries[i];
+        ItemPrototype const* proto = protos[urand(0, protos.size() - 1)];
+
+        switch (i % 5)
+        {
+            case 0:
+                query.filter.itemClass = proto->Class;
+                break;
+            case 1:
+                query.filter.itemClass = proto->Class;
+                query.filter.itemSubClass = proto->SubClass;
+                break;
+            case 2:
+            {
+                std::wstring name;
+                Utf8toWStr(proto->Name1, name);
+                wstrToLower(name);
+                size_t len = std::min(name.size(), size_t(4));
+                query.filter.searchedname = name.substr(urand(0, name.size() - len), len);
+                break;
+            }
+            case 3:
+                query.filter.quality = proto->Quality;
+                query.filter.levelmin = proto->RequiredLevel > 5 ? proto->RequiredLevel - 5 : 1;
+                query.filter.levelmax = proto->RequiredLevel + 5;
+                break;
+            default:
+                break;
+        }
+
+        memset(query.sort, MAX_AUCTION_SORT, MAX_AUCTION_SORT);
+        query.sort[0] = urand(0, MAX_AUCTION_SORT - 2) | (urand(0, 1) ? AUCTION_SORT_REVERSED : 0);
+        query.listfrom = urand(0, 3) ? 0 : 50 * urand(1, 3);
+    }
+
+    std::vector<AuctionEntry*> auctions;
+    std::vector<uint32> sortedTotals(queriesCount);
+
+    // Full copy and sort of house, then filter each auction
+    uint64 startTime = WorldTimer::getMicroTime();
+    for (uint32 i = 0; i < queriesCount; ++i)
+    {
+        AuctionBenchmarkQuery& query = queries[i];
+
+        auctions.clear();
+        for (AuctionEntryMap::const_iterator itr = house.AuctionsMap.begin(); itr != house.AuctionsMap.end(); ++itr)
+            auctions.push_back(itr->second);
+
+        std::sort(auctions.begin(), auctions.end(), AuctionSorter(query.sort, viewPlayer));
+
+        uint32 count = 0;
+        uint32 totalcount = 0;
+        for (std::vector<AuctionEntry*>::const_iterator itr = auctions.begin(); itr != auctions.end(); ++itr)
+        {
+            AuctionTemplateGroup group;
+            group.proto = ObjectMgr::GetItemPrototype((*itr)->itemTemplate);
+            if (!query.filter.searchedname.empty())
+            {
+                Utf8toWStr(group.proto->Name1, group.lowerName);
+                wstrToLower(group.lowerName);
+            }
+            if (!query.filter.IsFitTo(group))
+                continue;
+
+            if (count < 50 && totalcount >= query.listfrom)
+                ++count;
+            ++totalcount;
+        }
+        sortedTotals[i] = totalcount;
+    }
+    sortedTime = (WorldTimer::getMicroTime() - startTime) / queriesCount;
+
+    // Indexed select, then order only requested page
+    startTime = WorldTimer::getMicroTime();
+    for (uint32 i = 0; i < queriesCount; ++i)
+    {
+        AuctionBenchmarkQuery& query = queries[i];
+
+        auctions.clear();
+        house.FindAuctions(query.filter, auctions);
+
+        if (query.listfrom < auctions.size())
+        {
+            std::vector<AuctionEntry*>::iterator pageEnd = auctions.begin() + std::min(size_t(query.listfrom + 50), auctions.size());
+            std::partial_sort(auctions.begin(), pageEnd, auctions.end(), AuctionSorter(query.sort, viewPlayer));
+        }
+
+        foundCount += auctions.size();
+        if (auctions.size() != sortedTotals[i])
+            ++mismatches;
+    }
+    indexedTime = (WorldTimer::getMicroTime() - startTime) / queriesCount;
+}
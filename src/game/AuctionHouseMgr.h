@@ -95,6 +95,33 @@ struct AuctionEntry
     bool UpdateBid(uint32 newbid, Player* newbidder = NULL);// true if normal bid, false if buyout, bidder==NULL for generated bid
 };
 
+// auctions with same item template, filtered together by item prototype data
+struct AuctionTemplateGroup
+{
+    AuctionTemplateGroup() : proto(NULL) {}
+
+    ItemPrototype const* proto;
+    std::wstring lowerName;                                 // default locale name in lower case, for name search
+    std::map<uint32, AuctionEntry*> auctions;               // auctions ordered by id
+};
+
+// item prototype based part of auction browse query
+struct AuctionSearchFilter
+{
+    AuctionSearchFilter() : locale(-1), levelmin(0), levelmax(0), inventoryType(0xffffffff), itemClass(0xffffffff), itemSubClass(0xffffffff), quality(0xffffffff) {}
+
+    std::wstring searchedname;                              // lower case, empty for any name
+    int32 locale;                                           // locale index of searched name
+    uint32 levelmin;
+    uint32 levelmax;
+    uint32 inventoryType;
+    uint32 itemClass;
+    uint32 itemSubClass;
+    uint32 quality;
+
+    bool IsFitTo(AuctionTemplateGroup const& group) const;
+};
+
 // this class is used as auctionhouse instance
 class AuctionHouseObject
 {
@@ -114,11 +141,7 @@ class AuctionHouseObject
         AuctionEntryMap const& GetAuctions() const { return AuctionsMap; }
         AuctionEntryMapBounds GetAuctionsBounds() const {return AuctionEntryMapBounds(AuctionsMap.begin(), AuctionsMap.end()); }
 
-        void AddAuction(AuctionEntry* ah)
-        {
-            MANGOS_ASSERT(ah);
-            AuctionsMap[ah->Id] = ah;
-        }
+        void AddAuction(AuctionEntry* ah);
 
         AuctionEntry* GetAuction(uint32 id) const
         {
@@ -126,10 +149,7 @@ class AuctionHouseObject
             return itr != AuctionsMap.end() ? itr->second : NULL;
         }
 
-        bool RemoveAuction(uint32 id)
-        {
-            return AuctionsMap.erase(id);
-        }
+        bool RemoveAuction(uint32 id);
 
         void Update();
 
@@ -137,9 +157,24 @@ class AuctionHouseObject
         void BuildListOwnerItems(WorldPacket& data, Player* player, uint32& count, uint32& totalcount);
         void BuildListPendingSales(WorldPacket& data, Player* player, uint32& count);
 
+        // select not pending auctions fit to filter, using item template indexes
+        void FindAuctions(AuctionSearchFilter const& filter, std::vector<AuctionEntry*>& auctions) const;
+
         AuctionEntry* AddAuction(AuctionHouseEntry const* auctionHouseEntry, Item* newItem, uint32 etime, uint32 bid, uint32 buyout = 0, uint32 deposit = 0, Player* pl = NULL);
+
+        // Run browse queries against generated auctions, by full sort and by indexes
+        static void BenchmarkSearch(Player* viewPlayer, uint32 auctionsCount, uint32 queriesCount,
+            uint64& sortedTime, uint64& indexedTime, uint64& foundCount, uint32& mismatches);
     private:
+        typedef std::map<uint32 /*item template*/, AuctionTemplateGroup> AuctionTemplateGroupMap;
+        typedef std::multimap<uint32 /*class << 16 | subclass*/, AuctionTemplateGroup*> AuctionClassIndex;
+
+        void AddToIndex(AuctionEntry* ah);
+        void RemoveFromIndex(AuctionEntry* ah);
+
         AuctionEntryMap AuctionsMap;
+        AuctionTemplateGroupMap m_templateGroups;
+        AuctionClassIndex m_classIndex;
 };
 
 class AuctionSorter
@@ -637,6 +637,7 @@ void BattleGround::SetTeamStartLoc(Team team, float X, float Y, float Z, float O
 
 void BattleGround::SendPacketToAll(WorldPacket* packet)
 {
+    SharedPacket sharedPacket(packet);
     for (BattleGroundPlayerMap::const_iterator itr = m_Players.begin(); itr != m_Players.end(); ++itr)
     {
         if (itr->second.OfflineRemoveTime)
@@ -644,7 +645,7 @@ void BattleGround::SendPacketToAll(WorldPacket* packet)
 
         Player* plr = sObjectMgr.GetPlayer(itr->first);
         if (plr)
-            plr->GetSession()->SendPacket(packet);
+            plr->GetSession()->SendPacket(sharedPacket);
         else
             sLog.outError("BattleGround:SendPacketToAll: %s not found!", itr->first.GetString().c_str());
     }
@@ -220,6 +220,24 @@ ChatCommand* ChatHandler::getCommandTable()
         { NULL,             0,                  false, NULL,                                           "", NULL }
     };
 
+    static ChatCommand debugBenchReplayCommandTable[] =
+    {
+        { "start",          SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugBenchReplayStartCommand,    "", NULL },
+        { "stats",          SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugBenchReplayStatsCommand,    "", NULL },
+        { "stop",           SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugBenchReplayStopCommand,     "", NULL },
+        { NULL,             0,                  false, NULL,                                                "", NULL }
+    };
+
+    static ChatCommand debugBenchCommandTable[] =
+    {
+        { "auction",        SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugBenchAuctionCommand,        "", NULL },
+        { "broadcast",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugBenchBroadcastCommand,      "", NULL },
+        { "los",            SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugBenchLosCommand,            "", NULL },
+        { "replay",         SEC_ADMINISTRATOR,  true,  NULL,                                                "", debugBenchReplayCommandTable },
+        { "values",         SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugBenchValuesCommand,         "", NULL },
+        { NULL,             0,                  false, NULL,                                                "", NULL }
+    };
+
     static ChatCommand debugPlayCommandTable[] =
     {
         { "cinematic",      SEC_MODERATOR,      false, &ChatHandler::HandleDebugPlayCinematicCommand,       "", NULL },
@@ -250,6 +268,7 @@ ChatCommand* ChatHandler::getCommandTable()
     {
         { "anim",           SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugAnimCommand,                "", NULL },
         { "arena",          SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugArenaCommand,               "", NULL },
+        { "bench",          SEC_ADMINISTRATOR,  true,  NULL,                                                "", debugBenchCommandTable },
         { "bg",             SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugBattlegroundCommand,        "", NULL },
         { "getitemstate",   SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugGetItemStateCommand,        "", NULL },
         { "lootrecipient",  SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugGetLootRecipientCommand,    "", NULL },
@@ -714,12 +733,15 @@ ChatCommand* ChatHandler::getCommandTable()
 
     static ChatCommand serverCommandTable[] =
     {
+        { "compression",    SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerCompressionCommand,   "", NULL },
         { "corpses",        SEC_GAMEMASTER,     true,  &ChatHandler::HandleServerCorpsesCommand,       "", NULL },
+        { "database",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerDatabaseCommand,      "", NULL },
         { "exit",           SEC_CONSOLE,        true,  &ChatHandler::HandleServerExitCommand,          "", NULL },
         { "idlerestart",    SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverIdleRestartCommandTable },
         { "idleshutdown",   SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverShutdownCommandTable },
         { "info",           SEC_PLAYER,         true,  &ChatHandler::HandleServerInfoCommand,          "", NULL },
         { "log",            SEC_CONSOLE,        true,  NULL,                                           "", serverLogCommandTable },
+        { "mapstats",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerMapStatsCommand,      "", NULL },
         { "motd",           SEC_PLAYER,         true,  &ChatHandler::HandleServerMotdCommand,          "", NULL },
         { "plimit",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerPLimitCommand,        "", NULL },
         { "restart",        SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverRestartCommandTable },
@@ -221,6 +221,14 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleDebugEnterVehicleCommand(char* args);
         bool HandleDebugSendCalendarResultCommand(char* args);
 
+        bool HandleDebugBenchAuctionCommand(char* args);
+        bool HandleDebugBenchBroadcastCommand(char* args);
+        bool HandleDebugBenchLosCommand(char* args);
+        bool HandleDebugBenchReplayStartCommand(char* args);
+        bool HandleDebugBenchReplayStatsCommand(char* args);
+        bool HandleDebugBenchReplayStopCommand(char* args);
+        bool HandleDebugBenchValuesCommand(char* args);
+
         bool HandleDebugPlayCinematicCommand(char* args);
         bool HandleDebugPlayMovieCommand(char* args);
         bool HandleDebugPlaySoundCommand(char* args);
@@ -517,6 +525,9 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleServerInfoCommand(char* args);
         bool HandleServerLogFilterCommand(char* args);
         bool HandleServerLogLevelCommand(char* args);
+        bool HandleServerMapStatsCommand(char* args);
+        bool HandleServerCompressionCommand(char* args);
+        bool HandleServerDatabaseCommand(char* args);
         bool HandleServerMotdCommand(char* args);
         bool HandleServerPLimitCommand(char* args);
         bool HandleServerRestartCommand(char* args);
@@ -54,6 +54,7 @@
 
 // apply implementation of the singletons
 #include "Policies/Singleton.h"
+#include "MapObjectPool.h"
 
 ObjectGuid CreatureData::GetObjectGuid(uint32 lowguid) const
 {
@@ -161,6 +162,16 @@ Creature::~Creature()
     i_AI = NULL;
 }
 
+void* Creature::operator new(size_t size)
+{
+    return MapObjectPool::Allocate(MAP_POOL_CREATURE, size);
+}
+
+void Creature::operator delete(void* ptr)
+{
+    MapObjectPool::Free(ptr);
+}
+
 void Creature::AddToWorld()
 {
     Unit::AddToWorld();
@@ -212,33 +223,25 @@ void Creature::RemoveCorpse()
 /**
  * change the entry of creature until respawn
  */
-bool Creature::InitEntry(uint32 Entry, CreatureData const* data /*=NULL*/, GameEventCreatureData const* eventData /*=NULL*/)
+bool Creature::InitEntry(uint32 Entry, CreatureData const* data /*=NULL*/, GameEventCreatureData const* eventData /*=NULL*/, LoadingObjectPrepared const* prepared /*=NULL*/)
 {
     // use game event entry if any instead default suggested
     if (eventData && eventData->entry_id)
         Entry = eventData->entry_id;
 
-    CreatureInfo const* normalInfo = ObjectMgr::GetCreatureTemplate(Entry);
+    // prepared templates and model are valid only for default entry and model
+    if (prepared && (eventData || !prepared->creatureInfo || prepared->creatureInfo->Entry != Entry))
+        prepared = NULL;
+
+    CreatureInfo const* normalInfo = prepared ? prepared->creatureInfo : ObjectMgr::GetCreatureTemplate(Entry);
     if (!normalInfo)
     {
         sLog.outErrorDb("Creature::UpdateEntry creature entry %u does not exist.", Entry);
         return false;
     }
 
-    CreatureInfo const* cinfo = normalInfo;
-    for (Difficulty diff = GetMap()->GetDifficulty(); diff > REGULAR_DIFFICULTY; diff = GetPrevDifficulty(diff, GetMap()->IsRaid()))
-    {
-        // we already have valid Map pointer for current creature!
-        if (normalInfo->DifficultyEntry[diff - 1])
-        {
-            cinfo = ObjectMgr::GetCreatureTemplate(normalInfo->DifficultyEntry[diff - 1]);
-            if (cinfo)
-                break;                                      // template found
-
-            // check and reported at startup, so just ignore (restore normalInfo)
-            cinfo = normalInfo;
-        }
-    }
+    // we already have valid Map pointer for current creature!
+    CreatureInfo const* cinfo = prepared ? prepared->difficultyInfo : GetDifficultyTemplate(normalInfo, GetMap());
 
     SetEntry(Entry);                                        // normal entry always
     m_creatureInfo = cinfo;                                 // map mode related always
@@ -251,21 +254,25 @@ bool Creature::InitEntry(uint32 Entry, CreatureData const* data /*=NULL*/, GameE
     // known valid are: CLASS_WARRIOR,CLASS_PALADIN,CLASS_ROGUE,CLASS_MAGE
     SetByteValue(UNIT_FIELD_BYTES_0, 1, uint8(cinfo->unit_class));
 
-    uint32 display_id = ChooseDisplayId(GetCreatureInfo(), data, eventData);
-    if (!display_id)                                        // Cancel load if no display id
+    CreatureModelInfo const* minfo = prepared ? prepared->modelInfo : NULL;
+    if (!minfo)
     {
-        sLog.outErrorDb("Creature (Entry: %u) has no model defined in table `creature_template`, can't load.", Entry);
-        return false;
-    }
+        uint32 display_id = ChooseDisplayId(GetCreatureInfo(), data, eventData);
+        if (!display_id)                                    // Cancel load if no display id
+        {
+            sLog.outErrorDb("Creature (Entry: %u) has no model defined in table `creature_template`, can't load.", Entry);
+            return false;
+        }
 
-    CreatureModelInfo const* minfo = sObjectMgr.GetCreatureModelRandomGender(display_id);
-    if (!minfo)                                             // Cancel load if no model defined
-    {
-        sLog.outErrorDb("Creature (Entry: %u) has no model info defined in table `creature_model_info`, can't load.", Entry);
-        return false;
+        minfo = sObjectMgr.GetCreatureModelRandomGender(display_id);
+        if (!minfo)                                         // Cancel load if no model defined
+        {
+            sLog.outErrorDb("Creature (Entry: %u) has no model info defined in table `creature_model_info`, can't load.", Entry);
+            return false;
+        }
     }
 
-    display_id = minfo->modelid;                            // it can be different (for another gender)
+    uint32 display_id = minfo->modelid;                     // it can be different (for another gender)
 
     SetNativeDisplayId(display_id);
 
@@ -312,9 +319,9 @@ bool Creature::InitEntry(uint32 Entry, CreatureData const* data /*=NULL*/, GameE
     return true;
 }
 
-bool Creature::UpdateEntry(uint32 Entry, Team team, const CreatureData* data /*=NULL*/, GameEventCreatureData const* eventData /*=NULL*/, bool preserveHPAndPower /*=true*/)
+bool Creature::UpdateEntry(uint32 Entry, Team team, const CreatureData* data /*=NULL*/, GameEventCreatureData const* eventData /*=NULL*/, bool preserveHPAndPower /*=true*/, LoadingObjectPrepared const* prepared /*=NULL*/)
 {
-    if (!InitEntry(Entry, data, eventData))
+    if (!InitEntry(Entry, data, eventData, prepared))
         return false;
 
     m_regenHealth = GetCreatureInfo()->RegenHealth;
@@ -378,6 +385,22 @@ bool Creature::UpdateEntry(uint32 Entry, Team team, const CreatureData* data /*=
     return true;
 }
 
+CreatureInfo const* Creature::GetDifficultyTemplate(CreatureInfo const* normalInfo, Map const* map)
+{
+    for (Difficulty diff = map->GetDifficulty(); diff > REGULAR_DIFFICULTY; diff = GetPrevDifficulty(diff, map->IsRaid()))
+    {
+        if (normalInfo->DifficultyEntry[diff - 1])
+        {
+            if (CreatureInfo const* cinfo = ObjectMgr::GetCreatureTemplate(normalInfo->DifficultyEntry[diff - 1]))
+                return cinfo;                               // template found
+
+            // check and reported at startup, so just ignore (use normalInfo)
+        }
+    }
+
+    return normalInfo;
+}
+
 uint32 Creature::ChooseDisplayId(const CreatureInfo* cinfo, const CreatureData* data /*= NULL*/, GameEventCreatureData const* eventData /*=NULL*/)
 {
     // Use creature event model explicit, override any other static models
@@ -778,12 +801,12 @@ bool Creature::AIM_Initialize()
     return true;
 }
 
-bool Creature::Create(uint32 guidlow, CreatureCreatePos& cPos, CreatureInfo const* cinfo, Team team /*= TEAM_NONE*/, const CreatureData* data /*= NULL*/, GameEventCreatureData const* eventData /*= NULL*/)
+bool Creature::Create(uint32 guidlow, CreatureCreatePos& cPos, CreatureInfo const* cinfo, Team team /*= TEAM_NONE*/, const CreatureData* data /*= NULL*/, GameEventCreatureData const* eventData /*= NULL*/, LoadingObjectPrepared const* prepared /*= NULL*/)
 {
     SetMap(cPos.GetMap());
     SetPhaseMask(cPos.GetPhaseMask(), false);
 
-    if (!CreateFromProto(guidlow, cinfo, team, data, eventData))
+    if (!CreateFromProto(guidlow, cinfo, team, data, eventData, prepared))
         return false;
 
     cPos.SelectFinalPoint(this);
@@ -1262,18 +1285,18 @@ float Creature::GetSpellDamageMod(int32 Rank)
     }
 }
 
-bool Creature::CreateFromProto(uint32 guidlow, CreatureInfo const* cinfo, Team team, const CreatureData* data /*=NULL*/, GameEventCreatureData const* eventData /*=NULL*/)
+bool Creature::CreateFromProto(uint32 guidlow, CreatureInfo const* cinfo, Team team, const CreatureData* data /*=NULL*/, GameEventCreatureData const* eventData /*=NULL*/, LoadingObjectPrepared const* prepared /*=NULL*/)
 {
     m_originalEntry = cinfo->Entry;
 
     Object::_Create(guidlow, cinfo->Entry, cinfo->GetHighGuid());
 
-    return UpdateEntry(cinfo->Entry, team, data, eventData, false);
+    return UpdateEntry(cinfo->Entry, team, data, eventData, false, prepared);
 }
 
-bool Creature::LoadFromDB(uint32 guidlow, Map* map)
+bool Creature::LoadFromDB(uint32 guidlow, Map* map, LoadingObjectPrepared const* prepared /*=NULL*/)
 {
-    CreatureData const* data = sObjectMgr.GetCreatureData(guidlow);
+    CreatureData const* data = prepared && prepared->creatureData ? prepared->creatureData : sObjectMgr.GetCreatureData(guidlow);
 
     if (!data)
     {
@@ -1281,7 +1304,7 @@ bool Creature::LoadFromDB(uint32 guidlow, Map* map)
         return false;
     }
 
-    CreatureInfo const* cinfo = ObjectMgr::GetCreatureTemplate(data->id);
+    CreatureInfo const* cinfo = prepared && prepared->creatureInfo ? prepared->creatureInfo : ObjectMgr::GetCreatureTemplate(data->id);
     if (!cinfo)
     {
         sLog.outErrorDb("Creature (Entry: %u) not found in table `creature_template`, can't load. ", data->id);
@@ -1296,7 +1319,7 @@ bool Creature::LoadFromDB(uint32 guidlow, Map* map)
 
     CreatureCreatePos pos(map, data->posX, data->posY, data->posZ, data->orientation, data->phaseMask);
 
-    if (!Create(guidlow, pos, cinfo, TEAM_NONE, data, eventData))
+    if (!Create(guidlow, pos, cinfo, TEAM_NONE, data, eventData, prepared))
         return false;
 
     SetRespawnCoord(pos);
@@ -39,6 +39,7 @@ class Player;
 class WorldSession;
 
 struct GameEventCreatureData;
+struct LoadingObjectPrepared;
 
 enum CreatureFlagsExtra
 {
@@ -490,10 +491,14 @@ class MANGOS_DLL_SPEC Creature : public Unit
         explicit Creature(CreatureSubtype subtype = CREATURE_SUBTYPE_GENERIC);
         virtual ~Creature();
 
+        // memory from object pool of map updated by current thread (see MapObjectPool)
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr);
+
         void AddToWorld();
         virtual void RemoveFromWorld(bool remove) override;
 
-        bool Create(uint32 guidlow, CreatureCreatePos& cPos, CreatureInfo const* cinfo, Team team = TEAM_NONE, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL);
+        bool Create(uint32 guidlow, CreatureCreatePos& cPos, CreatureInfo const* cinfo, Team team = TEAM_NONE, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL, LoadingObjectPrepared const* prepared = NULL);
         bool LoadCreatureAddon(bool reload = false);
         void SelectLevel(const CreatureInfo* cinfo, float percentHealth = 100.0f, float percentMana = 100.0f);
         void LoadEquipment(uint32 equip_entry, bool force = false);
@@ -588,7 +593,7 @@ class MANGOS_DLL_SPEC Creature : public Unit
 
         bool HasSpell(uint32 spellID);
 
-        bool UpdateEntry(uint32 entry, Team team = ALLIANCE, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL, bool preserveHPAndPower = true);
+        bool UpdateEntry(uint32 entry, Team team = ALLIANCE, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL, bool preserveHPAndPower = true, LoadingObjectPrepared const* prepared = NULL);
 
         void ApplyGameEventSpells(GameEventCreatureData const* eventData, bool activated);
         bool UpdateStats(Stats stat);
@@ -614,6 +619,8 @@ class MANGOS_DLL_SPEC Creature : public Unit
         CreatureDataAddon const* GetCreatureAddon() const;
 
         static uint32 ChooseDisplayId(const CreatureInfo* cinfo, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL);
+        // template used in map difficulty, normalInfo if it has no difficulty entry
+        static CreatureInfo const* GetDifficultyTemplate(CreatureInfo const* normalInfo, Map const* map);
         void SetDisplayId(uint32 modelId);
 
         std::string GetAIName() const;
@@ -628,7 +635,7 @@ class MANGOS_DLL_SPEC Creature : public Unit
 
         void SetDeathState(DeathState s);                   // overwrite virtual Unit::SetDeathState
 
-        bool LoadFromDB(uint32 guid, Map* map);
+        bool LoadFromDB(uint32 guid, Map* map, LoadingObjectPrepared const* prepared = NULL);
         void SaveToDB();
         // overwrited in Pet
         virtual void SaveToDB(uint32 mapid, uint8 spawnMask, uint32 phaseMask);
@@ -743,8 +750,8 @@ class MANGOS_DLL_SPEC Creature : public Unit
     protected:
         bool MeetsSelectAttackingRequirement(Unit* pTarget, SpellEntry const* pSpellInfo, uint32 selectFlags) const;
 
-        bool CreateFromProto(uint32 guidlow, CreatureInfo const* cinfo, Team team, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL);
-        bool InitEntry(uint32 entry, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL);
+        bool CreateFromProto(uint32 guidlow, CreatureInfo const* cinfo, Team team, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL, LoadingObjectPrepared const* prepared = NULL);
+        bool InitEntry(uint32 entry, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL, LoadingObjectPrepared const* prepared = NULL);
 
         // vendor items
         VendorItemCounts m_vendorItemCounts;
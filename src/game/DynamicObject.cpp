@@ -27,6 +27,7 @@
 #include "GridNotifiersImpl.h"
 #include "SpellMgr.h"
 #include "DBCStores.h"
+#include "MapObjectPool.h"
 
 DynamicObject::DynamicObject() : WorldObject()
 {
@@ -38,6 +39,16 @@ DynamicObject::DynamicObject() : WorldObject()
     m_valuesCount = DYNAMICOBJECT_END;
 }
 
+void* DynamicObject::operator new(size_t size)
+{
+    return MapObjectPool::Allocate(MAP_POOL_DYNAMICOBJECT, size);
+}
+
+void DynamicObject::operator delete(void* ptr)
+{
+    MapObjectPool::Free(ptr);
+}
+
 void DynamicObject::AddToWorld()
 {
     WorldObject::AddToWorld();
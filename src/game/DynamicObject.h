@@ -37,6 +37,10 @@ class DynamicObject : public WorldObject
     public:
         explicit DynamicObject();
 
+        // memory from object pool of map updated by current thread (see MapObjectPool)
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr);
+
         void AddToWorld();
         virtual void RemoveFromWorld(bool remove) override;
 
@@ -46,6 +46,7 @@
 #include <G3D/Quat.h>
 #include "movement/MoveSplineInit.h"
 #include "movement/MoveSpline.h"
+#include "MapObjectPool.h"
 
 
 GameObject::GameObject() : WorldObject(),
@@ -83,6 +84,16 @@ GameObject::~GameObject()
     delete m_model;
 }
 
+void* GameObject::operator new(size_t size)
+{
+    return MapObjectPool::Allocate(MAP_POOL_GAMEOBJECT, size);
+}
+
+void GameObject::operator delete(void* ptr)
+{
+    MapObjectPool::Free(ptr);
+}
+
 void GameObject::AddToWorld()
 {
     WorldObject::AddToWorld();
@@ -658,9 +669,9 @@ void GameObject::SaveToDB(uint32 mapid, uint8 spawnMask, uint32 phaseMask)
     WorldDatabase.CommitTransaction();
 }
 
-bool GameObject::LoadFromDB(uint32 guid, Map* map)
+bool GameObject::LoadFromDB(uint32 guid, Map* map, LoadingObjectPrepared const* prepared /*=NULL*/)
 {
-    GameObjectData const* data = sObjectMgr.GetGOData(guid);
+    GameObjectData const* data = prepared && prepared->goData ? prepared->goData : sObjectMgr.GetGOData(guid);
 
     if (!data)
     {
@@ -2209,7 +2220,12 @@ void GameObject::EnableCollision(bool enable)
     /*if (enable && !GetMap()->Contains(*m_model))
         GetMap()->Insert(*m_model);*/
 
-    m_model->enable(enable ? GetPhaseMask() : 0);
+    uint32 phaseMask = enable ? GetPhaseMask() : 0;
+
+    if (IsInWorld())
+        GetMap()->SetGameObjectModelPhaseMask(*m_model, phaseMask);
+    else
+        m_model->enable(phaseMask);
 }
 
 bool GameObject::CalculateCurrentCollisionState() const
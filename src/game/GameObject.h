@@ -611,6 +611,7 @@ enum CapturePointSlider
 class Unit;
 class GameObjectModel;
 struct GameObjectDisplayInfoEntry;
+struct LoadingObjectPrepared;
 
 // 5 sec for bobber catch
 #define FISHING_BOBBER_READY_TIME 5
@@ -623,6 +624,10 @@ class MANGOS_DLL_SPEC GameObject : public WorldObject
         explicit GameObject();
         virtual ~GameObject();
 
+        // memory from object pool of map updated by current thread (see MapObjectPool)
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr);
+
         void AddToWorld();
         virtual void RemoveFromWorld(bool remove) override;
 
@@ -648,7 +653,7 @@ class MANGOS_DLL_SPEC GameObject : public WorldObject
 
         void SaveToDB();
         void SaveToDB(uint32 mapid, uint8 spawnMask, uint32 phaseMask);
-        bool LoadFromDB(uint32 guid, Map* map);
+        bool LoadFromDB(uint32 guid, Map* map, LoadingObjectPrepared const* prepared = NULL);
         void DeleteFromDB();
 
         void SetOwnerGuid(ObjectGuid ownerGuid)
@@ -28,16 +28,84 @@
 #include "GridMap.h"
 #include "VMapFactory.h"
 #include "MoveMap.h"
+#include "vmap/MapTree.h"
 #include "World.h"
 #include "Policies/Singleton.h"
 #include "Util.h"
 
+#include <ace/Atomic_Op.h>
+
 char const* MAP_MAGIC         = "MAPS";
 char const* MAP_VERSION_MAGIC = "v1.2";
 char const* MAP_AREA_MAGIC    = "AREA";
 char const* MAP_HEIGHT_MAGIC  = "MHGT";
 char const* MAP_LIQUID_MAGIC  = "MLIQ";
 
+// Reads grid map file either from stdio stream or from memory mapped file.
+// In mapped mode arrays are returned in place, so they must be properly aligned in file.
+struct GridMapFileReader
+{
+    explicit GridMapFileReader(FILE* _file) : file(_file), data(NULL), size(0), pos(0) {}
+    GridMapFileReader(uint8 const* _data, size_t _size) : file(NULL), data(_data), size(_size), pos(0) {}
+
+    bool Seek(uint32 offset)
+    {
+        if (file)
+            return fseek(file, offset, SEEK_SET) == 0;
+
+        if (offset > size)
+            return false;
+
+        pos = offset;
+        return true;
+    }
+
+    bool Read(void* dest, size_t bytes)
+    {
+        if (file)
+            return fread(dest, 1, bytes, file) == bytes;
+
+        if (bytes > size - pos)
+            return false;
+
+        memcpy(dest, data + pos, bytes);
+        pos += bytes;
+        return true;
+    }
+
+    // returns array owned by caller (new[]) for stdio stream, or pointer into mapped file
+    template<class T>
+    T* Get(size_t count)
+    {
+        size_t bytes = count * sizeof(T);
+        if (file)
+        {
+            T* array = new T[count];
+            if (fread(array, 1, bytes, file) != bytes)
+            {
+                delete[] array;
+                return NULL;
+            }
+            return array;
+        }
+
+        if (bytes > size - pos || (size_t(data + pos) % sizeof(T)) != 0)
+            return NULL;
+
+        T* array = (T*)(data + pos);
+        pos += bytes;
+        return array;
+    }
+
+    FILE* file;
+    uint8 const* data;
+    size_t size;
+    size_t pos;
+};
+
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> s_mappedFiles;
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> s_mappedBytes;
+
 GridMap::GridMap()
 {
     m_flags = 0;
@@ -62,6 +130,8 @@ GridMap::GridMap()
     m_liquidEntry = NULL;
     m_liquidFlags = NULL;
     m_liquid_map  = NULL;
+
+    m_mappedFile = NULL;
 }
 
 GridMap::~GridMap()
@@ -69,74 +139,125 @@ GridMap::~GridMap()
     unloadData();
 }
 
-bool GridMap::loadData(char* filename)
+bool GridMap::loadData(char* filename, bool mapped)
 {
     // Unload old data if exist
     unloadData();
 
-    GridMapFileHeader header;
+    if (mapped)
+    {
+        m_mappedFile = new ACE_Mem_Map();
+        if (m_mappedFile->map(filename, size_t(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, ACE_MAP_SHARED) == 0)
+        {
+            ++s_mappedFiles;
+            s_mappedBytes += long(m_mappedFile->size());
+
+            // mapping stays valid without file handle, don't hold one descriptor per loaded grid
+            m_mappedFile->close_handle();
+
+#ifdef MADV_WILLNEED
+            ACE_OS::madvise((caddr_t)m_mappedFile->addr(), m_mappedFile->size(), MADV_WILLNEED);
+#endif
+
+            GridMapFileReader in((uint8 const*)m_mappedFile->addr(), m_mappedFile->size());
+            if (loadFileData(in, filename, false))
+                return true;
+        }
+        else
+        {
+            delete m_mappedFile;
+            m_mappedFile = NULL;
+        }
+
+        // missing file or data which can't be used in place, errors are reported by normal loading
+        unloadData();
+    }
+
     // Not return error if file not found
-    FILE* in = fopen(filename, "rb");
-    if (!in)
+    FILE* file = fopen(filename, "rb");
+    if (!file)
         return true;
 
-    fread(&header, sizeof(header), 1, in);
-    if (header.mapMagic     == *((uint32 const*)(MAP_MAGIC)) &&
+    GridMapFileReader in(file);
+    bool result = loadFileData(in, filename, true);
+    fclose(file);
+
+    if (!result)
+        unloadData();
+
+    return result;
+}
+
+bool GridMap::loadFileData(GridMapFileReader& in, char const* filename, bool reportErrors)
+{
+    GridMapFileHeader header;
+    if (in.Read(&header, sizeof(header)) &&
+            header.mapMagic     == *((uint32 const*)(MAP_MAGIC)) &&
             header.versionMagic == *((uint32 const*)(MAP_VERSION_MAGIC)) &&
             IsAcceptableClientBuild(header.buildMagic))
     {
         // loadup area data
         if (header.areaMapOffset && !loadAreaData(in, header.areaMapOffset, header.areaMapSize))
         {
-            sLog.outError("Error loading map area data\n");
-            fclose(in);
+            if (reportErrors)
+                sLog.outError("Error loading map area data\n");
             return false;
         }
 
         // loadup height data
         if (header.heightMapOffset && !loadHeightData(in, header.heightMapOffset, header.heightMapSize))
         {
-            sLog.outError("Error loading map height data\n");
-            fclose(in);
+            if (reportErrors)
+                sLog.outError("Error loading map height data\n");
             return false;
         }
 
         // loadup liquid data
         if (header.liquidMapOffset && !loadGridMapLiquidData(in, header.liquidMapOffset, header.liquidMapSize))
         {
-            sLog.outError("Error loading map liquids data\n");
-            fclose(in);
+            if (reportErrors)
+                sLog.outError("Error loading map liquids data\n");
             return false;
         }
 
-        fclose(in);
         return true;
     }
 
-    sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.", filename);
-    fclose(in);
+    if (reportErrors)
+        sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.", filename);
     return false;
 }
 
 void GridMap::unloadData()
 {
-    if (m_area_map)
-        delete[] m_area_map;
+    if (m_mappedFile)
+    {
+        // arrays point into mapping, only unmap (pages stay in OS cache)
+        --s_mappedFiles;
+        s_mappedBytes -= long(m_mappedFile->size());
+        delete m_mappedFile;
+        m_mappedFile = NULL;
+    }
+    else
+    {
+        if (m_area_map)
+            delete[] m_area_map;
 
-    if (m_V9)
-        delete[] m_V9;
+        if (m_V9)
+            delete[] m_V9;
 
-    if (m_V8)
-        delete[] m_V8;
+        if (m_V8)
+            delete[] m_V8;
 
-    if (m_liquidEntry)
-        delete[] m_liquidEntry;
+        if (m_liquidEntry)
+            delete[] m_liquidEntry;
 
-    if (m_liquidFlags)
-        delete[] m_liquidFlags;
+        if (m_liquidFlags)
+            delete[] m_liquidFlags;
 
-    if (m_liquid_map)
-        delete[] m_liquid_map;
+        if (m_liquid_map)
+            delete[] m_liquid_map;
+    }
 
     m_area_map = NULL;
     m_V9 = NULL;
@@ -147,29 +268,36 @@ void GridMap::unloadData()
     m_gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
-bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
+void GridMap::GetMappedStatistics(uint32& files, uint64& bytes)
+{
+    files = uint32(s_mappedFiles.value());
+    bytes = uint64(s_mappedBytes.value());
+}
+
+bool GridMap::loadAreaData(GridMapFileReader& in, uint32 offset, uint32 /*size*/)
 {
     GridMapAreaHeader header;
-    fseek(in, offset, SEEK_SET);
-    fread(&header, sizeof(header), 1, in);
+    if (!in.Seek(offset) || !in.Read(&header, sizeof(header)))
+        return false;
     if (header.fourcc != *((uint32 const*)(MAP_AREA_MAGIC)))
         return false;
 
     m_gridArea = header.gridArea;
     if (!(header.flags & MAP_AREA_NO_AREA))
     {
-        m_area_map = new uint16 [16 * 16];
-        fread(m_area_map, sizeof(uint16), 16 * 16, in);
+        m_area_map = in.Get<uint16>(16 * 16);
+        if (!m_area_map)
+            return false;
     }
 
     return true;
 }
 
-bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadHeightData(GridMapFileReader& in, uint32 offset, uint32 /*size*/)
 {
     GridMapHeightHeader header;
-    fseek(in, offset, SEEK_SET);
-    fread(&header, sizeof(header), 1, in);
+    if (!in.Seek(offset) || !in.Read(&header, sizeof(header)))
+        return false;
     if (header.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
         return false;
 
@@ -178,30 +306,27 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     {
         if ((header.flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16 [129 * 129];
-            m_uint16_V8 = new uint16 [128 * 128];
-            fread(m_uint16_V9, sizeof(uint16), 129 * 129, in);
-            fread(m_uint16_V8, sizeof(uint16), 128 * 128, in);
+            m_uint16_V9 = in.Get<uint16>(129 * 129);
+            m_uint16_V8 = in.Get<uint16>(128 * 128);
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
             m_gridGetHeight = &GridMap::getHeightFromUint16;
         }
         else if ((header.flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8 [129 * 129];
-            m_uint8_V8 = new uint8 [128 * 128];
-            fread(m_uint8_V9, sizeof(uint8), 129 * 129, in);
-            fread(m_uint8_V8, sizeof(uint8), 128 * 128, in);
+            m_uint8_V9 = in.Get<uint8>(129 * 129);
+            m_uint8_V8 = in.Get<uint8>(128 * 128);
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
             m_gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float [129 * 129];
-            m_V8 = new float [128 * 128];
-            fread(m_V9, sizeof(float), 129 * 129, in);
-            fread(m_V8, sizeof(float), 128 * 128, in);
+            m_V9 = in.Get<float>(129 * 129);
+            m_V8 = in.Get<float>(128 * 128);
             m_gridGetHeight = &GridMap::getHeightFromFloat;
         }
+
+        if (!m_V9 || !m_V8)
+            return false;
     }
     else
         m_gridGetHeight = &GridMap::getHeightFromFlat;
@@ -209,11 +334,11 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     return true;
 }
 
-bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadGridMapLiquidData(GridMapFileReader& in, uint32 offset, uint32 /*size*/)
 {
     GridMapLiquidHeader header;
-    fseek(in, offset, SEEK_SET);
-    fread(&header, sizeof(header), 1, in);
+    if (!in.Seek(offset) || !in.Read(&header, sizeof(header)))
+        return false;
     if (header.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
         return false;
 
@@ -226,17 +351,17 @@ bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
 
     if (!(header.flags & MAP_LIQUID_NO_TYPE))
     {
-        m_liquidEntry = new uint16[16*16];
-        fread(m_liquidEntry, sizeof(uint16), 16*16, in);
-
-        m_liquidFlags = new uint8[16*16];
-        fread(m_liquidFlags, sizeof(uint8), 16*16, in);
+        m_liquidEntry = in.Get<uint16>(16 * 16);
+        m_liquidFlags = in.Get<uint8>(16 * 16);
+        if (!m_liquidEntry || !m_liquidFlags)
+            return false;
     }
 
     if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
     {
-        m_liquid_map = new float [m_liquid_width * m_liquid_height];
-        fread(m_liquid_map, sizeof(float), m_liquid_width * m_liquid_height, in);
+        m_liquid_map = in.Get<float>(m_liquid_width * m_liquid_height);
+        if (!m_liquid_map)
+            return false;
     }
 
     return true;
@@ -663,7 +788,190 @@ bool GridMap::ExistVMap(uint32 mapid, int gx, int gy)
 }
 
 //////////////////////////////////////////////////////////////////////////
-TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
+static void LoadGridMapFile(GridMap* map, uint32 mapId, uint32 x, uint32 y)
+{
+    // map file name
+    int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
+    char* tmp = new char[len];
+    snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), mapId, x, y);
+    DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
+
+    if (!map->loadData(tmp, sWorld.getConfig(CONFIG_BOOL_TERRAIN_MAPPED_FILES)))
+    {
+        sLog.outError("Error load map file: \n %s\n", tmp);
+        // ASSERT(false);
+    }
+
+    delete[] tmp;
+}
+
+void TerrainGridLoad::Load()
+{
+    uint32 mapId = terrain->GetMapId();
+
+    gridMap = new GridMap();
+    LoadGridMapFile(gridMap, mapId, x, y);
+
+    // vmap tile is parsed by map thread (vmap trees are not thread safe),
+    // reading it here only brings file into OS cache
+    const MapEntry* mapEntry = sMapStore.LookupEntry(mapId);
+    if (mapEntry && !mapEntry->IsTransport() && VMAP::VMapFactory::createOrGetVMapManager()->isMapLoadingEnabled())
+    {
+        std::string tileFile = sWorld.GetDataPath() + "vmaps/" + VMAP::StaticMapTree::getTileFileName(mapId, x, y);
+        if (FILE* file = fopen(tileFile.c_str(), "rb"))
+        {
+            char buffer[16 * 1024];
+            while (fread(buffer, 1, sizeof(buffer), file) == sizeof(buffer)) {}
+            fclose(file);
+        }
+    }
+
+    mmapData = MMAP::MMapManager::readTileData(mapId, x, y, mmapSize);
+}
+
+void TerrainGridLoad::Free()
+{
+    delete gridMap;
+    gridMap = NULL;
+
+    dtFree(mmapData);
+    mmapData = NULL;
+}
+
+TerrainLoader::TerrainLoader() : m_queueCond(m_lock), m_doneCond(m_lock), m_threads(0), m_stop(false)
+{
+}
+
+TerrainLoader::~TerrainLoader()
+{
+    Stop();
+}
+
+void TerrainLoader::Start(uint32 threads)
+{
+    if (m_threads || !threads)
+        return;
+
+    m_stop = false;
+    if (activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, int(threads)) == -1)
+    {
+        sLog.outError("TerrainLoader: can't start %u threads, terrain will be loaded by map threads", threads);
+        return;
+    }
+
+    m_threads = threads;
+}
+
+void TerrainLoader::Stop()
+{
+    if (!m_threads)
+        return;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_stop = true;
+        m_queueCond.broadcast();
+    }
+
+    // loads left in queue are read by map thread when needed
+    wait();
+    m_threads = 0;
+}
+
+void TerrainLoader::Queue(TerrainGridLoad* load)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_queue.push_back(load);
+    ++m_stats.queued;
+    m_queueCond.signal();
+}
+
+void TerrainLoader::Wait(TerrainGridLoad* load, bool loadIfQueued)
+{
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        switch (load->state)
+        {
+            case TERRAIN_LOAD_QUEUED:
+                m_queue.erase(std::find(m_queue.begin(), m_queue.end(), load));
+                if (!loadIfQueued)
+                {
+                    load->state = TERRAIN_LOAD_DONE;
+                    return;
+                }
+
+                // no point to wait for loader thread
+                load->state = TERRAIN_LOAD_LOADING;
+                ++m_stats.loadedInPlace;
+                break;
+            case TERRAIN_LOAD_LOADING:
+                if (loadIfQueued)
+                    ++m_stats.waited;
+
+                while (load->state != TERRAIN_LOAD_DONE)
+                    m_doneCond.wait();
+                return;
+            case TERRAIN_LOAD_DONE:
+                if (loadIfQueued)
+                    ++m_stats.ready;
+                return;
+        }
+    }
+
+    load->Load();
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    load->state = TERRAIN_LOAD_DONE;
+}
+
+bool TerrainLoader::IsDone(TerrainGridLoad* load)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+    return load->state == TERRAIN_LOAD_DONE;
+}
+
+void TerrainLoader::AddDiscarded()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    ++m_stats.discarded;
+}
+
+TerrainLoaderStatistics TerrainLoader::GetStatistics()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, m_stats);
+    return m_stats;
+}
+
+int TerrainLoader::svc()
+{
+    while (true)
+    {
+        TerrainGridLoad* load;
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+            while (m_queue.empty() && !m_stop)
+                m_queueCond.wait();
+
+            if (m_stop)
+                break;
+
+            load = m_queue.front();
+            m_queue.pop_front();
+            load->state = TERRAIN_LOAD_LOADING;
+        }
+
+        load->Load();
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+        load->state = TERRAIN_LOAD_DONE;
+        m_doneCond.broadcast();
+    }
+
+    return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid), m_collisionGeneration(0)
 {
     for (int k = 0; k < MAX_NUMBER_OF_GRIDS; ++k)
     {
@@ -671,6 +979,7 @@ TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
         {
             m_GridMaps[i][k] = NULL;
             m_GridRef[i][k] = 0;
+            m_GridLoads[i][k] = NULL;
         }
     }
 
@@ -686,9 +995,22 @@ TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
 TerrainInfo::~TerrainInfo()
 {
     for (int k = 0; k < MAX_NUMBER_OF_GRIDS; ++k)
+    {
         for (int i = 0; i < MAX_NUMBER_OF_GRIDS; ++i)
+        {
             delete m_GridMaps[i][k];
 
+            if (TerrainGridLoad* load = m_GridLoads[i][k])
+            {
+                TerrainLoader& loader = sTerrainMgr.GetLoader();
+                loader.Wait(load, false);
+                load->Free();
+                delete load;
+                loader.AddDiscarded();
+            }
+        }
+    }
+
     VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId);
     MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId);
 }
@@ -733,10 +1055,24 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
     if (!i_timer.Passed())
         return;
 
+    TerrainLoader& loader = sTerrainMgr.GetLoader();
+
     for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
     {
         for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
         {
+            // drop prefetched data not used for two clean up intervals (player turned away)
+            if (TerrainGridLoad* load = m_GridLoads[x][y])
+            {
+                if (loader.IsDone(load) && ++load->unusedCleanUps >= 2)
+                {
+                    m_GridLoads[x][y] = NULL;
+                    load->Free();
+                    delete load;
+                    loader.AddDiscarded();
+                }
+            }
+
             const int16& iRef = m_GridRef[x][y];
             GridMap* pMap = m_GridMaps[x][y];
 
@@ -750,6 +1086,7 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
 
                 // unload VMAPS...
                 VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId, x, y);
+                ++m_collisionGeneration;
 
                 // unload mmap...
                 MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId, x, y);
@@ -1171,21 +1508,29 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
 
         if (!m_GridMaps[x][y])
         {
-            GridMap* map = new GridMap();
-
-            // map file name
-            int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
-            char* tmp = new char[len];
-            snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
+            GridMap* map = NULL;
+            unsigned char* mmapData = NULL;
+            uint32 mmapSize = 0;
+            bool mmapRead = false;
 
-            if (!map->loadData(tmp))
+            // take prefetched data, waiting for loader thread only if it is still reading it
+            if (TerrainGridLoad* load = m_GridLoads[x][y])
+            {
+                sTerrainMgr.GetLoader().Wait(load, true);
+                map = load->gridMap;
+                mmapData = load->mmapData;
+                mmapSize = load->mmapSize;
+                mmapRead = true;
+
+                m_GridLoads[x][y] = NULL;
+                delete load;
+            }
+            else
             {
-                sLog.outError("Error load map file: \n %s\n", tmp);
-                // ASSERT(false);
+                map = new GridMap();
+                LoadGridMapFile(map, m_mapId, x, y);
             }
 
-            delete[] tmp;
             m_GridMaps[x][y] = map;
 
             // load VMAPs for current map/grid...
@@ -1206,14 +1551,45 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
                     break;
             }
 
-            // load navmesh
-            MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y);
+            if (vmapLoadResult == VMAP::VMAP_LOAD_RESULT_OK)
+                ++m_collisionGeneration;
+
+            // load navmesh, missing tile file was already checked by loader
+            if (!mmapRead || mmapData)
+                MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y, mmapData, mmapSize);
         }
     }
 
     return  m_GridMaps[x][y];
 }
 
+void TerrainInfo::PrefetchGrid(float x, float y)
+{
+    TerrainLoader& loader = sTerrainMgr.GetLoader();
+    if (!loader.IsEnabled())
+        return;
+
+    int gx = (int)(32 - x / SIZE_OF_GRIDS);                 // grid x
+    int gy = (int)(32 - y / SIZE_OF_GRIDS);                 // grid y
+
+    if (gx >= MAX_NUMBER_OF_GRIDS || gy >= MAX_NUMBER_OF_GRIDS ||
+        gx < 0 || gy < 0)
+        return;
+
+    // double checked lock pattern, as in LoadMapAndVMap
+    if (m_GridMaps[gx][gy] || m_GridLoads[gx][gy])
+        return;
+
+    LOCK_GUARD lock(m_mutex);
+
+    if (m_GridMaps[gx][gy] || m_GridLoads[gx][gy])
+        return;
+
+    TerrainGridLoad* load = new TerrainGridLoad(this, gx, gy);
+    m_GridLoads[gx][gy] = load;
+    loader.Queue(load);
+}
+
 float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= NULL*/) const
 {
     if (const_cast<TerrainInfo*>(this)->GetGrid(x, y))
@@ -26,8 +26,14 @@
 #include "Object.h"
 #include "SharedDefines.h"
 
+#include <ace/Task.h>
+#include <ace/Condition_Thread_Mutex.h>
+#include <ace/Mem_Map.h>
+#include <ace/Atomic_Op.h>
+
 #include <bitset>
 #include <list>
+#include <deque>
 
 class Creature;
 class Unit;
@@ -36,6 +42,7 @@ class InstanceData;
 class Group;
 class BattleGround;
 class Map;
+struct GridMapFileReader;
 
 struct GridMapFileHeader
 {
@@ -153,9 +160,13 @@ class GridMap
         uint8* m_liquidFlags;
         float *m_liquid_map;
 
-        bool loadAreaData(FILE *in, uint32 offset, uint32 size);
-        bool loadHeightData(FILE *in, uint32 offset, uint32 size);
-        bool loadGridMapLiquidData(FILE *in, uint32 offset, uint32 size);
+        // if set, all arrays above point into this read-only file mapping instead of own allocations
+        ACE_Mem_Map* m_mappedFile;
+
+        bool loadFileData(GridMapFileReader& in, char const* filename, bool reportErrors);
+        bool loadAreaData(GridMapFileReader& in, uint32 offset, uint32 size);
+        bool loadHeightData(GridMapFileReader& in, uint32 offset, uint32 size);
+        bool loadGridMapLiquidData(GridMapFileReader& in, uint32 offset, uint32 size);
 
         // Get height functions and pointers
         typedef float (GridMap::*pGetHeightPtr) (float x, float y) const;
@@ -170,9 +181,14 @@ class GridMap
         GridMap();
         ~GridMap();
 
-        bool loadData(char *filaname);
+        // mapped: use arrays in place from memory mapped file, pages are shared with all other users
+        // of the same file and stay in OS cache after unload
+        bool loadData(char *filaname, bool mapped = false);
         void unloadData();
 
+        bool IsMapped() const { return m_mappedFile != NULL; }
+        static void GetMappedStatistics(uint32& files, uint64& bytes);
+
         static bool ExistMap(uint32 mapid, int gx, int gy);
         static bool ExistVMap(uint32 mapid, int gx, int gy);
 
@@ -202,6 +218,45 @@ private:
 
 typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> AtomicLong;
 
+class TerrainInfo;
+
+enum TerrainGridLoadState
+{
+    TERRAIN_LOAD_QUEUED,
+    TERRAIN_LOAD_LOADING,
+    TERRAIN_LOAD_DONE,
+};
+
+// terrain files of one grid read in advance, owned by TerrainInfo until used or discarded
+struct TerrainGridLoad
+{
+    TerrainGridLoad(TerrainInfo* _terrain, uint32 _x, uint32 _y)
+        : terrain(_terrain), x(_x), y(_y), state(TERRAIN_LOAD_QUEUED), gridMap(NULL), mmapData(NULL), mmapSize(0), unusedCleanUps(0) {}
+
+    void Load();                                            // reads files, can be called from any thread
+    void Free();                                            // frees read data which was not used
+
+    TerrainInfo* terrain;
+    uint32 x;
+    uint32 y;
+    TerrainGridLoadState state;                             // guarded by TerrainLoader lock
+    GridMap* gridMap;
+    unsigned char* mmapData;                                // navmesh tile, allocated by dtAlloc
+    uint32 mmapSize;
+    uint32 unusedCleanUps;                                  // grid clean up passes while load was done but not used
+};
+
+struct TerrainLoaderStatistics
+{
+    TerrainLoaderStatistics() : queued(0), ready(0), waited(0), loadedInPlace(0), discarded(0) {}
+
+    uint32 queued;                                          // prefetch requests
+    uint32 ready;                                           // loads done before grid was needed
+    uint32 waited;                                          // grid activation waited for started load
+    uint32 loadedInPlace;                                   // grid needed before load started, loaded by map thread
+    uint32 discarded;                                       // loads never used
+};
+
 //class for sharing and managin GridMap objects
 class MANGOS_DLL_SPEC TerrainInfo : public Referencable<AtomicLong>
 {
@@ -240,6 +295,12 @@ public:
     //THIS METHOD IS NOT THREAD-SAFE!!!! AND IT SHOULDN'T BE THREAD-SAFE!!!!
     void CleanUpGrids(const uint32 diff);
 
+    // start background loading of grid at this position if it is not loaded yet
+    void PrefetchGrid(float x, float y);
+
+    // changed when vmaps of any grid are loaded or unloaded, maps sharing terrain drop cached queries then
+    uint32 GetCollisionGeneration() const { return m_collisionGeneration.value(); }
+
 protected:
     friend class Map;
     //load/unload terrain data
@@ -260,6 +321,8 @@ private:
 
     GridMap *m_GridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
     int16 m_GridRef[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+    // prefetched grids, moved to m_GridMaps under m_mutex when grid is needed
+    TerrainGridLoad *m_GridLoads[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
     //global garbage collection timer
     ShortIntervalTimer i_timer;
@@ -268,6 +331,41 @@ private:
     typedef ACE_Guard<LOCK_TYPE> LOCK_GUARD;
     LOCK_TYPE m_mutex;
     LOCK_TYPE m_refMutex;
+
+    ACE_Atomic_Op<ACE_Thread_Mutex, uint32> m_collisionGeneration;
+};
+
+// Background threads which read map, vmap and mmap files of grids before map thread needs them.
+// Read data is published into TerrainInfo only by map thread, at grid activation.
+class MANGOS_DLL_DECL TerrainLoader : protected ACE_Task_Base
+{
+public:
+    TerrainLoader();
+    virtual ~TerrainLoader();
+
+    void Start(uint32 threads);
+    void Stop();
+    bool IsEnabled() const { return m_threads > 0; }
+
+    void Queue(TerrainGridLoad* load);
+    // wait until load is done, not started load is read in calling thread or discarded if loadIfQueued is not set
+    void Wait(TerrainGridLoad* load, bool loadIfQueued);
+    bool IsDone(TerrainGridLoad* load);
+
+    void AddDiscarded();
+    TerrainLoaderStatistics GetStatistics();
+
+    virtual int svc();
+
+private:
+    ACE_Thread_Mutex m_lock;
+    ACE_Condition_Thread_Mutex m_queueCond;
+    ACE_Condition_Thread_Mutex m_doneCond;
+    std::deque<TerrainGridLoad*> m_queue;
+    uint32 m_threads;
+    bool m_stop;
+
+    TerrainLoaderStatistics m_stats;
 };
 
 //class for managing TerrainData object and all sort of geometry querying operations
@@ -283,6 +381,8 @@ public:
     void Update(const uint32 diff);
     void UnloadAll();
 
+    TerrainLoader& GetLoader() { return m_loader; }
+
     uint16 GetAreaFlag(uint32 mapid, float x, float y, float z) const
     {
         TerrainInfo* pData = const_cast<TerrainManager*>(this)->LoadTerrain(mapid);
@@ -314,6 +414,7 @@ private:
 
     typedef MaNGOS::ClassLevelLockable<TerrainManager, ACE_Thread_Mutex>::Lock Guard;
     TerrainDataMap i_TerrainMap;
+    TerrainLoader m_loader;
 };
 
 #define sTerrainMgr TerrainManager::Instance()
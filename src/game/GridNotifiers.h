@@ -57,7 +57,7 @@ namespace MaNGOS
     struct MANGOS_DLL_DECL MessageDeliverer
     {
         Player& i_player;
-        WorldPacket* i_message;
+        SharedPacket i_message;
         bool i_toSelf;
         MessageDeliverer(Player& pl, WorldPacket* msg, bool to_self) : i_player(pl), i_message(msg), i_toSelf(to_self) {}
         void Visit(CameraMapType& m);
@@ -66,9 +66,9 @@ namespace MaNGOS
 
     struct MessageDelivererExcept
     {
-        uint32        i_phaseMask;
-        WorldPacket*  i_message;
-        Player const* i_skipped_receiver;
+        uint32          i_phaseMask;
+        SharedPacket i_message;
+        Player const*   i_skipped_receiver;
 
         MessageDelivererExcept(WorldObject const* obj, WorldPacket* msg, Player const* skipped)
             : i_phaseMask(obj->GetPhaseMask()), i_message(msg), i_skipped_receiver(skipped) {}
@@ -80,7 +80,7 @@ namespace MaNGOS
     struct MANGOS_DLL_DECL ObjectMessageDeliverer
     {
         uint32 i_phaseMask;
-        WorldPacket* i_message;
+        SharedPacket i_message;
         explicit ObjectMessageDeliverer(WorldObject& obj, WorldPacket* msg)
             : i_phaseMask(obj.GetPhaseMask()), i_message(msg) {}
         void Visit(CameraMapType& m);
@@ -90,7 +90,7 @@ namespace MaNGOS
     struct MANGOS_DLL_DECL MessageDistDeliverer
     {
         Player& i_player;
-        WorldPacket* i_message;
+        SharedPacket i_message;
         bool i_toSelf;
         bool i_ownTeamOnly;
         float i_dist;
@@ -104,7 +104,7 @@ namespace MaNGOS
     struct MANGOS_DLL_DECL ObjectMessageDistDeliverer
     {
         WorldObject& i_object;
-        WorldPacket* i_message;
+        SharedPacket i_message;
         float i_dist;
         ObjectMessageDistDeliverer(WorldObject& obj, WorldPacket* msg, float dist) : i_object(obj), i_message(msg), i_dist(dist) {}
         void Visit(CameraMapType& m);
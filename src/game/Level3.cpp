@@ -6374,6 +6374,153 @@ bool ChatHandler::HandleServerPLimitCommand(char* args)
     return true;
 }
 
+struct MapUpdateCostOrder
+{
+    bool operator() (Map const* left, Map const* right) const
+    {
+        return left->GetUpdateStatistics().avgCost > right->GetUpdateStatistics().avgCost;
+    }
+};
+
+bool ChatHandler::HandleServerMapStatsCommand(char* args)
+{
+    uint32 count = 10;
+    if (*args && !ExtractUInt32(&args, count))
+        return false;
+
+    std::vector<Map*> maps;
+    MapManager::MapMapType const& mapsStore = sMapMgr.Maps();
+    for (MapManager::MapMapType::const_iterator itr = mapsStore.begin(); itr != mapsStore.end(); ++itr)
+        maps.push_back(itr->second);
+
+    std::sort(maps.begin(), maps.end(), MapUpdateCostOrder());
+
+    PSendSysMessage("Maps: %u, map update tasks stolen by idle threads: %u. Times in microseconds.",
+        uint32(maps.size()), sMapMgr.GetMapUpdater()->GetStolenTasksCount());
+
+    if (sWorld.getConfig(CONFIG_BOOL_MAPUPDATE_OBJECT_POOLS))
+    {
+        MapObjectPoolStatistics poolStats;
+        for (std::vector<Map*>::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+            if (MapObjectPool const* pool = (*itr)->GetObjectPool())
+                poolStats.Add(pool->GetStatistics());
+
+        uint32 used = 0, capacity = 0;
+        uint64 bytes = 0;
+        for (int i = 0; i < MAX_MAP_POOL_TYPES; ++i)
+        {
+            used += poolStats.used[i];
+            capacity += poolStats.capacity[i];
+            bytes += poolStats.bytes[i];
+        }
+
+        PSendSysMessage("Map object pools: %u of %u objects used, %u KB, objects outside pools %u",
+            used, capacity, uint32(bytes / 1024), MapObjectPool::GetHeapObjectsCount());
+    }
+
+    if (sTerrainMgr.GetLoader().IsEnabled())
+    {
+        TerrainLoaderStatistics terrainStats = sTerrainMgr.GetLoader().GetStatistics();
+        PSendSysMessage("Terrain prefetch: queued %u, ready at use %u, waited %u, loaded by map thread %u, discarded %u",
+            terrainStats.queued, terrainStats.ready, terrainStats.waited, terrainStats.loadedInPlace, terrainStats.discarded);
+    }
+
+    if (sMapMgr.GetObjectPreparer()->IsEnabled())
+    {
+        ObjectLoadPreparerStatistics prepareStats = sMapMgr.GetObjectPreparer()->GetStatistics();
+        PSendSysMessage("Grid object preparing: queued %u, ready at load %u, waited %u, loaded by map thread %u",
+            prepareStats.queued, prepareStats.ready, prepareStats.waited, prepareStats.loadedInPlace);
+    }
+
+    if (sMapMgr.GetPathRequestProcessor()->IsEnabled())
+    {
+        PathRequestProcessorStatistics pathStats = sMapMgr.GetPathRequestProcessor()->GetStatistics();
+        PSendSysMessage("Pathfinding threads: queued %u, calculated %u, shared poly paths %u",
+            pathStats.queued, pathStats.calculated, pathStats.sharedPolyPaths);
+    }
+
+    if (sWorld.getConfig(CONFIG_BOOL_TERRAIN_MAPPED_FILES))
+    {
+        uint32 mappedFiles;
+        uint64 mappedBytes;
+        GridMap::GetMappedStatistics(mappedFiles, mappedBytes);
+        PSendSysMessage("Terrain mapped files: %u, %u KB mapped", mappedFiles, uint32(mappedBytes / 1024));
+    }
+
+    for (uint32 i = 0; i < maps.size() && i < count; ++i)
+    {
+        Map const* map = maps[i];
+        MapUpdateStatistics const& stats = map->GetUpdateStatistics();
+        PSendSysMessage("Map %u instance %u (%s), players %u: cost avg %u last %u max %u, queue wait avg %u last %u, updates %u, active cells %u, cell regions %u",
+            map->GetId(), map->GetInstanceId(), map->GetMapName(), map->GetPlayers().getSize(),
+            stats.avgCost, stats.lastCost, stats.maxCost, stats.avgQueueWait, stats.lastQueueWait, stats.updates, map->GetActiveCellsCount(), stats.lastRegions);
+
+        if (MapObjectPool const* pool = map->GetObjectPool())
+        {
+            MapObjectPoolStatistics poolStats = pool->GetStatistics();
+            PSendSysMessage("  Object pools (used/capacity, KB): creatures %u/%u %u, gameobjects %u/%u %u, dynamic objects %u/%u %u",
+                poolStats.used[MAP_POOL_CREATURE], poolStats.capacity[MAP_POOL_CREATURE], uint32(poolStats.bytes[MAP_POOL_CREATURE] / 1024),
+                poolStats.used[MAP_POOL_GAMEOBJECT], poolStats.capacity[MAP_POOL_GAMEOBJECT], uint32(poolStats.bytes[MAP_POOL_GAMEOBJECT] / 1024),
+                poolStats.used[MAP_POOL_DYNAMICOBJECT], poolStats.capacity[MAP_POOL_DYNAMICOBJECT], uint32(poolStats.bytes[MAP_POOL_DYNAMICOBJECT] / 1024));
+        }
+
+        if (!map->IsLoadingObjectsQueueEmpty() || map->GetWarmedUpGridsCount())
+            PSendSysMessage("  Grid objects waiting for load %u, grids warmed up ahead of players %u",
+                uint32(map->GetLoadingObjectsQueue().size()), map->GetWarmedUpGridsCount());
+
+        if (sWorld.getConfig(CONFIG_UINT32_VMAP_QUERY_CACHE_SIZE))
+        {
+            MapQueryCacheStatistics cacheStats = map->GetQueryCacheStatistics();
+            uint64 queries = cacheStats.hits + cacheStats.misses;
+            PSendSysMessage("  LOS/height cache: size %u, hits " UI64FMTD ", misses " UI64FMTD " (hit rate %.1f%%), invalidations %u",
+                cacheStats.size, cacheStats.hits, cacheStats.misses, queries ? cacheStats.hits * 100.0f / queries : 0.0f, cacheStats.invalidations);
+        }
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleServerCompressionCommand(char* /*args*/)
+{
+    UpdateDataCompressionStatistics stats;
+    UpdateData::GetCompressionStatistics(stats);
+
+    PSendSysMessage("Update packets compression level %u, adaptive %s (large packet size %u).",
+        sWorld.getConfig(CONFIG_UINT32_COMPRESSION), sWorld.getConfig(CONFIG_BOOL_COMPRESSION_ADAPTIVE) ? "on" : "off",
+        sWorld.getConfig(CONFIG_UINT32_COMPRESSION_LARGE_PACKET_SIZE));
+
+    if (!stats.packets)
+        return true;
+
+    PSendSysMessage("Packets " UI64FMTD " (fastest level " UI64FMTD "), bytes " UI64FMTD " -> " UI64FMTD " (ratio %.2f), time " UI64FMTD " us (avg %.1f us per packet, %.1f MB/s)",
+        stats.packets, stats.fastPackets, stats.srcBytes, stats.dstBytes, float(stats.dstBytes) / stats.srcBytes,
+        stats.time, float(stats.time) / stats.packets, stats.time ? float(stats.srcBytes) / stats.time : 0.0f);
+    return true;
+}
+
+static void ShowDatabaseAsyncStats(ChatHandler* handler, char const* name, Database& db)
+{
+    std::vector<SqlAsyncStats> writers;
+    db.GetAsyncStats(writers, true);
+
+    for (uint32 i = 0; i < writers.size(); ++i)
+    {
+        SqlAsyncStats const& stats = writers[i];
+        handler->PSendSysMessage("%s writer %u: queue %u, operations " UI64FMTD ", group commits " UI64FMTD " (" UI64FMTD " transactions), latency avg " UI64FMTD " max " UI64FMTD " us",
+            name, i, stats.queueSize, stats.operations, stats.groupCommits, stats.groupedOperations,
+            stats.operations ? stats.totalLatency / stats.operations : uint64(0), stats.maxLatency);
+    }
+}
+
+bool ChatHandler::HandleServerDatabaseCommand(char* /*args*/)
+{
+    // statistics are counted from previous use of command
+    ShowDatabaseAsyncStats(this, "Character", CharacterDatabase);
+    ShowDatabaseAsyncStats(this, "World", WorldDatabase);
+    ShowDatabaseAsyncStats(this, "Login", LoginDatabase);
+    return true;
+}
+
 bool ChatHandler::HandleCastCommand(char* args)
 {
     if (!*args)
@@ -100,8 +100,13 @@ void LootStore::LoadLootTable()
 
     sLog.outString("%s :", GetName());
 
-    //                                                 0      1     2                    3        4              5         6
-    QueryResult* result = WorldDatabase.PQuery("SELECT entry, item, ChanceOrQuestChance, groupid, mincountOrRef, maxcount, condition_id FROM %s", GetName());
+    // prepared statement returns rows in binary form, no text parsing per field
+    std::string query = "SELECT entry, item, ChanceOrQuestChance, groupid, mincountOrRef, maxcount, condition_id FROM ";
+    //                          0      1     2                    3        4              5         6
+    query += GetName();
+
+    SqlStatementID loadLootTable;
+    QueryResult* result = WorldDatabase.CreateStatement(loadLootTable, query.c_str()).Query();
 
     if (result)
     {
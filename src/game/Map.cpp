@@ -35,14 +35,34 @@
 #include "DBCEnums.h"
 #include "MapPersistentStateMgr.h"
 #include "VMapFactory.h"
+#include "vmap/GameObjectModel.h"
 #include "MoveMap.h"
 #include "BattleGround/BattleGroundMgr.h"
 #include "Calendar.h"
+#include "WaypointMovementGenerator.h"
+#include "PathRequest.h"
+#include "Threading.h"
+
+#include <ace/TSS_T.h>
+
+// region of parallel cell update processed by current thread
+struct MapRegionContext
+{
+    MapRegionContext() : map(NULL), region(0) {}
+
+    Map const* map;
+    uint32 region;
+};
+
+static ACE_TSS<MapRegionContext> s_regionContext;
 
 Map::~Map()
 {
     UnloadAll(true);
 
+    // owners of pending paths are removed already, requests can only be deleted
+    ClearPathRequests();
+
     WriteGuard Guard(GetLock(MAP_LOCK_TYPE_MAPOBJECTS));
 
     if(!m_scriptSchedule.empty())
@@ -63,6 +83,12 @@ Map::~Map()
     //release reference count
     if(m_TerrainData->Release())
         sTerrainMgr.UnloadTerrain(m_TerrainData->GetMapId());
+
+    ClearObjectUpdateQueue();
+
+    // objects still alive (deleted later by other owners) keep the pool until they are freed
+    if (m_objectPool)
+        m_objectPool->Release();
 }
 
 void Map::LoadMapAndVMap(int gx,int gy)
@@ -71,7 +97,10 @@ void Map::LoadMapAndVMap(int gx,int gy)
         return;
 
     if (m_TerrainData->Load(gx, gy))
+    {
         m_bLoadedGrids[gx][gy] = true;
+        InvalidateQueryCache();
+    }
 }
 
 Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
@@ -80,8 +109,11 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
   m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
   m_activeNonPlayersIter(m_activeNonPlayers.end()),
   i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
+  m_activeCellsChanged(false), m_regionBorder(0), m_regionUpdateActive(false),
   i_data(NULL), i_script_id(0)
 {
+    i_lastPathRequestId = 0;
+
     m_CreatureGuids.Set(sObjectMgr.GetFirstTemporaryCreatureLowGuid());
     m_GameObjectGuids.Set(sObjectMgr.GetFirstTemporaryGameObjectLowGuid());
 
@@ -101,6 +133,11 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
     //add reference for TerrainData object
     m_TerrainData->AddRef();
 
+    m_queryCache.Initialize(sWorld.getConfig(CONFIG_UINT32_VMAP_QUERY_CACHE_SIZE));
+    m_queryCacheTerrainGeneration = m_TerrainData->GetCollisionGeneration();
+    m_objectPool = sWorld.getConfig(CONFIG_BOOL_MAPUPDATE_OBJECT_POOLS) ? new MapObjectPool() : NULL;
+    m_warmedUpGrids = 0;
+
     MapPersistentState* persistentState = sMapPersistentStateMgr.AddPersistentState(i_mapEntry, GetInstanceId(), GetDifficulty(), 0, IsDungeon());
     persistentState->SetUsedByMapState(this);
     SetBroken(false);
@@ -261,6 +298,8 @@ void Map::setUnitCell(Creature* obj)
 void
 Map::EnsureGridCreated(const GridPair &p)
 {
+    MapRegionGuard guard(this);
+
     if (!getNGrid(p.x_coord, p.y_coord))
     {
         {
@@ -283,6 +322,109 @@ Map::EnsureGridCreated(const GridPair &p)
     }
 }
 
+// queue background loading of terrain which moving player will see soon, so grid activation
+// at the edge of visibility normally finds it already read
+void Map::PrefetchTerrain(Player* player)
+{
+    if (!sTerrainMgr.GetLoader().IsEnabled())
+        return;
+
+    float speed;
+    if (player->IsTaxiFlying())
+        speed = player->GetSpeed(MOVE_FLIGHT);
+    else if (player->isMoving())
+        speed = player->GetSpeed(player->IsFlying() ? MOVE_FLIGHT : (player->IsWalking() ? MOVE_WALK : MOVE_RUN));
+    else
+        return;
+
+    float angle = player->GetOrientation();
+    float dx = cos(angle);
+    float dy = sin(angle);
+
+    // edge of visibility now and where it will be after prefetch time
+    float nearDist = GetVisibilityDistance() + SIZE_OF_GRID_CELL;
+    float farDist = nearDist + speed * sWorld.getConfig(CONFIG_UINT32_TERRAIN_PREFETCH_TIME);
+
+    for (float dist = nearDist; ; dist += SIZE_OF_GRIDS / 2)
+    {
+        if (dist > farDist)
+            dist = farDist;
+
+        m_TerrainData->PrefetchGrid(player->GetPositionX() + dx * dist, player->GetPositionY() + dy * dist);
+
+        if (dist >= farDist)
+            break;
+    }
+}
+
+void Map::WarmupGrids(Player* player)
+{
+    uint32 warmupTime = sWorld.getConfig(CONFIG_UINT32_OBJECT_WARMUP_TIME);
+    if (!warmupTime)
+        return;
+
+    // grids are loaded before visibility of player reaches them, objects get queued with low priority
+    // and loaded in next map updates while player is still far away
+    float dist = GetVisibilityDistance() + SIZE_OF_GRID_CELL;
+    float x = player->GetPositionX();
+    float y = player->GetPositionY();
+
+    if (player->IsTaxiFlying())
+    {
+        MovementGenerator* movement = player->GetMotionMaster()->CurrentMovementGenerator();
+        if (!movement || movement->GetMovementGeneratorType() != FLIGHT_MOTION_TYPE)
+            return;
+
+        // follow taxi path nodes, flight path can turn a lot
+        FlightPathMovementGenerator* flight = (FlightPathMovementGenerator*)movement;
+        TaxiPathNodeList const& path = flight->GetPath();
+        float left = dist + player->GetSpeed(MOVE_FLIGHT) * warmupTime;
+        for (uint32 i = flight->GetCurrentNode(); i < path.size() && left > 0.0f; ++i)
+        {
+            TaxiPathNodeEntry const& node = path[i];
+            if (node.mapid != GetId())
+                break;
+
+            left -= sqrt((node.x - x) * (node.x - x) + (node.y - y) * (node.y - y));
+            x = node.x;
+            y = node.y;
+
+            WarmupGrid(x, y);
+        }
+    }
+    else if (Transport* transport = player->GetTransport())
+    {
+        // transport paths are long and mostly straight, look ahead in its current direction
+        float angle = transport->GetOrientation();
+        float farDist = dist + transport->GetGOInfo()->moTransport.moveSpeed * warmupTime;
+        for (float step = dist; ; step += SIZE_OF_GRIDS / 2)
+        {
+            if (step > farDist)
+                step = farDist;
+
+            WarmupGrid(x + cos(angle) * step, y + sin(angle) * step);
+
+            if (step >= farDist)
+                break;
+        }
+    }
+}
+
+void Map::WarmupGrid(float x, float y)
+{
+    CellPair pair = MaNGOS::ComputeCellPair(x, y);
+    if (pair.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || pair.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
+        return;
+
+    Cell cell(pair);
+    if (IsGridObjectDataLoaded(getNGrid(cell.GridX(), cell.GridY())))
+        return;
+
+    DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_MOVES, "Warmup of grid[%u,%u] on map %u", cell.GridX(), cell.GridY(), i_id);
+    EnsureGridLoaded(cell);
+    ++m_warmedUpGrids;
+}
+
 void
 Map::EnsureGridLoadedAtEnter(Cell const& cell, Player* player)
 {
@@ -312,6 +454,8 @@ Map::EnsureGridLoadedAtEnter(Cell const& cell, Player* player)
 
 bool Map::EnsureGridLoaded(const Cell &cell)
 {
+    MapRegionGuard guard(this);
+
     EnsureGridCreated(GridPair(cell.GridX(), cell.GridY()));
     NGridType* grid = getNGrid(cell.GridX(), cell.GridY());
 
@@ -324,12 +468,16 @@ bool Map::EnsureGridLoaded(const Cell &cell)
         //active object A(loaded with loader.LoadN call and added to the  map)
         //summons some active object B, while B added to map grid loading called again and so on..
         SetGridObjectDataLoaded(true, grid);
+        MapObjectPoolScope poolScope(m_objectPool);
         ObjectGridLoader loader(*grid, this, cell);
         loader.LoadN();
 
         // Add resurrectable corpses to world object list in grid
         sObjectAccessor.AddCorpsesToGrid(GridPair(cell.GridX(),cell.GridY()),(*grid)(cell.CellX(), cell.CellY()), this);
-        m_dyn_tree.balance();
+        {
+            ACE_WRITE_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_dynTreeLock, true);
+            m_dyn_tree.balance();
+        }
         return true;
     }
 
@@ -387,6 +535,8 @@ void Map::ActivateGrid(NGridType* nGrid)
 
 bool Map::Add(Player *player)
 {
+    MapRegionGuard guard(this);
+
     player->GetMapRef().link(this, player);
     player->SetMap(this);
     CreateAttackersStorageFor(player->GetObjectGuid());
@@ -396,6 +546,7 @@ bool Map::Add(Player *player)
     Cell cell(p);
     EnsureGridLoadedAtEnter(cell, player);
     player->AddToWorld();
+    AddActiveCellSource(player);
 
     SendInitSelf(player);
     SendInitActiveObjects(player);
@@ -416,6 +567,8 @@ template<class T>
 void
 Map::Add(T *obj)
 {
+    MapRegionGuard guard(this);
+
     MANGOS_ASSERT(obj);
 
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
@@ -548,7 +701,12 @@ bool Map::loaded(GridPair const& p) const
 
 void Map::Update(const uint32 &t_diff)
 {
-    m_dyn_tree.update(t_diff);
+    MapObjectPoolScope poolScope(m_objectPool);
+
+    {
+        ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, guard, m_dynTreeLock);
+        m_dyn_tree.update(t_diff);
+    }
 
     // Load all objects in begin of update diff (loading objects count limited by time)
     uint32 loadingObjectToGridUpdateTime = WorldTimer::getMSTime();
@@ -560,16 +718,18 @@ void Map::Update(const uint32 &t_diff)
         if (!loadingObject)
             continue;
 
+        sMapMgr.GetObjectPreparer()->Take(loadingObject);
+
         switch(loadingObject->objectTypeID)
         {
             case TYPEID_UNIT:
             {
-                LoadObjectToGrid<Creature>(loadingObject->guid, loadingObject->grid, bg);
+                LoadObjectToGrid<Creature>(loadingObject, bg);
                 break;
             }
             case TYPEID_GAMEOBJECT:
             {
-                LoadObjectToGrid<GameObject>(loadingObject->guid, loadingObject->grid, bg);
+                LoadObjectToGrid<GameObject>(loadingObject, bg);
                 break;
             }
             default:
@@ -581,6 +741,9 @@ void Map::Update(const uint32 &t_diff)
 
     UpdateEvents(t_diff);
 
+    // launch paths calculated by pathfinding threads since last update
+    ProcessCalculatedPaths();
+
     /// update worldsessions for existing players
     for(m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
@@ -608,122 +771,492 @@ void Map::Update(const uint32 &t_diff)
     }
 
     /// update active cells around players and active objects
-    resetMarkedCells();
+    CollectActiveCells(t_diff);
 
-    MaNGOS::ObjectUpdater updater(t_diff);
+    // instance scripts keep state of whole map and are called from any cell, so their maps are updated serially
+    if (sWorld.getConfig(CONFIG_BOOL_MAPUPDATE_PARALLEL_CELLS) && !i_data && BuildUpdateRegions())
+        UpdateCellsParallel(t_diff);
+    else
+    {
+        m_updateStatistics.lastRegions = 0;
+        UpdateCells(m_activeCells, t_diff);
+    }
+
+    // Send world objects and item update field changes
+    SendObjectUpdates();
+
+    // Calculate and send map-related WorldState updates
+    sWorldStateMgr.MapUpdate(this);
+
+    // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
+    // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
+    if (!IsBattleGroundOrArena())
+    {
+        for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); )
+        {
+            NGridType *grid = i->getSource();
+            GridInfo *info = i->getSource()->getGridInfoRef();
+            ++i;                                                // The update might delete the map and we need the next map before the iterator gets invalid
+            MANGOS_ASSERT(grid->GetGridState() >= 0 && grid->GetGridState() < MAX_GRID_STATE);
+            sMapMgr.UpdateGridState(grid->GetGridState(), *this, *grid, *info, grid->getX(), grid->getY(), t_diff);
+        }
+    }
+
+    ///- Process necessary scripts
+    if (!m_scriptSchedule.empty())
+        ScriptsProcess();
+
+    if(i_data)
+        i_data->Update(t_diff);
+}
+
+void Map::CollectActiveCells(uint32 diff)
+{
+    // FIXME - temphack for update active MO_TRANSPORT objects
+    if (!m_activeNonPlayers.empty())
+    {
+        for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end(); )
+        {
+            // step before processing, in this case if Map::Remove remove next object we correctly
+            // step to next-next, and if we step to end() then newly added objects can wait next update.
+            WorldObject* obj = *m_activeNonPlayersIter;
+            ++m_activeNonPlayersIter;
+
+            if (obj->IsInWorld() && obj->GetObjectGuid().IsMOTransport())
+            {
+                WorldObject::UpdateHelper helper(obj);
+                helper.Update(diff);
+            }
+        }
+    }
+
+    // active cells are tracked at source moves, only take a snapshot stable during update
+    if (m_activeCellsChanged)
+    {
+        m_activeCells = m_activeCellList;
+        m_activeCellsChanged = false;
+    }
+}
+
+void Map::AddActiveCellSource(WorldObject* obj)
+{
+    MapRegionGuard guard(this);
+
+    if (m_activeCellSources.find(obj) != m_activeCellSources.end())
+        return;
+
+    ActiveCellSource& source = m_activeCellSources[obj];
+    source.valid = obj->IsPositionValid();
+    if (source.valid)
+    {
+        source.area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
+        AddActiveCellArea(source.area, NULL);
+    }
+}
+
+void Map::RemoveActiveCellSource(WorldObject* obj)
+{
+    MapRegionGuard guard(this);
+
+    ActiveCellSources::iterator itr = m_activeCellSources.find(obj);
+    if (itr == m_activeCellSources.end())
+        return;
+
+    if (itr->second.valid)
+        RemoveActiveCellArea(itr->second.area, NULL);
+    m_activeCellSources.erase(itr);
+}
+
+void Map::UpdateActiveCellSource(WorldObject* obj, float oldX, float oldY)
+{
+    // most moves stay inside same cells area, checked by moving object's thread without region lock
+    if (obj->IsPositionValid() && MaNGOS::IsValidMapCoord(oldX, oldY))
+    {
+        CellArea oldArea = Cell::CalculateCellArea(oldX, oldY, GetVisibilityDistance());
+        CellArea newArea = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
+        if (oldArea.low_bound == newArea.low_bound && oldArea.high_bound == newArea.high_bound)
+            return;
+    }
+
+    MapRegionGuard guard(this);
+
+    ActiveCellSources::iterator itr = m_activeCellSources.find(obj);
+    if (itr == m_activeCellSources.end())
+        return;
+
+    ActiveCellSource& source = itr->second;
+    bool valid = obj->IsPositionValid();
+    CellArea area;
+    if (valid)
+    {
+        area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
+
+        // area counted by earlier update may differ from area of old position
+        if (source.valid && area.low_bound == source.area.low_bound && area.high_bound == source.area.high_bound)
+            return;
+    }
+    else if (!source.valid)
+        return;
+
+    // only cells entered or left are touched
+    if (valid)
+        AddActiveCellArea(area, source.valid ? &source.area : NULL);
+    if (source.valid)
+        RemoveActiveCellArea(source.area, valid ? &area : NULL);
+
+    source.valid = valid;
+    source.area = area;
+}
+
+static inline bool IsCellInArea(CellArea const* area, uint32 x, uint32 y)
+{
+    return area && area->low_bound.x_coord <= x && x <= area->high_bound.x_coord &&
+        area->low_bound.y_coord <= y && y <= area->high_bound.y_coord;
+}
+
+void Map::AddActiveCellArea(CellArea const& area, CellArea const* except)
+{
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        {
+            if (IsCellInArea(except, x, y))
+                continue;
+
+            uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+            ActiveCellRefs::iterator itr = m_activeCellRefs.find(cell_id);
+            if (itr != m_activeCellRefs.end())
+            {
+                ++itr->second.refs;
+                continue;
+            }
+
+            ActiveCellRef& ref = m_activeCellRefs[cell_id];
+            ref.refs = 1;
+            ref.index = m_activeCellList.size();
+            m_activeCellList.push_back(cell_id);
+            m_activeCellsChanged = true;
+        }
+    }
+}
+
+void Map::RemoveActiveCellArea(CellArea const& area, CellArea const* except)
+{
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        {
+            if (IsCellInArea(except, x, y))
+                continue;
+
+            uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+            ActiveCellRefs::iterator itr = m_activeCellRefs.find(cell_id);
+            MANGOS_ASSERT(itr != m_activeCellRefs.end());
+
+            if (--itr->second.refs > 0)
+                continue;
+
+            // move last cell to freed place
+            uint32 index = itr->second.index;
+            uint32 lastCell = m_activeCellList.back();
+            m_activeCellList[index] = lastCell;
+            m_activeCellRefs[lastCell].index = index;
+            m_activeCellList.pop_back();
+            m_activeCellRefs.erase(cell_id);
+            m_activeCellsChanged = true;
+        }
+    }
+}
+
+void Map::UpdateCells(std::vector<uint32> const& cells, uint32 diff)
+{
+    MaNGOS::ObjectUpdater updater(diff);
     // for creature
     TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
     // for pets
     TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
 
-    // the player iterator is stored in the map object
-    // to make sure calls to Map::Remove don't invalidate it
-    for(m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    for (std::vector<uint32>::const_iterator itr = cells.begin(); itr != cells.end(); ++itr)
     {
-        Player* plr = m_mapRefIter->getSource();
+        CellPair pair(*itr % TOTAL_NUMBER_OF_CELLS_PER_MAP, *itr / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+        Cell cell(pair);
+        cell.SetNoCreate();
+        Visit(cell, grid_object_update);
+        Visit(cell, world_object_update);
+    }
+}
 
-        if (!plr || !plr->IsInWorld() || !plr->IsPositionValid())
-            continue;
+// Split active cells to regions which can't affect each other: any cells of different regions
+// are separated by more than two visibility distances, so notifiers and movement of objects
+// from one region never reach cells of another one.
+bool Map::BuildUpdateRegions()
+{
+    m_updateRegions.clear();
+    m_cellRegions.clear();
+
+    if (m_activeCells.size() < 2)
+        return false;
+
+    uint32 visibilityCells = uint32(ceil(GetVisibilityDistance() / SIZE_OF_GRID_CELL));
+    m_regionBorder = visibilityCells + 1;
+    uint32 const mergeDist = 2 * m_regionBorder;
 
-        //lets update mobs/objects in ALL visible cells around player!
-        CellArea area = Cell::CalculateCellArea(plr->GetPositionX(), plr->GetPositionY(), GetVisibilityDistance());
+    // union-find over active cells, candidates found by buckets of mergeDist size
+    uint32 const count = m_activeCells.size();
+    std::vector<uint32> parent(count);
+    for (uint32 i = 0; i < count; ++i)
+        parent[i] = i;
 
-        for(uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    typedef UNORDERED_MAP<uint32, std::vector<uint32> > CellBuckets;
+    CellBuckets buckets;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        uint32 x = m_activeCells[i] % TOTAL_NUMBER_OF_CELLS_PER_MAP;
+        uint32 y = m_activeCells[i] / TOTAL_NUMBER_OF_CELLS_PER_MAP;
+        buckets[(y / mergeDist) * TOTAL_NUMBER_OF_CELLS_PER_MAP + x / mergeDist].push_back(i);
+    }
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        int32 x = m_activeCells[i] % TOTAL_NUMBER_OF_CELLS_PER_MAP;
+        int32 y = m_activeCells[i] / TOTAL_NUMBER_OF_CELLS_PER_MAP;
+        int32 bx = x / mergeDist;
+        int32 by = y / mergeDist;
+
+        for (int32 nbx = bx - 1; nbx <= bx + 1; ++nbx)
         {
-            for(uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+            for (int32 nby = by - 1; nby <= by + 1; ++nby)
             {
-                // marked cells are those that have been visited
-                // don't visit the same cell twice
-                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                if(!isCellMarked(cell_id))
+                if (nbx < 0 || nby < 0)
+                    continue;
+
+                CellBuckets::const_iterator bucket = buckets.find(nby * TOTAL_NUMBER_OF_CELLS_PER_MAP + nbx);
+                if (bucket == buckets.end())
+                    continue;
+
+                for (std::vector<uint32>::const_iterator itr = bucket->second.begin(); itr != bucket->second.end(); ++itr)
                 {
-                    markCell(cell_id);
-                    CellPair pair(x,y);
-                    Cell cell(pair);
-                    cell.SetNoCreate();
-                    Visit(cell, grid_object_update);
-                    Visit(cell, world_object_update);
+                    uint32 j = *itr;
+                    if (j <= i)
+                        continue;
+
+                    int32 ox = m_activeCells[j] % TOTAL_NUMBER_OF_CELLS_PER_MAP;
+                    int32 oy = m_activeCells[j] / TOTAL_NUMBER_OF_CELLS_PER_MAP;
+                    if (uint32(abs(ox - x)) > mergeDist || uint32(abs(oy - y)) > mergeDist)
+                        continue;
+
+                    uint32 ri = i;
+                    while (parent[ri] != ri)
+                        ri = parent[ri] = parent[parent[ri]];
+                    uint32 rj = j;
+                    while (parent[rj] != rj)
+                        rj = parent[rj] = parent[parent[rj]];
+                    if (ri != rj)
+                        parent[std::max(ri, rj)] = std::min(ri, rj);
                 }
             }
         }
     }
 
-    // non-player active objects
-    if(!m_activeNonPlayers.empty())
+    // regions numbered by first cell, cells kept in serial visit order
+    UNORDERED_MAP<uint32, uint32> rootRegions;
+    for (uint32 i = 0; i < count; ++i)
     {
-        for(m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end(); )
+        uint32 root = i;
+        while (parent[root] != root)
+            root = parent[root];
+
+        UNORDERED_MAP<uint32, uint32>::const_iterator found = rootRegions.find(root);
+        uint32 region;
+        if (found == rootRegions.end())
         {
-            // skip not in world
-            WorldObject* obj = *m_activeNonPlayersIter;
+            region = m_updateRegions.size();
+            rootRegions[root] = region;
+            m_updateRegions.push_back(MapUpdateRegion());
+        }
+        else
+            region = found->second;
 
-            // step before processing, in this case if Map::Remove remove next object we correctly
-            // step to next-next, and if we step to end() then newly added objects can wait next update.
-            ++m_activeNonPlayersIter;
+        m_updateRegions[region].cells.push_back(m_activeCells[i]);
+        m_cellRegions[m_activeCells[i]] = region;
+    }
 
-            if (!obj->IsInWorld() || !obj->IsPositionValid())
-                continue;
+    return m_updateRegions.size() > 1;
+}
 
-            // FIXME - temphack for update active MO_TRANSPORT objects
-            if (obj->GetObjectGuid().IsMOTransport())
-            {
-                WorldObject::UpdateHelper helper(obj);
-                helper.Update(t_diff);
-            }
+// collects objects which ObjectUpdater visits, without update
+struct UpdateRegionCollector
+{
+    std::vector<ObjectGuid>& i_guids;
+    explicit UpdateRegionCollector(std::vector<ObjectGuid>& guids) : i_guids(guids) {}
+
+    template<class T> void Visit(GridRefManager<T>& m)
+    {
+        for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+            i_guids.push_back(itr->getSource()->GetObjectGuid());
+    }
+    void Visit(PlayerMapType&) {}
+    void Visit(CorpseMapType&) {}
+    void Visit(CameraMapType&) {}
+};
+
+void Map::CheckUpdateRegions()
+{
+    std::vector<ObjectGuid> serialGuids;
+    std::vector<ObjectGuid> regionGuids;
+    UpdateRegionCollector serialCollector(serialGuids);
+    UpdateRegionCollector regionCollector(regionGuids);
+    TypeContainerVisitor<UpdateRegionCollector, GridTypeMapContainer> serialGridVisitor(serialCollector);
+    TypeContainerVisitor<UpdateRegionCollector, WorldTypeMapContainer> serialWorldVisitor(serialCollector);
+    TypeContainerVisitor<UpdateRegionCollector, GridTypeMapContainer> regionGridVisitor(regionCollector);
+    TypeContainerVisitor<UpdateRegionCollector, WorldTypeMapContainer> regionWorldVisitor(regionCollector);
 
-            //lets update mobs/objects in ALL visible cells around player!
-            CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
+    for (std::vector<uint32>::const_iterator itr = m_activeCells.begin(); itr != m_activeCells.end(); ++itr)
+    {
+        Cell cell(CellPair(*itr % TOTAL_NUMBER_OF_CELLS_PER_MAP, *itr / TOTAL_NUMBER_OF_CELLS_PER_MAP));
+        cell.SetNoCreate();
+        Visit(cell, serialGridVisitor);
+        Visit(cell, serialWorldVisitor);
+    }
 
-            for(uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    uint32 regionCells = 0;
+    for (uint32 i = 0; i < m_updateRegions.size(); ++i)
+    {
+        std::vector<uint32> const& cells = m_updateRegions[i].cells;
+        regionCells += cells.size();
+
+        for (std::vector<uint32>::const_iterator itr = cells.begin(); itr != cells.end(); ++itr)
+        {
+            Cell cell(CellPair(*itr % TOTAL_NUMBER_OF_CELLS_PER_MAP, *itr / TOTAL_NUMBER_OF_CELLS_PER_MAP));
+            cell.SetNoCreate();
+            Visit(cell, regionGridVisitor);
+            Visit(cell, regionWorldVisitor);
+        }
+
+        // regions must not come closer than two borders
+        for (uint32 j = i + 1; j < m_updateRegions.size(); ++j)
+        {
+            for (std::vector<uint32>::const_iterator itr = cells.begin(); itr != cells.end(); ++itr)
             {
-                for(uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+                for (std::vector<uint32>::const_iterator itr2 = m_updateRegions[j].cells.begin(); itr2 != m_updateRegions[j].cells.end(); ++itr2)
                 {
-                    // marked cells are those that have been visited
-                    // don't visit the same cell twice
-                    uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                    if(!isCellMarked(cell_id))
-                    {
-                        markCell(cell_id);
-                        CellPair pair(x,y);
-                        Cell cell(pair);
-                        cell.SetNoCreate();
-                        Visit(cell, grid_object_update);
-                        Visit(cell, world_object_update);
-                    }
+                    uint32 dx = uint32(abs(int32(*itr % TOTAL_NUMBER_OF_CELLS_PER_MAP) - int32(*itr2 % TOTAL_NUMBER_OF_CELLS_PER_MAP)));
+                    uint32 dy = uint32(abs(int32(*itr / TOTAL_NUMBER_OF_CELLS_PER_MAP) - int32(*itr2 / TOTAL_NUMBER_OF_CELLS_PER_MAP)));
+                    if (dx <= 2 * m_regionBorder && dy <= 2 * m_regionBorder)
+                        sLog.outError("Map::CheckUpdateRegions: map %u instance %u, regions %u and %u too close (cells %u and %u)",
+                            GetId(), GetInstanceId(), i, j, *itr, *itr2);
                 }
             }
         }
     }
 
-    // Send world objects and item update field changes
-    SendObjectUpdates();
+    if (regionCells != m_activeCells.size() || m_cellRegions.size() != m_activeCells.size())
+        sLog.outError("Map::CheckUpdateRegions: map %u instance %u, active cells %u, cells in regions %u (unique %u)",
+            GetId(), GetInstanceId(), uint32(m_activeCells.size()), regionCells, uint32(m_cellRegions.size()));
 
-    // Calculate and send map-related WorldState updates
-    sWorldStateMgr.MapUpdate(this);
+    std::sort(serialGuids.begin(), serialGuids.end());
+    std::sort(regionGuids.begin(), regionGuids.end());
+    if (serialGuids != regionGuids)
+        sLog.outError("Map::CheckUpdateRegions: map %u instance %u, serial update visits %u objects, region update visits %u objects",
+            GetId(), GetInstanceId(), uint32(serialGuids.size()), uint32(regionGuids.size()));
+    else if (std::adjacent_find(regionGuids.begin(), regionGuids.end()) != regionGuids.end())
+        sLog.outError("Map::CheckUpdateRegions: map %u instance %u, some objects visited more than once", GetId(), GetInstanceId());
+}
 
-    // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
-    // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
-    if (!IsBattleGroundOrArena())
+void Map::UpdateCellsParallel(uint32 diff)
+{
+    bool checkMode = sWorld.getConfig(CONFIG_BOOL_MAPUPDATE_PARALLEL_CELLS_CHECK);
+    if (checkMode)
+        CheckUpdateRegions();
+
+    m_updateStatistics.lastRegions = m_updateRegions.size();
+    m_regionUpdateActive = true;
+
+    if (checkMode)
     {
-        for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); )
+        // deterministic order, but still with region ownership checks
+        for (uint32 i = 0; i < m_updateRegions.size(); ++i)
+            UpdateRegion(i, diff);
+    }
+    else
+    {
+        m_regionBatch.map = this;
+        m_regionBatch.diff = diff;
+        m_regionBatch.compressionDeadline = UpdateData::GetCompressionDeadline();
+        m_regionBatch.regionsCount = m_updateRegions.size();
+        sMapMgr.GetRegionUpdater()->Execute(m_regionBatch);
+    }
+
+    m_regionUpdateActive = false;
+
+    // merge phase
+    ProcessDeferredRelocations();
+}
+
+void Map::UpdateRegion(uint32 regionIndex, uint32 diff)
+{
+    MANGOS_ASSERT(regionIndex < m_updateRegions.size());
+
+    MapRegionContext* context = s_regionContext.ts_object();
+    context->map = this;
+    context->region = regionIndex;
+
+    MapObjectPoolScope poolScope(m_objectPool);
+
+    UpdateCells(m_updateRegions[regionIndex].cells, diff);
+
+    context->map = NULL;
+}
+
+int32 Map::GetUpdateRegionFor(CellPair const& cellPair) const
+{
+    int32 border = int32(m_regionBorder);
+    for (int32 dx = -border; dx <= border; ++dx)
+    {
+        for (int32 dy = -border; dy <= border; ++dy)
         {
-            NGridType *grid = i->getSource();
-            GridInfo *info = i->getSource()->getGridInfoRef();
-            ++i;                                                // The update might delete the map and we need the next map before the iterator gets invalid
-            MANGOS_ASSERT(grid->GetGridState() >= 0 && grid->GetGridState() < MAX_GRID_STATE);
-            sMapMgr.UpdateGridState(grid->GetGridState(), *this, *grid, *info, grid->getX(), grid->getY(), t_diff);
+            int32 x = int32(cellPair.x_coord) + dx;
+            int32 y = int32(cellPair.y_coord) + dy;
+            if (x < 0 || y < 0 || x >= TOTAL_NUMBER_OF_CELLS_PER_MAP || y >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
+                continue;
+
+            // regions are separated by more than two borders, so first found region is the only one
+            UNORDERED_MAP<uint32, uint32>::const_iterator itr = m_cellRegions.find(uint32(y) * TOTAL_NUMBER_OF_CELLS_PER_MAP + uint32(x));
+            if (itr != m_cellRegions.end())
+                return int32(itr->second);
         }
     }
 
-    ///- Process necessary scripts
-    if (!m_scriptSchedule.empty())
-        ScriptsProcess();
+    return -1;
+}
 
-    if(i_data)
-        i_data->Update(t_diff);
+// Move into cell owned by other region (or by nobody) can't be done while regions are updated,
+// it is stored and done after all regions updated
+template<class T>
+bool Map::DeferRegionRelocation(T* obj, Position const& pos)
+{
+    if (!m_regionUpdateActive)
+        return false;
+
+    CellPair newPair = MaNGOS::ComputeCellPair(pos.x, pos.y);
+    if (newPair == MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY()))
+        return false;
+
+    MapRegionContext const* context = s_regionContext.ts_object();
+    if (context->map == this && GetUpdateRegionFor(newPair) == int32(context->region))
+        return false;
+
+    MapRegionGuard guard(this);
+    m_deferredRelocations.push_back(std::make_pair((WorldObject*)obj, pos));
+    return true;
 }
 
 void Map::Remove(Player* player, bool remove)
 {
+    MapRegionGuard guard(this);
+    CancelDeferredRelocation(player);
+    RemoveActiveCellSource(player);
+
     if (i_data)
         i_data->OnPlayerLeave(player);
 
@@ -783,6 +1316,9 @@ template<class T>
 void
 Map::Remove(T* obj, bool remove)
 {
+    MapRegionGuard guard(this);
+    CancelDeferredRelocation(obj);
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if(p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP )
     {
@@ -843,6 +1379,9 @@ void Map::Relocation(Player* player, Position const& pos)
 {
     MANGOS_ASSERT(player);
 
+    if (DeferRegionRelocation(player, pos))
+        return;
+
     CellPair old_val = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
     CellPair new_val = MaNGOS::ComputeCellPair(pos.x, pos.y);
 
@@ -854,6 +1393,8 @@ void Map::Relocation(Player* player, Position const& pos)
 
     if( old_cell.DiffGrid(new_cell) || old_cell.DiffCell(new_cell) )
     {
+        MapRegionGuard guard(this);
+
         DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_MOVES, "Player %s relocation grid[%u,%u]cell[%u,%u]->grid[%u,%u]cell[%u,%u]", player->GetName(), old_cell.GridX(), old_cell.GridY(), old_cell.CellX(), old_cell.CellY(), new_cell.GridX(), new_cell.GridY(), new_cell.CellX(), new_cell.CellY());
 
         NGridType* oldGrid = getNGrid(old_cell.GridX(), old_cell.GridY());
@@ -870,7 +1411,11 @@ void Map::Relocation(Player* player, Position const& pos)
     player->OnRelocated();
 
     if (!same_cell)
+    {
         ActivateGrid(getNGrid(new_cell.GridX(), new_cell.GridY()));
+        PrefetchTerrain(player);
+        WarmupGrids(player);
+    }
 };
 
 template<>
@@ -878,6 +1423,9 @@ void Map::Relocation(Creature* creature, Position const& pos)
 {
     MANGOS_ASSERT(CheckGridIntegrity(creature,false));
 
+    if (DeferRegionRelocation(creature, pos))
+        return;
+
 //    Cell old_cell = creature->GetCurrentCell();
     Cell new_cell(MaNGOS::ComputeCellPair(pos.x, pos.y));
 
@@ -904,6 +1452,9 @@ void Map::Relocation(GameObject* go, Position const& pos)
 {
     MANGOS_ASSERT(go);
 
+    if (DeferRegionRelocation(go, pos))
+        return;
+
     CellPair old_val = MaNGOS::ComputeCellPair(go->GetPositionX(), go->GetPositionY());
     CellPair new_val = MaNGOS::ComputeCellPair(pos.x, pos.y);
 
@@ -914,6 +1465,8 @@ void Map::Relocation(GameObject* go, Position const& pos)
 
     if (old_cell != new_cell)
     {
+        MapRegionGuard guard(this);
+
         // Need check for spawn some GO in not loaded grids
         EnsureGridLoadedAtEnter(old_cell);
 
@@ -939,9 +1492,63 @@ void Map::CreatureRelocation(Creature* object, float x, float y, float z, float
     Relocation(object, Position(x, y, z, orientation, object->GetPhaseMask()));
 };
 
+void Map::ProcessDeferredRelocations()
+{
+    if (m_deferredRelocations.empty())
+        return;
+
+    DeferredRelocations relocations;
+    relocations.swap(m_deferredRelocations);
+
+    for (DeferredRelocations::iterator itr = relocations.begin(); itr != relocations.end(); ++itr)
+    {
+        WorldObject* obj = itr->first;
+        if (!obj->IsInWorld() || obj->GetMap() != this)
+            continue;
+
+        switch (obj->GetTypeId())
+        {
+            case TYPEID_PLAYER:
+                Relocation((Player*)obj, itr->second);
+                break;
+            case TYPEID_UNIT:
+                Relocation((Creature*)obj, itr->second);
+                break;
+            case TYPEID_GAMEOBJECT:
+                Relocation((GameObject*)obj, itr->second);
+                break;
+            default:
+                break;
+        }
+    }
+
+    DEBUG_LOG("Map::ProcessDeferredRelocations: map %u instance %u, %u objects moved between update regions",
+        GetId(), GetInstanceId(), uint32(relocations.size()));
+}
+
+void Map::CancelDeferredRelocation(WorldObject* obj)
+{
+    if (m_deferredRelocations.empty())
+        return;
+
+    MapRegionGuard guard(this);
+    for (DeferredRelocations::iterator itr = m_deferredRelocations.begin(); itr != m_deferredRelocations.end();)
+    {
+        if (itr->first == obj)
+            itr = m_deferredRelocations.erase(itr);
+        else
+            ++itr;
+    }
+}
+
 bool Map::CreatureCellRelocation(Creature* c, Cell new_cell)
 {
     Cell const& old_cell = c->GetCurrentCell();
+    if (old_cell == new_cell)
+        return true;
+
+    MapRegionGuard guard(this);
+
     if (old_cell.DiffGrid(new_cell))
     {
         if (!c->isActiveObject() && !loaded(new_cell.gridPair()))
@@ -1033,6 +1640,7 @@ bool Map::UnloadGrid(const uint32 &x, const uint32 &y, bool pForce)
     {
         m_bLoadedGrids[gx][gy] = false;
         m_TerrainData->Unload(gx, gy);
+        InvalidateQueryCache();
     }
 
     return true;
@@ -1043,7 +1651,10 @@ void Map::UnloadAll(bool pForce)
     while (!IsLoadingObjectsQueueEmpty())
     {
         if (LoadingObjectQueueMember* member = GetNextLoadingObject())
+        {
+            sMapMgr.GetObjectPreparer()->Take(member);
             delete member;
+        }
     }
 
     for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); )
@@ -1056,8 +1667,12 @@ void Map::UnloadAll(bool pForce)
 
 void Map::AddLoadingObject(LoadingObjectQueueMember* obj)
 {
-    WriteGuard Guard(GetLock(MAP_LOCK_TYPE_MAPOBJECTS));
-    i_loadingObjectQueue.push(obj);
+    {
+        WriteGuard Guard(GetLock(MAP_LOCK_TYPE_MAPOBJECTS));
+        i_loadingObjectQueue.push(obj);
+    }
+
+    sMapMgr.GetObjectPreparer()->Queue(obj);
 }
 
 LoadingObjectQueueMember* Map::GetNextLoadingObject()
@@ -1235,6 +1850,8 @@ inline void Map::setNGrid(NGridType *grid, uint32 x, uint32 y)
 
 void Map::AddObjectToRemoveList(WorldObject* obj, bool immediateCleanup)
 {
+    MapRegionGuard guard(this);
+
     MANGOS_ASSERT(obj && obj->GetMap() == this);
 
     obj->CleanupsBeforeDelete();                                // remove or simplify at least cross referenced links
@@ -1245,6 +1862,8 @@ void Map::AddObjectToRemoveList(WorldObject* obj, bool immediateCleanup)
 
 void Map::RemoveObjectFromRemoveList(WorldObject* obj)
 {
+    MapRegionGuard guard(this);
+
     if (!i_objectsToRemove.empty())
         i_objectsToRemove.erase(obj);
 }
@@ -1296,8 +1915,9 @@ uint32 Map::GetPlayersCountExceptGMs() const
 
 void Map::SendToPlayers(WorldPacket const* data) const
 {
+    SharedPacket packet(data);
     for(MapRefManager::const_iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
-        itr->getSource()->GetSession()->SendPacket(data);
+        itr->getSource()->GetSession()->SendPacket(packet);
 }
 
 bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
@@ -1342,7 +1962,10 @@ bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
 
 void Map::AddToActive(WorldObject* obj)
 {
+    MapRegionGuard guard(this);
+
     m_activeNonPlayers.insert(obj);
+    AddActiveCellSource(obj);
     Cell cell = Cell(MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY()));
     EnsureGridLoaded(cell);
 
@@ -1393,6 +2016,8 @@ void Map::AddToActive(WorldObject* obj)
 
 void Map::RemoveFromActive( WorldObject* obj )
 {
+    MapRegionGuard guard(this);
+
     // Map::Update for active object in proccess
     if(m_activeNonPlayersIter != m_activeNonPlayers.end())
     {
@@ -1404,6 +2029,8 @@ void Map::RemoveFromActive( WorldObject* obj )
     else
         m_activeNonPlayers.erase(obj);
 
+    RemoveActiveCellSource(obj);
+
     // also allow unloading spawn grid
     if (obj->GetTypeId()==TYPEID_UNIT)
     {
@@ -1898,6 +2525,8 @@ void BattleGroundMap::UnloadAll(bool pForce)
 /// Put scripts in the execution queue
 bool Map::ScriptsStart(ScriptMapMapName const& scripts, uint32 id, Object* source, Object* target, ScriptExecutionParam execParams /*=SCRIPT_EXEC_PARAM_UNIQUE_BY_SOURCE_TARGET*/)
 {
+    MapRegionGuard guard(this);
+
     MANGOS_ASSERT(source);
 
     ///- Find the script map
@@ -1940,6 +2569,8 @@ bool Map::ScriptsStart(ScriptMapMapName const& scripts, uint32 id, Object* sourc
 
 void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* source, Object* target)
 {
+    MapRegionGuard guard(this);
+
     // NOTE: script record _must_ exist until command executed
 
     // prepare static data
@@ -2184,28 +2815,68 @@ WorldObject* Map::GetWorldObject(ObjectGuid const& guid)
 
 void Map::AddUpdateObject(ObjectGuid const& guid)
 {
-    WriteGuard Guard(GetLock(MAP_LOCK_TYPE_DEFAULT));
-    i_objectsToClientUpdate.insert(guid);
+    i_objectsToClientUpdate.add(new ObjectUpdateQueueMember(guid));
 }
 
-void Map::RemoveUpdateObject(ObjectGuid const& guid)
+void Map::ClearObjectUpdateQueue()
 {
-    WriteGuard Guard(GetLock(MAP_LOCK_TYPE_DEFAULT));
-    i_objectsToClientUpdate.erase(guid);
+    ObjectUpdateQueueMember* member;
+    while (i_objectsToClientUpdate.next(member))
+        delete member;
+}
+
+uint32 Map::QueuePathRequest(Unit* owner, PathFinder* path)
+{
+    // units of different cell regions can queue requests at the same time
+    uint32 requestId = ++i_lastPathRequestId;
+    if (!requestId)                                         // 0 is used by movement generators for no request
+        requestId = ++i_lastPathRequestId;
+
+    PathRequest* request = new PathRequest(requestId, owner, path);
+    ++i_pathRequestsInProgress;
+    sMapMgr.GetPathRequestProcessor()->Queue(request);
+    return requestId;
+}
+
+void Map::PathRequestCalculated(PathRequest* request)
+{
+    i_calculatedPaths.add(request);
+    --i_pathRequestsInProgress;
+}
+
+void Map::ProcessCalculatedPaths()
+{
+    PathRequest* request;
+    while (i_calculatedPaths.next(request))
+    {
+        // owner could leave the map or stop waiting for the path meantime
+        Unit* owner = GetUnit(request->GetOwnerGuid());
+        if (owner && owner->IsInWorld() && owner->GetMap() == this)
+            owner->GetMotionMaster()->PathCalculated(request);
+
+        delete request;
+    }
+}
+
+void Map::ClearPathRequests()
+{
+    while (i_pathRequestsInProgress.value() > 0)
+        ACE_Based::Thread::Sleep(1);
+
+    PathRequest* request;
+    while (i_calculatedPaths.next(request))
+        delete request;
 }
 
 void Map::SendObjectUpdates()
 {
     UpdateDataMapType update_players;
 
-    while (!GetObjectsUpdateQueue()->empty())
+    ObjectUpdateQueueMember* member;
+    while (i_objectsToClientUpdate.next(member))
     {
-        ObjectGuid guid;
-        {
-            WriteGuard Guard(GetLock(MAP_LOCK_TYPE_DEFAULT));
-            guid = *i_objectsToClientUpdate.begin();
-            i_objectsToClientUpdate.erase(i_objectsToClientUpdate.begin());
-        }
+        ObjectGuid guid = member->guid;
+        delete member;
 
         if (guid.IsEmpty())
             continue;
@@ -2251,6 +2922,9 @@ void Map::SendObjectUpdates()
 
 uint32 Map::GenerateLocalLowGuid(HighGuid guidhigh)
 {
+    // objects are summoned by all regions of parallel update
+    MapRegionGuard guard(this);
+
     // TODO: for map local guid counters possible force reload map instead shutdown server at guid counter overflow
     switch(guidhigh)
     {
@@ -2508,7 +3182,7 @@ void Map::ForcedUnload()
     sLog.outError("Map::ForcedUnload called for map %u instance %u. Map crushed. Cleaning up...", GetId(), GetInstanceId());
 
     // Immediately cleanup update queue
-    i_objectsToClientUpdate.clear();
+    ClearObjectUpdateQueue();
 
     Map::PlayerList const pList = GetPlayers();
     for (PlayerList::const_iterator itr = pList.begin(); itr != pList.end(); ++itr)
@@ -2585,8 +3259,69 @@ float Map::GetVisibilityDistance(WorldObject* obj) const
 
 bool Map::IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ)
-        && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask);
+    if (!m_queryCache.IsEnabled())
+        return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ)
+            && IsInDynamicLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask);
+
+    CheckQueryCacheTerrain();
+
+    MapQueryKey key(MAP_QUERY_LINE_OF_SIGHT, phasemask, srcX, srcY, srcZ, destX, destY, destZ);
+    float result;
+    if (m_queryCache.Find(key, result))
+        return result != 0.0f;
+
+    uint32 generation = m_queryCache.GetGeneration();
+    bool inLOS = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ)
+        && IsInDynamicLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask);
+    m_queryCache.Store(key, generation, inLOS ? 1.0f : 0.0f);
+    return inLOS;
+}
+
+void Map::IsInLineOfSight(float srcX, float srcY, float srcZ, float const* dest, uint32 count, uint32 phasemask, bool* results) const
+{
+    if (m_queryCache.IsEnabled())
+        CheckQueryCacheTerrain();
+
+    uint32 generation = m_queryCache.GetGeneration();
+
+    // cached results first, the rest goes to vmaps in one batch
+    std::vector<float> missed;
+    std::vector<uint32> missedIndexes;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        float const* point = dest + i * 3;
+        if (m_queryCache.IsEnabled())
+        {
+            float result;
+            if (m_queryCache.Find(MapQueryKey(MAP_QUERY_LINE_OF_SIGHT, phasemask, srcX, srcY, srcZ, point[0], point[1], point[2]), result))
+            {
+                results[i] = result != 0.0f;
+                continue;
+            }
+        }
+
+        missed.insert(missed.end(), point, point + 3);
+        missedIndexes.push_back(i);
+    }
+
+    if (missedIndexes.empty())
+        return;
+
+    bool* staticResults = new bool[missedIndexes.size()];
+    VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, &missed[0], missedIndexes.size(), staticResults);
+
+    ACE_READ_GUARD(ACE_RW_Thread_Mutex, guard, m_dynTreeLock);
+    for (uint32 i = 0; i < missedIndexes.size(); ++i)
+    {
+        float const* point = &missed[i * 3];
+        bool inLOS = staticResults[i] && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, point[0], point[1], point[2], phasemask);
+        results[missedIndexes[i]] = inLOS;
+
+        if (m_queryCache.IsEnabled())
+            m_queryCache.Store(MapQueryKey(MAP_QUERY_LINE_OF_SIGHT, phasemask, srcX, srcY, srcZ, point[0], point[1], point[2]), generation, inLOS ? 1.0f : 0.0f);
+    }
+
+    delete[] staticResults;
 }
 
 /**
@@ -2607,6 +3342,7 @@ bool Map::GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float
         destZ = tempZ;
     }
     // at second all dynamic objects, if static check has an hit, then we can calculate only to this point and NOT to end, because we need closely hit point
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_dynTreeLock, result0);
     bool result1 = m_dyn_tree.getObjectHitPos(phasemask, srcX, srcY, srcZ, destX, destY, destZ, tempX, tempY, tempZ, modifyDist);
     if (result1)
     {
@@ -2619,37 +3355,96 @@ bool Map::GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float
 }
 
 float Map::GetHeight(uint32 phasemask, float x, float y, float z) const
+{
+    if (!m_queryCache.IsEnabled())
+        return CalculateHeight(phasemask, x, y, z);
+
+    CheckQueryCacheTerrain();
+
+    MapQueryKey key(MAP_QUERY_HEIGHT, phasemask, x, y, z);
+    float height;
+    if (m_queryCache.Find(key, height))
+        return height;
+
+    uint32 generation = m_queryCache.GetGeneration();
+    height = CalculateHeight(phasemask, x, y, z);
+    m_queryCache.Store(key, generation, height);
+    return height;
+}
+
+float Map::CalculateHeight(uint32 phasemask, float x, float y, float z) const
 {
     float staticHeight = m_TerrainData->GetHeightStatic(x, y, z);
 
     // Get Dynamic Height around static Height (if valid)
     float dynSearchHeight = 2.0f + (z < staticHeight ? staticHeight : z);
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_dynTreeLock, staticHeight);
     return std::max<float>(staticHeight, m_dyn_tree.getHeight(x, y, dynSearchHeight, dynSearchHeight - staticHeight, phasemask));
 }
 
+// vmaps are shared by all instances of map, grid loaded or unloaded by other instance changes results of this one
+void Map::CheckQueryCacheTerrain() const
+{
+    uint32 terrainGeneration = m_TerrainData->GetCollisionGeneration();
+    if (m_queryCacheTerrainGeneration.value() == terrainGeneration)
+        return;
+
+    m_queryCacheTerrainGeneration = terrainGeneration;
+    m_queryCache.Invalidate();
+}
+
+bool Map::IsInDynamicLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask) const
+{
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_dynTreeLock, true);
+    return m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask);
+}
+
 void Map::InsertGameObjectModel(const GameObjectModel& mdl)
 {
-    m_dyn_tree.insert(mdl);
+    {
+        ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, guard, m_dynTreeLock);
+        m_dyn_tree.insert(mdl);
+    }
+    InvalidateQueryCache();
 }
 
 void Map::RemoveGameObjectModel(const GameObjectModel& mdl)
 {
-    m_dyn_tree.remove(mdl);
+    {
+        ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, guard, m_dynTreeLock);
+        m_dyn_tree.remove(mdl);
+    }
+    InvalidateQueryCache();
 }
 
 bool Map::ContainsGameObjectModel(const GameObjectModel& mdl) const
 {
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_dynTreeLock, false);
     return m_dyn_tree.contains(mdl);
 }
 
-template<class T> void Map::LoadObjectToGrid(uint32& guid, GridType& grid, BattleGround* bg)
+void Map::SetGameObjectModelPhaseMask(GameObjectModel& mdl, uint32 phaseMask)
+{
+    {
+        ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, guard, m_dynTreeLock);
+        if (mdl.getPhaseMask() == phaseMask)
+            return;
+
+        mdl.enable(phaseMask);
+    }
+    InvalidateQueryCache();
+}
+
+template<class T> void Map::LoadObjectToGrid(LoadingObjectQueueMember const* member, BattleGround* bg)
 {
     T* obj = new T;
-    if(!obj->LoadFromDB(guid, this))
+    if(!obj->LoadFromDB(member->guid, this, &member->prepared))
     {
         delete obj;
         return;
     }
+
+    GridType& grid = member->grid;
     grid.AddGridObject(obj);
     setUnitCell(obj);
 
@@ -39,12 +39,21 @@
 #include "CreatureLinkingMgr.h"
 #include "ObjectLock.h"
 #include "vmap/DynamicTree.h"
+#include "MapQueryCache.h"
+#include "MapObjectPool.h"
 #include "WorldObjectEvents.h"
+#include "MapUpdater.h"
+#include "MPSCQueue.h"
+
+#include <ace/Recursive_Thread_Mutex.h>
+#include <ace/RW_Thread_Mutex.h>
 
-#include <bitset>
 #include <list>
 
 struct CreatureInfo;
+struct CreatureData;
+struct CreatureModelInfo;
+struct GameObjectData;
 class Creature;
 class Unit;
 class WorldPacket;
@@ -60,6 +69,8 @@ class BattleGround;
 class GridMap;
 class GameObjectModel;
 class TerrainInfo;
+class PathRequest;
+class PathFinder;
 
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
 #if defined( __GNUC__ )
@@ -99,16 +110,41 @@ enum LevelRequirementVsMode
 
 typedef std::map<ObjectGuid,GuidSet>  AttackersMap;
 
+enum LoadingObjectState
+{
+    LOADING_OBJECT_NEW,                                     // owned by map thread only
+    LOADING_OBJECT_QUEUED,                                  // waits in ObjectLoadPreparer queue
+    LOADING_OBJECT_PREPARING,
+    LOADING_OBJECT_PREPARED,
+};
+
+// Spawn data resolved before map thread creates the object, every field is optional
+struct LoadingObjectPrepared
+{
+    LoadingObjectPrepared() : creatureData(NULL), goData(NULL), creatureInfo(NULL), difficultyInfo(NULL), modelInfo(NULL) {}
+
+    CreatureData const* creatureData;                       // resolved at queueing
+    GameObjectData const* goData;
+    CreatureInfo const* creatureInfo;                       // resolved by ObjectLoadPreparer
+    CreatureInfo const* difficultyInfo;
+    CreatureModelInfo const* modelInfo;                     // native model, not used if game event changes it
+};
+
 struct LoadingObjectQueueMember
 {
-    explicit LoadingObjectQueueMember(uint32 _guid, TypeID _objectTypeID, GridType& _grid) :
-        guid(_guid), objectTypeID(_objectTypeID), grid(_grid)
+    explicit LoadingObjectQueueMember(uint32 _guid, TypeID _objectTypeID, GridType& _grid, Map const* _map, uint32 _priority) :
+        guid(_guid), objectTypeID(_objectTypeID), grid(_grid), map(_map), priority(_priority), state(LOADING_OBJECT_NEW)
     {}
     uint32 guid;
     TypeID objectTypeID;
     GridType& grid;
+    Map const* map;
+    uint32 priority;                                        // distance in cells to nearest player at queueing
+    LoadingObjectState state;                               // changed only under ObjectLoadPreparer lock
+    LoadingObjectPrepared prepared;
 };
 
+// objects near players first, gameobjects before creatures at same distance
 class LoadingObjectsCompare
 {
     public:
@@ -117,12 +153,33 @@ class LoadingObjectsCompare
 
         bool operator() (LoadingObjectQueueMember const* lqm, LoadingObjectQueueMember const* rqm) const
         {
+            if (lqm->priority != rqm->priority)
+                return lqm->priority > rqm->priority;
+
             return lqm->objectTypeID < rqm->objectTypeID;
         };
 };
 
 typedef std::priority_queue<LoadingObjectQueueMember*, std::vector<LoadingObjectQueueMember*>, LoadingObjectsCompare> LoadingObjectsQueue;
 
+// object marked for client update, added to map queue by any thread without locks
+struct ObjectUpdateQueueMember
+{
+    explicit ObjectUpdateQueueMember(ObjectGuid const& _guid) : guid(_guid), m_queueNext(NULL) {}
+    ObjectGuid guid;
+    ObjectUpdateQueueMember* m_queueNext;
+};
+
+typedef ACE_Based::MPSCQueue<ObjectUpdateQueueMember> ObjectUpdateQueue;
+
+// Group of active cells updated by one thread in parallel cell update
+struct MapUpdateRegion
+{
+    std::vector<uint32> cells;                              // cell ids in serial visit order
+};
+
+typedef std::vector<MapUpdateRegion> MapUpdateRegions;
+
 class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 {
     friend class MapReference;
@@ -244,9 +301,11 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, CellPair cellpair);
 
-        void resetMarkedCells() { marked_cells.reset(); }
-        bool isCellMarked(uint32 pCellId) { return marked_cells.test(pCellId); }
-        void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
+        // cells around players and active objects, updated at source move
+        void AddActiveCellSource(WorldObject* obj);
+        void RemoveActiveCellSource(WorldObject* obj);
+        void UpdateActiveCellSource(WorldObject* obj, float oldX, float oldY);
+        uint32 GetActiveCellsCount() const { return m_activeCellList.size(); }
 
         bool HavePlayers() const { return !m_mapRefManager.isEmpty(); }
         bool isFull() const { return GetPlayersCountExceptGMs() >= GetMaxPlayers(); }
@@ -298,8 +357,10 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
         // Manipulation with objects update queue
         void AddUpdateObject(ObjectGuid const& guid);
-        void RemoveUpdateObject(ObjectGuid const& guid);
-        GuidSet const* GetObjectsUpdateQueue() { return &i_objectsToClientUpdate; };
+
+        // Paths calculated by pathfinding threads, owners get them at next map update
+        uint32 QueuePathRequest(Unit* owner, PathFinder* path);    // returns request id
+        void PathRequestCalculated(PathRequest* request);   // called by pathfinding thread
 
         // DynObjects currently
         uint32 GenerateLocalLowGuid(HighGuid guidhigh);
@@ -341,19 +402,39 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         void SetBroken( bool _value = true ) { m_broken = _value; };
         void ForcedUnload();
 
+        // update timings, filled by MapUpdater
+        MapUpdateStatistics& GetUpdateStatistics() { return m_updateStatistics; }
+        MapUpdateStatistics const& GetUpdateStatistics() const { return m_updateStatistics; }
+
+        // parallel cell update, called from MapRegionUpdater threads
+        void UpdateRegion(uint32 regionIndex, uint32 diff);
+        bool IsRegionUpdateActive() const { return m_regionUpdateActive; }
+        ACE_Recursive_Thread_Mutex& GetRegionLock() { return m_regionLock; }
+
         // Dynamic VMaps
         float GetHeight(uint32 phasemask, float x, float y, float z) const;
         bool IsInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const;
+        // line of sight from one point to count points (x, y, z triples in dest), static models are traced in ray packets
+        void IsInLineOfSight(float srcX, float srcY, float srcZ, float const* dest, uint32 count, uint32 phasemask, bool* results) const;
         bool GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, uint32 phasemask, float modifyDist) const;
 
         void InsertGameObjectModel(const GameObjectModel& mdl);
         void RemoveGameObjectModel(const GameObjectModel& mdl);
         bool ContainsGameObjectModel(const GameObjectModel& mdl) const;
+        void SetGameObjectModelPhaseMask(GameObjectModel& mdl, uint32 phaseMask);
+
+        // must be called at any change of collision data used by IsInLineOfSight/GetHeight (GO models, loaded grids)
+        void InvalidateQueryCache() { m_queryCache.Invalidate(); }
+        MapQueryCacheStatistics GetQueryCacheStatistics() const { return m_queryCache.GetStatistics(); }
+
+        // NULL if map object pools are disabled
+        MapObjectPool const* GetObjectPool() const { return m_objectPool; }
 
         void AddLoadingObject(LoadingObjectQueueMember* obj);
         LoadingObjectQueueMember* GetNextLoadingObject();
-        LoadingObjectsQueue const& GetLoadingObjectsQueue() { return i_loadingObjectQueue; };
+        LoadingObjectsQueue const& GetLoadingObjectsQueue() const { return i_loadingObjectQueue; };
         bool IsLoadingObjectsQueueEmpty() const { return i_loadingObjectQueue.empty(); };
+        uint32 GetWarmedUpGridsCount() const { return m_warmedUpGrids; }
 
         // Event handler
         WorldObjectEventProcessor* GetEvents();
@@ -364,6 +445,9 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
     private:
         void LoadMapAndVMap(int gx, int gy);
+        float CalculateHeight(uint32 phasemask, float x, float y, float z) const;
+        void CheckQueryCacheTerrain() const;
+        bool IsInDynamicLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask) const;
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
 
@@ -380,6 +464,9 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         void EnsureGridCreated(GridPair const& p);
         bool EnsureGridLoaded(Cell const& c);
         void EnsureGridLoadedAtEnter(Cell const& c, Player* player = NULL);
+        void PrefetchTerrain(Player* player);
+        void WarmupGrids(Player* player);
+        void WarmupGrid(float x, float y);
 
         void buildNGridLinkage(NGridType* pNGridType) { pNGridType->link(this); }
 
@@ -394,7 +481,7 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
             return i_grids[x][y];
         }
 
-        template<class T> void LoadObjectToGrid(uint32& guid, GridType& grid, BattleGround* bg);
+        template<class T> void LoadObjectToGrid(LoadingObjectQueueMember const* member, BattleGround* bg);
         template<class T> void setUnitCell(T* /*obj*/) {}
         void setUnitCell(Creature* obj);
 
@@ -406,7 +493,28 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
         void SendObjectUpdates();
 
-        GuidSet i_objectsToClientUpdate;
+        // active cells update
+        void CollectActiveCells(uint32 diff);
+        void UpdateCells(std::vector<uint32> const& cells, uint32 diff);
+        bool BuildUpdateRegions();
+        void CheckUpdateRegions();
+        void UpdateCellsParallel(uint32 diff);
+        int32 GetUpdateRegionFor(CellPair const& cellPair) const;
+        template<class T> bool DeferRegionRelocation(T* obj, Position const& pos);
+        void ProcessDeferredRelocations();
+        void CancelDeferredRelocation(WorldObject* obj);
+
+        void ClearObjectUpdateQueue();
+
+        void ProcessCalculatedPaths();
+        void ClearPathRequests();
+
+        ObjectUpdateQueue i_objectsToClientUpdate;          // may have duplicates and removed objects, checked at SendObjectUpdates
+
+        typedef ACE_Based::MPSCQueue<PathRequest> PathRequestQueue;
+        PathRequestQueue i_calculatedPaths;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> i_pathRequestsInProgress;   // queued to pathfinding threads and not returned yet
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint32> i_lastPathRequestId;
 
         LoadingObjectsQueue i_loadingObjectQueue;
 
@@ -433,10 +541,46 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         //Shared geodata object with map coord info...
         TerrainInfo* const m_TerrainData;
         DynamicMapTree m_dyn_tree;
+        mutable ACE_RW_Thread_Mutex m_dynTreeLock;         // GO models are inserted and removed by regions of parallel update
+        mutable MapQueryCache m_queryCache;
+        mutable ACE_Atomic_Op<ACE_Thread_Mutex, uint32> m_queryCacheTerrainGeneration; // of m_TerrainData, at last cache check
+        MapObjectPool* m_objectPool;                        // creatures, gameobjects and dynamic objects created while map updated
+        uint32 m_warmedUpGrids;                             // grids loaded ahead of players on taxi and transports
 
         bool m_bLoadedGrids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
-        std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP*TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
+        // active cells, reference counted by players and active objects around
+        struct ActiveCellRef
+        {
+            uint32 refs;
+            uint32 index;                                   // in m_activeCellList
+        };
+        typedef UNORDERED_MAP<uint32, ActiveCellRef> ActiveCellRefs;
+        struct ActiveCellSource
+        {
+            CellArea area;
+            bool valid;                                     // no cells counted for invalid position
+        };
+        typedef UNORDERED_MAP<WorldObject const*, ActiveCellSource> ActiveCellSources;
+
+        void AddActiveCellArea(CellArea const& area, CellArea const* except);
+        void RemoveActiveCellArea(CellArea const& area, CellArea const* except);
+
+        ActiveCellRefs m_activeCellRefs;
+        ActiveCellSources m_activeCellSources;
+        std::vector<uint32> m_activeCellList;
+        bool m_activeCellsChanged;
+        std::vector<uint32> m_activeCells;                  // active cells snapshot for current update
+
+        // parallel cell update data
+        MapUpdateRegions m_updateRegions;
+        UNORDERED_MAP<uint32, uint32> m_cellRegions;        // active cell id -> region index
+        uint32 m_regionBorder;                              // in cells, region owns cells not farther than this from own active cells
+        MapRegionBatch m_regionBatch;
+        typedef std::vector<std::pair<WorldObject*, Position> > DeferredRelocations;
+        DeferredRelocations m_deferredRelocations;
+        ACE_Recursive_Thread_Mutex m_regionLock;
+        volatile bool m_regionUpdateActive;
 
         UNORDERED_SET<WorldObject*> i_objectsToRemove;
 
@@ -465,6 +609,7 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         mutable ObjectLockType  i_lock[MAP_LOCK_TYPE_MAX];
         AttackersMap        m_attackersMap;
         bool                m_broken;
+        MapUpdateStatistics m_updateStatistics;
 
         WorldObjectEventProcessor m_Events;
 
@@ -534,6 +679,27 @@ class MANGOS_DLL_SPEC BattleGroundMap : public Map
         BattleGround* m_bg;
 };
 
+// Serialize structural map changes (grid containers, active/remove lists, script schedule)
+// while cells are updated by several threads, no-op at serial update
+class MapRegionGuard
+{
+    public:
+        explicit MapRegionGuard(Map* map) : m_lock(map->IsRegionUpdateActive() ? &map->GetRegionLock() : NULL)
+        {
+            if (m_lock)
+                m_lock->acquire();
+        }
+
+        ~MapRegionGuard()
+        {
+            if (m_lock)
+                m_lock->release();
+        }
+
+    private:
+        ACE_Recursive_Thread_Mutex* m_lock;
+};
+
 template<class T, class CONTAINER>
 inline void
 Map::Visit(const Cell& cell, TypeContainerVisitor<T, CONTAINER> &visitor)
@@ -55,6 +55,20 @@ MapManager::Initialize()
     if (m_threadsCount > 0 && m_updater.activate(m_threadsCount) == -1)
         abort();
 
+    // helper threads for parallel update of cell regions inside one map
+    if (sWorld.getConfig(CONFIG_BOOL_MAPUPDATE_PARALLEL_CELLS) && sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_PARALLEL_CELLS_THREADS) > 0 &&
+        m_regionUpdater.activate(sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_PARALLEL_CELLS_THREADS)) == -1)
+        abort();
+
+    // background reading of terrain files for grids in front of moving players
+    sTerrainMgr.GetLoader().Start(sWorld.getConfig(CONFIG_UINT32_TERRAIN_LOAD_THREADS));
+
+    // background resolving of creature templates and models for grid loading queues
+    m_objectPreparer.Start(sWorld.getConfig(CONFIG_UINT32_OBJECT_PREPARE_THREADS));
+
+    // chasing paths calculated on navmesh out of map threads
+    m_pathRequestProcessor.Start(sWorld.getConfig(CONFIG_UINT32_PATHFINDING_THREADS));
+
     InitStateMachine();
 
     i_balanceTimer.SetInterval(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE)*100);
@@ -204,7 +218,7 @@ void MapManager::Update(uint32 diff)
             m_updater.schedule_update(*iter->second, (uint32)i_timer.GetCurrent());
         }
         else
-            iter->second->Update((uint32)i_timer.GetCurrent());
+            MapUpdater::UpdateMap(*iter->second, (uint32)i_timer.GetCurrent(), 0);
     }
 
     if (m_updater.activated())
@@ -273,11 +287,17 @@ void MapManager::UnloadAll()
         i_maps.erase(i_maps.begin());
     }
 
+    m_objectPreparer.Stop();
+    m_pathRequestProcessor.Stop();
+    TerrainManager::Instance().GetLoader().Stop();
     TerrainManager::Instance().UnloadAll();
 
     if (m_updater.activated())
         m_updater.deactivate();
 
+    if (m_regionUpdater.activated())
+        m_regionUpdater.deactivate();
+
 }
 
 uint32 MapManager::GetNumInstances()
@@ -26,6 +26,8 @@
 #include "Map.h"
 #include "GridStates.h"
 #include "MapUpdater.h"
+#include "ObjectGridLoader.h"
+#include "PathRequest.h"
 
 class BattleGround;
 
@@ -156,6 +158,9 @@ class MANGOS_DLL_DECL MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::
         void DoForAllMapsWithMapId(uint32 mapId, Do& _do);
 
         MapUpdater* GetMapUpdater() { return &m_updater; };
+        MapRegionUpdater* GetRegionUpdater() { return &m_regionUpdater; };
+        ObjectLoadPreparer* GetObjectPreparer() { return &m_objectPreparer; };
+        PathRequestProcessor* GetPathRequestProcessor() { return &m_pathRequestProcessor; };
 
         void UpdateLoadBalancer(bool b_start);
 
@@ -184,6 +189,9 @@ class MANGOS_DLL_DECL MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::
         MapMapType i_maps;
 
         MapUpdater m_updater;
+        MapRegionUpdater m_regionUpdater;
+        ObjectLoadPreparer m_objectPreparer;
+        PathRequestProcessor m_pathRequestProcessor;
         ShortIntervalTimer i_balanceTimer;
         int32  m_threadsCount;
         int32  m_threadsCountPreferred;
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MapObjectPool.h"
+#include <ace/Guard_T.h>
+#include <ace/TSS_T.h>
+#include <ace/Atomic_Op.h>
+
+// stored before every pooled object, size keeps object alignment
+union MapObjectBlockHeader
+{
+    struct
+    {
+        MapObjectPool* pool;                                // NULL for global heap
+        ObjectSlabPool* slab;
+    } owner;
+    double align[2];
+};
+
+struct MapObjectPoolContext
+{
+    MapObjectPoolContext() : pool(NULL) {}
+
+    MapObjectPool* pool;
+};
+
+static ACE_TSS<MapObjectPoolContext> s_poolContext;
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> s_heapObjects;
+
+ObjectSlabPool::ObjectSlabPool(size_t blockSize) : m_blockSize(blockSize), m_free(NULL), m_used(0)
+{
+}
+
+ObjectSlabPool::~ObjectSlabPool()
+{
+    for (std::vector<char*>::const_iterator itr = m_slabs.begin(); itr != m_slabs.end(); ++itr)
+        delete[] *itr;
+}
+
+void* ObjectSlabPool::Allocate()
+{
+    if (!m_free)
+    {
+        char* slab = new char[m_blockSize * MAP_OBJECT_POOL_SLAB_SIZE];
+        m_slabs.push_back(slab);
+
+        // link in address order, so new objects are placed one after another
+        for (int i = MAP_OBJECT_POOL_SLAB_SIZE - 1; i >= 0; --i)
+        {
+            FreeBlock* block = (FreeBlock*)(slab + i * m_blockSize);
+            block->next = m_free;
+            m_free = block;
+        }
+    }
+
+    FreeBlock* block = m_free;
+    m_free = block->next;
+    ++m_used;
+    return block;
+}
+
+void ObjectSlabPool::Free(void* ptr)
+{
+    FreeBlock* block = (FreeBlock*)ptr;
+    block->next = m_free;
+    m_free = block;
+    --m_used;
+}
+
+MapObjectPool::MapObjectPool() : m_allocated(0), m_released(false)
+{
+}
+
+MapObjectPool::~MapObjectPool()
+{
+    for (int i = 0; i < MAX_MAP_POOL_TYPES; ++i)
+        for (SlabPoolList::const_iterator itr = m_pools[i].begin(); itr != m_pools[i].end(); ++itr)
+            delete *itr;
+}
+
+void* MapObjectPool::Allocate(MapObjectPoolType type, size_t size)
+{
+    MapObjectPool* pool = GetCurrent();
+
+    MapObjectBlockHeader* header;
+    if (pool)
+    {
+        ObjectSlabPool* slab;
+        header = (MapObjectBlockHeader*)pool->AllocateBlock(type, sizeof(MapObjectBlockHeader) + size, slab);
+        header->owner.pool = pool;
+        header->owner.slab = slab;
+    }
+    else
+    {
+        header = (MapObjectBlockHeader*)::operator new(sizeof(MapObjectBlockHeader) + size);
+        header->owner.pool = NULL;
+        header->owner.slab = NULL;
+        ++s_heapObjects;
+    }
+
+    return header + 1;
+}
+
+void MapObjectPool::Free(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    MapObjectBlockHeader* header = (MapObjectBlockHeader*)ptr - 1;
+    if (header->owner.pool)
+        header->owner.pool->FreeBlock(header->owner.slab, header);
+    else
+    {
+        --s_heapObjects;
+        ::operator delete(header);
+    }
+}
+
+MapObjectPool* MapObjectPool::GetCurrent()
+{
+    return s_poolContext->pool;
+}
+
+void MapObjectPool::SetCurrent(MapObjectPool* pool)
+{
+    s_poolContext->pool = pool;
+}
+
+uint32 MapObjectPool::GetHeapObjectsCount()
+{
+    return uint32(s_heapObjects.value());
+}
+
+void* MapObjectPool::AllocateBlock(MapObjectPoolType type, size_t size, ObjectSlabPool*& slab)
+{
+    // round to header alignment, so next block in slab is aligned too
+    size = (size + sizeof(MapObjectBlockHeader) - 1) / sizeof(MapObjectBlockHeader) * sizeof(MapObjectBlockHeader);
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
+
+    slab = NULL;
+    SlabPoolList& pools = m_pools[type];
+    for (SlabPoolList::const_iterator itr = pools.begin(); itr != pools.end(); ++itr)
+    {
+        if ((*itr)->GetBlockSize() == size)
+        {
+            slab = *itr;
+            break;
+        }
+    }
+
+    if (!slab)
+    {
+        slab = new ObjectSlabPool(size);
+        pools.push_back(slab);
+    }
+
+    ++m_allocated;
+    return slab->Allocate();
+}
+
+void MapObjectPool::FreeBlock(ObjectSlabPool* slab, void* block)
+{
+    bool destroy;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        slab->Free(block);
+        --m_allocated;
+        destroy = m_released && !m_allocated;
+    }
+
+    if (destroy)
+        delete this;
+}
+
+void MapObjectPool::Release()
+{
+    if (GetCurrent() == this)
+        SetCurrent(NULL);
+
+    bool destroy;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_released = true;
+        destroy = !m_allocated;
+    }
+
+    if (destroy)
+        delete this;
+}
+
+MapObjectPoolStatistics MapObjectPool::GetStatistics() const
+{
+    MapObjectPoolStatistics stats;
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, stats);
+    for (int i = 0; i < MAX_MAP_POOL_TYPES; ++i)
+    {
+        for (SlabPoolList::const_iterator itr = m_pools[i].begin(); itr != m_pools[i].end(); ++itr)
+        {
+            stats.used[i] += (*itr)->GetUsed();
+            stats.capacity[i] += (*itr)->GetCapacity();
+            stats.bytes[i] += uint64((*itr)->GetCapacity()) * (*itr)->GetBlockSize();
+        }
+    }
+
+    return stats;
+}
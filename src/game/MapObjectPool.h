@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _MAP_OBJECT_POOL_H_INCLUDED
+#define _MAP_OBJECT_POOL_H_INCLUDED
+
+#include "Common.h"
+
+#include <ace/Thread_Mutex.h>
+
+#include <vector>
+
+// objects allocated from one slab of pool
+#define MAP_OBJECT_POOL_SLAB_SIZE   64
+
+enum MapObjectPoolType
+{
+    MAP_POOL_CREATURE       = 0,                            // Creature and all subclasses (summons, pets, totems, vehicles)
+    MAP_POOL_GAMEOBJECT     = 1,
+    MAP_POOL_DYNAMICOBJECT  = 2,
+    MAX_MAP_POOL_TYPES
+};
+
+struct MapObjectPoolStatistics
+{
+    MapObjectPoolStatistics()
+    {
+        for (int i = 0; i < MAX_MAP_POOL_TYPES; ++i)
+        {
+            used[i] = 0;
+            capacity[i] = 0;
+            bytes[i] = 0;
+        }
+    }
+
+    void Add(MapObjectPoolStatistics const& other)
+    {
+        for (int i = 0; i < MAX_MAP_POOL_TYPES; ++i)
+        {
+            used[i] += other.used[i];
+            capacity[i] += other.capacity[i];
+            bytes[i] += other.bytes[i];
+        }
+    }
+
+    uint32 used[MAX_MAP_POOL_TYPES];                        // objects alive
+    uint32 capacity[MAX_MAP_POOL_TYPES];                    // object places in allocated slabs
+    uint64 bytes[MAX_MAP_POOL_TYPES];                       // memory of allocated slabs
+};
+
+// Fixed size blocks carved from slabs of MAP_OBJECT_POOL_SLAB_SIZE blocks, freed blocks are reused
+class ObjectSlabPool
+{
+    public:
+
+        explicit ObjectSlabPool(size_t blockSize);
+        ~ObjectSlabPool();
+
+        void* Allocate();
+        void Free(void* block);
+
+        size_t GetBlockSize() const { return m_blockSize; }
+        uint32 GetUsed() const { return m_used; }
+        uint32 GetCapacity() const { return uint32(m_slabs.size()) * MAP_OBJECT_POOL_SLAB_SIZE; }
+
+    private:
+
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        size_t m_blockSize;
+        std::vector<char*> m_slabs;
+        FreeBlock* m_free;
+        uint32 m_used;
+};
+
+// Per map pools of world objects. Class operator new of pooled objects takes memory from pool
+// of map updated by current thread (set by MapObjectPoolScope), otherwise from global heap.
+// Every block knows its pool, so object can be deleted by any thread, also after its map is gone:
+// pool released by map is destroyed with last returned object.
+class MapObjectPool
+{
+    public:
+
+        MapObjectPool();
+
+        static void* Allocate(MapObjectPoolType type, size_t size);
+        static void Free(void* ptr);
+
+        // pool used by allocations of current thread, NULL - global heap
+        static MapObjectPool* GetCurrent();
+        static void SetCurrent(MapObjectPool* pool);
+
+        // objects allocated outside of map pools
+        static uint32 GetHeapObjectsCount();
+
+        // called by owner instead of delete
+        void Release();
+
+        MapObjectPoolStatistics GetStatistics() const;
+
+    private:
+
+        ~MapObjectPool();
+
+        void* AllocateBlock(MapObjectPoolType type, size_t size, ObjectSlabPool*& slab);
+        void FreeBlock(ObjectSlabPool* slab, void* block);
+
+        typedef std::vector<ObjectSlabPool*> SlabPoolList;  // subclasses of one type have different sizes
+
+        mutable ACE_Thread_Mutex m_lock;
+        SlabPoolList m_pools[MAX_MAP_POOL_TYPES];
+        uint32 m_allocated;
+        bool m_released;
+};
+
+// sets pool of map for allocations of current thread while in scope
+class MapObjectPoolScope
+{
+    public:
+
+        explicit MapObjectPoolScope(MapObjectPool* pool) : m_prev(MapObjectPool::GetCurrent()) { MapObjectPool::SetCurrent(pool); }
+        ~MapObjectPoolScope() { MapObjectPool::SetCurrent(m_prev); }
+
+    private:
+
+        MapObjectPool* m_prev;
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MapQueryCache.h"
+#include <ace/Guard_T.h>
+#include <math.h>
+
+static inline int32 QuantizeQueryCoord(float value)
+{
+    return int32(floor(value / MAP_QUERY_CACHE_STEP));
+}
+
+MapQueryKey::MapQueryKey(MapQueryType _type, uint32 _phasemask, float x1, float y1, float z1, float x2, float y2, float z2)
+    : phasemask(_phasemask), type(_type)
+{
+    coords[0] = QuantizeQueryCoord(x1);
+    coords[1] = QuantizeQueryCoord(y1);
+    coords[2] = QuantizeQueryCoord(z1);
+    coords[3] = QuantizeQueryCoord(x2);
+    coords[4] = QuantizeQueryCoord(y2);
+    coords[5] = QuantizeQueryCoord(z2);
+}
+
+bool MapQueryKey::operator== (MapQueryKey const& other) const
+{
+    return type == other.type && phasemask == other.phasemask &&
+        coords[0] == other.coords[0] && coords[1] == other.coords[1] && coords[2] == other.coords[2] &&
+        coords[3] == other.coords[3] && coords[4] == other.coords[4] && coords[5] == other.coords[5];
+}
+
+uint32 MapQueryKey::GetHash() const
+{
+    // FNV-1a over key fields
+    uint32 hash = 2166136261u;
+    for (int i = 0; i < 6; ++i)
+        hash = (hash ^ uint32(coords[i])) * 16777619u;
+    hash = (hash ^ phasemask) * 16777619u;
+    hash = (hash ^ type) * 16777619u;
+    return hash ^ (hash >> 16);
+}
+
+MapQueryCache::MapQueryCache() : m_enabled(false), m_entryMask(0), m_generation(1), m_invalidations(0)
+{
+}
+
+void MapQueryCache::Initialize(uint32 size)
+{
+    uint32 perSegment = 0;
+    if (size)
+    {
+        perSegment = 1;
+        while (perSegment * MAP_QUERY_CACHE_SEGMENTS < size)
+            perSegment <<= 1;
+    }
+
+    for (int i = 0; i < MAP_QUERY_CACHE_SEGMENTS; ++i)
+    {
+        Segment& segment = m_segments[i];
+        ACE_GUARD(ACE_Thread_Mutex, guard, segment.lock);
+        segment.entries.assign(perSegment, Entry());
+    }
+
+    m_entryMask = perSegment ? perSegment - 1 : 0;
+    m_enabled = perSegment != 0;
+}
+
+bool MapQueryCache::Find(MapQueryKey const& key, float& result)
+{
+    uint32 hash = key.GetHash();
+    Segment& segment = m_segments[hash % MAP_QUERY_CACHE_SEGMENTS];
+    uint32 generation = GetGeneration();
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, segment.lock, false);
+
+    Entry const& entry = segment.entries[(hash / MAP_QUERY_CACHE_SEGMENTS) & m_entryMask];
+    if (entry.generation == generation && entry.key == key)
+    {
+        result = entry.result;
+        ++segment.hits;
+        return true;
+    }
+
+    ++segment.misses;
+    return false;
+}
+
+void MapQueryCache::Store(MapQueryKey const& key, uint32 generation, float result)
+{
+    uint32 hash = key.GetHash();
+    Segment& segment = m_segments[hash % MAP_QUERY_CACHE_SEGMENTS];
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, segment.lock);
+
+    Entry& entry = segment.entries[(hash / MAP_QUERY_CACHE_SEGMENTS) & m_entryMask];
+    entry.key = key;
+    entry.generation = generation;
+    entry.result = result;
+}
+
+void MapQueryCache::Invalidate()
+{
+    if (!IsEnabled())
+        return;
+
+    // 0 is reserved for unused entries
+    if (++m_generation == 0)
+        ++m_generation;
+
+    ++m_invalidations;
+}
+
+MapQueryCacheStatistics MapQueryCache::GetStatistics() const
+{
+    MapQueryCacheStatistics stats;
+    stats.invalidations = m_invalidations.value();
+
+    for (int i = 0; i < MAP_QUERY_CACHE_SEGMENTS; ++i)
+    {
+        Segment& segment = const_cast<Segment&>(m_segments[i]);
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, segment.lock, stats);
+        stats.size += uint32(segment.entries.size());
+        stats.hits += segment.hits;
+        stats.misses += segment.misses;
+    }
+
+    return stats;
+}
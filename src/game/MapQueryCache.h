@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _MAP_QUERY_CACHE_H_INCLUDED
+#define _MAP_QUERY_CACHE_H_INCLUDED
+
+#include "Common.h"
+
+#include <ace/Thread_Mutex.h>
+#include <ace/Atomic_Op.h>
+
+#include <vector>
+
+// positions are cached with this precision (in yards)
+#define MAP_QUERY_CACHE_STEP        0.25f
+// independent locked parts of cache, so parallel cell updates of one map rarely wait each other
+#define MAP_QUERY_CACHE_SEGMENTS    16
+
+enum MapQueryType
+{
+    MAP_QUERY_LINE_OF_SIGHT = 1,
+    MAP_QUERY_HEIGHT        = 2,
+};
+
+struct MapQueryKey
+{
+    MapQueryKey() {}
+    MapQueryKey(MapQueryType type, uint32 phasemask, float x1, float y1, float z1, float x2 = 0.0f, float y2 = 0.0f, float z2 = 0.0f);
+
+    bool operator== (MapQueryKey const& other) const;
+    uint32 GetHash() const;
+
+    int32 coords[6];
+    uint32 phasemask;
+    uint32 type;
+};
+
+struct MapQueryCacheStatistics
+{
+    MapQueryCacheStatistics() : size(0), hits(0), misses(0), invalidations(0) {}
+
+    uint32 size;
+    uint64 hits;
+    uint64 misses;
+    uint32 invalidations;
+};
+
+// Bounded cache of line of sight and height query results of one map.
+// Every key has one possible slot, newer result replaces older one.
+// All results are dropped at once (by generation change) when collision data of map changes.
+class MapQueryCache
+{
+    public:
+
+        MapQueryCache();
+
+        // size 0 disables cache, otherwise rounded up to power of 2
+        void Initialize(uint32 size);
+        bool IsEnabled() const { return m_enabled; }
+
+        bool Find(MapQueryKey const& key, float& result);
+        // generation must be taken before calculation of result, so result of query
+        // running concurrently with collision change is not stored as valid
+        void Store(MapQueryKey const& key, uint32 generation, float result);
+        uint32 GetGeneration() const { return m_generation.value(); }
+
+        void Invalidate();
+
+        MapQueryCacheStatistics GetStatistics() const;
+
+    private:
+
+        struct Entry
+        {
+            Entry() : generation(0), result(0.0f) {}
+
+            MapQueryKey key;
+            uint32 generation;                              // 0 for never used entry
+            float result;
+        };
+
+        struct Segment
+        {
+            Segment() : hits(0), misses(0) {}
+
+            ACE_Thread_Mutex lock;
+            std::vector<Entry> entries;
+            uint64 hits;
+            uint64 misses;
+        };
+
+        Segment m_segments[MAP_QUERY_CACHE_SEGMENTS];
+        bool m_enabled;
+        uint32 m_entryMask;                                 // entries per segment - 1
+
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint32> m_generation;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint32> m_invalidations;
+};
+
+#endif
@@ -17,49 +17,47 @@
  */
 
 #include "MapUpdater.h"
-#include "DelayExecutor.h"
 #include "Map.h"
 #include "MapManager.h"
 #include "World.h"
+#include "UpdateData.h"
 #include "Database/DatabaseEnv.h"
 #include <ace/Guard_T.h>
-#include <ace/Method_Request.h>
 
-class MapUpdateRequest : public ACE_Method_Request
+void MapUpdateStatistics::AddSample(uint32 cost, uint32 queueWait)
 {
-    private:
+    lastCost = cost;
+    lastQueueWait = queueWait;
+    if (cost > maxCost)
+        maxCost = cost;
 
-        Map& m_map;
-        MapUpdater& m_updater;
-        ACE_UINT32 m_diff;
-
-    public:
+    // first sample initializes average, later use moving average with 1/8 weight
+    if (!updates)
+    {
+        avgCost = cost;
+        avgQueueWait = queueWait;
+    }
+    else
+    {
+        avgCost = uint32(int64(avgCost) + (int64(cost) - int64(avgCost)) / 8);
+        avgQueueWait = uint32(int64(avgQueueWait) + (int64(queueWait) - int64(avgQueueWait)) / 8);
+    }
 
-        MapUpdateRequest(Map& m, MapUpdater& u, ACE_UINT32 d)
-            : m_map(m), m_updater(u), m_diff(d)
-        {
-        }
+    ++updates;
+}
 
-        virtual int call()
-        {
-            ACE_thread_t const threadId = ACE_OS::thr_self();
-            m_updater.register_thread(threadId, m_map.GetId(),m_map.GetInstanceId());
-            if (m_map.IsBroken())
-            {
-                m_map.ForcedUnload();
-            }
-            else
-            {
-                m_map.Update(m_diff);
-            }
-            m_updater.unregister_thread(threadId);
-            m_updater.update_finished ();
-            return 0;
-        }
+// most expensive maps go first
+struct MapUpdateTaskCostOrder
+{
+    bool operator() (MapUpdateTask const& left, MapUpdateTask const& right) const
+    {
+        return left.cost > right.cost;
+    }
 };
 
 MapUpdater::MapUpdater()
-    : m_mutex(), m_condition(m_mutex), m_executor(), pending_requests(0), m_broken(false)
+    : m_workSignal(0), m_doneSignal(0), m_pendingRequests(0), m_nextWorkerIndex(0), m_stolenTasks(0),
+    m_threadsCount(0), m_activated(false), m_stopping(false), m_broken(false)
 {
 }
 
@@ -70,14 +68,48 @@ MapUpdater::~MapUpdater()
 
 int MapUpdater::activate(size_t num_threads)
 {
-    return m_executor.activate((int)num_threads);
+    if (activated() || num_threads < 1)
+        return -1;
+
+    m_threadsCount = num_threads;
+    m_nextWorkerIndex = 0;
+    m_stopping = false;
+
+    for (size_t i = 0; i < num_threads; ++i)
+        m_queues.push_back(new MapUpdateWorkerQueue);
+
+    if (ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, int(num_threads)) == -1)
+    {
+        for (MapUpdateWorkerQueues::iterator itr = m_queues.begin(); itr != m_queues.end(); ++itr)
+            delete *itr;
+        m_queues.clear();
+        m_threadsCount = 0;
+        return -1;
+    }
+
+    m_activated = true;
+    return 0;
 }
 
 int MapUpdater::deactivate()
 {
+    if (!activated())
+        return -1;
+
     wait();
 
-    return m_executor.deactivate();
+    m_activated = false;
+    m_stopping = true;
+    m_workSignal.release(uint32(m_threadsCount));
+
+    ACE_Task_Base::wait();
+
+    for (MapUpdateWorkerQueues::iterator itr = m_queues.begin(); itr != m_queues.end(); ++itr)
+        delete *itr;
+    m_queues.clear();
+    m_threadsCount = 0;
+
+    return 0;
 }
 
 void MapUpdater::ReActivate(uint32 threads)
@@ -89,54 +121,183 @@ void MapUpdater::ReActivate(uint32 threads)
 
 int MapUpdater::wait()
 {
-    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+    if (m_batch.empty())
+        return 0;
 
-    while (pending_requests > 0)
-        m_condition.wait();
+    dispatch();
 
-    return 0;
+    return m_doneSignal.acquire();
 }
 
 int MapUpdater::schedule_update(Map& map, ACE_UINT32 diff)
 {
-    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+    if (!activated())
+        return -1;
+
+    m_batch.push_back(MapUpdateTask(&map, diff, map.GetUpdateStatistics().avgCost));
+    return 0;
+}
+
+void MapUpdater::dispatch()
+{
+    std::stable_sort(m_batch.begin(), m_batch.end(), MapUpdateTaskCostOrder());
+
+    m_pendingRequests = long(m_batch.size());
 
-    ++pending_requests;
+    // greedy longest-first distribution: every next map goes to the least loaded worker,
+    // so expensive maps start in parallel and cheap instances fill the gaps
+    std::vector<uint64> workerLoad(m_threadsCount, 0);
+    uint64 now = WorldTimer::getMicroTime();
 
-    if (m_executor.execute(new MapUpdateRequest(map, *this, diff)) == -1)
+    for (MapUpdateTaskList::iterator itr = m_batch.begin(); itr != m_batch.end(); ++itr)
     {
-        ACE_DEBUG((LM_ERROR, ACE_TEXT("(%t) \n"), ACE_TEXT("Failed to schedule Map Update")));
+        size_t target = 0;
+        for (size_t i = 1; i < m_threadsCount; ++i)
+            if (workerLoad[i] < workerLoad[target])
+                target = i;
+
+        // empty maps still cost something, count them too
+        workerLoad[target] += itr->cost + 1;
+        itr->queuedTime = now;
+
+        MapUpdateWorkerQueue* queue = m_queues[target];
+        ACE_GUARD(ACE_Thread_Mutex, guard, queue->lock);
+        queue->tasks.push_back(*itr);
+        queue->pendingCost += itr->cost + 1;
+    }
 
-        --pending_requests;
-        return -1;
+    m_workSignal.release(uint32(std::min(m_batch.size(), m_threadsCount)));
+    m_batch.clear();
+}
+
+bool MapUpdater::PopTask(uint32 workerIndex, MapUpdateTask& task)
+{
+    MapUpdateWorkerQueue* queue = m_queues[workerIndex];
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, queue->lock, false);
+
+    if (queue->tasks.empty())
+        return false;
+
+    task = queue->tasks.front();
+    queue->tasks.pop_front();
+    queue->pendingCost -= task.cost + 1;
+    return true;
+}
+
+bool MapUpdater::StealTask(uint32 workerIndex, MapUpdateTask& task)
+{
+    // select the most loaded victim, then take its cheapest task
+    MapUpdateWorkerQueue* victim = NULL;
+    uint64 victimCost = 0;
+    for (uint32 i = 0; i < m_queues.size(); ++i)
+    {
+        if (i == workerIndex)
+            continue;
+
+        MapUpdateWorkerQueue* queue = m_queues[i];
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, queue->lock, false);
+        if (!queue->tasks.empty() && queue->pendingCost > victimCost)
+        {
+            victim = queue;
+            victimCost = queue->pendingCost;
+        }
+    }
+
+    if (!victim)
+        return false;
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, victim->lock, false);
+
+    // may be drained by its owner in between
+    if (victim->tasks.empty())
+        return false;
+
+    task = victim->tasks.back();
+    victim->tasks.pop_back();
+    victim->pendingCost -= task.cost + 1;
+    ++m_stolenTasks;
+    return true;
+}
+
+int MapUpdater::svc()
+{
+    uint32 const workerIndex = uint32(m_nextWorkerIndex++);
+    MANGOS_ASSERT(workerIndex < m_queues.size());
+
+    for (;;)
+    {
+        MapUpdateTask task;
+        if (PopTask(workerIndex, task) || StealTask(workerIndex, task))
+        {
+            ACE_thread_t const threadId = ACE_OS::thr_self();
+            register_thread(threadId, task.map->GetId(), task.map->GetInstanceId());
+            UpdateMap(*task.map, task.diff, task.queuedTime);
+            unregister_thread(threadId);
+            request_finished();
+            continue;
+        }
+
+        if (m_stopping)
+            break;
+
+        m_workSignal.acquire();
     }
 
     return 0;
 }
 
-bool MapUpdater::activated()
+void MapUpdater::UpdateMap(Map& map, uint32 diff, uint64 queuedTime)
 {
-    return m_executor.activated();
+    uint64 startTime = WorldTimer::getMicroTime();
+
+    // maps updated by world thread restore deadline of world update
+    uint64 callerDeadline = UpdateData::GetCompressionDeadline();
+    UpdateData::SetCompressionDeadline(startTime + uint64(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE)) * 1000);
+
+    if (map.IsBroken())
+        map.ForcedUnload();
+    else
+        map.Update(diff);
+
+    UpdateData::SetCompressionDeadline(callerDeadline);
+
+    uint64 endTime = WorldTimer::getMicroTime();
+    uint32 queueWait = (queuedTime && startTime > queuedTime) ? uint32(startTime - queuedTime) : 0;
+    map.GetUpdateStatistics().AddSample(uint32(endTime - startTime), queueWait);
 }
 
-void MapUpdater::update_finished()
+bool MapUpdater::activated()
 {
-    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+    return m_activated;
+}
 
-    if (pending_requests == 0)
+bool MapUpdater::request_finished()
+{
+    long pending = --m_pendingRequests;
+    if (pending < 0)
     {
         ACE_ERROR((LM_ERROR, ACE_TEXT("(%t)\n"), ACE_TEXT("MapUpdater::update_finished BUG, report to devs")));
-        return;
+        m_pendingRequests = 0;
+        return false;
     }
 
-    --pending_requests;
+    if (pending > 0)
+        return true;
 
-    m_condition.broadcast();
+    m_doneSignal.release();
+    return false;
+}
+
+void MapUpdater::update_finished()
+{
+    // called for a crashed worker (VMSS), its queue must be stolen by the others
+    if (request_finished())
+        m_workSignal.release(uint32(m_threadsCount));
 }
 
 void MapUpdater::register_thread(ACE_thread_t const threadId, uint32 mapId, uint32 instanceId)
 {
-    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_threadsLock);
     MapID pair = MapID(mapId, instanceId);
     m_threads.insert(std::make_pair(threadId, pair));
     m_starttime.insert(std::make_pair(threadId, WorldTimer::getMSTime()));
@@ -144,7 +305,7 @@ void MapUpdater::register_thread(ACE_thread_t const threadId, uint32 mapId, uint
 
 void MapUpdater::unregister_thread(ACE_thread_t const threadId)
 {
-    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_threadsLock);
     m_threads.erase(threadId);
     m_starttime.erase(threadId);
 }
@@ -162,7 +323,7 @@ MapID const* MapUpdater::GetMapPairByThreadId(ACE_thread_t const threadId)
 
 void MapUpdater::FreezeDetect()
 {
-    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_threadsLock);
     if (!m_starttime.empty())
     {
         for (ThreadStartTimeMap::const_iterator itr = m_starttime.begin(); itr != m_starttime.end(); ++itr)
@@ -219,3 +380,139 @@ MapBrokenData const* MapUpdater::GetMapBrokenData(MapID const* mapPair)
     }
     return NULL;
 }
+
+MapRegionUpdater::MapRegionUpdater()
+    : m_signal(0), m_threadsCount(0), m_activated(false), m_stopping(false)
+{
+}
+
+MapRegionUpdater::~MapRegionUpdater()
+{
+    deactivate();
+}
+
+int MapRegionUpdater::activate(size_t num_threads)
+{
+    if (activated() || num_threads < 1)
+        return -1;
+
+    m_threadsCount = num_threads;
+    m_stopping = false;
+
+    if (ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, int(num_threads)) == -1)
+    {
+        m_threadsCount = 0;
+        return -1;
+    }
+
+    m_activated = true;
+    return 0;
+}
+
+int MapRegionUpdater::deactivate()
+{
+    if (!activated())
+        return -1;
+
+    m_activated = false;
+    m_stopping = true;
+    m_signal.release(uint32(m_threadsCount));
+
+    ACE_Task_Base::wait();
+    m_threadsCount = 0;
+
+    return 0;
+}
+
+void MapRegionUpdater::RunBatch(MapRegionBatch& batch)
+{
+    uint64 ownDeadline = UpdateData::GetCompressionDeadline();
+    UpdateData::SetCompressionDeadline(batch.compressionDeadline);
+
+    for (;;)
+    {
+        long index = batch.nextRegion++;
+        if (index >= long(batch.regionsCount))
+            break;
+
+        batch.map->UpdateRegion(uint32(index), batch.diff);
+        batch.Finish(1);
+    }
+
+    UpdateData::SetCompressionDeadline(ownDeadline);
+}
+
+void MapRegionUpdater::Execute(MapRegionBatch& batch)
+{
+    size_t helpers = activated() ? std::min(m_threadsCount, size_t(batch.regionsCount - 1)) : 0;
+
+    batch.nextRegion = 0;
+    batch.finished = 0;
+    batch.finishTarget = long(batch.regionsCount + helpers);
+
+    if (helpers)
+    {
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+            for (size_t i = 0; i < helpers; ++i)
+                m_queue.push_back(&batch);
+        }
+        m_signal.release(uint32(helpers));
+    }
+
+    RunBatch(batch);
+
+    // helpers not started yet are not needed anymore
+    if (helpers)
+    {
+        long removed = 0;
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+            for (std::deque<MapRegionBatch*>::iterator itr = m_queue.begin(); itr != m_queue.end();)
+            {
+                if (*itr == &batch)
+                {
+                    itr = m_queue.erase(itr);
+                    ++removed;
+                }
+                else
+                    ++itr;
+            }
+        }
+
+        if (removed)
+            batch.Finish(removed);
+    }
+
+    batch.done.acquire();
+}
+
+int MapRegionUpdater::svc()
+{
+    for (;;)
+    {
+        MapRegionBatch* batch = NULL;
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+            if (!m_queue.empty())
+            {
+                batch = m_queue.front();
+                m_queue.pop_front();
+            }
+        }
+
+        if (batch)
+        {
+            RunBatch(*batch);
+            batch->Finish(1);                               // batch can't be used after this
+            continue;
+        }
+
+        if (m_stopping)
+            break;
+
+        m_signal.acquire();
+    }
+
+    return 0;
+}
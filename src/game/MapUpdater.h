@@ -19,12 +19,16 @@
 #ifndef _MAP_UPDATER_H_INCLUDED
 #define _MAP_UPDATER_H_INCLUDED
 
+#include <ace/Task.h>
 #include <ace/Thread_Mutex.h>
-#include <ace/Condition_Thread_Mutex.h>
+#include <ace/Thread_Semaphore.h>
+#include <ace/Atomic_Op.h>
 
-#include "DelayExecutor.h"
 #include "Common.h"
 
+#include <deque>
+#include <vector>
+
 class Map;
 struct MapID;
 
@@ -46,21 +50,64 @@ struct MapBrokenData
     time_t lastErrorTime;
 };
 
+// Per-map update timings, all values in microseconds.
+// Written only by the thread that currently updates the map.
+struct MapUpdateStatistics
+{
+    MapUpdateStatistics() : avgCost(0), lastCost(0), maxCost(0), avgQueueWait(0), lastQueueWait(0), updates(0), lastRegions(0) {}
+
+    void AddSample(uint32 cost, uint32 queueWait);
+
+    uint32 avgCost;                                         // moving average of Map::Update time
+    uint32 lastCost;
+    uint32 maxCost;
+    uint32 avgQueueWait;                                    // moving average of time between dispatch and update start
+    uint32 lastQueueWait;
+    uint32 updates;
+    uint32 lastRegions;                                     // cell regions updated in parallel at last update, 0 if serial
+};
+
+struct MapUpdateTask
+{
+    MapUpdateTask() : map(NULL), diff(0), cost(0), queuedTime(0) {}
+    MapUpdateTask(Map* _map, uint32 _diff, uint32 _cost) : map(_map), diff(_diff), cost(_cost), queuedTime(0) {}
+
+    Map* map;
+    uint32 diff;
+    uint32 cost;                                            // estimated update cost, used for ordering
+    uint64 queuedTime;
+};
+
+typedef std::vector<MapUpdateTask> MapUpdateTaskList;
+
+// Task queue owned by one worker thread. Owner pops from front (most expensive first),
+// idle workers steal from back (cheapest first).
+struct MapUpdateWorkerQueue
+{
+    MapUpdateWorkerQueue() : pendingCost(0) {}
+
+    ACE_Thread_Mutex lock;
+    std::deque<MapUpdateTask> tasks;
+    uint64 pendingCost;
+};
+
+typedef std::vector<MapUpdateWorkerQueue*> MapUpdateWorkerQueues;
+
 typedef std::map<ACE_thread_t const, MapID> ThreadMapMap;
 typedef std::map<ACE_thread_t const, uint32/*MSTime*/>  ThreadStartTimeMap;
 typedef std::map<MapID,MapBrokenData> MapBrokenDataMap;
 
-class MapUpdater
+class MapUpdater : protected ACE_Task_Base
 {
     public:
 
         MapUpdater();
         virtual ~MapUpdater();
 
-        friend class MapUpdateRequest;
-
+        // only collects the map for current tick, real dispatch happens in wait()
         int schedule_update(Map& map, ACE_UINT32 diff);
 
+        // dispatch all scheduled maps (most expensive first) and block until all are updated
         int wait();
 
         int activate(size_t num_threads);
@@ -71,6 +118,11 @@ class MapUpdater
 
         void update_finished();
 
+        virtual int svc();
+
+        // update map in caller thread and collect its statistics
+        static void UpdateMap(Map& map, uint32 diff, uint64 queuedTime);
+
         void register_thread(ACE_thread_t const threadId, uint32 mapId, uint32 instanceId);
         void unregister_thread(ACE_thread_t const threadId);
 
@@ -84,17 +136,85 @@ class MapUpdater
         void MapBrokenEvent(MapID const* mapPair);
         MapBrokenData const* GetMapBrokenData(MapID const* mapPair);
 
+        uint32 GetStolenTasksCount() const { return m_stolenTasks.value(); }
+
     private:
 
-        ACE_Thread_Mutex m_mutex;
-        ACE_Condition_Thread_Mutex m_condition;
-        DelayExecutor m_executor;
-        size_t pending_requests;
+        void dispatch();
+        bool request_finished();                            // return true if some requests still pending
+        bool PopTask(uint32 workerIndex, MapUpdateTask& task);
+        bool StealTask(uint32 workerIndex, MapUpdateTask& task);
+
+        MapUpdateTaskList m_batch;                          // accessed only from world thread
+        MapUpdateWorkerQueues m_queues;
 
+        ACE_Thread_Semaphore m_workSignal;
+        ACE_Thread_Semaphore m_doneSignal;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_pendingRequests;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_nextWorkerIndex;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_stolenTasks;
+        size_t m_threadsCount;
+        volatile bool m_activated;
+        volatile bool m_stopping;
+
+        ACE_Thread_Mutex m_threadsLock;
         ThreadMapMap m_threads;
         ThreadStartTimeMap m_starttime;
         MapBrokenDataMap   m_brokendata;
         bool m_broken;
 };
 
+// Independent regions of one map update, filled by map thread before MapRegionUpdater::Execute.
+// Regions are claimed one by one by map thread and helper threads.
+struct MapRegionBatch
+{
+    MapRegionBatch() : map(NULL), diff(0), compressionDeadline(0), regionsCount(0), nextRegion(0), finished(0), finishTarget(0), done(0) {}
+
+    void Finish(long count)
+    {
+        if ((finished += count) == finishTarget)
+            done.release();
+    }
+
+    Map* map;
+    uint32 diff;
+    uint64 compressionDeadline;                             // of map thread, used by helper threads too
+    uint32 regionsCount;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> nextRegion;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> finished;         // updated regions + helpers that left the batch
+    long finishTarget;
+    ACE_Thread_Semaphore done;
+};
+
+// Helper threads for parallel cell update of single map (MapUpdate.ParallelCells)
+class MapRegionUpdater : protected ACE_Task_Base
+{
+    public:
+
+        MapRegionUpdater();
+        virtual ~MapRegionUpdater();
+
+        int activate(size_t num_threads);
+
+        int deactivate();
+
+        bool activated() const { return m_activated; }
+
+        // update all regions of batch, caller thread takes part, return when all regions updated
+        void Execute(MapRegionBatch& batch);
+
+        virtual int svc();
+
+    private:
+
+        static void RunBatch(MapRegionBatch& batch);
+
+        ACE_Thread_Mutex m_lock;
+        std::deque<MapRegionBatch*> m_queue;
+        ACE_Thread_Semaphore m_signal;
+        size_t m_threadsCount;
+        volatile bool m_activated;
+        volatile bool m_stopping;
+};
+
 #endif //_MAP_UPDATER_H_INCLUDED
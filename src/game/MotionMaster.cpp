@@ -259,6 +259,12 @@ void MotionMaster::propagateSpeedChange()
     GetUnitStateMgr()->CurrentAction()->UnitSpeedChanged();
 }
 
+void MotionMaster::PathCalculated(PathRequest* request)
+{
+    // only active generator can launch the path, interrupted one requests new path at reset
+    CurrentMovementGenerator()->OnPathCalculated(*m_owner, request);
+}
+
 uint32 MotionMaster::getLastReachedWaypoint() const
 {
     if (ActionInfo* action = const_cast<MotionMaster*>(this)->GetUnitStateMgr()->GetAction(UNIT_ACTION_DOWAYPOINTS))
@@ -26,6 +26,7 @@
 
 class MovementGenerator;
 class Unit;
+class PathRequest;
 
 // Creature Entry ID used for waypoints show, visible only for GMs
 #define VISUAL_WAYPOINT 1
@@ -65,6 +66,7 @@ class MANGOS_DLL_SPEC MotionMaster
         MovementGeneratorType GetCurrentMovementGeneratorType() const;
 
         void propagateSpeedChange();
+        void PathCalculated(PathRequest* request);
         uint32 getLastReachedWaypoint() const;
 
         class UnitStateMgr* GetUnitStateMgr();
@@ -129,7 +129,7 @@ namespace MMAP
         DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMapData: Loaded %03i.mmap", mapId);
 
         // store inside our map list
-        MMapData* mmap_data = new MMapData(mesh);
+        MMapData* mmap_data = new MMapData(mesh, ++lastGeneration);
         mmap_data->mmapLoadedTiles.clear();
 
         loadedMMaps.insert(std::pair<uint32, MMapData*>(mapId, mmap_data));
@@ -141,24 +141,8 @@ namespace MMAP
         return uint32(x << 16 | y);
     }
 
-    bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y)
+    unsigned char* MMapManager::readTileData(uint32 mapId, int32 x, int32 y, uint32& size)
     {
-        // make sure the mmap is loaded and ready to load tiles
-        if(!loadMapData(mapId))
-            return false;
-
-        // get this mmap data
-        MMapData* mmap = loadedMMaps[mapId];
-        MANGOS_ASSERT(mmap->navMesh);
-
-        // check if we already have this tile loaded
-        uint32 packedGridPos = packTileID(x, y);
-        if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
-        {
-            sLog.outError("MMAP:loadMap: Asked to load already loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
-            return false;
-        }
-
         // load this tile :: mmaps/MMMXXYY.mmtile
         uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i%02i%02i.mmtile")+1;
         char* fileName = new char[pathLen];
@@ -169,7 +153,7 @@ namespace MMAP
         {
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "ERROR: MMAP:loadMap: Could not open mmtile file '%s'", fileName);
             delete[] fileName;
-            return false;
+            return NULL;
         }
         delete [] fileName;
 
@@ -181,7 +165,7 @@ namespace MMAP
         {
             sLog.outError("MMAP:loadMap: Bad header in mmap %03u%02i%02i.mmtile", mapId, x, y);
             fclose(file);
-            return false;
+            return NULL;
         }
 
         if (fileHeader.mmapVersion != MMAP_VERSION)
@@ -189,7 +173,7 @@ namespace MMAP
             sLog.outError("MMAP:loadMap: %03u%02i%02i.mmtile was built with generator v%i, expected v%i",
                           mapId, x, y, fileHeader.mmapVersion, MMAP_VERSION);
             fclose(file);
-            return false;
+            return NULL;
         }
 
         unsigned char* data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
@@ -201,16 +185,53 @@ namespace MMAP
         if(!result)
         {
             sLog.outError("MMAP:loadMap: Bad header or data in mmap %03u%02i%02i.mmtile", mapId, x, y);
+            dtFree(data);
+            return NULL;
+        }
+
+        size = fileHeader.size;
+        return data;
+    }
+
+    bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y, unsigned char* tileData, uint32 tileSize)
+    {
+        // make sure the mmap is loaded and ready to load tiles
+        if(!loadMapData(mapId))
+        {
+            dtFree(tileData);
+            return false;
+        }
+
+        // get this mmap data
+        MMapData* mmap = loadedMMaps[mapId];
+        MANGOS_ASSERT(mmap->navMesh);
+
+        // check if we already have this tile loaded
+        uint32 packedGridPos = packTileID(x, y);
+        if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
+        {
+            sLog.outError("MMAP:loadMap: Asked to load already loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
+            dtFree(tileData);
             return false;
         }
 
+        unsigned char* data = tileData;
+        uint32 dataSize = tileSize;
+        if (!data)
+        {
+            data = readTileData(mapId, x, y, dataSize);
+            if (!data)
+                return false;
+        }
+
         dtMeshHeader* header = (dtMeshHeader*)data;
         dtTileRef tileRef = 0;
 
         dtStatus stat;
         {
-            ReadGuard Guard(GetLock(mapId));
-            stat = mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef);
+            // pathfinding threads read navmesh under read lock
+            WriteGuard Guard(GetLock(mapId));
+            stat = mmap->navMesh->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, &tileRef);
         }
 
         // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
@@ -344,6 +365,14 @@ namespace MMAP
         return loadedMMaps[mapId]->navMesh;
     }
 
+    uint32 MMapManager::GetNavMeshGeneration(uint32 mapId)
+    {
+        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+            return 0;
+
+        return loadedMMaps[mapId]->generation;
+    }
+
     dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
     {
         if (loadedMMaps.find(mapId) == loadedMMaps.end())
@@ -48,7 +48,7 @@ namespace MMAP
     // dummy struct to hold map's mmap data
     struct MMapData
     {
-        MMapData(dtNavMesh* mesh) : navMesh(mesh) {}
+        MMapData(dtNavMesh* mesh, uint32 _generation) : navMesh(mesh), generation(_generation) {}
         ~MMapData()
         {
             for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
@@ -59,6 +59,7 @@ namespace MMAP
         }
 
         dtNavMesh* navMesh;
+        uint32 generation;                  // unique for every loaded navmesh, a freed navmesh address can be reused
 
         // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
         NavMeshQuerySet navMeshQueries;     // instanceId to query
@@ -73,10 +74,13 @@ namespace MMAP
     class MMapManager
     {
         public:
-            MMapManager() : loadedTiles(0) {}
+            MMapManager() : loadedTiles(0), lastGeneration(0) {}
             ~MMapManager();
 
-            bool loadMap(uint32 mapId, int32 x, int32 y);
+            // tileData - already read tile file (see readTileData), freed by manager in any case
+            bool loadMap(uint32 mapId, int32 x, int32 y, unsigned char* tileData = NULL, uint32 tileSize = 0);
+            // read tile file without adding it to navmesh, can be used from any thread. Data allocated by dtAlloc
+            static unsigned char* readTileData(uint32 mapId, int32 x, int32 y, uint32& size);
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
             bool unloadMapInstance(uint32 mapId, uint32 instanceId);
@@ -84,6 +88,7 @@ namespace MMAP
             // the returned [dtNavMeshQuery const*] is NOT threadsafe
             dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
+            uint32 GetNavMeshGeneration(uint32 mapId);
 
             uint32 getLoadedTilesCount() const { return loadedTiles; }
             uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
@@ -96,6 +101,7 @@ namespace MMAP
 
             MMapDataSet loadedMMaps;
             uint32 loadedTiles;
+            uint32 lastGeneration;
     };
 
     // static class
@@ -31,6 +31,7 @@
 class Unit;
 class Creature;
 class Player;
+class PathRequest;
 
 class MANGOS_DLL_SPEC MovementGenerator : public UnitAction
 {
@@ -53,6 +54,9 @@ class MANGOS_DLL_SPEC MovementGenerator : public UnitAction
 
         virtual void UnitSpeedChanged() { }
 
+        // path calculated by pathfinding thread, generator takes path of request it waits for
+        virtual void OnPathCalculated(Unit&, PathRequest*) { }
+
         // used by Evade code for select point to evade with expected restart default movement
         virtual bool GetResetPosition(Unit&, float& /*x*/, float& /*y*/, float& /*z*/) const { return false; }
 
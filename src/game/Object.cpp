@@ -290,6 +290,116 @@ void Object::BuildValuesUpdateBlockForPlayer(UpdateData *data, Player *target) c
     data->AddUpdateBlock(buf);
 }
 
+void Object::BuildValuesUpdateBlockForPlayer(UpdateData *data, Player *target, ValuesUpdateCache& cache) const
+{
+    if (!target)
+        return;
+
+    UpdateFieldData ufd(this, target);
+
+    ValuesUpdateCache::Block* block = cache.Find(ufd.GetVisibilityClass());
+    if (!block)
+    {
+        block = cache.Add(ufd.GetVisibilityClass());
+
+        ByteBuffer& buf = block->data;
+        buf << uint8(UPDATETYPE_VALUES);
+        buf << GetPackGUID();
+
+        UpdateMask updateMask;
+        updateMask.SetCount(m_valuesCount);
+
+        _SetUpdateBits(&updateMask, ufd);
+        SetValuesUpdateSpecialBits(UPDATETYPE_VALUES, &updateMask);
+
+        buf << (uint8)updateMask.GetBlockCount();
+        buf.append(updateMask.GetMask(), updateMask.GetLength());
+
+        // values of per target fields written at place for each target
+        for (uint32 i = 0; i < updateMask.GetBlockCount(); ++i)
+        {
+            for (uint32 bits = updateMask.GetBlock(i); bits; bits &= bits - 1)
+            {
+                uint16 index = uint16(i * 32 + UpdateMask::CountTrailingZeros(bits));
+                if (IsPerTargetUpdateField(index))
+                {
+                    block->perTargetFields.push_back(std::make_pair(buf.wpos(), index));
+                    buf << uint32(0);
+                }
+                else
+                    buf << GetUpdateFieldValue(index);
+            }
+        }
+    }
+
+    if (block->perTargetFields.empty())
+    {
+        data->AddUpdateBlock(block->data);
+        return;
+    }
+
+    ByteBuffer buf(block->data);
+    for (std::vector<std::pair<size_t, uint16> >::const_iterator itr = block->perTargetFields.begin(); itr != block->perTargetFields.end(); ++itr)
+        buf.put<uint32>(itr->first, GetUpdateFieldValueForPlayer(itr->second, target));
+
+    data->AddUpdateBlock(buf);
+}
+
+void Object::BenchmarkValuesUpdate(std::vector<Player*> const& observers, uint32 step, uint32 count,
+    uint64& perTargetTime, uint64& sharedTime, uint32& fields, uint32& classes, uint32& mismatches)
+{
+    perTargetTime = sharedTime = 0;
+    fields = classes = mismatches = 0;
+
+    if (!m_uint32Values || !step || observers.empty() || !count)
+        return;
+
+    std::set<uint32> visibilityClasses;
+    for (std::vector<Player*>::const_iterator itr = observers.begin(); itr != observers.end(); ++itr)
+        visibilityClasses.insert(UpdateFieldData(this, *itr).GetVisibilityClass());
+    classes = visibilityClasses.size();
+
+    // fields only marked as changed while benchmark, object not added to update queue
+    std::vector<bool> changedValues = m_changedValues;
+    for (uint16 index = 0; index < m_valuesCount; index += step)
+    {
+        m_changedValues[index] = true;
+        ++fields;
+    }
+
+    for (uint32 c = 0; c < count; ++c)
+    {
+        std::vector<UpdateData> perTargetData(observers.size());
+        uint64 startTime = WorldTimer::getMicroTime();
+        for (size_t i = 0; i < observers.size(); ++i)
+            BuildValuesUpdateBlockForPlayer(&perTargetData[i], observers[i]);
+        perTargetTime += WorldTimer::getMicroTime() - startTime;
+
+        std::vector<UpdateData> sharedData(observers.size());
+        startTime = WorldTimer::getMicroTime();
+        ValuesUpdateCache cache;
+        for (size_t i = 0; i < observers.size(); ++i)
+            BuildValuesUpdateBlockForPlayer(&sharedData[i], observers[i], cache);
+        sharedTime += WorldTimer::getMicroTime() - startTime;
+
+        if (c)
+            continue;
+
+        for (size_t i = 0; i < observers.size(); ++i)
+        {
+            WorldPacket perTargetPacket;
+            WorldPacket sharedPacket;
+            perTargetData[i].BuildPacket(&perTargetPacket);
+            sharedData[i].BuildPacket(&sharedPacket);
+            if (perTargetPacket.size() != sharedPacket.size() ||
+                memcmp(perTargetPacket.contents(), sharedPacket.contents(), perTargetPacket.size()) != 0)
+                ++mismatches;
+        }
+    }
+
+    m_changedValues = changedValues;
+}
+
 void Object::BuildOutOfRangeUpdateBlock(UpdateData * data) const
 {
     data->AddOutOfRangeGUID(GetObjectGuid());
@@ -485,247 +595,235 @@ void Object::BuildMovementUpdate(ByteBuffer * data, uint16 updateFlags) const
     }
 }
 
-void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer * data, UpdateMask *updateMask, Player *target) const
+void Object::SetValuesUpdateSpecialBits(uint8 updatetype, UpdateMask* updateMask) const
 {
-    if (!target)
-        return;
-
-    bool IsActivateToQuest = false;
-    bool IsPerCasterAuraState = false;
+    if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsDynTransport())
+    {
+        if (updatetype == UPDATETYPE_VALUES)
+            updateMask->SetBit(GAMEOBJECT_BYTES_1);         // why do we need this here?
+    }
+    else if (isType(TYPEMASK_UNIT))
+    {
+        if (((Unit*)this)->HasAuraState(AURA_STATE_CONFLAGRATE))
+            updateMask->SetBit(UNIT_FIELD_AURASTATE);
+    }
+}
 
-    if (updatetype == UPDATETYPE_CREATE_OBJECT || updatetype == UPDATETYPE_CREATE_OBJECT2)
+bool Object::IsPerTargetUpdateField(uint16 index) const
+{
+    if (isType(TYPEMASK_UNIT))
     {
-        if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsDynTransport())
-        {
-            if (((GameObject*)this)->ActivateToQuest(target) || target->isGameMaster())
-                IsActivateToQuest = true;
-        }
-        else if (isType(TYPEMASK_UNIT))
+        switch (index)
         {
-            if (((Unit*)this)->HasAuraState(AURA_STATE_CONFLAGRATE))
-            {
-                IsPerCasterAuraState = true;
-                updateMask->SetBit(UNIT_FIELD_AURASTATE);
-            }
+            case UNIT_NPC_FLAGS:
+                return GetTypeId() == TYPEID_UNIT;
+            case UNIT_FIELD_AURASTATE:
+                return ((Unit*)this)->HasAuraState(AURA_STATE_CONFLAGRATE);
+            case UNIT_FIELD_FLAGS:
+            case UNIT_DYNAMIC_FLAGS:
+            case UNIT_FIELD_BYTES_2:
+            case UNIT_FIELD_FACTIONTEMPLATE:
+                return true;
+            default:
+                return false;
         }
     }
-    else                                                    // case UPDATETYPE_VALUES
+    else if (isType(TYPEMASK_GAMEOBJECT))
+        return index == GAMEOBJECT_DYNAMIC;
+
+    return false;
+}
+
+uint32 Object::GetUpdateFieldValue(uint16 index) const
+{
+    if (isType(TYPEMASK_UNIT))
     {
-        if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsDynTransport())
+        // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
+        if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
         {
-            if (((GameObject*)this)->ActivateToQuest(target) || target->isGameMaster())
-                IsActivateToQuest = true;
-            updateMask->SetBit(GAMEOBJECT_BYTES_1);         // why do we need this here?
+            // convert from float to uint32 and send
+            return uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
         }
-        else if (isType(TYPEMASK_UNIT))
+
+        // there are some float values which may be negative or can't get negative due to other checks
+        if ((index >= UNIT_FIELD_NEGSTAT0 && index <= UNIT_FIELD_NEGSTAT4) ||
+            (index >= UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
+            (index >= UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
+            (index >= UNIT_FIELD_POSSTAT0 && index <= UNIT_FIELD_POSSTAT4))
         {
-            if (((Unit*)this)->HasAuraState(AURA_STATE_CONFLAGRATE))
-            {
-                IsPerCasterAuraState = true;
-                updateMask->SetBit(UNIT_FIELD_AURASTATE);
-            }
+            return uint32(m_floatValues[index]);
         }
     }
 
-    MANGOS_ASSERT(updateMask && updateMask->GetCount() == m_valuesCount);
-
-    *data << (uint8)updateMask->GetBlockCount();
-    data->append(updateMask->GetMask(), updateMask->GetLength());
+    // send in current format (float as float, uint32 as uint32)
+    return m_uint32Values[index];
+}
 
-    // 2 specialized loops for speed optimization in non-unit case
-    if (isType(TYPEMASK_UNIT))                              // unit (creature/player) case
+uint32 Object::GetUpdateFieldValueForPlayer(uint16 index, Player* target) const
+{
+    if (isType(TYPEMASK_UNIT))
     {
-        for(uint16 index = 0; index < m_valuesCount; ++index)
+        switch (index)
         {
-            if (updateMask->GetBit(index))
+            case UNIT_NPC_FLAGS:
             {
-                if (index == UNIT_NPC_FLAGS)
+                uint32 appendValue = m_uint32Values[index];
+
+                if (GetTypeId() == TYPEID_UNIT)
                 {
-                    uint32 appendValue = m_uint32Values[index];
+                    if (!target->canSeeSpellClickOn((Creature*)this))
+                        appendValue &= ~UNIT_NPC_FLAG_SPELLCLICK;
 
-                    if (GetTypeId() == TYPEID_UNIT)
+                    if (appendValue & UNIT_NPC_FLAG_TRAINER)
                     {
-                        if (!target->canSeeSpellClickOn((Creature*)this))
-                            appendValue &= ~UNIT_NPC_FLAG_SPELLCLICK;
-
-                        if (appendValue & UNIT_NPC_FLAG_TRAINER)
-                        {
-                            if (!((Creature*)this)->IsTrainerOf(target, false))
-                                appendValue &= ~(UNIT_NPC_FLAG_TRAINER | UNIT_NPC_FLAG_TRAINER_CLASS | UNIT_NPC_FLAG_TRAINER_PROFESSION);
-                        }
-
-                        if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
-                        {
-                            if (target->getClass() != CLASS_HUNTER)
-                                appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
-                        }
+                        if (!((Creature*)this)->IsTrainerOf(target, false))
+                            appendValue &= ~(UNIT_NPC_FLAG_TRAINER | UNIT_NPC_FLAG_TRAINER_CLASS | UNIT_NPC_FLAG_TRAINER_PROFESSION);
                     }
 
-                    *data << uint32(appendValue);
-                }
-                else if (index == UNIT_FIELD_AURASTATE)
-                {
-                    if (IsPerCasterAuraState)
+                    if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
                     {
-                        // IsPerCasterAuraState set if related pet caster aura state set already
-                        if (((Unit*)this)->HasAuraStateForCaster(AURA_STATE_CONFLAGRATE, target->GetObjectGuid()))
-                            *data << m_uint32Values[index];
-                        else
-                            *data << (m_uint32Values[index] & ~(1 << (AURA_STATE_CONFLAGRATE-1)));
+                        if (target->getClass() != CLASS_HUNTER)
+                            appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
                     }
-                    else
-                        *data << m_uint32Values[index];
-                }
-                // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
-                else if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
-                {
-                    // convert from float to uint32 and send
-                    *data << uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
                 }
 
-                // there are some float values which may be negative or can't get negative due to other checks
-                else if ((index >= UNIT_FIELD_NEGSTAT0 && index <= UNIT_FIELD_NEGSTAT4) ||
-                    (index >= UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
-                    (index >= UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
-                    (index >= UNIT_FIELD_POSSTAT0 && index <= UNIT_FIELD_POSSTAT4))
-                {
-                    *data << uint32(m_floatValues[index]);
-                }
+                return appendValue;
+            }
+            case UNIT_FIELD_AURASTATE:
+            {
+                // per caster aura state only if related pet caster aura state set already
+                if (((Unit*)this)->HasAuraState(AURA_STATE_CONFLAGRATE) &&
+                    !((Unit*)this)->HasAuraStateForCaster(AURA_STATE_CONFLAGRATE, target->GetObjectGuid()))
+                    return m_uint32Values[index] & ~(1 << (AURA_STATE_CONFLAGRATE-1));
 
+                return m_uint32Values[index];
+            }
+            case UNIT_FIELD_FLAGS:
+            {
                 // Gamemasters should be always able to select units - remove not selectable flag
-                else if (index == UNIT_FIELD_FLAGS && target->isGameMaster())
-                {
-                    *data << (m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE);
-                }
+                if (target->isGameMaster())
+                    return m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE;
+
+                return m_uint32Values[index];
+            }
+            case UNIT_DYNAMIC_FLAGS:
+            {
                 // hide lootable animation for unallowed players
-                else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_UNIT)
+                if (GetTypeId() == TYPEID_UNIT)
                 {
                     if (!target->isAllowedToLoot((Creature*)this))
-                        *data << (m_uint32Values[index] & ~(UNIT_DYNFLAG_LOOTABLE | UNIT_DYNFLAG_TAPPED_BY_PLAYER));
-                    else
-                    {
-                        // flag only for original loot recipent
-                        if (target->GetObjectGuid() == ((Creature*)this)->GetLootRecipientGuid())
-                            *data << m_uint32Values[index];
-                        else
-                            *data << (m_uint32Values[index] & ~(UNIT_DYNFLAG_TAPPED | UNIT_DYNFLAG_TAPPED_BY_PLAYER));
-                    }
+                        return m_uint32Values[index] & ~(UNIT_DYNFLAG_LOOTABLE | UNIT_DYNFLAG_TAPPED_BY_PLAYER);
+
+                    // flag only for original loot recipent
+                    if (target->GetObjectGuid() == ((Creature*)this)->GetLootRecipientGuid())
+                        return m_uint32Values[index];
+
+                    return m_uint32Values[index] & ~(UNIT_DYNFLAG_TAPPED | UNIT_DYNFLAG_TAPPED_BY_PLAYER);
                 }
+
                 // hide RAF flag if need
-                else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_PLAYER)
+                if (!((Player*)this)->IsReferAFriendLinked(target))
+                    return m_uint32Values[index] & ~UNIT_DYNFLAG_REFER_A_FRIEND;
+
+                return m_uint32Values[index];
+            }
+            // Frozen Mod
+            case UNIT_FIELD_BYTES_2:
+            case UNIT_FIELD_FACTIONTEMPLATE:
+            {
+                if (target == this)
+                    return m_uint32Values[index];
+
+                bool forcefriendly = false; // bool for pets/totems to offload more code from the big if below
+
+                if (GetTypeId() == TYPEID_UNIT && ((Creature*)this)->GetOwner())
                 {
-                    if (!((Player*)this)->IsReferAFriendLinked(target))
-                        *data << (m_uint32Values[index] & ~UNIT_DYNFLAG_REFER_A_FRIEND);
-                    else
-                        *data << m_uint32Values[index];
+                    forcefriendly = (((Creature*)this)->IsTotem() || ((Creature*)this)->IsPet())
+                    && (((Creature*)this)->GetOwner()->GetTypeId() == TYPEID_PLAYER
+                        && ((Creature*)this)->GetOwner()->IsFriendlyTo(target)
+                        && ((Creature*)this)->GetOwner() != target
+                        && (target->IsInSameGroupWith((Player*)((Creature*)this)->GetOwner()) || target->IsInSameRaidWith((Player*)((Creature*)this)->GetOwner())));
                 }
-                // Frozen Mod
-                else if (index == UNIT_FIELD_BYTES_2 || index == UNIT_FIELD_FACTIONTEMPLATE)
-                {
-                    bool ch = false;
 
-                    if((GetTypeId() == TYPEID_PLAYER || GetTypeId() == TYPEID_UNIT) && target != this)
+                if(((Unit*)this)->IsSpoofSamePlayerFaction() || forcefriendly || (target->GetTypeId() == TYPEID_PLAYER && GetTypeId() == TYPEID_PLAYER && (target->IsInSameGroupWith((Player*)this) || target->IsInSameRaidWith((Player*)this))))
+                {
+                    if (index == UNIT_FIELD_BYTES_2)
                     {
-                        bool forcefriendly = false; // bool for pets/totems to offload more code from the big if below
-
-                        if (GetTypeId() == TYPEID_UNIT && ((Creature*)this)->GetOwner())
-                        {
-                            forcefriendly = (((Creature*)this)->IsTotem() || ((Creature*)this)->IsPet())
-                            && (((Creature*)this)->GetOwner()->GetTypeId() == TYPEID_PLAYER
-                                && ((Creature*)this)->GetOwner()->IsFriendlyTo(target)
-                                && ((Creature*)this)->GetOwner() != target
-                                && (target->IsInSameGroupWith((Player*)((Creature*)this)->GetOwner()) || target->IsInSameRaidWith((Player*)((Creature*)this)->GetOwner())));
-                        }
+                        DEBUG_LOG("-- VALUES_UPDATE: Sending '%s' the blue-group-fix from '%s' (flag)", target->GetName(), ((Unit*)this)->GetName());
+                        return m_uint32Values[index] & (UNIT_BYTE2_FLAG_SANCTUARY << 8); // this flag is at uint8 offset 1 !!
+                    }
+                    else
+                    {
+                        FactionTemplateEntry const *ft1, *ft2;
+                        ft1 = ((Unit*)this)->getFactionTemplateEntry();
+                        ft2 = ((Unit*)target)->getFactionTemplateEntry();
 
-                        if(((Unit*)this)->IsSpoofSamePlayerFaction() || forcefriendly || (target->GetTypeId() == TYPEID_PLAYER && GetTypeId() == TYPEID_PLAYER && (target->IsInSameGroupWith((Player*)this) || target->IsInSameRaidWith((Player*)this))))
+                        if (ft1 && ft2 && (!ft1->IsFriendlyTo(*ft2) || ((Unit*)this)->IsSpoofSamePlayerFaction()))
                         {
-                            if (index == UNIT_FIELD_BYTES_2)
-                            {
-                                DEBUG_LOG("-- VALUES_UPDATE: Sending '%s' the blue-group-fix from '%s' (flag)", target->GetName(), ((Unit*)this)->GetName());
-                                *data << ( m_uint32Values[ index ] & (UNIT_BYTE2_FLAG_SANCTUARY << 8) ); // this flag is at uint8 offset 1 !!
-                                ch = true;
-                            }
-                            else if (index == UNIT_FIELD_FACTIONTEMPLATE)
-                            {
-                                FactionTemplateEntry const *ft1, *ft2;
-                                ft1 = ((Unit*)this)->getFactionTemplateEntry();
-                                ft2 = ((Unit*)target)->getFactionTemplateEntry();
-
-                                if (ft1 && ft2 && (!ft1->IsFriendlyTo(*ft2) || ((Unit*)this)->IsSpoofSamePlayerFaction()))
-                                {
-                                    uint32 faction = ((Player*)target)->getFaction(); // pretend that all other HOSTILE players have own faction, to allow follow, heal, rezz (trade wont work)
-                                    DEBUG_LOG("-- VALUES_UPDATE: Sending '%s' the blue-group-fix from '%s' (faction %u)", target->GetName(), ((Unit*)this)->GetName(), faction);
-                                    *data << uint32(faction);
-                                    ch = true;
-                                }
-                            }
+                            uint32 faction = ((Player*)target)->getFaction(); // pretend that all other HOSTILE players have own faction, to allow follow, heal, rezz (trade wont work)
+                            DEBUG_LOG("-- VALUES_UPDATE: Sending '%s' the blue-group-fix from '%s' (faction %u)", target->GetName(), ((Unit*)this)->GetName(), faction);
+                            return faction;
                         }
                     }
-
-                    if(!ch)
-                        *data << m_uint32Values[ index ];
-                }
-                // Frozen Mod
-                else
-                {
-                    // send in current format (float as float, uint32 as uint32)
-                    *data << m_uint32Values[index];
                 }
+
+                return m_uint32Values[index];
             }
+            // Frozen Mod
+            default:
+                break;
         }
     }
-    else if (isType(TYPEMASK_GAMEOBJECT))                   // gameobject case
+    else if (isType(TYPEMASK_GAMEOBJECT) && index == GAMEOBJECT_DYNAMIC)
     {
-        for(uint16 index = 0; index < m_valuesCount; ++index)
-        {
-            if (updateMask->GetBit(index))
-            {
-                // send in current format (float as float, uint32 as uint32)
-                if (index == GAMEOBJECT_DYNAMIC)
-                {
-                    // GAMEOBJECT_TYPE_DUNGEON_DIFFICULTY can have lo flag = 2
-                    //      most likely related to "can enter map" and then should be 0 if can not enter
+        bool IsActivateToQuest = !((GameObject*)this)->IsDynTransport() &&
+            (((GameObject*)this)->ActivateToQuest(target) || target->isGameMaster());
 
-                    switch(((GameObject*)this)->GetGoType())
-                    {
-                        case GAMEOBJECT_TYPE_QUESTGIVER:
-                            // GO also seen with GO_DYNFLAG_LO_SPARKLE explicit, relation/reason unclear (192861)
-                            *data << uint16(IsActivateToQuest ? GO_DYNFLAG_LO_ACTIVATE : GO_DYNFLAG_LO_NONE);
-                            *data << uint16(-1);
-                            break;
-                        case GAMEOBJECT_TYPE_CHEST:
-                        case GAMEOBJECT_TYPE_GENERIC:
-                        case GAMEOBJECT_TYPE_SPELL_FOCUS:
-                        case GAMEOBJECT_TYPE_GOOBER:
-                            *data << uint16(IsActivateToQuest ? (GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE) : GO_DYNFLAG_LO_NONE);
-                            *data << uint16(-1);
-                            break;
-                        case GAMEOBJECT_TYPE_TRANSPORT:
-                        case GAMEOBJECT_TYPE_MO_TRANSPORT:
-                            *data << uint16(((GameObject*)this)->GetGoState() != GO_STATE_ACTIVE ? GO_DYNFLAG_LO_TRANSPORT_STOP : GO_DYNFLAG_LO_NONE);
-                            *data << uint16(-1);
-                            break;
-                        default:
-                            // unknown, not happen.
-                            *data << uint16(GO_DYNFLAG_LO_NONE);
-                            *data << uint16(-1);
-                            break;
-                    }
-                }
-                else
-                    *data << m_uint32Values[index];         // other cases
-            }
+        // GAMEOBJECT_TYPE_DUNGEON_DIFFICULTY can have lo flag = 2
+        //      most likely related to "can enter map" and then should be 0 if can not enter
+        // hi part is always uint16(-1)
+        switch(((GameObject*)this)->GetGoType())
+        {
+            case GAMEOBJECT_TYPE_QUESTGIVER:
+                // GO also seen with GO_DYNFLAG_LO_SPARKLE explicit, relation/reason unclear (192861)
+                return uint32(IsActivateToQuest ? GO_DYNFLAG_LO_ACTIVATE : GO_DYNFLAG_LO_NONE) | 0xFFFF0000;
+            case GAMEOBJECT_TYPE_CHEST:
+            case GAMEOBJECT_TYPE_GENERIC:
+            case GAMEOBJECT_TYPE_SPELL_FOCUS:
+            case GAMEOBJECT_TYPE_GOOBER:
+                return uint32(IsActivateToQuest ? (GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE) : GO_DYNFLAG_LO_NONE) | 0xFFFF0000;
+            case GAMEOBJECT_TYPE_TRANSPORT:
+            case GAMEOBJECT_TYPE_MO_TRANSPORT:
+                return uint32(((GameObject*)this)->GetGoState() != GO_STATE_ACTIVE ? GO_DYNFLAG_LO_TRANSPORT_STOP : GO_DYNFLAG_LO_NONE) | 0xFFFF0000;
+            default:
+                // unknown, not happen.
+                return uint32(GO_DYNFLAG_LO_NONE) | 0xFFFF0000;
         }
     }
-    else                                                    // other objects case (no special index checks)
+
+    return GetUpdateFieldValue(index);
+}
+
+void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer * data, UpdateMask *updateMask, Player *target) const
+{
+    if (!target)
+        return;
+
+    SetValuesUpdateSpecialBits(updatetype, updateMask);
+
+    MANGOS_ASSERT(updateMask && updateMask->GetCount() == m_valuesCount);
+
+    *data << (uint8)updateMask->GetBlockCount();
+    data->append(updateMask->GetMask(), updateMask->GetLength());
+
+    // set bits taken by 32 fields blocks, specialized case for speed optimization of objects without special fields
+    bool hasSpecialFields = isType(TYPEMASK_UNIT) || isType(TYPEMASK_GAMEOBJECT);
+    for (uint32 block = 0; block < updateMask->GetBlockCount(); ++block)
     {
-        for(uint16 index = 0; index < m_valuesCount; ++index)
+        for (uint32 bits = updateMask->GetBlock(block); bits; bits &= bits - 1)
         {
-            if (updateMask->GetBit(index))
-            {
-                // send in current format (float as float, uint32 as uint32)
-                *data << m_uint32Values[index];
-            }
+            uint16 index = uint16(block * 32 + UpdateMask::CountTrailingZeros(bits));
+            *data << (hasSpecialFields ? GetUpdateFieldValueForPlayer(index, target) : m_uint32Values[index]);
         }
     }
 }
@@ -766,8 +864,11 @@ bool Object::LoadValues(const char* data)
 
 void Object::_SetUpdateBits(UpdateMask* updateMask, Player* target) const
 {
-    UpdateFieldData ufd(this, target);
+    _SetUpdateBits(updateMask, UpdateFieldData(this, target));
+}
 
+void Object::_SetUpdateBits(UpdateMask* updateMask, UpdateFieldData const& ufd) const
+{
     for (uint16 index = 0; index < m_valuesCount; ++index)
     {
         if (ufd.IsUpdateNeeded(index, m_fieldNotifyFlags) ||
@@ -1038,6 +1139,16 @@ void Object::BuildUpdateDataForPlayer(Player* player, UpdateDataMapType& update_
     BuildValuesUpdateBlockForPlayer(&data, player);
 }
 
+void Object::BuildUpdateDataForPlayer(Player* player, UpdateDataMapType& update_players, ValuesUpdateCache& cache)
+{
+    if (!player)
+        return;
+
+    UpdateData& data = update_players[player->GetObjectGuid()];
+
+    BuildValuesUpdateBlockForPlayer(&data, player, cache);
+}
+
 void Object::AddToClientUpdateList()
 {
     sLog.outError("Unexpected call of Object::AddToClientUpdateList for object (TypeId: %u Update fields: %u)",GetTypeId(), m_valuesCount);
@@ -1110,8 +1221,6 @@ void WorldObject::RemoveFromWorld(bool remove)
     if (IsInWorld())
         Object::RemoveFromWorld(remove);
 
-    map->RemoveUpdateObject(GetObjectGuid());
-
     if (remove)
     {
         ResetMap();
@@ -1130,6 +1239,8 @@ void WorldObject::Relocate(Position const& location)
     bool locationChanged    = !bool(location == m_position);
     bool orientationChanged = bool(fabs(location.o - m_position.o) > M_NULL_F);
 
+    float oldX = m_position.x;
+    float oldY = m_position.y;
     m_position = location;
 
     if (isType(TYPEMASK_UNIT))
@@ -1139,6 +1250,10 @@ void WorldObject::Relocate(Position const& location)
         else if (orientationChanged)
             ((Unit*)this)->m_movementInfo.ChangeOrientation(m_position.o);
     }
+
+    // players and active objects keep cells around them active
+    if (locationChanged && IsInWorld() && (GetTypeId() == TYPEID_PLAYER || isActiveObject()))
+        GetMap()->UpdateActiveCellSource(this, oldX, oldY);
 }
 
 void WorldObject::SetOrientation(float orientation)
@@ -2103,38 +2218,82 @@ void WorldObject::AddToClientUpdateList()
 
 void WorldObject::RemoveFromClientUpdateList()
 {
-    GetMap()->RemoveUpdateObject(GetObjectGuid());
+    // map update queue is lock-free list, not updated objects just skipped at Map::SendObjectUpdates
 }
 
-struct WorldObjectChangeAccumulator
+struct WorldObjectPassengerObserversHelper
 {
-    UpdateDataMapType &i_updateDatas;
-    WorldObject &i_object;
-    WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d) : i_updateDatas(d), i_object(obj)
+    WorldObject const& i_object;
+    std::vector<Player*>& i_players;
+    WorldObjectPassengerObserversHelper(WorldObject const& obj, std::vector<Player*>& players) : i_object(obj), i_players(players) {}
+
+    // boarded players have transport at client without it in client guids set, so not listed in observers
+    void operator()(WorldObject* passenger) const
     {
-        // send self fields changes in another way, otherwise
-        // with new camera system when player's camera too far from player, camera wouldn't receive packets and changes from player
-        if (i_object.isType(TYPEMASK_PLAYER))
-            i_object.BuildUpdateDataForPlayer((Player*)&i_object, i_updateDatas);
+        if (passenger->GetTypeId() != TYPEID_PLAYER || passenger == &i_object)
+            return;
+
+        Player* player = (Player*)passenger;
+        if (!player->HasClientGuid(i_object.GetObjectGuid()))
+            i_players.push_back(player);
+    }
+};
+
+void WorldObject::BuildUpdateData( UpdateDataMapType & update_players)
+{
+    // send self fields changes in another way, otherwise
+    // with new camera system when player's camera too far from player, camera wouldn't receive packets and changes from player
+    // observers of same visibility class share values update block
+    ValuesUpdateCache cache;
+
+    if (isType(TYPEMASK_PLAYER))
+        BuildUpdateDataForPlayer((Player*)this, update_players, cache);
+
+    Map* map = GetMap();
+
+    // copy observers, BuildUpdateDataForPlayer must not be called under map objects lock
+    std::vector<ObjectGuid> observers;
+    {
+        MAPLOCK_READ(this, MAP_LOCK_TYPE_MAPOBJECTS);
+        observers.assign(m_observedBy.begin(), m_observedBy.end());
     }
 
-    void Visit(CameraMapType &m)
+    std::vector<ObjectGuid> staleObservers;
+    for (std::vector<ObjectGuid>::const_iterator itr = observers.begin(); itr != observers.end(); ++itr)
     {
-        for(CameraMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+        // observer can leave map without notify (map change, logout), then just forget it
+        Player* player = map->GetPlayer(*itr);
+        if (!player || !player->HasClientGuid(GetObjectGuid()))
         {
-            Player* owner = iter->getSource()->GetOwner();
-            if (owner && owner != &i_object && owner->HaveAtClient(i_object.GetObjectGuid()))
-                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+            staleObservers.push_back(*itr);
+            continue;
         }
+
+        if (player != this)
+            BuildUpdateDataForPlayer(player, update_players, cache);
     }
 
-    template<class SKIP> void Visit(GridRefManager<SKIP> &) {}
-};
+    if (!staleObservers.empty())
+    {
+        MAPLOCK_WRITE(this, MAP_LOCK_TYPE_MAPOBJECTS);
+        for (std::vector<ObjectGuid>::const_iterator itr = staleObservers.begin(); itr != staleObservers.end(); ++itr)
+        {
+            Player* player = map->GetPlayer(*itr);
+            if (!player || player->GetClientGuids().find(GetObjectGuid()) == player->GetClientGuids().end())
+                m_observedBy.erase(*itr);
+        }
+    }
 
-void WorldObject::BuildUpdateData( UpdateDataMapType & update_players)
-{
-    WorldObjectChangeAccumulator notifier(*this, update_players);
-    Cell::VisitWorldObjects(this, notifier, GetMap()->GetVisibilityDistance(this));
+    if (TransportBase* transportBase = GetTransportBase())
+    {
+        if (transportBase->HasPassengers())
+        {
+            std::vector<Player*> passengers;
+            transportBase->CallForAllPassengers(WorldObjectPassengerObserversHelper(*this, passengers));
+            for (std::vector<Player*>::const_iterator itr = passengers.begin(); itr != passengers.end(); ++itr)
+                BuildUpdateDataForPlayer(*itr, update_players, cache);
+        }
+    }
 
     ClearUpdateMask(false);
 }
@@ -31,6 +31,7 @@
 #include "WorldLocation.h"
 #include "LootMgr.h"
 
+#include <list>
 #include <set>
 #include <string>
 
@@ -113,6 +114,8 @@ struct UpdateFieldData
         UpdateFieldData(Object const* object, Player* target);
         bool IsUpdateNeeded(uint16 fieldIndex, uint32 fieldNotifyFlags) const { return HasFlags(fieldIndex, fieldNotifyFlags) || (HasFlags(fieldIndex, UF_FLAG_SPECIAL_INFO) && m_hasSpecialInfo); }
         bool IsUpdateFieldVisible(uint16 fieldIndex) const;
+        // targets with same class see same fields of object
+        uint32 GetVisibilityClass() const { return uint32(m_isSelf) | (uint32(m_isOwner) << 1) | (uint32(m_isItemOwner) << 2) | (uint32(m_hasSpecialInfo) << 3) | (uint32(m_isPartyMember) << 4); }
     private:
         inline bool HasFlags(uint16 fieldIndex, uint32 flags) const { return m_flags[fieldIndex] & flags; }
 
@@ -124,6 +127,38 @@ struct UpdateFieldData
         bool m_isPartyMember;
 };
 
+// Values update blocks of object built for observers in one update, observers of same visibility class get same block
+// and only per target field values (npc flags, caster aura state, quest activated gameobject flags etc) are patched for each
+class ValuesUpdateCache
+{
+    public:
+        struct Block
+        {
+            explicit Block(uint32 _visibilityClass) : visibilityClass(_visibilityClass) {}
+
+            uint32 visibilityClass;
+            ByteBuffer data;
+            std::vector<std::pair<size_t, uint16> > perTargetFields; // position in data, field index
+        };
+
+        Block* Find(uint32 visibilityClass)
+        {
+            for (std::list<Block>::iterator itr = m_blocks.begin(); itr != m_blocks.end(); ++itr)
+                if (itr->visibilityClass == visibilityClass)
+                    return &*itr;
+            return NULL;
+        }
+
+        Block* Add(uint32 visibilityClass)
+        {
+            m_blocks.push_back(Block(visibilityClass));
+            return &m_blocks.back();
+        }
+
+    private:
+        std::list<Block> m_blocks;                          // few classes per object, list keeps blocks at place
+};
+
 class MANGOS_DLL_SPEC Object
 {
     public:
@@ -186,6 +221,7 @@ class MANGOS_DLL_SPEC Object
         void RemoveFieldNotifyFlag(uint16 flag) { m_fieldNotifyFlags &= ~flag; }
 
         void BuildValuesUpdateBlockForPlayer( UpdateData *data, Player *target ) const;
+        void BuildValuesUpdateBlockForPlayer( UpdateData *data, Player *target, ValuesUpdateCache& cache ) const;
         void BuildOutOfRangeUpdateBlock( UpdateData *data ) const;
         void BuildMovementUpdateBlock( UpdateData * data, uint16 flags = 0 ) const;
 
@@ -379,6 +415,10 @@ class MANGOS_DLL_SPEC Object
         virtual bool HasQuest(uint32 /* quest_id */) const { return false; }
         virtual bool HasInvolvedQuest(uint32 /* quest_id */) const { return false; }
 
+        // build values update of every #step field for all observers #count times, per target and with shared blocks
+        void BenchmarkValuesUpdate(std::vector<Player*> const& observers, uint32 step, uint32 count,
+            uint64& perTargetTime, uint64& sharedTime, uint32& fields, uint32& classes, uint32& mismatches);
+
     protected:
         Object();
 
@@ -387,11 +427,18 @@ class MANGOS_DLL_SPEC Object
         void _Create(ObjectGuid guid);
 
         void _SetUpdateBits(UpdateMask* updateMask, Player* target) const;
+        void _SetUpdateBits(UpdateMask* updateMask, UpdateFieldData const& ufd) const;
         void _SetCreateBits(UpdateMask* updateMask, Player* target) const;
 
         void BuildMovementUpdate(ByteBuffer * data, uint16 updateFlags) const;
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer *data, UpdateMask *updateMask, Player *target ) const;
         void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players);
+        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateCache& cache);
+
+        void SetValuesUpdateSpecialBits(uint8 updatetype, UpdateMask* updateMask) const;
+        bool IsPerTargetUpdateField(uint16 index) const;
+        uint32 GetUpdateFieldValue(uint16 index) const;
+        uint32 GetUpdateFieldValueForPlayer(uint16 index, Player* target) const;
 
         uint16 m_objectType;
 
@@ -709,6 +756,11 @@ class MANGOS_DLL_SPEC WorldObject : public Object
         void  RemoveNotifiedClient(ObjectGuid const& guid) { m_notifiedClients.erase(guid); };
         bool  HasNotifiedClients() const { return !m_notifiedClients.empty(); };
 
+        // Players that have object at client, reverse of Player::m_clientGUIDs (access under map MAP_LOCK_TYPE_MAPOBJECTS lock)
+        GuidSet const& GetObservedBy() const { return m_observedBy; }
+        void  AddObservedBy(ObjectGuid const& guid)    { m_observedBy.insert(guid); }
+        void  RemoveObservedBy(ObjectGuid const& guid) { m_observedBy.erase(guid); }
+
     protected:
         explicit WorldObject();
 
@@ -742,6 +794,7 @@ class MANGOS_DLL_SPEC WorldObject : public Object
         WorldObjectEventProcessor m_Events;
 
         GuidSet    m_notifiedClients;
+        GuidSet    m_observedBy;
 };
 
 #endif
@@ -27,6 +27,8 @@
 #include "World.h"
 #include "CellImpl.h"
 #include "GridDefines.h"
+#include "Player.h"
+#include <ace/Guard_T.h>
 
 class MANGOS_DLL_DECL ObjectGridRespawnMover
 {
@@ -107,11 +109,17 @@ template<> void addUnitState(Creature *obj, CellPair const& cell_pair)
 }
 
 template <class T>
-void LoadHelper(CellGuidSet const& guid_set, CellPair& cell, GridRefManager<T>& /*m*/, uint32& count, Map* map, GridType& grid, TypeID objectTypeID)
+void LoadHelper(CellGuidSet const& guid_set, CellPair& cell, GridRefManager<T>& /*m*/, uint32& count, Map* map, GridType& grid, TypeID objectTypeID, uint32 priority)
 {
     for(CellGuidSet::const_iterator i_guid = guid_set.begin(); i_guid != guid_set.end(); ++i_guid)
     {
-        map->AddLoadingObject(new LoadingObjectQueueMember(*i_guid, objectTypeID, grid));
+        LoadingObjectQueueMember* member = new LoadingObjectQueueMember(*i_guid, objectTypeID, grid, map, priority);
+        if (objectTypeID == TYPEID_UNIT)
+            member->prepared.creatureData = sObjectMgr.GetCreatureData(*i_guid);
+        else
+            member->prepared.goData = sObjectMgr.GetGOData(*i_guid);
+
+        map->AddLoadingObject(member);
         ++count;
     }
 }
@@ -155,8 +163,9 @@ ObjectGridLoader::Visit(GameObjectMapType &m)
     CellObjectGuids const& cell_guids = sObjectMgr.GetCellObjectGuids(i_map->GetId(), i_map->GetSpawnMode(), cell_id);
 
     GridType& grid = (*i_map->getNGrid(i_cell.GridX(),i_cell.GridY())) (i_cell.CellX(),i_cell.CellY());
-    LoadHelper(cell_guids.gameobjects, cell_pair, m, i_gameObjects, i_map, grid, TYPEID_GAMEOBJECT);
-    LoadHelper(i_map->GetPersistentState()->GetCellObjectGuids(cell_id).gameobjects, cell_pair, m, i_gameObjects, i_map, grid, TYPEID_GAMEOBJECT);
+    uint32 priority = GetCellPriority(cell_pair);
+    LoadHelper(cell_guids.gameobjects, cell_pair, m, i_gameObjects, i_map, grid, TYPEID_GAMEOBJECT, priority);
+    LoadHelper(i_map->GetPersistentState()->GetCellObjectGuids(cell_id).gameobjects, cell_pair, m, i_gameObjects, i_map, grid, TYPEID_GAMEOBJECT, priority);
 }
 
 void
@@ -170,8 +179,9 @@ ObjectGridLoader::Visit(CreatureMapType &m)
     CellObjectGuids const& cell_guids = sObjectMgr.GetCellObjectGuids(i_map->GetId(), i_map->GetSpawnMode(), cell_id);
 
     GridType& grid = (*i_map->getNGrid(i_cell.GridX(),i_cell.GridY())) (i_cell.CellX(),i_cell.CellY());
-    LoadHelper(cell_guids.creatures, cell_pair, m, i_creatures, i_map, grid, TYPEID_UNIT);
-    LoadHelper(i_map->GetPersistentState()->GetCellObjectGuids(cell_id).creatures, cell_pair, m, i_creatures, i_map, grid, TYPEID_UNIT);
+    uint32 priority = GetCellPriority(cell_pair);
+    LoadHelper(cell_guids.creatures, cell_pair, m, i_creatures, i_map, grid, TYPEID_UNIT, priority);
+    LoadHelper(i_map->GetPersistentState()->GetCellObjectGuids(cell_id).creatures, cell_pair, m, i_creatures, i_map, grid, TYPEID_UNIT, priority);
 }
 
 void
@@ -207,6 +217,21 @@ ObjectGridLoader::Load(GridType &grid)
 void ObjectGridLoader::LoadN(void)
 {
     i_gameObjects = 0; i_creatures = 0; i_corpses = 0;
+
+    // players in loaded or neighbour grids define loading order, others will not see these objects soon
+    i_viewers.clear();
+    Map::PlayerList const& players = i_map->GetPlayers();
+    for (Map::PlayerList::const_iterator itr = players.begin(); itr != players.end(); ++itr)
+    {
+        Player* player = itr->getSource();
+        if (!player || !player->IsInWorld())
+            continue;
+
+        Cell viewerCell(MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY()));
+        if (abs(int32(viewerCell.GridX()) - int32(i_cell.GridX())) <= 1 && abs(int32(viewerCell.GridY()) - int32(i_cell.GridY())) <= 1)
+            i_viewers.push_back(viewerCell.cellPair());
+    }
+
     i_cell.data.Part.cell_y = 0;
     for(unsigned int x=0; x < MAX_NUMBER_OF_CELLS; ++x)
     {
@@ -221,6 +246,19 @@ void ObjectGridLoader::LoadN(void)
     DEBUG_LOG("%u GameObjects, %u Creatures, and %u Corpses/Bones loaded for grid %u on map %u", i_gameObjects, i_creatures, i_corpses,i_grid.GetGridId(), i_map->GetId());
 }
 
+uint32 ObjectGridLoader::GetCellPriority(CellPair const& cell) const
+{
+    uint32 priority = TOTAL_NUMBER_OF_CELLS_PER_MAP;
+    for (std::vector<CellPair>::const_iterator itr = i_viewers.begin(); itr != i_viewers.end(); ++itr)
+    {
+        uint32 dx = cell.x_coord > itr->x_coord ? cell.x_coord - itr->x_coord : itr->x_coord - cell.x_coord;
+        uint32 dy = cell.y_coord > itr->y_coord ? cell.y_coord - itr->y_coord : itr->y_coord - cell.y_coord;
+        priority = std::min(priority, std::max(dx, dy));
+    }
+
+    return priority;
+}
+
 void ObjectGridUnloader::MoveToRespawnN()
 {
     for(unsigned int x=0; x < MAX_NUMBER_OF_CELLS; ++x)
@@ -282,3 +320,154 @@ ObjectGridStoper::Visit(CreatureMapType &m)
 
 template void ObjectGridUnloader::Visit(GameObjectMapType &);
 template void ObjectGridUnloader::Visit(DynamicObjectMapType &);
+
+bool LoadingObjectsPrepareOrder::operator() (LoadingObjectQueueMember const* left, LoadingObjectQueueMember const* right) const
+{
+    if (left->priority != right->priority)
+        return left->priority < right->priority;
+
+    return left < right;
+}
+
+ObjectLoadPreparer::ObjectLoadPreparer() : m_queueCond(m_lock), m_doneCond(m_lock), m_threads(0), m_stop(false)
+{
+}
+
+ObjectLoadPreparer::~ObjectLoadPreparer()
+{
+    Stop();
+}
+
+void ObjectLoadPreparer::Start(uint32 threads)
+{
+    if (m_threads || !threads)
+        return;
+
+    m_stop = false;
+    if (activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, int(threads)) == -1)
+    {
+        sLog.outError("ObjectLoadPreparer: can't start %u threads, grid objects will be prepared by map threads", threads);
+        return;
+    }
+
+    m_threads = threads;
+}
+
+void ObjectLoadPreparer::Stop()
+{
+    if (!m_threads)
+        return;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_stop = true;
+        m_queueCond.broadcast();
+    }
+
+    wait();
+
+    // not prepared members stay in map loading queues and are loaded by map threads
+    for (PrepareQueue::const_iterator itr = m_queue.begin(); itr != m_queue.end(); ++itr)
+        (*itr)->state = LOADING_OBJECT_NEW;
+    m_queue.clear();
+
+    m_threads = 0;
+}
+
+void ObjectLoadPreparer::Queue(LoadingObjectQueueMember* member)
+{
+    // only creatures have templates and models worth resolving off map thread
+    if (!m_threads || member->objectTypeID != TYPEID_UNIT || !member->prepared.creatureData)
+        return;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    member->state = LOADING_OBJECT_QUEUED;
+    m_queue.insert(member);
+    ++m_stats.queued;
+    m_queueCond.signal();
+}
+
+void ObjectLoadPreparer::Take(LoadingObjectQueueMember* member)
+{
+    if (!m_threads)
+        return;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    switch (member->state)
+    {
+        case LOADING_OBJECT_NEW:
+            break;
+        case LOADING_OBJECT_QUEUED:
+            m_queue.erase(member);
+            member->state = LOADING_OBJECT_NEW;
+            ++m_stats.loadedInPlace;
+            break;
+        case LOADING_OBJECT_PREPARING:
+            ++m_stats.waited;
+            while (member->state != LOADING_OBJECT_PREPARED)
+                m_doneCond.wait();
+            break;
+        case LOADING_OBJECT_PREPARED:
+            ++m_stats.ready;
+            break;
+    }
+}
+
+ObjectLoadPreparerStatistics ObjectLoadPreparer::GetStatistics()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, m_stats);
+    return m_stats;
+}
+
+void ObjectLoadPreparer::Prepare(LoadingObjectQueueMember* member)
+{
+    LoadingObjectPrepared& prepared = member->prepared;
+
+    // templates and model infos are not changed after server start, so can be read by any thread.
+    // Failed lookups are left to map thread, it reports them at creature loading.
+    CreatureInfo const* normalInfo = ObjectMgr::GetCreatureTemplate(prepared.creatureData->id);
+    if (!normalInfo)
+        return;
+
+    CreatureInfo const* cinfo = Creature::GetDifficultyTemplate(normalInfo, member->map);
+
+    uint32 displayId = Creature::ChooseDisplayId(cinfo, prepared.creatureData);
+    if (!displayId)
+        return;
+
+    CreatureModelInfo const* minfo = sObjectMgr.GetCreatureModelRandomGender(displayId);
+    if (!minfo)
+        return;
+
+    prepared.creatureInfo = normalInfo;
+    prepared.difficultyInfo = cinfo;
+    prepared.modelInfo = minfo;
+}
+
+int ObjectLoadPreparer::svc()
+{
+    while (true)
+    {
+        LoadingObjectQueueMember* member;
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+            while (m_queue.empty() && !m_stop)
+                m_queueCond.wait();
+
+            if (m_stop)
+                break;
+
+            member = *m_queue.begin();
+            m_queue.erase(m_queue.begin());
+            member->state = LOADING_OBJECT_PREPARING;
+        }
+
+        Prepare(member);
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+        member->state = LOADING_OBJECT_PREPARED;
+        m_doneCond.broadcast();
+    }
+
+    return 0;
+}
@@ -26,7 +26,15 @@
 #include "GridDefines.h"
 #include "Cell.h"
 
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <set>
+#include <vector>
+
 class ObjectWorldLoader;
+struct LoadingObjectQueueMember;
 
 class MANGOS_DLL_DECL ObjectGridLoader
 {
@@ -46,10 +54,14 @@ class MANGOS_DLL_DECL ObjectGridLoader
 
         void LoadN(void);
 
+        // distance in cells from cell to nearest player, objects of nearer cells are loaded first
+        uint32 GetCellPriority(CellPair const& cell) const;
+
     private:
         Cell i_cell;
         NGridType &i_grid;
         Map* i_map;
+        std::vector<CellPair> i_viewers;                    // cells of players near loaded grid
         uint32 i_gameObjects;
         uint32 i_creatures;
         uint32 i_corpses;
@@ -106,4 +118,56 @@ class MANGOS_DLL_DECL ObjectGridStoper
 };
 
 typedef GridLoader<Player, AllWorldObjectTypes, AllGridObjectTypes> GridLoaderType;
+
+struct ObjectLoadPreparerStatistics
+{
+    ObjectLoadPreparerStatistics() : queued(0), ready(0), waited(0), loadedInPlace(0) {}
+
+    uint32 queued;                                          // creatures queued for preparing
+    uint32 ready;                                           // prepared before map thread needed them
+    uint32 waited;                                          // map thread waited for started preparing
+    uint32 loadedInPlace;                                   // needed before preparing started, loaded by map thread
+};
+
+// same order as map loading queue, so next loaded objects are prepared first
+struct LoadingObjectsPrepareOrder
+{
+    bool operator() (LoadingObjectQueueMember const* left, LoadingObjectQueueMember const* right) const;
+};
+
+// Background threads which resolve templates and models of creatures queued for grid loading.
+// Objects are created and added to grid only by map thread.
+class MANGOS_DLL_DECL ObjectLoadPreparer : protected ACE_Task_Base
+{
+    public:
+        ObjectLoadPreparer();
+        virtual ~ObjectLoadPreparer();
+
+        void Start(uint32 threads);
+        void Stop();
+        bool IsEnabled() const { return m_threads > 0; }
+
+        void Queue(LoadingObjectQueueMember* member);
+        // must be called before map thread uses or deletes queued member:
+        // not started member is removed from queue, started one is waited for
+        void Take(LoadingObjectQueueMember* member);
+
+        ObjectLoadPreparerStatistics GetStatistics();
+
+        virtual int svc();
+
+    private:
+        static void Prepare(LoadingObjectQueueMember* member);
+
+        typedef std::set<LoadingObjectQueueMember*, LoadingObjectsPrepareOrder> PrepareQueue;
+
+        ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_queueCond;
+        ACE_Condition_Thread_Mutex m_doneCond;
+        PrepareQueue m_queue;
+        uint32 m_threads;
+        bool m_stop;
+
+        ObjectLoadPreparerStatistics m_stats;
+};
 #endif
@@ -1202,8 +1202,10 @@ void ObjectMgr::LoadCreatureModelRace()
 void ObjectMgr::LoadCreatures()
 {
     uint32 count = 0;
-    //                                                0                       1   2    3
-    QueryResult *result = WorldDatabase.Query("SELECT creature.guid, creature.id, map, modelid,"
+    // loaded by prepared statement to get rows in binary form, saves text parsing for every field
+    SqlStatementID loadCreatures;
+    //                                                                         0                       1   2    3
+    QueryResult *result = WorldDatabase.CreateStatement(loadCreatures, "SELECT creature.guid, creature.id, map, modelid,"
     //   4             5           6           7           8            9              10         11
         "equipment_id, position_x, position_y, position_z, orientation, spawntimesecs, spawndist, currentwaypoint,"
     //   12         13       14          15            16         17         18
@@ -1213,7 +1215,7 @@ void ObjectMgr::LoadCreatures()
         "FROM creature "
         "LEFT OUTER JOIN game_event_creature ON creature.guid = game_event_creature.guid "
         "LEFT OUTER JOIN pool_creature ON creature.guid = pool_creature.guid "
-        "LEFT OUTER JOIN pool_creature_template ON creature.id = pool_creature_template.id");
+        "LEFT OUTER JOIN pool_creature_template ON creature.id = pool_creature_template.id").Query();
 
     if (!result)
     {
@@ -1454,8 +1456,10 @@ void ObjectMgr::LoadGameObjects()
 {
     uint32 count = 0;
 
-    //                                                0                           1   2    3           4           5           6
-    QueryResult *result = WorldDatabase.Query("SELECT gameobject.guid, gameobject.id, map, position_x, position_y, position_z, orientation,"
+    // loaded by prepared statement to get rows in binary form, saves text parsing for every field
+    SqlStatementID loadGameObjects;
+    //                                                                           0                           1   2    3           4           5           6
+    QueryResult *result = WorldDatabase.CreateStatement(loadGameObjects, "SELECT gameobject.guid, gameobject.id, map, position_x, position_y, position_z, orientation,"
     //   7          8          9          10         11             12            13     14         15         16
         "rotation0, rotation1, rotation2, rotation3, spawntimesecs, animprogress, state, spawnMask, phaseMask, event,"
     //   17                          18
@@ -1463,7 +1467,7 @@ void ObjectMgr::LoadGameObjects()
         "FROM gameobject "
         "LEFT OUTER JOIN game_event_gameobject ON gameobject.guid = game_event_gameobject.guid "
         "LEFT OUTER JOIN pool_gameobject ON gameobject.guid = pool_gameobject.guid "
-        "LEFT OUTER JOIN pool_gameobject_template ON gameobject.id = pool_gameobject_template.id");
+        "LEFT OUTER JOIN pool_gameobject_template ON gameobject.id = pool_gameobject_template.id").Query();
 
     if (!result)
     {
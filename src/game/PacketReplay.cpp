@@ -0,0 +1,585 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PacketReplay.h"
+#include "Policies/Singleton.h"
+#include "Database/DatabaseEnv.h"
+#include "WorldSession.h"
+#include "WorldPacket.h"
+#include "Opcodes.h"
+#include "Player.h"
+#include "World.h"
+#include "ObjectMgr.h"
+#include "Log.h"
+#include "Timer.h"
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+INSTANTIATE_SINGLETON_1(PacketReplayMgr);
+
+// login callbacks carry generation of replay and index of session
+#define REPLAY_ID_INDEX_BITS        16
+#define REPLAY_MAX_SESSIONS         (1 << REPLAY_ID_INDEX_BITS)
+
+static bool readLE(FILE* file, uint64& value, size_t bytes)
+{
+    value = 0;
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        int c = fgetc(file);
+        if (c == EOF)
+            return false;
+
+        value |= uint64(c & 0xFF) << (i * 8);
+    }
+    return true;
+}
+
+static uint32 GetProcessMemoryKB()
+{
+#if defined(__linux__)
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+
+    unsigned long size = 0, resident = 0;
+    int read = fscanf(statm, "%lu %lu", &size, &resident);
+    fclose(statm);
+
+    return read == 2 ? uint32(resident * (sysconf(_SC_PAGESIZE) / 1024)) : 0;
+#else
+    return 0;
+#endif
+}
+
+// packed guid at packet start (movement packets) and full guids anywhere in packet are replaced
+static void ReplaceGuid(WorldPacket& packet, ObjectGuid from, ObjectGuid to)
+{
+    if (from.IsEmpty() || from == to || packet.empty())
+        return;
+
+    uint64 fromRaw = from.GetRawValue();
+    uint64 toRaw = to.GetRawValue();
+
+    size_t packedSize = 0;
+    uint8 mask = packet[0];
+    uint64 packed = 0;
+    for (size_t i = 0, pos = 1; i < 8; ++i)
+    {
+        if (mask & (1 << i))
+        {
+            if (pos >= packet.size())
+            {
+                packed = 0;
+                break;
+            }
+
+            packed |= uint64(packet[pos++]) << (i * 8);
+        }
+        packedSize = pos;
+    }
+
+    if (packed == fromRaw)
+    {
+        ByteBuffer rest;
+        if (packet.size() > packedSize)
+            rest.append(packet.contents() + packedSize, packet.size() - packedSize);
+
+        packet.clear();
+        packet.appendPackGUID(toRaw);
+        if (rest.size())
+            packet.append(rest.contents(), rest.size());
+    }
+
+    for (size_t pos = 0; pos + sizeof(uint64) <= packet.size(); ++pos)
+    {
+        uint64 value = 0;
+        for (size_t i = 0; i < sizeof(uint64); ++i)
+            value |= uint64(packet[pos + i]) << (i * 8);
+
+        if (value == fromRaw)
+        {
+            for (size_t i = 0; i < sizeof(uint64); ++i)
+                packet.put<uint8>(pos + i, uint8(toRaw >> (i * 8)));
+
+            pos += sizeof(uint64) - 1;
+        }
+    }
+}
+
+// login, logout and transfer are done by replay itself, recorded ones would break replaying character
+static bool IsReplayedOpcode(uint16 opcode)
+{
+    if (opcode >= NUM_MSG_TYPES)
+        return false;
+
+    switch (opcode)
+    {
+        case CMSG_LOGOUT_REQUEST:
+        case CMSG_PLAYER_LOGOUT:
+        case CMSG_LOGOUT_CANCEL:
+        case MSG_MOVE_TELEPORT_ACK:
+            return false;
+        default:
+            break;
+    }
+
+    switch (opcodeTable[opcode].status)
+    {
+        case STATUS_LOGGEDIN:
+        case STATUS_LOGGEDIN_OR_RECENTLY_LOGGEDOUT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+struct PacketReplayOpcodeOrder
+{
+    bool operator() (PacketReplayOpcodeStatistics const& left, PacketReplayOpcodeStatistics const& right) const
+    {
+        return left.totalTime > right.totalTime;
+    }
+};
+
+PacketReplayMgr::PacketReplayMgr() : m_running(false), m_speed(1.0f), m_replayTime(0.0), m_generation(0),
+    m_packets(0), m_skippedPackets(0), m_startMemory(0)
+{
+}
+
+PacketReplayMgr::~PacketReplayMgr()
+{
+    Stop();
+}
+
+bool PacketReplayMgr::LoadCapture(std::string const& fileName, std::string& error)
+{
+    m_recorded.clear();
+
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (!file)
+    {
+        error = "can't open " + fileName;
+        return false;
+    }
+
+    char magic[4];
+    uint64 version;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, PACKET_LOG_MAGIC, 4) != 0 || !readLE(file, version, 2) || version != PACKET_LOG_VERSION)
+    {
+        fclose(file);
+        error = fileName + " is not binary world log of supported version";
+        return false;
+    }
+
+    // character login of socket, index in m_recorded
+    typedef UNORDERED_MAP<uint32, size_t> SocketSessionMap;
+    SocketSessionMap socketSessions;
+    std::vector<uint64> loginTimes;
+    std::vector<uint8> data;
+
+    while (true)
+    {
+        int type = fgetc(file);
+        if (type == EOF)
+            break;
+
+        if (type == PACKET_LOG_RECORD_OPCODE_NAME)
+        {
+            uint64 opcode, length;
+            if (!readLE(file, opcode, 2) || !readLE(file, length, 1) || fseek(file, long(length), SEEK_CUR) != 0)
+                break;
+
+            continue;
+        }
+
+        uint64 timeMs, socket, opcode, direction, length;
+        if (type != PACKET_LOG_RECORD_PACKET || !readLE(file, timeMs, 8) || !readLE(file, socket, 4) || !readLE(file, opcode, 2) ||
+            !readLE(file, direction, 1) || !readLE(file, length, 4))
+            break;
+
+        data.resize(size_t(length));
+        if (length && fread(&data[0], 1, size_t(length), file) != length)
+            break;
+
+        if (direction == PACKET_LOG_CLIENT_TO_SERVER && opcode == CMSG_PLAYER_LOGIN)
+        {
+            if (length < sizeof(uint64))
+                continue;
+
+            ByteBuffer login;
+            login.append(&data[0], data.size());
+
+            RecordedSession session;
+            session.socket = uint32(socket);
+            session.playerGuid = ObjectGuid(login.read<uint64>());
+
+            socketSessions[uint32(socket)] = m_recorded.size();
+            loginTimes.push_back(timeMs);
+            m_recorded.push_back(session);
+            continue;
+        }
+
+        SocketSessionMap::const_iterator itr = socketSessions.find(uint32(socket));
+        if (itr == socketSessions.end())
+            continue;
+
+        RecordedSession& session = m_recorded[itr->second];
+
+        if (direction != PACKET_LOG_CLIENT_TO_SERVER)
+        {
+            if (opcode == SMSG_LOGIN_VERIFY_WORLD && !session.hasPosition && length >= 20)
+            {
+                ByteBuffer verify;
+                verify.append(&data[0], data.size());
+                verify >> session.mapId >> session.x >> session.y >> session.z >> session.orientation;
+                session.hasPosition = true;
+            }
+            continue;
+        }
+
+        RecordedPacket packet;
+        packet.time = uint32(timeMs > loginTimes[itr->second] ? timeMs - loginTimes[itr->second] : 0);
+        packet.opcode = uint16(opcode);
+        packet.data = data;
+        session.packets.push_back(packet);
+    }
+
+    fclose(file);
+
+    // logins without any replayable traffic are not useful
+    for (RecordedSessions::iterator itr = m_recorded.begin(); itr != m_recorded.end();)
+    {
+        if (itr->packets.empty())
+            itr = m_recorded.erase(itr);
+        else
+            ++itr;
+    }
+
+    if (m_recorded.empty())
+    {
+        error = fileName + " has no recorded character sessions (client packets after CMSG_PLAYER_LOGIN)";
+        return false;
+    }
+
+    return true;
+}
+
+bool PacketReplayMgr::Start(std::string const& fileName, uint32 sessions, float speed, std::string const& namePrefix, std::string& error)
+{
+    if (m_running)
+    {
+        error = "replay is already running";
+        return false;
+    }
+
+    if (!sessions || sessions >= REPLAY_MAX_SESSIONS || speed <= 0.0f)
+    {
+        error = "wrong session count or speed";
+        return false;
+    }
+
+    if (!LoadCapture(fileName, error))
+        return false;
+
+    std::string prefix = namePrefix;
+    CharacterDatabase.escape_string(prefix);
+
+    // characters of accounts which are not online, so they don't collide with real sessions
+    QueryResult* result = CharacterDatabase.PQuery("SELECT guid, account FROM characters WHERE name LIKE '%s%%' AND online = 0 ORDER BY guid", prefix.c_str());
+    if (result)
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            ObjectGuid guid = ObjectGuid(HIGHGUID_PLAYER, fields[0].GetUInt32());
+            uint32 accountId = fields[1].GetUInt32();
+
+            if (sWorld.FindSession(accountId) || sObjectMgr.GetPlayer(guid))
+                continue;
+
+            PacketReplaySession replay;
+            replay.guid = guid;
+            replay.accountId = accountId;
+            replay.recorded = &m_recorded[m_sessions.size() % m_recorded.size()];
+            m_sessions.push_back(replay);
+        }
+        while (m_sessions.size() < sessions && result->NextRow());
+
+        delete result;
+    }
+
+    if (m_sessions.empty())
+    {
+        m_recorded.clear();
+        error = "no offline characters with name starting by " + namePrefix;
+        return false;
+    }
+
+    m_running = true;
+    m_speed = speed;
+    m_replayTime = 0.0;
+    ++m_generation;
+    m_tickTimes.clear();
+    m_opcodeStats.clear();
+    m_packets = 0;
+    m_skippedPackets = 0;
+    m_startMemory = GetProcessMemoryKB();
+
+    sLog.outString("PacketReplay: replaying %u recorded sessions from %s by %u characters, speed %.2f",
+        uint32(m_recorded.size()), fileName.c_str(), uint32(m_sessions.size()), speed);
+
+    for (size_t i = 0; i < m_sessions.size(); ++i)
+        LoginPlayer((m_generation << REPLAY_ID_INDEX_BITS) | i, m_sessions[i].accountId, m_sessions[i].guid);
+
+    return true;
+}
+
+void PacketReplayMgr::Stop()
+{
+    if (!m_running)
+        return;
+
+    for (ReplaySessions::iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+    {
+        if (!itr->session)
+            continue;
+
+        itr->session->LogoutPlayer(true);
+        delete itr->session;
+        itr->session = NULL;
+    }
+
+    m_sessions.clear();
+    m_recorded.clear();
+    m_running = false;
+
+    sLog.outString("PacketReplay: stopped");
+}
+
+PacketReplaySession* PacketReplayMgr::GetSessionByReplayId(uint32 replayId)
+{
+    if (!m_running || (replayId >> REPLAY_ID_INDEX_BITS) != m_generation)
+        return NULL;
+
+    uint32 index = replayId & (REPLAY_MAX_SESSIONS - 1);
+    return index < m_sessions.size() ? &m_sessions[index] : NULL;
+}
+
+bool PacketReplayMgr::IsWaitingLogin(uint32 replayId, ObjectGuid guid) const
+{
+    PacketReplaySession const* replay = const_cast<PacketReplayMgr*>(this)->GetSessionByReplayId(replayId);
+    return replay && replay->guid == guid && replay->state == REPLAY_SESSION_LOGGING_IN;
+}
+
+void PacketReplayMgr::OnSessionLogin(uint32 replayId, WorldSession* session)
+{
+    PacketReplaySession* replay = GetSessionByReplayId(replayId);
+    if (!replay || !session->GetPlayer())
+    {
+        if (replay)
+            replay->state = REPLAY_SESSION_FAILED;
+
+        if (session->GetPlayer())
+            session->LogoutPlayer(true);
+        delete session;
+        return;
+    }
+
+    replay->session = session;
+
+    RecordedSession const* recorded = replay->recorded;
+    Player* player = session->GetPlayer();
+    if (recorded->hasPosition && (player->GetMapId() != recorded->mapId || !player->IsWithinDist3d(recorded->x, recorded->y, recorded->z, 1.0f)))
+    {
+        player->TeleportTo(recorded->mapId, recorded->x, recorded->y, recorded->z, recorded->orientation);
+        replay->state = REPLAY_SESSION_TELEPORTING;
+    }
+    else
+    {
+        replay->state = REPLAY_SESSION_REPLAYING;
+        replay->startTime = m_replayTime;
+    }
+}
+
+void PacketReplayMgr::Update(uint32 diff)
+{
+    if (!m_running)
+        return;
+
+    m_replayTime += diff * m_speed;
+
+    for (ReplaySessions::iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+        if (itr->session)
+            UpdateSession(*itr);
+}
+
+void PacketReplayMgr::UpdateSession(PacketReplaySession& replay)
+{
+    Player* player = replay.session->GetPlayer();
+    if (!player)
+        return;
+
+    // clients confirm teleports at once, as playerbots do
+    if (player->IsBeingTeleportedFar())
+        replay.session->HandleMoveWorldportAckOpcode();
+    else if (player->IsBeingTeleportedNear())
+    {
+        WorldPacket ack(MSG_MOVE_TELEPORT_ACK, 8 + 4 + 4);
+        ack.appendPackGUID(player->GetObjectGuid().GetRawValue());
+        ack << uint32(0);
+        ack << uint32(time(NULL));
+        replay.session->HandleMoveTeleportAckOpcode(ack);
+    }
+
+    if (!player->IsInWorld() || player->IsBeingTeleported())
+        return;
+
+    if (replay.state == REPLAY_SESSION_TELEPORTING)
+    {
+        replay.state = REPLAY_SESSION_REPLAYING;
+        replay.startTime = m_replayTime;
+    }
+
+    if (replay.state != REPLAY_SESSION_REPLAYING)
+        return;
+
+    std::vector<RecordedPacket> const& packets = replay.recorded->packets;
+    while (replay.nextPacket < packets.size() && packets[replay.nextPacket].time <= m_replayTime - replay.startTime)
+    {
+        ExecutePacket(replay, packets[replay.nextPacket++]);
+
+        // handler can log out or teleport character, rest waits for next update
+        player = replay.session->GetPlayer();
+        if (!player || !player->IsInWorld() || player->IsBeingTeleported())
+            break;
+    }
+
+    if (replay.nextPacket >= packets.size())
+    {
+        replay.state = REPLAY_SESSION_FINISHED;
+
+        bool allFinished = true;
+        for (ReplaySessions::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+            if (itr->state != REPLAY_SESSION_FINISHED && itr->state != REPLAY_SESSION_FAILED)
+                allFinished = false;
+
+        if (allFinished)
+            sLog.outString("PacketReplay: all sessions finished, %u packets replayed", m_packets);
+    }
+}
+
+void PacketReplayMgr::ExecutePacket(PacketReplaySession& replay, RecordedPacket const& recorded)
+{
+    if (!IsReplayedOpcode(recorded.opcode))
+    {
+        ++m_skippedPackets;
+        return;
+    }
+
+    WorldPacket packet(Opcodes(recorded.opcode), recorded.data.size());
+    if (!recorded.data.empty())
+        packet.append(&recorded.data[0], recorded.data.size());
+
+    ReplaceGuid(packet, replay.recorded->playerGuid, replay.guid);
+
+    OpcodeHandler const& opHandle = opcodeTable[recorded.opcode];
+
+    uint64 startTime = WorldTimer::getMicroTime();
+    try
+    {
+        replay.session->ExecuteOpcode(opHandle, &packet);
+    }
+    catch (ByteBufferException &)
+    {
+        DEBUG_LOG("PacketReplay: ByteBufferException while replaying %s (0x%.4X)", opHandle.name, recorded.opcode);
+    }
+    uint64 time = WorldTimer::getMicroTime() - startTime;
+
+    PacketReplayOpcodeStatistics& stats = m_opcodeStats[recorded.opcode];
+    stats.opcode = recorded.opcode;
+    ++stats.count;
+    stats.totalTime += time;
+    if (time > stats.maxTime)
+        stats.maxTime = uint32(time);
+
+    ++m_packets;
+}
+
+PacketReplayStatistics PacketReplayMgr::GetStatistics() const
+{
+    PacketReplayStatistics stats;
+    stats.sessions = m_sessions.size();
+
+    for (ReplaySessions::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+    {
+        switch (itr->state)
+        {
+            case REPLAY_SESSION_TELEPORTING:
+            case REPLAY_SESSION_REPLAYING:
+                ++stats.loggedIn;
+                break;
+            case REPLAY_SESSION_FINISHED:
+                ++stats.loggedIn;
+                ++stats.finished;
+                break;
+            case REPLAY_SESSION_FAILED:
+                ++stats.failed;
+                break;
+            default:
+                break;
+        }
+    }
+
+    stats.packets = m_packets;
+    stats.skippedPackets = m_skippedPackets;
+
+    if (!m_tickTimes.empty())
+    {
+        std::vector<uint32> sorted = m_tickTimes;
+        std::sort(sorted.begin(), sorted.end());
+
+        uint64 total = 0;
+        for (std::vector<uint32>::const_iterator itr = sorted.begin(); itr != sorted.end(); ++itr)
+            total += *itr;
+
+        size_t last = sorted.size() - 1;
+        stats.ticks = sorted.size();
+        stats.tickMin = sorted.front();
+        stats.tickAvg = uint32(total / sorted.size());
+        stats.tickP50 = sorted[last * 50 / 100];
+        stats.tickP90 = sorted[last * 90 / 100];
+        stats.tickP99 = sorted[last * 99 / 100];
+        stats.tickMax = sorted.back();
+    }
+
+    stats.startMemory = m_startMemory;
+    stats.currentMemory = GetProcessMemoryKB();
+    return stats;
+}
+
+void PacketReplayMgr::GetOpcodeStatistics(std::vector<PacketReplayOpcodeStatistics>& stats) const
+{
+    stats.clear();
+    for (OpcodeStatisticsMap::const_iterator itr = m_opcodeStats.begin(); itr != m_opcodeStats.end(); ++itr)
+        stats.push_back(itr->second);
+
+    std::sort(stats.begin(), stats.end(), PacketReplayOpcodeOrder());
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PACKET_REPLAY_H
+#define MANGOS_PACKET_REPLAY_H
+
+#include "Common.h"
+#include "ObjectGuid.h"
+#include "Policies/Singleton.h"
+
+class WorldSession;
+
+// Client packet of recorded session, time is relative to character login
+struct RecordedPacket
+{
+    uint32 time;
+    uint16 opcode;
+    std::vector<uint8> data;
+};
+
+// Client traffic of one character login, from CMSG_PLAYER_LOGIN to next login or end of connection
+struct RecordedSession
+{
+    RecordedSession() : socket(0), mapId(0), x(0.0f), y(0.0f), z(0.0f), orientation(0.0f), hasPosition(false) {}
+
+    uint32 socket;
+    ObjectGuid playerGuid;                                  // recorded character, replaced by replaying character in packets
+
+    // login position from SMSG_LOGIN_VERIFY_WORLD, replaying character starts there
+    uint32 mapId;
+    float x, y, z, orientation;
+    bool hasPosition;
+
+    std::vector<RecordedPacket> packets;
+};
+
+enum PacketReplaySessionState
+{
+    REPLAY_SESSION_LOGGING_IN   = 0,
+    REPLAY_SESSION_TELEPORTING  = 1,                        // moved to recorded login position
+    REPLAY_SESSION_REPLAYING    = 2,
+    REPLAY_SESSION_FINISHED     = 3,
+    REPLAY_SESSION_FAILED       = 4                         // character can't be loaded
+};
+
+// Character which replays recorded session, logged in without socket like playerbots
+struct PacketReplaySession
+{
+    PacketReplaySession() : accountId(0), session(NULL), recorded(NULL), state(REPLAY_SESSION_LOGGING_IN), nextPacket(0), startTime(0) {}
+
+    ObjectGuid guid;
+    uint32 accountId;
+    WorldSession* session;
+    RecordedSession const* recorded;
+    PacketReplaySessionState state;
+    size_t nextPacket;
+    double startTime;                                       // replay time of recorded login
+};
+
+struct PacketReplayOpcodeStatistics
+{
+    PacketReplayOpcodeStatistics() : opcode(0), count(0), totalTime(0), maxTime(0) {}
+
+    uint16 opcode;
+    uint32 count;
+    uint64 totalTime;                                       // us spent in handler
+    uint32 maxTime;
+};
+
+struct PacketReplayStatistics
+{
+    PacketReplayStatistics() : sessions(0), loggedIn(0), finished(0), failed(0), packets(0), skippedPackets(0),
+        ticks(0), tickMin(0), tickAvg(0), tickP50(0), tickP90(0), tickP99(0), tickMax(0), startMemory(0), currentMemory(0) {}
+
+    uint32 sessions;
+    uint32 loggedIn;
+    uint32 finished;
+    uint32 failed;
+    uint32 packets;                                         // executed by handlers
+    uint32 skippedPackets;                                  // login, logout and transfer packets handled by replay itself
+
+    // world update durations in us since replay start
+    uint32 ticks;
+    uint32 tickMin, tickAvg, tickP50, tickP90, tickP99, tickMax;
+
+    // resident memory of process in KB, 0 if not known for this platform
+    uint32 startMemory;
+    uint32 currentMemory;
+};
+
+// Headless load benchmark: client packets recorded in binary world log (WorldLogBinary = 1) are replayed
+// by characters logged in without client, with time of capture divided by speed. World update duration,
+// time spent in handlers per opcode and memory growth are measured while replay runs.
+class PacketReplayMgr
+{
+    public:
+        PacketReplayMgr();
+        ~PacketReplayMgr();
+
+        // loads capture and logs in characters with name starting by prefix, error is filled on failure
+        bool Start(std::string const& fileName, uint32 sessions, float speed, std::string const& namePrefix, std::string& error);
+        void Stop();
+        bool IsRunning() const { return m_running; }
+
+        // world thread, after sessions update
+        void Update(uint32 diff);
+        // duration of whole world update in us
+        void AddTickTime(uint32 time) { if (m_running) m_tickTimes.push_back(time); }
+
+        PacketReplayStatistics GetStatistics() const;
+        // opcodes sorted by total handler time
+        void GetOpcodeStatistics(std::vector<PacketReplayOpcodeStatistics>& stats) const;
+
+        uint32 GetRecordedSessionCount() const { return m_recorded.size(); }
+        float GetSpeed() const { return m_speed; }
+
+        // login callback
+        void OnSessionLogin(uint32 replayId, WorldSession* session);
+        bool IsWaitingLogin(uint32 replayId, ObjectGuid guid) const;
+
+    private:
+        bool LoadCapture(std::string const& fileName, std::string& error);
+        void LoginPlayer(uint32 replayId, uint32 accountId, ObjectGuid guid);
+        void UpdateSession(PacketReplaySession& replay);
+        void ExecutePacket(PacketReplaySession& replay, RecordedPacket const& recorded);
+
+        PacketReplaySession* GetSessionByReplayId(uint32 replayId);
+
+        typedef std::vector<RecordedSession> RecordedSessions;
+        typedef std::vector<PacketReplaySession> ReplaySessions;
+        typedef std::map<uint16, PacketReplayOpcodeStatistics> OpcodeStatisticsMap;
+
+        RecordedSessions m_recorded;
+        ReplaySessions m_sessions;
+        bool m_running;
+        float m_speed;
+        double m_replayTime;                                // ms of capture time replayed since start
+        uint32 m_generation;                                // login callbacks of previous replays are ignored
+
+        std::vector<uint32> m_tickTimes;
+        OpcodeStatisticsMap m_opcodeStats;
+        uint32 m_packets;
+        uint32 m_skippedPackets;
+        uint32 m_startMemory;
+};
+
+#define sPacketReplayMgr MaNGOS::Singleton<PacketReplayMgr>::Instance()
+
+#endif
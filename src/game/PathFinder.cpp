@@ -24,20 +24,41 @@
 
 #include "../recastnavigation/Detour/Include/DetourCommon.h"
 
+////////////////// PathPolyCache //////////////////
+bool PathPolyCache::Find(dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter, dtPolyRef* path, uint32& pathLength)
+{
+    PolyPathMap::const_iterator itr = m_paths.find(PolyPathKey(startPoly, endPoly, filter));
+    if (itr == m_paths.end())
+        return false;
+
+    pathLength = itr->second.size();
+    std::copy(itr->second.begin(), itr->second.end(), path);
+    ++m_hits;
+    return true;
+}
+
+void PathPolyCache::Add(dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter, dtPolyRef const* path, uint32 pathLength)
+{
+    m_paths[PolyPathKey(startPoly, endPoly, filter)].assign(path, path + pathLength);
+}
+
 ////////////////// PathFinder //////////////////
 PathFinder::PathFinder(const Unit* owner) :
     m_polyLength(0), m_type(PATHFIND_BLANK),
     m_useStraightPath(false), m_forceDestination(false), m_pointPathLimit(MAX_POINT_PATH_LENGTH),
-    m_sourceUnit(owner), m_navMesh(NULL), m_navMeshQuery(NULL)
+    m_sourceUnit(owner), m_navMesh(NULL), m_navMeshGeneration(0), m_navMeshQuery(NULL), m_polyCache(NULL),
+    m_sourceGuidLow(owner->GetGUIDLow()), m_mapId(owner->GetMapId()),
+    m_sourceIsCreature(owner->GetTypeId() == TYPEID_UNIT), m_canSwim(false), m_canFly(false), m_isLevitating(false),
+    m_liquidPrecalculated(false), m_startUnderWater(false), m_endUnderWater(false)
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceUnit->GetGUIDLow());
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceGuidLow);
 
-    uint32 mapId = m_sourceUnit->GetMapId();
-    if (MMAP::MMapFactory::IsPathfindingEnabled(mapId))
+    if (MMAP::MMapFactory::IsPathfindingEnabled(m_mapId))
     {
         MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-        m_navMesh = mmap->GetNavMesh(mapId);
-        m_navMeshQuery = mmap->GetNavMeshQuery(mapId, m_sourceUnit->GetInstanceId());
+        m_navMesh = mmap->GetNavMesh(m_mapId);
+        m_navMeshGeneration = mmap->GetNavMeshGeneration(m_mapId);
+        m_navMeshQuery = mmap->GetNavMeshQuery(m_mapId, m_sourceUnit->GetInstanceId());
     }
 
     createFilter();
@@ -45,12 +66,19 @@ PathFinder::PathFinder(const Unit* owner) :
 
 PathFinder::~PathFinder()
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceUnit->GetGUIDLow());
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceGuidLow);
 }
 
 bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest)
 {
-    Vector3 oldDest = getEndPosition();
+    if (prepare(destX, destY, destZ, forceDest))
+        calculateOnMesh(m_navMeshQuery);
+
+    return true;
+}
+
+bool PathFinder::prepare(float destX, float destY, float destZ, bool forceDest, bool async)
+{
     Vector3 dest(destX, destY, destZ);
     setEndPosition(dest);
 
@@ -61,27 +89,64 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
 
     m_forceDestination = forceDest;
 
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceUnit->GetGUIDLow());
+    // owner state used by path building, it must not be accessed by pathfinding thread
+    if (m_sourceIsCreature)
+    {
+        Creature* creature = (Creature*)m_sourceUnit;
+        m_canSwim = creature->CanSwim();
+        m_canFly = creature->CanFly();
+        m_isLevitating = creature->IsLevitating();
+    }
+
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::prepare() for %u \n", m_sourceGuidLow);
 
     // make sure navMesh works - we can run on map w/o mmap
-    // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
-    if (!m_navMesh || !m_navMeshQuery || m_sourceUnit->hasUnitState(UNIT_STAT_IGNORE_PATHFINDING) ||
-        !HaveTile(start) || !HaveTile(dest) || (m_sourceUnit->GetTypeId() == TYPEID_UNIT && ((Creature*)m_sourceUnit)->IsLevitating()))
+    if (!m_navMesh || !m_navMeshQuery || m_sourceUnit->hasUnitState(UNIT_STAT_IGNORE_PATHFINDING) || m_isLevitating)
     {
         BuildShortcut();
         m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
-        return true;
+        return false;
     }
 
     updateFilter();
 
+    // terrain grids can be unloaded by map thread, so liquid checks of path built by pathfinding thread are done here.
+    // Liquid status only changes the result for swimming or flying creatures
+    m_liquidPrecalculated = async;
+    m_startUnderWater = false;
+    m_endUnderWater = false;
+    if (async && (m_canSwim || m_canFly))
     {
-        ReadGuard Guard(MMAP::MMapFactory::createOrGetMMapManager()->GetLock(m_sourceUnit->GetMapId()));
-        BuildPolyPath(start, dest);
+        TerrainInfo const* terrain = m_sourceUnit->GetTerrain();
+        m_startUnderWater = terrain->IsUnderWater(start.x, start.y, start.z);
+        m_endUnderWater = terrain->IsUnderWater(dest.x, dest.y, dest.z);
     }
+
     return true;
 }
 
+void PathFinder::calculateOnMesh(dtNavMeshQuery const* navMeshQuery, PathPolyCache* polyCache)
+{
+    ReadGuard Guard(MMAP::MMapFactory::createOrGetMMapManager()->GetLock(m_mapId));
+
+    // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
+    if (!HaveTile(m_startPosition) || !HaveTile(m_endPosition))
+    {
+        BuildShortcut();
+        m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+        return;
+    }
+
+    dtNavMeshQuery const* ownQuery = m_navMeshQuery;
+    m_navMeshQuery = navMeshQuery;
+    m_polyCache = polyCache;
+
+    BuildPolyPath(m_startPosition, m_endPosition);
+
+    m_navMeshQuery = ownQuery;
+    m_polyCache = NULL;
+}
+
 dtPolyRef PathFinder::getPathPolyByPosition(const dtPolyRef *polyPath, uint32 polyPathSize, const float* point, float *distance) const
 {
     if (!polyPath || !polyPathSize)
@@ -169,13 +234,13 @@ void PathFinder::BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos)
         BuildShortcut();
 
         // Check for swimming or flying shortcut
-        if (m_sourceUnit->GetTypeId() == TYPEID_UNIT)
+        if (m_sourceIsCreature)
         {
-            if ((startPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsUnderWater(startPos.x, startPos.y, startPos.z)) ||
-                    (endPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsUnderWater(endPos.x, endPos.y, endPos.z)))
-                m_type = ((Creature*)m_sourceUnit)->CanSwim() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+            if ((startPoly == INVALID_POLYREF && isUnderWater(startPos, m_startUnderWater)) ||
+                    (endPoly == INVALID_POLYREF && isUnderWater(endPos, m_endUnderWater)))
+                m_type = m_canSwim ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
             else
-                m_type = ((Creature*)m_sourceUnit)->CanFly() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+                m_type = m_canFly ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
         }
         else
             m_type = PATHFIND_NOPATH;
@@ -190,21 +255,19 @@ void PathFinder::BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos)
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: farFromPoly distToStartPoly=%.3f distToEndPoly=%.3f\n", distToStartPoly, distToEndPoly);
 
         bool buildShotrcut = false;
-        if (m_sourceUnit->GetTypeId() == TYPEID_UNIT)
+        if (m_sourceIsCreature)
         {
-            Creature* owner = (Creature*)m_sourceUnit;
-
-            Vector3 p = (distToStartPoly > 7.0f) ? startPos : endPos;
-            if (m_sourceUnit->GetTerrain()->IsUnderWater(p.x, p.y, p.z))
+            bool underWater = (distToStartPoly > 7.0f) ? isUnderWater(startPos, m_startUnderWater) : isUnderWater(endPos, m_endUnderWater);
+            if (underWater)
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: underWater case\n");
-                if (owner->CanSwim())
+                if (m_canSwim)
                     buildShotrcut = true;
             }
             else
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: flying case\n");
-                if (owner->IsLevitating())
+                if (m_isLevitating)
                     buildShotrcut = true;
             }
         }
@@ -258,7 +321,9 @@ void PathFinder::BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos)
         for (pathStartIndex = 0; pathStartIndex < m_polyLength; ++pathStartIndex)
         {
             // here to catch few bugs
-            MANGOS_ASSERT(m_pathPolyRefs[pathStartIndex] != INVALID_POLYREF || m_sourceUnit->PrintEntryError("PathFinder::BuildPolyPath"));
+            if (m_pathPolyRefs[pathStartIndex] == INVALID_POLYREF)
+                sLog.outError("PathFinder::BuildPolyPath: invalid poly in old path of %u, map %u", m_sourceGuidLow, m_mapId);
+            MANGOS_ASSERT(m_pathPolyRefs[pathStartIndex] != INVALID_POLYREF);
 
             if (m_pathPolyRefs[pathStartIndex] == startPoly)
             {
@@ -341,7 +406,7 @@ void PathFinder::BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos)
             // this is probably an error state, but we'll leave it
             // and hopefully recover on the next Update
             // we still need to copy our preffix
-            sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
+            sLog.outError("%u's Path Build failed: 0 length path", m_sourceGuidLow);
         }
 
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n",m_polyLength, prefixPolyLength, suffixPolyLength);
@@ -360,20 +425,28 @@ void PathFinder::BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos)
         // free and invalidate old path data
         clear();
 
-        dtStatus dtResult = m_navMeshQuery->findPath(
-                startPoly,          // start polygon
-                endPoly,            // end polygon
-                startPoint,         // start position
-                endPoint,           // end position
-                &m_filter,           // polygon search filter
-                m_pathPolyRefs,     // [out] path
-                (int*)&m_polyLength,
-                MAX_PATH_LENGTH);   // max number of polygons in output path
+        // units chasing same target from same polygon in one batch of path requests share the poly path
+        dtStatus dtResult = DT_SUCCESS;
+        if (!m_polyCache || !m_polyCache->Find(startPoly, endPoly, m_filter, m_pathPolyRefs, m_polyLength))
+        {
+            dtResult = m_navMeshQuery->findPath(
+                    startPoly,          // start polygon
+                    endPoly,            // end polygon
+                    startPoint,         // start position
+                    endPoint,           // end position
+                    &m_filter,           // polygon search filter
+                    m_pathPolyRefs,     // [out] path
+                    (int*)&m_polyLength,
+                    MAX_PATH_LENGTH);   // max number of polygons in output path
+
+            if (m_polyCache && m_polyLength && dtResult == DT_SUCCESS)
+                m_polyCache->Add(startPoly, endPoly, m_filter, m_pathPolyRefs, m_polyLength);
+        }
 
         if (!m_polyLength || dtResult != DT_SUCCESS)
         {
             // only happens if we passed bad data to findPath(), or navmesh is messed up
-            sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
+            sLog.outError("%u's Path Build failed: 0 length path", m_sourceGuidLow);
             BuildShortcut();
             m_type = PATHFIND_NOPATH;
             return;
@@ -559,6 +632,15 @@ void PathFinder::updateFilter()
     }
 }
 
+bool PathFinder::isUnderWater(const Vector3& p, bool precalculated) const
+{
+    // path calculated by owner's thread checks terrain only when it is needed
+    if (m_liquidPrecalculated)
+        return precalculated;
+
+    return m_sourceUnit->GetTerrain()->IsUnderWater(p.x, p.y, p.z);
+}
+
 NavTerrain PathFinder::getNavTerrain(float x, float y, float z)
 {
     GridMapLiquidData data;
@@ -57,6 +57,48 @@ enum PathType
     PATHFIND_NOT_USING_PATH = 0x0010    // used when we are either flying/swiming or on map w/o mmaps
 };
 
+// Poly paths found by one pathfinding thread in a batch of path requests,
+// units chasing same target from same polygon use the poly path found for first of them
+class PathPolyCache
+{
+    public:
+        PathPolyCache() : m_hits(0) {}
+
+        bool Find(dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter, dtPolyRef* path, uint32& pathLength);
+        void Add(dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter, dtPolyRef const* path, uint32 pathLength);
+
+        void Clear() { m_paths.clear(); }
+        uint32 GetHits() const { return m_hits; }
+
+    private:
+        struct PolyPathKey
+        {
+            PolyPathKey(dtPolyRef start, dtPolyRef end, dtQueryFilter const& filter)
+                : startPoly(start), endPoly(end), includeFlags(filter.getIncludeFlags()), excludeFlags(filter.getExcludeFlags()) {}
+
+            bool operator< (PolyPathKey const& other) const
+            {
+                if (startPoly != other.startPoly)
+                    return startPoly < other.startPoly;
+                if (endPoly != other.endPoly)
+                    return endPoly < other.endPoly;
+                if (includeFlags != other.includeFlags)
+                    return includeFlags < other.includeFlags;
+                return excludeFlags < other.excludeFlags;
+            }
+
+            dtPolyRef startPoly;
+            dtPolyRef endPoly;
+            uint16 includeFlags;
+            uint16 excludeFlags;
+        };
+
+        typedef std::map<PolyPathKey, std::vector<dtPolyRef> > PolyPathMap;
+
+        PolyPathMap m_paths;
+        uint32 m_hits;
+};
+
 class PathFinder
 {
     public:
@@ -67,6 +109,17 @@ class PathFinder
         // return: true if new path was calculated, false otherwise (no change needed)
         bool calculate(float destX, float destY, float destZ, bool forceDest = false);
 
+        // Same calculation split for pathfinding threads: prepare is called by owner's map thread and
+        // returns true if the path must be found on navmesh, calculateOnMesh can be called by any thread
+        // with its own navmesh query, it doesn't access the owner. Path of async request (calculated by
+        // pathfinding thread) gets liquid status of its start and end here, otherwise it is checked when needed
+        bool prepare(float destX, float destY, float destZ, bool forceDest = false, bool async = false);
+        void calculateOnMesh(dtNavMeshQuery const* navMeshQuery, PathPolyCache* polyCache = NULL);
+
+        uint32 getMapId() const { return m_mapId; }
+        dtNavMesh const* getNavMesh() const { return m_navMesh; }
+        uint32 getNavMeshGeneration() const { return m_navMeshGeneration; }
+
         // option setters - use optional
         void setUseStrightPath(bool useStraightPath) { m_useStraightPath = useStraightPath; };
         void setPathLengthLimit(float distance) { m_pointPathLimit = std::min<uint32>(uint32(distance/SMOOTH_PATH_STEP_SIZE), MAX_POINT_PATH_LENGTH); };
@@ -97,7 +150,20 @@ class PathFinder
 
         const Unit* const       m_sourceUnit;       // the unit that is moving
         const dtNavMesh*        m_navMesh;          // the nav mesh
+        uint32                  m_navMeshGeneration; // identifies the nav mesh, its address can be reused after unload
         const dtNavMeshQuery*   m_navMeshQuery;     // the nav mesh query used to find the path
+        PathPolyCache*          m_polyCache;        // poly paths shared by requests calculated together
+
+        // owner data read by path building, copied so path can be calculated without owner
+        uint32                  m_sourceGuidLow;
+        uint32                  m_mapId;
+        bool                    m_sourceIsCreature;
+        bool                    m_canSwim;
+        bool                    m_canFly;
+        bool                    m_isLevitating;
+        bool                    m_liquidPrecalculated;
+        bool                    m_startUnderWater;  // liquid status of start/end position, found by prepare of async request
+        bool                    m_endUnderWater;
 
         dtQueryFilter m_filter;                     // use single filter for all movements, update it when needed
 
@@ -118,6 +184,7 @@ class PathFinder
         dtPolyRef getPathPolyByPosition(const dtPolyRef *polyPath, uint32 polyPathSize, const float* point, float *distance = NULL) const;
         dtPolyRef getPolyByLocation(const float* point, float *distance) const;
         bool HaveTile(const Vector3 &p) const;
+        bool isUnderWater(const Vector3& p, bool precalculated) const;
 
         void BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos);
         void BuildPointPath(const float *startPoint, const float *endPoint);
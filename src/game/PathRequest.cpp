@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PathRequest.h"
+#include "Map.h"
+#include "Unit.h"
+#include "Log.h"
+#include <ace/Guard_T.h>
+
+// navmesh query of pathfinding thread uses same node pool size as queries of map instances
+#define PATH_REQUEST_QUERY_NODES    1024
+// requests taken by thread at once, small enough to keep other threads busy
+#define PATH_REQUEST_BATCH_SIZE     64
+
+PathRequest::PathRequest(uint32 id, Unit* owner, PathFinder* path) :
+    m_queueNext(NULL), m_id(id), m_ownerGuid(owner->GetObjectGuid()), m_map(owner->GetMap()), m_path(path)
+{
+}
+
+PathRequest::~PathRequest()
+{
+    delete m_path;
+}
+
+// requests of same map moving to same point are calculated one after another, so they can share poly paths
+struct PathRequestBatchOrder
+{
+    bool operator() (PathRequest const* left, PathRequest const* right) const
+    {
+        PathFinder const* leftPath = left->GetPath();
+        PathFinder const* rightPath = right->GetPath();
+
+        if (leftPath->getNavMesh() != rightPath->getNavMesh())
+            return leftPath->getNavMesh() < rightPath->getNavMesh();
+
+        Vector3 leftEnd = leftPath->getEndPosition();
+        Vector3 rightEnd = rightPath->getEndPosition();
+        if (leftEnd.x != rightEnd.x)
+            return leftEnd.x < rightEnd.x;
+        if (leftEnd.y != rightEnd.y)
+            return leftEnd.y < rightEnd.y;
+        return leftEnd.z < rightEnd.z;
+    }
+};
+
+PathRequestProcessor::PathRequestProcessor() : m_queueCond(m_lock), m_threads(0), m_stop(false)
+{
+}
+
+PathRequestProcessor::~PathRequestProcessor()
+{
+    Stop();
+}
+
+void PathRequestProcessor::Start(uint32 threads)
+{
+    if (m_threads || !threads)
+        return;
+
+    m_stop = false;
+    if (activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, int(threads)) == -1)
+    {
+        sLog.outError("PathRequestProcessor: can't start %u threads, paths will be calculated by map threads", threads);
+        return;
+    }
+
+    m_threads = threads;
+}
+
+void PathRequestProcessor::Stop()
+{
+    if (!m_threads)
+        return;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_stop = true;
+        m_queueCond.broadcast();
+    }
+
+    wait();
+
+    // not calculated requests are returned to maps, their movement generators ask for new paths later
+    for (RequestQueue::const_iterator itr = m_queue.begin(); itr != m_queue.end(); ++itr)
+        Complete(*itr);
+    m_queue.clear();
+
+    m_threads = 0;
+}
+
+void PathRequestProcessor::Queue(PathRequest* request)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_queue.push_back(request);
+    ++m_stats.queued;
+    m_queueCond.signal();
+}
+
+PathRequestProcessorStatistics PathRequestProcessor::GetStatistics()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, m_stats);
+    return m_stats;
+}
+
+// navmesh of a map is freed when its terrain is unloaded (and reloaded later), map waits for its requests
+// in progress before. So query of pathfinding thread is kept per map and replaced when navmesh generation changes
+struct NavMeshQueryEntry
+{
+    NavMeshQueryEntry() : generation(0), query(NULL) {}
+
+    uint32 generation;
+    dtNavMeshQuery* query;
+};
+
+void PathRequestProcessor::Complete(PathRequest* request)
+{
+    request->GetMap()->PathRequestCalculated(request);
+}
+
+int PathRequestProcessor::svc()
+{
+    typedef UNORDERED_MAP<uint32, NavMeshQueryEntry> NavMeshQueryMap;
+    NavMeshQueryMap queries;
+
+    PathPolyCache polyCache;
+    RequestBatch batch;
+
+    while (true)
+    {
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+            while (m_queue.empty() && !m_stop)
+                m_queueCond.wait();
+
+            if (m_stop)
+                break;
+
+            size_t count = std::min<size_t>(m_queue.size(), PATH_REQUEST_BATCH_SIZE);
+            batch.assign(m_queue.begin(), m_queue.begin() + count);
+            m_queue.erase(m_queue.begin(), m_queue.begin() + count);
+        }
+
+        std::sort(batch.begin(), batch.end(), PathRequestBatchOrder());
+
+        uint32 calculated = 0;
+        uint32 sharedBefore = polyCache.GetHits();
+
+        for (RequestBatch::const_iterator itr = batch.begin(); itr != batch.end(); ++itr)
+        {
+            PathRequest* request = *itr;
+            PathFinder* path = request->GetPath();
+            NavMeshQueryEntry& entry = queries[path->getMapId()];
+            if (entry.generation != path->getNavMeshGeneration())
+            {
+                dtFreeNavMeshQuery(entry.query);
+                entry.query = NULL;
+                entry.generation = path->getNavMeshGeneration();
+            }
+
+            dtNavMeshQuery*& query = entry.query;
+            if (!query)
+            {
+                query = dtAllocNavMeshQuery();
+                if (!query || DT_SUCCESS != query->init(path->getNavMesh(), PATH_REQUEST_QUERY_NODES))
+                {
+                    sLog.outError("PathRequestProcessor: failed to initialize dtNavMeshQuery for mapId %03u", path->getMapId());
+                    dtFreeNavMeshQuery(query);
+                    query = NULL;
+                }
+            }
+
+            if (query)
+            {
+                path->calculateOnMesh(query, &polyCache);
+                ++calculated;
+            }
+
+            Complete(request);
+        }
+
+        polyCache.Clear();
+        batch.clear();
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+        m_stats.calculated += calculated;
+        m_stats.sharedPolyPaths += polyCache.GetHits() - sharedBefore;
+    }
+
+    for (NavMeshQueryMap::const_iterator itr = queries.begin(); itr != queries.end(); ++itr)
+        dtFreeNavMeshQuery(itr->second.query);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PATH_REQUEST_H
+#define MANGOS_PATH_REQUEST_H
+
+#include "Common.h"
+#include "ObjectGuid.h"
+#include "PathFinder.h"
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+
+class Map;
+class Unit;
+
+// Prepared path of one unit, calculated on navmesh by pathfinding thread.
+// Created and deleted by map of the owner, calculated path is given to owner's current movement generator,
+// which takes it if request id is the one it waits for.
+class MANGOS_DLL_SPEC PathRequest
+{
+    public:
+        PathRequest(uint32 id, Unit* owner, PathFinder* path);
+        ~PathRequest();
+
+        uint32 GetId() const { return m_id; }
+        ObjectGuid const& GetOwnerGuid() const { return m_ownerGuid; }
+        Map* GetMap() const { return m_map; }
+        PathFinder* GetPath() const { return m_path; }
+
+        // path is given to movement generator, it is not deleted with request
+        PathFinder* ReleasePath() { PathFinder* path = m_path; m_path = NULL; return path; }
+
+        PathRequest* m_queueNext;                           // used by map calculated paths queue
+
+    private:
+        uint32 m_id;
+        ObjectGuid m_ownerGuid;
+        Map* m_map;
+        PathFinder* m_path;
+};
+
+struct PathRequestProcessorStatistics
+{
+    PathRequestProcessorStatistics() : queued(0), calculated(0), sharedPolyPaths(0) {}
+
+    uint32 queued;                                          // requests queued by map threads
+    uint32 calculated;                                      // paths calculated by pathfinding threads
+    uint32 sharedPolyPaths;                                 // poly paths taken from other request of same batch
+};
+
+// Background threads which calculate paths on navmesh, each thread has own navmesh query for every map.
+// Queued requests are taken in batches, requests of units moving to the same target share found poly paths.
+// Calculated requests are returned to map, which gives them to owners at next update.
+class MANGOS_DLL_DECL PathRequestProcessor : protected ACE_Task_Base
+{
+    public:
+        PathRequestProcessor();
+        virtual ~PathRequestProcessor();
+
+        void Start(uint32 threads);
+        void Stop();
+        bool IsEnabled() const { return m_threads > 0; }
+
+        void Queue(PathRequest* request);
+
+        PathRequestProcessorStatistics GetStatistics();
+
+        virtual int svc();
+
+    private:
+        typedef std::deque<PathRequest*> RequestQueue;      // oldest requests first
+        typedef std::vector<PathRequest*> RequestBatch;
+
+        static void Complete(PathRequest* request);
+
+        ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_queueCond;
+        RequestQueue m_queue;
+        uint32 m_threads;
+        bool m_stop;
+
+        PathRequestProcessorStatistics m_stats;
+};
+#endif
@@ -358,6 +358,9 @@ void Pet::SavePetToDB(PetSaveMode mode)
     if (!pOwner)
         return;
 
+    // written in order with owner saves
+    SqlAsyncPartition partition(CharacterDatabase, pOwner->GetSession()->GetAccountId());
+
     // current/stable/not_in_slot
     if (mode >= PET_SAVE_AS_CURRENT)
     {
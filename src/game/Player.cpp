@@ -476,6 +476,7 @@ Player::Player (WorldSession *session): Unit(), m_mover(this), m_camera(NULL), m
     m_deathExpireTime = 0;
 
     m_lastWSUpdateTime = 0; // == 0 in initialise, for review all updates
+    m_lastWSUpdateVersion = 0;
 
     m_swingErrorMsg = 0;
 
@@ -4233,6 +4234,8 @@ void Player::DeleteFromDB(ObjectGuid playerguid, uint32 accountId, bool updateRe
 
     uint32 lowguid = playerguid.GetCounter();
 
+    SqlAsyncPartition partition(CharacterDatabase, accountId);
+
     // convert corpse to bones if exist (to prevent exiting Corpse in World without DB entry)
     // bones will be deleted by corpse/bones deleting thread shortly
     sObjectAccessor.ConvertCorpseForPlayer(playerguid);
@@ -8774,7 +8777,10 @@ void Player::SendUpdatedWorldStates(bool force)
     if (IsBeingTeleported() || GetLastWorldStateUpdateTime() == time(NULL))
         return;
 
-    if (WorldStateSet* wsSet = sWorldStateMgr.GetUpdatedWorldStatesFor(this, force ? 0 : GetLastWorldStateUpdateTime()))
+    // states, renewed while collecting, will be sent at next sync
+    uint64 version = WorldState::GetLastVersion();
+
+    if (WorldStateSet* wsSet = sWorldStateMgr.GetUpdatedWorldStatesFor(this, force ? 0 : GetLastWorldStateUpdateVersion()))
     {
         for (uint8 i = 0; i < wsSet->count(); ++i)
         {
@@ -8786,6 +8792,7 @@ void Player::SendUpdatedWorldStates(bool force)
     }
 
     SetLastWorldStateUpdateTime(time(NULL));
+    SetLastWorldStateUpdateVersion(version);
 }
 
 void Player::SendInitWorldStates(uint32 zoneid, uint32 areaid)
@@ -17648,6 +17655,9 @@ void Player::SaveToDB()
     DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     outDebugStatsValues();
 
+    // saves of different accounts can be written in parallel, saves of one account keep their order
+    SqlAsyncPartition partition(CharacterDatabase, GetSession()->GetAccountId());
+
     CharacterDatabase.BeginTransaction();
 
     static SqlStatementID delChar ;
@@ -19356,7 +19366,7 @@ void Player::HandleStealthedUnitsDetection()
             {
                 ObjectGuid i_guid = (*i)->GetObjectGuid();
                 (*i)->SendCreateUpdateToPlayer(this);
-                AddClientGuid(i_guid);
+                AddClientGuid(*i);
 
                 DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "%s is detected in stealth by player %u. Distance = %f",i_guid.GetString().c_str(),GetGUIDLow(),GetDistance(*i));
 
@@ -19371,7 +19381,7 @@ void Player::HandleStealthedUnitsDetection()
             if (hasAtClient)
             {
                 (*i)->DestroyForPlayer(this);
-                RemoveClientGuid((*i)->GetObjectGuid());
+                RemoveClientGuid(*i);
             }
         }
     }
@@ -20436,16 +20446,29 @@ bool Player::HaveAtClient(ObjectGuid const& guid) const
             HasClientGuid(guid);
 }
 
-void Player::AddClientGuid(ObjectGuid const& guid)
+void Player::AddClientGuid(WorldObject* target)
+{
+    MAPLOCK_WRITE(this,MAP_LOCK_TYPE_MAPOBJECTS);
+    m_clientGUIDs.insert(target->GetObjectGuid());
+    target->AddObservedBy(GetObjectGuid());
+}
+
+void Player::RemoveClientGuid(WorldObject* target)
 {
     MAPLOCK_WRITE(this,MAP_LOCK_TYPE_MAPOBJECTS);
-    m_clientGUIDs.insert(guid);
+    m_clientGUIDs.erase(target->GetObjectGuid());
+    target->RemoveObservedBy(GetObjectGuid());
 }
 
 void Player::RemoveClientGuid(ObjectGuid const& guid)
 {
+    // object can be already removed from map, then it not have observers anymore
+    WorldObject* target = GetMap() ? GetMap()->GetWorldObject(guid) : NULL;
+
     MAPLOCK_WRITE(this,MAP_LOCK_TYPE_MAPOBJECTS);
     m_clientGUIDs.erase(guid);
+    if (target)
+        target->RemoveObservedBy(GetObjectGuid());
 }
 
 bool Player::HasClientGuid(ObjectGuid const& guid) const
@@ -20483,7 +20506,7 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
             else
                 target->DestroyForPlayer(this);
 
-            RemoveClientGuid(t_guid);
+            RemoveClientGuid(target);
 
             DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "Player::UpdateVisibilityOf (by viewPoint) %s out of range for %s, distance = %f",t_guid.GetString().c_str(),GetObjectGuid().GetString().c_str(), GetDistance(target));
         }
@@ -20495,7 +20518,7 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
             if (!GetMap()->IsVisibleGlobally(target->GetObjectGuid()))
             {
                 target->SendCreateUpdateToPlayer(this);
-                AddClientGuid(target->GetObjectGuid());
+                AddClientGuid(target);
 
                 DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "Player::UpdateVisibilityOf (by viewPoint) %s is visible now for %s, distance = %f", target->GetObjectGuid().GetString().c_str(), GetObjectGuid().GetString().c_str(), GetDistance(target));
 
@@ -20519,7 +20542,7 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
             ObjectGuid t_guid = target->GetObjectGuid();
 
             target->BuildOutOfRangeUpdateBlock(&data);
-            RemoveClientGuid(t_guid);
+            RemoveClientGuid(target);
 
             DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "Player::UpdateVisibilityOf %s is out of range for %s, distance = %f", t_guid.GetString().c_str(), GetGuidStr().c_str(), GetDistance(target));
         }
@@ -20530,7 +20553,7 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
         {
             visibleNow.insert(target);
             target->BuildCreateUpdateBlockForPlayer(&data, this);
-            AddClientGuid(target->GetObjectGuid());
+            AddClientGuid(target);
 
             DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "Player::UpdateVisibilityOf %s is visible now for %s, distance = %f", target->GetGuidStr().c_str(), GetGuidStr().c_str(), GetDistance(target));
         }
@@ -2051,6 +2051,8 @@ class MANGOS_DLL_SPEC Player : public Unit
         void SendUpdatedWorldStates(bool force = false);
         time_t const& GetLastWorldStateUpdateTime() { return m_lastWSUpdateTime; };
         void SetLastWorldStateUpdateTime(time_t _time)   { m_lastWSUpdateTime = _time; };
+        uint64 const& GetLastWorldStateUpdateVersion() { return m_lastWSUpdateVersion; };
+        void SetLastWorldStateUpdateVersion(uint64 version) { m_lastWSUpdateVersion = version; };
 
         void SendDirectMessage(WorldPacket *data);
 
@@ -2269,7 +2271,8 @@ class MANGOS_DLL_SPEC Player : public Unit
         // list of currently visible objects, stored at player client
         GuidSet const& GetClientGuids() { return m_clientGUIDs; };
         bool HaveAtClient(ObjectGuid const& guid) const;
-        void AddClientGuid(ObjectGuid const& guid);
+        void AddClientGuid(WorldObject* target);
+        void RemoveClientGuid(WorldObject* target);
         void RemoveClientGuid(ObjectGuid const& guid);
         bool HasClientGuid(ObjectGuid const& guid) const;
 
@@ -2618,6 +2621,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         time_t m_deathExpireTime;
 
         time_t m_lastWSUpdateTime;
+        uint64 m_lastWSUpdateVersion;
 
         uint32 m_restTime;
 
@@ -652,6 +652,16 @@ void Aura::Update(uint32 diff)
     }
 }
 
+void Aura::SetPeriodic(bool periodic)
+{
+    m_isPeriodic = periodic;
+
+    // holder may be skipped in target aura updates before become periodic
+    if (periodic)
+        if (Unit* target = GetTarget())
+            target->AuraUpdateListChanged();
+}
+
 void Aura::AreaAuraUpdate(uint32 diff)
 {
     // update for the caster of the aura
@@ -2455,7 +2465,7 @@ void Aura::HandleAuraDummy(bool apply, bool Real)
                         return;
                     case 7057:                              // Haunting Spirits
                         // expected to tick with 30 sec period (tick part see in Aura::PeriodicTick)
-                        m_isPeriodic = true;
+                        SetPeriodic(true);
                         m_modifier.periodictime = 30*IN_MILLISECONDS;
                         m_periodicTimer = m_modifier.periodictime;
                         return;
@@ -6093,7 +6103,7 @@ void Aura::HandleAuraModStalked(bool apply, bool /*Real*/)
 
 void Aura::HandlePeriodicTriggerSpell(bool apply, bool /*Real*/)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 
     Unit *target = GetTarget();
 
@@ -6254,7 +6264,7 @@ void Aura::HandlePeriodicTriggerSpell(bool apply, bool /*Real*/)
 
 void Aura::HandlePeriodicTriggerSpellWithValue(bool apply, bool /*Real*/)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandlePeriodicEnergize(bool apply, bool Real)
@@ -6316,12 +6326,12 @@ void Aura::HandlePeriodicEnergize(bool apply, bool Real)
         }
     }
 
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandleAuraPowerBurn(bool apply, bool /*Real*/)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandleAuraPeriodicDummy(bool apply, bool Real)
@@ -6506,12 +6516,12 @@ void Aura::HandleAuraPeriodicDummy(bool apply, bool Real)
         }
     }
 
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandlePeriodicHeal(bool apply, bool /*Real*/)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 
     Unit *target = GetTarget();
 
@@ -6580,7 +6590,7 @@ void Aura::HandlePeriodicHeal(bool apply, bool /*Real*/)
 
 void Aura::HandleDamagePercentTaken(bool apply, bool Real)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 
     Unit* target = GetTarget();
 
@@ -6612,7 +6622,7 @@ void Aura::HandlePeriodicDamage(bool apply, bool Real)
     if (!Real)
         return;
 
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 
     Unit *target = GetTarget();
     SpellEntry const* spellProto = GetSpellProto();
@@ -6815,12 +6825,12 @@ void Aura::HandlePeriodicDamage(bool apply, bool Real)
 
 void Aura::HandlePeriodicDamagePCT(bool apply, bool /*Real*/)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandlePeriodicLeech(bool apply, bool /*Real*/)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 
     // For prevent double apply bonuses
     bool loading = (GetTarget()->GetTypeId() == TYPEID_PLAYER && ((Player*)GetTarget())->GetSession()->PlayerLoading());
@@ -6844,12 +6854,12 @@ void Aura::HandlePeriodicLeech(bool apply, bool /*Real*/)
 
 void Aura::HandlePeriodicManaLeech(bool apply, bool /*Real*/)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandlePeriodicHealthFunnel(bool apply, bool /*Real*/)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 
     // For prevent double apply bonuses
     bool loading = (GetTarget()->GetTypeId() == TYPEID_PLAYER && ((Player*)GetTarget())->GetSession()->PlayerLoading());
@@ -7115,7 +7125,7 @@ void Aura::HandleAuraModResistenceOfStatPercent(bool /*apply*/, bool /*Real*/)
 /********************************/
 void Aura::HandleAuraModTotalHealthPercentRegen(bool apply, bool /*Real*/)
 {
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandleAuraModTotalManaPercentRegen(bool apply, bool /*Real*/)
@@ -7124,7 +7134,7 @@ void Aura::HandleAuraModTotalManaPercentRegen(bool apply, bool /*Real*/)
         m_modifier.periodictime = 1000;
 
     m_periodicTimer = m_modifier.periodictime;
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandleModRegen(bool apply, bool /*Real*/)        // eating
@@ -7133,7 +7143,7 @@ void Aura::HandleModRegen(bool apply, bool /*Real*/)        // eating
         m_modifier.periodictime = 5000;
 
     m_periodicTimer = 5000;
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandleModPowerRegen(bool apply, bool Real)       // drinking
@@ -7158,7 +7168,7 @@ void Aura::HandleModPowerRegen(bool apply, bool Real)       // drinking
     if (GetTarget()->GetTypeId() == TYPEID_PLAYER && m_modifier.m_miscvalue == POWER_MANA)
         ((Player*)GetTarget())->UpdateManaRegen();
 
-    m_isPeriodic = apply;
+    SetPeriodic(apply);
 }
 
 void Aura::HandleModPowerRegenPCT(bool /*apply*/, bool Real)
@@ -12561,6 +12571,48 @@ bool SpellAuraHolder::IsEmptyHolder() const
     return true;
 }
 
+bool SpellAuraHolder::IsNeedUpdate() const
+{
+    // timed holders counted down and expired in updates
+    if (!(IsPermanent() || IsPassive()) || m_duration > 0)
+        return true;
+
+    // Channeled aura required check distance from caster
+    if (IsChanneledSpell(m_spellProto) && m_target && GetCasterGuid() != m_target->GetObjectGuid())
+        return true;
+
+    for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+    {
+        Aura const* aura = GetAura(SpellEffectIndex(i));
+        if (!aura)
+            continue;
+
+        if (aura->IsPeriodic() || aura->GetAuraClassType() != AURA_CLASS_AURA)
+            return true;
+
+        // auras checked in Aura::PeriodicCheck
+        switch (aura->GetModifier()->m_auraname)
+        {
+            case SPELL_AURA_MOD_CONFUSE:
+            case SPELL_AURA_MOD_FEAR:
+            case SPELL_AURA_MOD_STUN:
+            case SPELL_AURA_MOD_ROOT:
+            case SPELL_AURA_TRANSFORM:
+                return true;
+            default:
+                break;
+        }
+    }
+
+    return false;
+}
+
+void SpellAuraHolder::UpdateStateChanged()
+{
+    if (m_target)
+        m_target->AuraUpdateListChanged();
+}
+
 void SpellAuraHolder::UnregisterAndCleanupTrackedAuras()
 {
     TrackedAuraType trackedType = GetTrackedAuraType();
@@ -111,7 +111,13 @@ class MANGOS_DLL_SPEC SpellAuraHolder
         void SetAffectiveCasterGuid(ObjectGuid guid);
 
         bool IsPermanent() const { return m_permanent; }
-        void SetPermanent(bool permanent) { m_permanent = permanent; }
+        void SetPermanent(bool permanent)
+        {
+            if (m_permanent == permanent)
+                return;
+            m_permanent = permanent;
+            UpdateStateChanged();
+        }
         bool IsPassive() const { return m_isPassive; }
         bool IsDeathPersistent() const { return m_isDeathPersist; }
         bool IsPersistent() const;
@@ -122,6 +128,7 @@ class MANGOS_DLL_SPEC SpellAuraHolder
         bool IsRemovedOnShapeLost() const { return m_isRemovedOnShapeLost; }
         bool IsDeleted() const { return m_deleted;}
         bool IsEmptyHolder() const;
+        bool IsNeedUpdate() const;                          // false for passive and permanent holders without timed effects
 
         void SetDeleted() { m_deleted = true; }
 
@@ -136,7 +143,13 @@ class MANGOS_DLL_SPEC SpellAuraHolder
         int32 GetAuraMaxDuration() const { return m_maxDuration; }
         void SetAuraMaxDuration(int32 duration);
         int32 GetAuraDuration() const { return m_duration; }
-        void SetAuraDuration(int32 duration) { m_duration = duration; }
+        void SetAuraDuration(int32 duration)
+        {
+            // permanent holder with duration must be counted down
+            if (duration > 0 && m_duration <= 0)
+                UpdateStateChanged();
+            m_duration = duration;
+        }
 
         uint8 GetAuraSlot() const { return m_auraSlot; }
         void SetAuraSlot(uint8 slot) { m_auraSlot = slot; }
@@ -186,6 +199,7 @@ class MANGOS_DLL_SPEC SpellAuraHolder
 
     private:
         void AddAura(Aura const& aura, SpellEffectIndex index);
+        void UpdateStateChanged();
 
         SpellEntry const* m_spellProto;
 
@@ -458,6 +472,7 @@ class MANGOS_DLL_SPEC Aura
         bool IsPersistent() const { return m_isPersistent; }
         bool IsAreaAura() const { return m_isAreaAura; }
         bool IsPeriodic() const { return m_isPeriodic; }
+        void SetPeriodic(bool periodic);
         bool IsStacking() const { return m_stacking;}
 
         void ApplyModifier(bool apply, bool Real = false);
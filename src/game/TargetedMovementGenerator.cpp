@@ -23,9 +23,13 @@
 #include "CreatureAI.h"
 #include "Player.h"
 #include "World.h"
+#include "MapManager.h"
+#include "PathRequest.h"
 #include "movement/MoveSplineInit.h"
 #include "movement/MoveSpline.h"
 
+#define PATH_REQUEST_MAX_WAIT_TIME 1000
+
 //-----------------------------------------------//
 template<class T, typename D>
 void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T& owner, bool updateDestination)
@@ -102,13 +106,50 @@ void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T& owner, bool up
     // allow pets following their master to cheat while generating paths
     bool forceDest = (owner.GetTypeId() == TYPEID_UNIT && ((Creature*)&owner)->IsPet()
                       && owner.hasUnitState(UNIT_STAT_FOLLOW));
-    i_path->calculate(x, y, z, forceDest);
+
+    if (sMapMgr.GetPathRequestProcessor()->IsEnabled())
+    {
+        // previous spline is kept until pending path is calculated, new destination is checked after it.
+        // Request could be lost if owner left the map, so after some time it is not waited for
+        if (i_pathRequestId && WorldTimer::getMSTimeDiff(i_pathRequestTime, WorldTimer::getMSTime()) < PATH_REQUEST_MAX_WAIT_TIME)
+            return;
+
+        PathFinder* path = new PathFinder(*i_path);
+        if (path->prepare(x, y, z, forceDest, true))
+        {
+            i_pathRequestId = owner.GetMap()->QueuePathRequest(&owner, path);
+            i_pathRequestTime = WorldTimer::getMSTime();
+            return;
+        }
+
+        // path without navmesh is ready at once
+        _cancelPathRequest();
+        delete i_path;
+        i_path = path;
+    }
+    else
+        i_path->calculate(x, y, z, forceDest);
+
+    _moveByPath(owner);
+}
+
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T, D>::_moveByPath(T& owner)
+{
+    // path could be calculated by pathfinding thread, so recheck what could change meantime
+    if (!i_target.isValid() || !i_target->IsInWorld())
+        return;
+
+    if (owner.hasUnitState(UNIT_STAT_NOT_MOVE))
+        return;
+
     if (i_path->getPathType() & PATHFIND_NOPATH)
     {
+        G3D::Vector3 end = i_path->getEndPosition();
         DEBUG_FILTER_LOG(LOG_FILTER_AI_AND_MOVEGENSS,"TargetedMovementGeneratorMedium::  unit %s cannot find path to %s (%f, %f, %f),  gained PATHFIND_NOPATH! Owerride used.",
             owner.GetObjectGuid().GetString().c_str(),
             i_target.isValid() ? i_target->GetObjectGuid().GetString().c_str() : "<none>",
-            x,y,z);
+            end.x, end.y, end.z);
         //return;
     }
 
@@ -122,6 +163,20 @@ void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T& owner, bool up
     init.Launch();
 }
 
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T, D>::OnPathCalculated(Unit& owner, PathRequest* request)
+{
+    if (!i_pathRequestId || request->GetId() != i_pathRequestId)
+        return;
+
+    i_pathRequestId = 0;
+
+    delete i_path;
+    i_path = request->ReleasePath();
+
+    _moveByPath(static_cast<T&>(owner));
+}
+
 #define RECHECK_DISTANCE_TIMER 50
 #define TARGET_NOT_ACCESSIBLE_MAX_TIMER 5000
 
@@ -273,12 +328,14 @@ void ChaseMovementGenerator<Creature>::Initialize(Creature& owner)
 template<class T>
 void ChaseMovementGenerator<T>::Finalize(T& owner)
 {
+    this->_cancelPathRequest();
     owner.clearUnitState(UNIT_STAT_CHASE | UNIT_STAT_CHASE_MOVE);
 }
 
 template<class T>
 void ChaseMovementGenerator<T>::Interrupt(T& owner)
 {
+    this->_cancelPathRequest();
     owner.InterruptMoving();
     owner.clearUnitState(UNIT_STAT_CHASE | UNIT_STAT_CHASE_MOVE);
 }
@@ -335,6 +392,7 @@ void FollowMovementGenerator<Creature>::Initialize(Creature& owner)
 template<class T>
 void FollowMovementGenerator<T>::Finalize(T& owner)
 {
+    this->_cancelPathRequest();
     owner.clearUnitState(UNIT_STAT_FOLLOW | UNIT_STAT_FOLLOW_MOVE);
     _updateSpeed(owner);
 }
@@ -342,6 +400,7 @@ void FollowMovementGenerator<T>::Finalize(T& owner)
 template<class T>
 void FollowMovementGenerator<T>::Interrupt(T& owner)
 {
+    this->_cancelPathRequest();
     owner.InterruptMoving();
     owner.clearUnitState(UNIT_STAT_FOLLOW | UNIT_STAT_FOLLOW_MOVE);
     _updateSpeed(owner);
@@ -362,6 +421,10 @@ template bool TargetedMovementGeneratorMedium<Player, ChaseMovementGenerator<Pla
 template bool TargetedMovementGeneratorMedium<Player, FollowMovementGenerator<Player> >::Update(Player&, const uint32&);
 template bool TargetedMovementGeneratorMedium<Creature, ChaseMovementGenerator<Creature> >::Update(Creature&, const uint32&);
 template bool TargetedMovementGeneratorMedium<Creature, FollowMovementGenerator<Creature> >::Update(Creature&, const uint32&);
+template void TargetedMovementGeneratorMedium<Player, ChaseMovementGenerator<Player> >::OnPathCalculated(Unit&, PathRequest*);
+template void TargetedMovementGeneratorMedium<Player, FollowMovementGenerator<Player> >::OnPathCalculated(Unit&, PathRequest*);
+template void TargetedMovementGeneratorMedium<Creature, ChaseMovementGenerator<Creature> >::OnPathCalculated(Unit&, PathRequest*);
+template void TargetedMovementGeneratorMedium<Creature, FollowMovementGenerator<Creature> >::OnPathCalculated(Unit&, PathRequest*);
 
 template void ChaseMovementGenerator<Player>::_reachTarget(Player&);
 template void ChaseMovementGenerator<Creature>::_reachTarget(Creature&);
@@ -45,7 +45,7 @@ class MANGOS_DLL_SPEC TargetedMovementGeneratorMedium
             i_recheckDistance(0), i_targetSearchingTimer(0),
             i_offset(offset), i_angle(angle),
             m_speedChanged(false), i_targetReached(false),
-            i_path(NULL)
+            i_path(NULL), i_pathRequestId(0), i_pathRequestTime(0)
         {
         }
         virtual ~TargetedMovementGeneratorMedium() { delete i_path; }
@@ -53,6 +53,9 @@ class MANGOS_DLL_SPEC TargetedMovementGeneratorMedium
     public:
         bool Update(T &, const uint32 &);
 
+        // path calculated by pathfinding thread replaces current one, unit kept its previous spline meantime
+        void OnPathCalculated(Unit& owner, PathRequest* request);
+
         bool IsReachable() const
         {
             return (i_path) ? (i_path->getPathType() & PATHFIND_NORMAL) : true;
@@ -65,6 +68,10 @@ class MANGOS_DLL_SPEC TargetedMovementGeneratorMedium
 
     protected:
         void _setTargetLocation(T&, bool updateDestination);
+        void _moveByPath(T&);
+
+        // path of forgotten request is dropped when it comes back
+        void _cancelPathRequest() { i_pathRequestId = 0; }
 
         ShortTimeTracker i_recheckDistance;
         uint32 i_targetSearchingTimer;
@@ -74,6 +81,8 @@ class MANGOS_DLL_SPEC TargetedMovementGeneratorMedium
         bool i_targetReached : 1;
 
         PathFinder* i_path;
+        uint32 i_pathRequestId;                             // not 0 while path is calculated by pathfinding thread
+        uint32 i_pathRequestTime;
 };
 
 template<class T>
@@ -198,6 +198,8 @@ Unit::Unit() :
     m_HostileRefManager(new HostileRefManager(this)),
     m_stateMgr(this)
 {
+    m_auraUpdateListChanged = false;
+
     m_objectType |= TYPEMASK_UNIT;
     m_objectTypeId = TYPEID_UNIT;
 
@@ -323,6 +325,7 @@ Unit::~Unit()
         MAPLOCK_WRITE(this, MAP_LOCK_TYPE_DEFAULT);
         MAPLOCK_WRITE1(this, MAP_LOCK_TYPE_AURAS);
 #endif
+        m_auraUpdateList.clear();
         CleanupDeletedHolders(true);
 
         delete m_charmInfo;
@@ -4166,40 +4169,38 @@ void Unit::_UpdateSpells( uint32 time )
             m_currentSpells[i] = NULL;                      // remove pointer
         }
     }
-    std::queue<SpellAuraHolderPtr> updateQueue;
-    // update auras
+    // rebuild list of holders for update only after holders set changed,
+    // passive and permanent holders without timed effects not updated at all
+    if (m_auraUpdateListChanged)
     {
         MAPLOCK_READ(this,MAP_LOCK_TYPE_AURAS);
+        m_auraUpdateListChanged = false;
+        m_auraUpdateList.clear();
         for (SpellAuraHolderMap::const_iterator itr = m_spellAuraHolders.begin(); itr != m_spellAuraHolders.end(); ++itr)
-            if (itr->second && !itr->second->IsDeleted())
-                updateQueue.push(itr->second);
-
+            if (itr->second && !itr->second->IsDeleted() && itr->second->IsNeedUpdate())
+                m_auraUpdateList.push_back(itr->second);
     }
 
-    while(!updateQueue.empty())
+    // update auras, collect expired in same pass
+    SpellAuraHolderList expiredHolders;
+    for (size_t i = 0; i < m_auraUpdateList.size(); ++i)
     {
-        if (updateQueue.front() && !updateQueue.front()->IsDeleted())
-            updateQueue.front()->UpdateHolder(time);
-        updateQueue.pop();
-    }
+        SpellAuraHolder* holder = m_auraUpdateList[i].get();
+        if (!holder || holder->IsDeleted())
+            continue;
 
-    // remove expired auras, cleanup empty holders
-    {
-        MAPLOCK_READ(this,MAP_LOCK_TYPE_AURAS);
-        for (SpellAuraHolderMap::const_iterator itr = m_spellAuraHolders.begin(); itr != m_spellAuraHolders.end(); ++itr)
-            if (itr->second && !itr->second->IsDeleted()
-                && !(itr->second->IsPermanent() || itr->second->IsPassive())
-                && ((itr->second->GetAuraDuration() == 0) || itr->second->IsEmptyHolder()))
-                updateQueue.push(itr->second);
-    }
+        holder->UpdateHolder(time);
 
-    while(!updateQueue.empty())
-    {
-        if (updateQueue.front() && !updateQueue.front()->IsDeleted())
-            RemoveSpellAuraHolder(updateQueue.front(), AURA_REMOVE_BY_EXPIRE);
-        updateQueue.pop();
+        if (!holder->IsDeleted() && !(holder->IsPermanent() || holder->IsPassive())
+            && ((holder->GetAuraDuration() == 0) || holder->IsEmptyHolder()))
+            expiredHolders.push_back(m_auraUpdateList[i]);
     }
 
+    // remove expired auras, cleanup empty holders
+    for (SpellAuraHolderList::const_iterator itr = expiredHolders.begin(); itr != expiredHolders.end(); ++itr)
+        if (!(*itr)->IsDeleted())
+            RemoveSpellAuraHolder(*itr, AURA_REMOVE_BY_EXPIRE);
+
     if(!m_gameObj.empty())
     {
         GameObjectList::iterator ite1, dnext1;
@@ -5175,6 +5176,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolderPtr holder)
         holder->_AddSpellAuraHolder();
         MAPLOCK_WRITE(this,MAP_LOCK_TYPE_AURAS);
         m_spellAuraHolders.insert(SpellAuraHolderMap::value_type(holder->GetId(), holder));
+        m_auraUpdateListChanged = true;
     }
 
     for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
@@ -5917,6 +5919,7 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolderPtr holder, AuraRemoveMode mode)
             if (itr->second == holder)
             {
                 m_spellAuraHolders.erase(itr);
+                m_auraUpdateListChanged = true;
                 break;
             }
         }
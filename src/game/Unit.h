@@ -1304,6 +1304,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         typedef std::pair<SpellAuraHolderMap::iterator, SpellAuraHolderMap::iterator> SpellAuraHolderBounds;
         typedef std::pair<SpellAuraHolderMap::const_iterator, SpellAuraHolderMap::const_iterator> SpellAuraHolderConstBounds;
         typedef std::queue<SpellAuraHolderPtr> SpellAuraHolderQueue;
+        typedef std::vector<SpellAuraHolderPtr> SpellAuraHolderList;
         typedef std::list<AuraPair> AuraList;
         typedef std::list<DiminishingReturn> Diminishing;
         typedef UNORDERED_SET<ObjectGuid> ComboPointHolderSet;
@@ -1769,6 +1770,9 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
 
         bool AddSpellAuraHolderToRemoveList(SpellAuraHolderPtr holder);
 
+        // holders list for update must be rebuilt at next spells update
+        void AuraUpdateListChanged() { m_auraUpdateListChanged = true; }
+
         // removing specific aura stacks by diff reasons and selections
         void RemoveAurasDueToSpell(uint32 spellId, SpellAuraHolderPtr except = SpellAuraHolderPtr(NULL), AuraRemoveMode mode = AURA_REMOVE_BY_DEFAULT);
         void RemoveAurasDueToItemSpell(Item* castItem, uint32 spellId);
@@ -2275,6 +2279,8 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
 
         SpellAuraHolderMap m_spellAuraHolders;
         SpellAuraHolderQueue m_deletedHolders;
+        SpellAuraHolderList m_auraUpdateList;               // holders with timers, updated in _UpdateSpells
+        bool m_auraUpdateListChanged;
 
         // Store Auras for which the target must be tracked
         TrackedAuraTargetMap m_trackedAuraTargets[MAX_TRACKED_AURA_TYPES];
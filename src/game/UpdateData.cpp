@@ -25,6 +25,8 @@
 #include "World.h"
 #include "ObjectGuid.h"
 #include <zlib/zlib.h>
+#include <ace/TSS_T.h>
+#include <ace/Atomic_Op.h>
 
 UpdateData::UpdateData() : m_blockCount(0)
 {
@@ -46,43 +48,114 @@ void UpdateData::AddUpdateBlock(const ByteBuffer &block)
     ++m_blockCount;
 }
 
-void UpdateData::Compress(void* dst, uint32 *dst_size, void* src, int src_size)
+// zlib stream of current thread, reset for each packet instead of init/end
+struct UpdateDataCompressor
+{
+    UpdateDataCompressor() : initialized(false), level(0), deadline(0) {}
+    ~UpdateDataCompressor()
+    {
+        if (initialized)
+            deflateEnd(&stream);
+    }
+
+    z_stream stream;
+    bool initialized;
+    int level;
+    uint64 deadline;                                        // end of current map update tick budget, 0 if none
+};
+
+static ACE_TSS<UpdateDataCompressor> s_compressor;
+
+// 64 bit counters, long is 32 bit on Windows and byte counts overflow it in days
+static ACE_Atomic_Op<ACE_Thread_Mutex, uint64> s_compressedPackets;
+static ACE_Atomic_Op<ACE_Thread_Mutex, uint64> s_compressedFastPackets;
+static ACE_Atomic_Op<ACE_Thread_Mutex, uint64> s_compressedSrcBytes;
+static ACE_Atomic_Op<ACE_Thread_Mutex, uint64> s_compressedDstBytes;
+static ACE_Atomic_Op<ACE_Thread_Mutex, uint64> s_compressTime;
+
+void UpdateData::SetCompressionDeadline(uint64 deadline)
+{
+    s_compressor->deadline = deadline;
+}
+
+uint64 UpdateData::GetCompressionDeadline()
 {
-    z_stream c_stream;
+    return s_compressor->deadline;
+}
 
-    c_stream.zalloc = (alloc_func)0;
-    c_stream.zfree = (free_func)0;
-    c_stream.opaque = (voidpf)0;
+void UpdateData::GetCompressionStatistics(UpdateDataCompressionStatistics& stats)
+{
+    stats.packets = s_compressedPackets.value();
+    stats.fastPackets = s_compressedFastPackets.value();
+    stats.srcBytes = s_compressedSrcBytes.value();
+    stats.dstBytes = s_compressedDstBytes.value();
+    stats.time = s_compressTime.value();
+}
 
+int UpdateData::SelectCompressionLevel(int src_size, uint64 deadline)
+{
     // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
+    int level = int(sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
+    if (level == Z_BEST_SPEED || !sWorld.getConfig(CONFIG_BOOL_COMPRESSION_ADAPTIVE))
+        return level;
+
+    // big bursts (login, teleport) and updates sent after map used its tick time are compressed fastest
+    if (uint32(src_size) >= sWorld.getConfig(CONFIG_UINT32_COMPRESSION_LARGE_PACKET_SIZE) ||
+        (deadline && WorldTimer::getMicroTime() > deadline))
+        return Z_BEST_SPEED;
+
+    return level;
+}
+
+void UpdateData::Compress(void* dst, uint32 *dst_size, void* src, int src_size)
+{
+    uint64 startTime = WorldTimer::getMicroTime();
+
+    UpdateDataCompressor* compressor = s_compressor.ts_object();
+    z_stream& c_stream = compressor->stream;
+    int level = SelectCompressionLevel(src_size, compressor->deadline);
+
+    int z_res;
+    if (!compressor->initialized)
     {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)",z_res,zError(z_res));
-        *dst_size = 0;
-        return;
+        c_stream.zalloc = (alloc_func)0;
+        c_stream.zfree = (free_func)0;
+        c_stream.opaque = (voidpf)0;
+
+        z_res = deflateInit(&c_stream, level);
+        if (z_res != Z_OK)
+        {
+            sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)",z_res,zError(z_res));
+            *dst_size = 0;
+            return;
+        }
+
+        compressor->initialized = true;
     }
+    else
+    {
+        z_res = deflateReset(&c_stream);
+        if (z_res == Z_OK && level != compressor->level)
+            z_res = deflateParams(&c_stream, level, Z_DEFAULT_STRATEGY);
+
+        if (z_res != Z_OK)
+        {
+            sLog.outError("Can't compress update packet (zlib: deflateReset) Error code: %i (%s)",z_res,zError(z_res));
+            deflateEnd(&c_stream);
+            compressor->initialized = false;
+            *dst_size = 0;
+            return;
+        }
+    }
+
+    compressor->level = level;
 
     c_stream.next_out = (Bytef*)dst;
     c_stream.avail_out = *dst_size;
     c_stream.next_in = (Bytef*)src;
     c_stream.avail_in = (uInt)src_size;
 
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)",z_res,zError(z_res));
-        *dst_size = 0;
-        return;
-    }
-
-    if (c_stream.avail_in != 0)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflate not greedy)");
-        *dst_size = 0;
-        return;
-    }
-
+    // output buffer is compressBound() sized, so all data is compressed by one call
     z_res = deflate(&c_stream, Z_FINISH);
     if (z_res != Z_STREAM_END)
     {
@@ -91,15 +164,14 @@ void UpdateData::Compress(void* dst, uint32 *dst_size, void* src, int src_size)
         return;
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)",z_res,zError(z_res));
-        *dst_size = 0;
-        return;
-    }
-
     *dst_size = c_stream.total_out;
+
+    ++s_compressedPackets;
+    if (level == Z_BEST_SPEED && level != int(sWorld.getConfig(CONFIG_UINT32_COMPRESSION)))
+        ++s_compressedFastPackets;
+    s_compressedSrcBytes += uint64(src_size);
+    s_compressedDstBytes += uint64(c_stream.total_out);
+    s_compressTime += WorldTimer::getMicroTime() - startTime;
 }
 
 bool UpdateData::BuildPacket(WorldPacket *packet)
@@ -49,11 +49,25 @@ enum ObjectUpdateFlags
     UPDATEFLAG_ROTATION             = 0x0200
 };
 
+struct UpdateDataCompressionStatistics
+{
+    uint64 packets;
+    uint64 fastPackets;                                     // compressed with lowered level by adaptive policy
+    uint64 srcBytes;
+    uint64 dstBytes;
+    uint64 time;                                            // in microseconds
+};
+
 class UpdateData
 {
     public:
         UpdateData();
 
+        // compression of packets built by current thread is adapted to this time (WorldTimer::getMicroTime), 0 to disable
+        static void SetCompressionDeadline(uint64 deadline);
+        static uint64 GetCompressionDeadline();
+        static void GetCompressionStatistics(UpdateDataCompressionStatistics& stats);
+
         void AddOutOfRangeGUID(GuidSet& guids);
         void AddOutOfRangeGUID(ObjectGuid const &guid);
         void AddUpdateBlock(const ByteBuffer &block);
@@ -69,5 +83,6 @@ class UpdateData
         ByteBuffer m_data;
 
         void Compress(void* dst, uint32 *dst_size, void* src, int src_size);
+        static int SelectCompressionLevel(int src_size, uint64 deadline);
 };
 #endif
@@ -21,6 +21,11 @@
 
 #include "UpdateFields.h"
 #include "Errors.h"
+#include "Utilities/ByteConverter.h"
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
 
 class UpdateMask
 {
@@ -49,6 +54,34 @@ class UpdateMask
             return (((uint8*)m_UpdateMask)[index >> 3] & (1 << (index & 0x7))) != 0;
         }
 
+        // bits of 32 fields block, bit N is field (block * 32 + N) at any byte order
+        uint32 GetBlock(uint32 block) const
+        {
+            uint32 bits = m_UpdateMask[block];
+            EndianConvert(bits);
+            return bits;
+        }
+
+        // number of lowest not set bits, bits must be not 0
+        static uint32 CountTrailingZeros(uint32 bits)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, bits);
+            return index;
+#elif defined(__GNUC__)
+            return __builtin_ctz(bits);
+#else
+            uint32 count = 0;
+            while (!(bits & 1))
+            {
+                bits >>= 1;
+                ++count;
+            }
+            return count;
+#endif
+        }
+
         uint32 GetBlockCount() const { return m_Blocks; }
         uint32 GetLength() const { return m_Blocks << 2; }
         uint32 GetCount() const { return m_Count; }
@@ -42,6 +42,7 @@
 #include "Chat.h"
 #include "DBCStores.h"
 #include "MassMailMgr.h"
+#include "PacketReplay.h"
 #include "LootMgr.h"
 #include "ItemEnchantmentMgr.h"
 #include "MapManager.h"
@@ -69,6 +70,7 @@
 #include "CreatureLinkingMgr.h"
 #include "LFGMgr.h"
 #include "warden/WardenDataStorage.h"
+#include "WorldLoadGraph.h"
 
 INSTANTIATE_SINGLETON_1( World );
 
@@ -147,6 +149,7 @@ World::~World()
 /// Cleanups before world stop
 void World::CleanupsBeforeStop()
 {
+    sPacketReplayMgr.Stop();                         // replay characters have no sessions in session map
     KickAll();                                       // save and kick all players
     UpdateSessions(1);                               // real players unload required UpdateSessions call
     sBattleGroundMgr.DeleteAllBattleGrounds();       // unload battleground templates before different singletons destroyed
@@ -563,6 +566,8 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_ANTICHEAT_WARDEN,              "Anticheat.Warden", false);
 
     setConfigMinMax(CONFIG_UINT32_COMPRESSION, "Compression", 1, 1, 9);
+    setConfig(CONFIG_BOOL_COMPRESSION_ADAPTIVE, "Compression.Adaptive", false);
+    setConfigMin(CONFIG_UINT32_COMPRESSION_LARGE_PACKET_SIZE, "Compression.Adaptive.LargePacketSize", 16384, 100);
     setConfig(CONFIG_BOOL_ADDON_CHANNEL, "AddonChannel", true);
     setConfig(CONFIG_BOOL_CLEAN_CHARACTER_DB, "CleanCharacterDB", true);
     setConfig(CONFIG_BOOL_GRID_UNLOAD, "GridUnload", true);
@@ -585,6 +590,16 @@ void World::LoadConfigSettings(bool reload)
     }
 #endif
 
+    setConfigMinMax(CONFIG_UINT32_LOADING_THREADS, "Loading.Threads", 1, 1, 16);
+
+#ifdef MANGOSR2_SINGLE_THREAD
+    if (getConfig(CONFIG_UINT32_LOADING_THREADS) > 1)
+    {
+        sLog.outError(" Your OS (%s) not support set Loading.Threads > 1! Resetted to 1", MANGOSR2_SINGLE_THREAD);
+        setConfig(CONFIG_UINT32_LOADING_THREADS, "fakeString", 1);
+    }
+#endif
+
     setConfigMinMax(CONFIG_FLOAT_LOADBALANCE_HIGHVALUE, "MapUpdate.LoadBalanceHighValue", 0.8f, 0.5f, 1.0f);
     setConfigMinMax(CONFIG_FLOAT_LOADBALANCE_LOWVALUE, "MapUpdate.LoadBalanceLowValue", 0.2f, 0.0f, 0.5f);
 
@@ -597,7 +612,36 @@ void World::LoadConfigSettings(bool reload)
 
     setConfigMinMax(CONFIG_UINT32_POSITION_UPDATE_DELAY, "MapUpdate.PositionUpdateDelay", 400, 100, 2000);
 
+    setConfig(CONFIG_BOOL_MAPUPDATE_PARALLEL_CELLS, "MapUpdate.ParallelCells.Enable", false);
+    setConfigMinMax(CONFIG_UINT32_MAPUPDATE_PARALLEL_CELLS_THREADS, "MapUpdate.ParallelCells.Threads", 2, 0, 16);
+    setConfig(CONFIG_BOOL_MAPUPDATE_PARALLEL_CELLS_CHECK, "MapUpdate.ParallelCells.CheckMode", false);
+    setConfig(CONFIG_BOOL_MAPUPDATE_OBJECT_POOLS, "MapUpdate.ObjectPools", false);
+
+    setConfigMinMax(CONFIG_UINT32_TERRAIN_LOAD_THREADS, "Terrain.LoadThreads", 0, 0, 8);
+
+#ifdef MANGOSR2_SINGLE_THREAD
+    if (getConfig(CONFIG_UINT32_TERRAIN_LOAD_THREADS) > 0)
+    {
+        sLog.outError(" Your OS (%s) not support set Terrain.LoadThreads > 0! Resetted to 0", MANGOSR2_SINGLE_THREAD);
+        setConfig(CONFIG_UINT32_TERRAIN_LOAD_THREADS, "fakeString", 0);
+    }
+#endif
+
+    setConfigMinMax(CONFIG_UINT32_TERRAIN_PREFETCH_TIME, "Terrain.PrefetchTime", 10, 0, 60);
+    setConfig(CONFIG_BOOL_TERRAIN_MAPPED_FILES, "Terrain.MappedFiles", false);
+
     setConfigMinMax(CONFIG_UINT32_OBJECTLOADINGSPLITTER_ALLOWEDTIME, "ObjectLoadingSplitter.MaxAllowedTime", 10, 5, 1000);
+    setConfigMinMax(CONFIG_UINT32_OBJECT_PREPARE_THREADS, "ObjectLoadingSplitter.PrepareThreads", 0, 0, 8);
+
+#ifdef MANGOSR2_SINGLE_THREAD
+    if (getConfig(CONFIG_UINT32_OBJECT_PREPARE_THREADS) > 0)
+    {
+        sLog.outError(" Your OS (%s) not support set ObjectLoadingSplitter.PrepareThreads > 0! Resetted to 0", MANGOSR2_SINGLE_THREAD);
+        setConfig(CONFIG_UINT32_OBJECT_PREPARE_THREADS, "fakeString", 0);
+    }
+#endif
+
+    setConfigMinMax(CONFIG_UINT32_OBJECT_WARMUP_TIME, "ObjectLoadingSplitter.WarmupTime", 0, 0, 60);
 
     setConfig(CONFIG_UINT32_INTERVAL_CHANGEWEATHER, "ChangeWeatherInterval", 10 * MINUTE * IN_MILLISECONDS);
 
@@ -926,6 +970,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_ALLOW_FLIGHT_ON_OLD_MAPS, "AllowFlightOnOldMaps", false);
 
     setConfig(CONFIG_BOOL_DYNAMIC_VMAP_DOUBLE_CHECK,"vmap.Dynamic.DoubleCheck", false);
+    setConfigMinMax(CONFIG_UINT32_VMAP_QUERY_CACHE_SIZE, "vmap.QueryCache.Size", 0, 0, 1024 * 1024);
 
     m_relocation_ai_notify_delay = sConfig.GetIntDefault("Visibility.AIRelocationNotifyDelay", 1000u);
     m_relocation_lower_limit     = sConfig.GetFloatDefault("Visibility.RelocationLowerLimit", 10.0f);
@@ -1042,6 +1087,16 @@ void World::LoadConfigSettings(bool reload)
     MMAP::MMapFactory::preventPathfindingOnMaps(ignoreMapIds.c_str());
     sLog.outString("WORLD: mmap pathfinding %sabled", getConfig(CONFIG_BOOL_MMAP_ENABLED) ? "en" : "dis");
 
+    setConfigMinMax(CONFIG_UINT32_PATHFINDING_THREADS, "mmap.pathfindingThreads", 0, 0, 8);
+
+#ifdef MANGOSR2_SINGLE_THREAD
+    if (getConfig(CONFIG_UINT32_PATHFINDING_THREADS) > 0)
+    {
+        sLog.outError(" Your OS (%s) not support set mmap.pathfindingThreads > 0! Resetted to 0", MANGOSR2_SINGLE_THREAD);
+        setConfig(CONFIG_UINT32_PATHFINDING_THREADS, "fakeString", 0);
+    }
+#endif
+
     // reset duel system
     setConfig(CONFIG_BOOL_RESET_DUEL_AREA_ENABLED, "DuelReset.Enable", false);
     std::string areaIdsEnabledDuel = sConfig.GetStringDefault("DuelReset.AreaIds", "");
@@ -1122,329 +1177,434 @@ void World::LoadConfigSettings(bool reload)
 extern void LoadGameObjectModelList();
 
 /// Initialize the World
-void World::SetInitialWorldSettings()
+/// Startup loading steps of World::SetInitialWorldSettings
+static void LoadStepPageTexts()
 {
-    ///- Initialize the random number generator
-    srand((unsigned int)time(NULL));
-
-    ///- Time server startup
-    uint32 uStartTime = WorldTimer::getMSTime();
-
-    ///- Initialize detour memory management
-    dtAllocSetCustom(dtCustomAlloc, dtCustomFree);
-
-    ///- Initialize config settings
-    LoadConfigSettings();
-
-    ///- Check the existence of the map files for all races start areas.
-    if (!MapManager::ExistMapAndVMap(0,-6240.32f, 331.033f) ||
-        !MapManager::ExistMapAndVMap(0,-8949.95f,-132.493f) ||
-        !MapManager::ExistMapAndVMap(0,-8949.95f,-132.493f) ||
-        !MapManager::ExistMapAndVMap(1,-618.518f,-4251.67f) ||
-        !MapManager::ExistMapAndVMap(0, 1676.35f, 1677.45f) ||
-        !MapManager::ExistMapAndVMap(1, 10311.3f, 832.463f) ||
-        !MapManager::ExistMapAndVMap(1,-2917.58f,-257.98f) ||
-        (m_configUint32Values[CONFIG_UINT32_EXPANSION] >= EXPANSION_TBC &&
-        (!MapManager::ExistMapAndVMap(530,10349.6f,-6357.29f) || !MapManager::ExistMapAndVMap(530,-3961.64f,-13931.2f))) ||
-        (m_configUint32Values[CONFIG_UINT32_EXPANSION] >= EXPANSION_WOTLK &&
-        !MapManager::ExistMapAndVMap(609,2355.84f,-5664.77f)))
-    {
-        sLog.outError("Correct *.map files not found in path '%smaps' or *.vmtree/*.vmtile files in '%svmaps'. Please place *.map and vmap files in appropriate directories or correct the DataDir value in the mangosd.conf file.",m_dataPath.c_str(),m_dataPath.c_str());
-        Log::WaitBeforeContinueIfNeed();
-        exit(1);
-    }
-
-    ///- Loading strings. Getting no records means core load has to be canceled because no error message can be output.
-    sLog.outString();
-    sLog.outString("Loading MaNGOS strings...");
-    if (!sObjectMgr.LoadMangosStrings())
-    {
-        Log::WaitBeforeContinueIfNeed();
-        exit(1);                                            // Error message displayed in function already
-    }
-
-    ///- Update the realm entry in the database with the realm type from the config file
-    //No SQL injection as values are treated as integers
-
-    // not send custom type REALM_FFA_PVP to realm list
-    uint32 server_type = IsFFAPvPRealm() ? REALM_TYPE_PVP : getConfig(CONFIG_UINT32_GAME_TYPE);
-    uint32 realm_zone = getConfig(CONFIG_UINT32_REALM_ZONE);
-    LoginDatabase.PExecute("UPDATE realmlist SET icon = %u, timezone = %u WHERE id = '%u'", server_type, realm_zone, getConfig(CONFIG_UINT32_REALMID));
-
-    ///- Remove the bones (they should not exist in DB though) and old corpses after a restart
-    CharacterDatabase.PExecute("DELETE FROM corpse WHERE corpse_type = '0' OR time < (UNIX_TIMESTAMP()-'%u')", 3*DAY);
-
-    ///- Load the DBC files
-    sLog.outString("Initialize data stores...");
-    LoadDBCStores(m_dataPath);
-    DetectDBCLang();
-    sObjectMgr.SetDBCLocaleIndex(GetDefaultDbcLocale());    // Get once for all the locale index of DBC language (console/broadcasts)
-
-    sLog.outString("Loading opcodes for realm (client build %u)...",CLIENT_VERSION);
-    sObjectMgr.LoadOpcodes();
-
-    sLog.outString("Loading GameObject models...");
-    LoadGameObjectModelList();
-
-    sLog.outString( "Loading SpellDbc..." );
-    sSpellMgr.LoadSpellDbc();
-
-    sLog.outString( "Loading SpellTemplate..." );
-    sObjectMgr.LoadSpellTemplate();
-
-    sLog.outString( "Loading Script Names...");
-    sScriptMgr.LoadScriptNames();
-
-    sLog.outString( "Loading WorldTemplate..." );
-    sObjectMgr.LoadWorldTemplate();
-
-    sLog.outString( "Loading InstanceTemplate..." );
-    sObjectMgr.LoadInstanceTemplate();
-
-    sLog.outString("Loading SkillLineAbilityMultiMap Data...");
-    sSpellMgr.LoadSkillLineAbilityMap();
-
-    sLog.outString("Loading SkillRaceClassInfoMultiMap Data...");
-    sSpellMgr.LoadSkillRaceClassInfoMap();
-
-    ///- Clean up and pack instances
-    sLog.outString( "Cleaning up instances..." );
-    sMapPersistentStateMgr.CleanupInstances();              // must be called before `creature_respawn`/`gameobject_respawn` tables
-
-    sLog.outString( "Packing instances..." );
-    sMapPersistentStateMgr.PackInstances();
-
-    sLog.outString( "Packing groups..." );
-    sObjectMgr.PackGroupIds();                              // must be after CleanupInstances
-
-    ///- Init highest guids before any guid using table loading to prevent using not initialized guids in some code.
-    sObjectMgr.SetHighestGuids();                           // must be after PackInstances() and PackGroupIds()
-    sLog.outString();
-
     sLog.outString( "Loading Page Texts..." );
     sObjectMgr.LoadPageTexts();
+}
 
-    sLog.outString( "Loading Game Object Templates..." );   // must be after LoadPageTexts
+static void LoadStepGameObjectTemplates()
+{
+    sLog.outString( "Loading Game Object Templates..." );
     sObjectMgr.LoadGameobjectInfo();
+}
 
+static void LoadStepSpellChains()
+{
     sLog.outString( "Loading Spell Chain Data..." );
     sSpellMgr.LoadSpellChains();
+}
 
+static void LoadStepSpellElixirs()
+{
     sLog.outString( "Loading Spell Elixir types..." );
     sSpellMgr.LoadSpellElixirs();
+}
 
+static void LoadStepSpellLearnSkills()
+{
     sLog.outString( "Loading Spell Learn Skills..." );
-    sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
+    sSpellMgr.LoadSpellLearnSkills();
+}
 
+static void LoadStepSpellLearnSpells()
+{
     sLog.outString( "Loading Spell Learn Spells..." );
     sSpellMgr.LoadSpellLearnSpells();
+}
 
+static void LoadStepSpellProcEvents()
+{
     sLog.outString( "Loading Spell Proc Event conditions..." );
     sSpellMgr.LoadSpellProcEvents();
+}
 
+static void LoadStepSpellBonuses()
+{
     sLog.outString( "Loading Spell Bonus Data..." );
-    sSpellMgr.LoadSpellBonuses();                           // must be after LoadSpellChains
+    sSpellMgr.LoadSpellBonuses();
+}
 
+static void LoadStepSpellProcItemEnchant()
+{
     sLog.outString( "Loading Spell Proc Item Enchant..." );
-    sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
+    sSpellMgr.LoadSpellProcItemEnchant();
+}
 
+static void LoadStepSpellLinked()
+{
     sLog.outString( "Loading Spell Linked definitions..." );
-    sSpellMgr.LoadSpellLinked();                            // must be after LoadSpellChains
+    sSpellMgr.LoadSpellLinked();
+}
 
+static void LoadStepSpellThreats()
+{
     sLog.outString( "Loading Aggro Spells Definitions...");
     sSpellMgr.LoadSpellThreats();
+}
 
+static void LoadStepGossipText()
+{
     sLog.outString( "Loading NPC Texts..." );
     sObjectMgr.LoadGossipText();
+}
 
+static void LoadStepRandomEnchantments()
+{
     sLog.outString( "Loading Item Random Enchantments Table..." );
     LoadRandomEnchantmentsTable();
+}
 
-    sLog.outString("Loading Items...");                     // must be after LoadRandomEnchantmentsTable and LoadPageTexts
+static void LoadStepItems()
+{
+    sLog.outString("Loading Items...");
     sObjectMgr.LoadItemPrototypes();
+}
 
-    sLog.outString("Loading Item converts...");             // must be after LoadItemPrototypes
+static void LoadStepItemConverts()
+{
+    sLog.outString("Loading Item converts...");
     sObjectMgr.LoadItemConverts();
+}
 
-    sLog.outString("Loading Item expire converts...");      // must be after LoadItemPrototypes
+static void LoadStepItemExpireConverts()
+{
+    sLog.outString("Loading Item expire converts...");
     sObjectMgr.LoadItemExpireConverts();
+}
 
+static void LoadStepCreatureModelInfo()
+{
     sLog.outString( "Loading Creature Model Based Info Data..." );
     sObjectMgr.LoadCreatureModelInfo();
+}
 
+static void LoadStepEquipmentTemplates()
+{
     sLog.outString( "Loading Equipment templates...");
     sObjectMgr.LoadEquipmentTemplates();
+}
 
-    // FIXME! currently spells must be loaded _before_ templates for correct detection.
+static void LoadStepCreatureSpells()
+{
     sLog.outString( "Loading Creature spells..." );
     sObjectMgr.LoadCreatureSpells();
+}
 
+static void LoadStepCreatureTemplates()
+{
     sLog.outString( "Loading Creature templates..." );
     sObjectMgr.LoadCreatureTemplates();
+}
 
-    sLog.outString( "Loading Creature Model for race..." ); // must be after creature templates
+static void LoadStepCreatureModelRace()
+{
+    sLog.outString( "Loading Creature Model for race..." );
     sObjectMgr.LoadCreatureModelRace();
+}
 
+static void LoadStepSpellScriptTarget()
+{
     sLog.outString( "Loading SpellsScriptTarget...");
-    sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates and LoadGameobjectInfo
+    sSpellMgr.LoadSpellScriptTarget();
+}
 
-    sLog.outString("Loading Vehicle Accessory...");         // must be after creature templates
+static void LoadStepVehicleAccessory()
+{
+    sLog.outString("Loading Vehicle Accessory...");
     sObjectMgr.LoadVehicleAccessory();
+}
 
+static void LoadStepItemRequiredTarget()
+{
     sLog.outString( "Loading ItemRequiredTarget...");
     sObjectMgr.LoadItemRequiredTarget();
+}
 
+static void LoadStepReputationRewardRate()
+{
     sLog.outString( "Loading Reputation Reward Rates...");
     sObjectMgr.LoadReputationRewardRate();
+}
 
+static void LoadStepReputationOnKill()
+{
     sLog.outString( "Loading Creature Reputation OnKill Data..." );
     sObjectMgr.LoadReputationOnKill();
+}
 
+static void LoadStepReputationSpillover()
+{
     sLog.outString( "Loading Reputation Spillover Data..." );
     sObjectMgr.LoadReputationSpilloverTemplate();
+}
 
+static void LoadStepPointsOfInterest()
+{
     sLog.outString( "Loading Points Of Interest Data..." );
     sObjectMgr.LoadPointsOfInterest();
+}
 
+static void LoadStepCreatures()
+{
     sLog.outString( "Loading Creature Data..." );
     sObjectMgr.LoadCreatures();
+}
 
+static void LoadStepPetLevelupSpells()
+{
     sLog.outString( "Loading pet levelup spells..." );
     sSpellMgr.LoadPetLevelupSpellMap();
+}
 
+static void LoadStepPetDefaultSpells()
+{
     sLog.outString( "Loading pet default spell additional to levelup spells..." );
     sSpellMgr.LoadPetDefaultSpells();
+}
 
+static void LoadStepCreatureAddons()
+{
     sLog.outString( "Loading Creature Addon Data..." );
     sLog.outString();
-    sObjectMgr.LoadCreatureAddons();                        // must be after LoadCreatureTemplates() and LoadCreatures()
+    sObjectMgr.LoadCreatureAddons();
     sLog.outString( ">>> Creature Addon Data loaded" );
     sLog.outString();
+}
 
+static void LoadStepGameObjects()
+{
     sLog.outString( "Loading Gameobject Data..." );
     sObjectMgr.LoadGameObjects();
+}
 
+static void LoadStepGameObjectAddons()
+{
     sLog.outString( "Loading Gameobject Addon Data..." );
     sObjectMgr.LoadGameObjectAddon();
+}
 
-    sLog.outString( "Loading CreatureLinking Data..." );    // must be after Creatures
+static void LoadStepCreatureLinking()
+{
+    sLog.outString( "Loading CreatureLinking Data..." );
     sCreatureLinkingMgr.LoadFromDB();
+}
 
+static void LoadStepPools()
+{
     sLog.outString( "Loading Objects Pooling Data...");
     sPoolMgr.LoadFromDB();
+}
 
+static void LoadStepWeather()
+{
     sLog.outString( "Loading Weather Data..." );
     sObjectMgr.LoadWeatherZoneChances();
+}
 
+static void LoadStepQuests()
+{
     sLog.outString( "Loading Quests..." );
-    sObjectMgr.LoadQuests();                                // must be loaded after DBCs, creature_template, item_template, gameobject tables
+    sObjectMgr.LoadQuests();
+
+    sLog.outString( "Loading Quest Area Triggers..." );
+    sObjectMgr.LoadQuestAreaTriggers();
+}
 
+static void LoadStepQuestPOI()
+{
     sLog.outString( "Loading Quest POI" );
     sObjectMgr.LoadQuestPOI();
+}
 
+static void LoadStepNPCSpellClickSpells()
+{
+    sLog.outString( "Loading UNIT_NPC_FLAG_SPELLCLICK Data..." );
+    sObjectMgr.LoadNPCSpellClickSpells();
+}
+
+static void LoadStepQuestRelations()
+{
     sLog.outString( "Loading Quests Relations..." );
     sLog.outString();
-    sObjectMgr.LoadQuestRelations();                        // must be after quest load
+    sObjectMgr.LoadQuestRelations();
     sLog.outString( ">>> Quests Relations loaded" );
     sLog.outString();
+}
 
-    sLog.outString( "Loading Game Event Data...");          // must be after sPoolMgr.LoadFromDB and quests to properly load pool events and quests for events
+static void LoadStepGameEvents()
+{
+    sLog.outString( "Loading Game Event Data...");
     sLog.outString();
     sGameEventMgr.LoadFromDB();
     sLog.outString( ">>> Game Event Data loaded" );
     sLog.outString();
+}
 
-    // Load Conditions
+static void LoadStepConditions()
+{
     sLog.outString( "Loading Conditions..." );
     sObjectMgr.LoadConditions();
+}
 
-    sLog.outString( "Creating map persistent states for non-instanceable maps..." );   // must be after PackInstances(), LoadCreatures(), sPoolMgr.LoadFromDB(), sGameEventMgr.LoadFromDB();
+static void LoadStepWorldMaps()
+{
+    sLog.outString( "Creating map persistent states for non-instanceable maps..." );
     sMapPersistentStateMgr.InitWorldMaps();
+}
 
-    sLog.outString( "Loading Creature Respawn Data..." );   // must be after LoadCreatures(), and sMapPersistentStateMgr.InitWorldMaps() , and PackInstances()
+static void LoadStepCreatureRespawn()
+{
+    sLog.outString( "Loading Creature Respawn Data..." );
     sMapPersistentStateMgr.LoadCreatureRespawnTimes();
+}
 
-    sLog.outString( "Loading Gameobject Respawn Data..." ); // must be after LoadGameObjects(), and sMapPersistentStateMgr.InitWorldMaps()
+static void LoadStepGameObjectRespawn()
+{
+    sLog.outString( "Loading Gameobject Respawn Data..." );
     sMapPersistentStateMgr.LoadGameobjectRespawnTimes();
+}
 
-    sLog.outString( "Loading UNIT_NPC_FLAG_SPELLCLICK Data..." );
-    sObjectMgr.LoadNPCSpellClickSpells();
-
-    sLog.outString( "Loading SpellArea Data..." );          // must be after quest load
+static void LoadStepSpellAreas()
+{
+    sLog.outString( "Loading SpellArea Data..." );
     sSpellMgr.LoadSpellAreas();
+}
 
+static void LoadStepAreaTriggerTeleports()
+{
     sLog.outString( "Loading AreaTrigger definitions..." );
-    sObjectMgr.LoadAreaTriggerTeleports();                  // must be after item template load
-
-    sLog.outString( "Loading Quest Area Triggers..." );
-    sObjectMgr.LoadQuestAreaTriggers();                     // must be after LoadQuests
+    sObjectMgr.LoadAreaTriggerTeleports();
+}
 
+static void LoadStepTavernAreaTriggers()
+{
     sLog.outString( "Loading Tavern Area Triggers..." );
     sObjectMgr.LoadTavernAreaTriggers();
+}
 
+static void LoadStepAreaTriggerScripts()
+{
     sLog.outString( "Loading AreaTrigger script names..." );
     sScriptMgr.LoadAreaTriggerScripts();
+}
 
+static void LoadStepEventIdScripts()
+{
     sLog.outString( "Loading event id script names..." );
     sScriptMgr.LoadEventIdScripts();
+}
 
+static void LoadStepGraveyardZones()
+{
     sLog.outString( "Loading Graveyard-zone links...");
     sObjectMgr.LoadGraveyardZones();
+}
 
+static void LoadStepSpellTargetPositions()
+{
     sLog.outString( "Loading spell target destination coordinates..." );
     sSpellMgr.LoadSpellTargetPositions();
+}
 
+static void LoadStepSpellPetAuras()
+{
     sLog.outString( "Loading spell pet auras..." );
     sSpellMgr.LoadSpellPetAuras();
+}
 
+static void LoadStepPlayerInfo()
+{
     sLog.outString( "Loading Player Create Info & Level Stats..." );
     sLog.outString();
     sObjectMgr.LoadPlayerInfo();
     sLog.outString( ">>> Player Create Info & Level Stats loaded" );
     sLog.outString();
+}
 
+static void LoadStepExplorationBaseXP()
+{
     sLog.outString( "Loading Exploration BaseXP Data..." );
     sObjectMgr.LoadExplorationBaseXP();
+}
 
+static void LoadStepPetNames()
+{
     sLog.outString( "Loading Pet Name Parts..." );
     sObjectMgr.LoadPetNames();
+}
 
+static void LoadStepCharacterDatabaseCleaner()
+{
     CharacterDatabaseCleaner::CleanDatabase();
+}
 
+static void LoadStepPetNumber()
+{
     sLog.outString( "Loading the max pet number..." );
     sObjectMgr.LoadPetNumber();
+}
 
+static void LoadStepPetLevelInfo()
+{
     sLog.outString( "Loading pet level stats..." );
     sObjectMgr.LoadPetLevelInfo();
+}
 
+static void LoadStepPetScalingData()
+{
     sLog.outString( "Loading pet scaling data..." );
     sObjectMgr.LoadPetScalingData();
+}
 
+static void LoadStepCorpses()
+{
     sLog.outString( "Loading Player Corpses..." );
     sObjectMgr.LoadCorpses();
+}
 
+static void LoadStepMailLevelRewards()
+{
     sLog.outString( "Loading Player level dependent mail rewards..." );
     sObjectMgr.LoadMailLevelRewards();
+}
 
+static void LoadStepSpellDisabled()
+{
     sLog.outString( "Loading Spell disabled..." );
     sObjectMgr.LoadSpellDisabledEntrys();
+}
 
+static void LoadStepLootTables()
+{
     sLog.outString( "Loading Loot Tables..." );
     sLog.outString();
     LoadLootTables();
     sLog.outString( ">>> Loot Tables loaded" );
     sLog.outString();
+}
 
+static void LoadStepSkillDiscovery()
+{
     sLog.outString( "Loading Skill Discovery Table..." );
     sSpellMgr.LoadSkillDiscoveryTable();
+}
 
+static void LoadStepSkillExtraItem()
+{
     sLog.outString( "Loading Skill Extra Item Table..." );
     sSpellMgr.LoadSkillExtraItemTable();
+}
 
+static void LoadStepFishingBaseSkill()
+{
     sLog.outString( "Loading Skill Fishing base level requirements..." );
     sObjectMgr.LoadFishingBaseSkillLevel();
+}
 
-    sLog.outString();
+static void LoadStepAchievements()
+{
     sLog.outString( "Loading Achievements..." );
     sAchievementMgr.LoadAchievementReferenceList();
     sAchievementMgr.LoadAchievementCriteriaList();
@@ -1454,42 +1614,265 @@ void World::SetInitialWorldSettings()
     sAchievementMgr.LoadCompletedAchievements();
     sLog.outString( ">>> Achievements loaded" );
     sLog.outString();
+}
 
-    sLog.outString( "Loading Instance encounters data..." );  // must be after Creature loading
+static void LoadStepInstanceEncounters()
+{
+    sLog.outString( "Loading Instance encounters data..." );
     sObjectMgr.LoadInstanceEncounters();
+}
 
+static void LoadStepGossipScripts()
+{
     sLog.outString( "Loading Gossip scripts..." );
-    sScriptMgr.LoadGossipScripts();                         // must be before gossip menu options
+    sScriptMgr.LoadGossipScripts();
+}
 
+static void LoadStepGossipMenus()
+{
     sObjectMgr.LoadGossipMenus();
+}
 
+static void LoadStepVendors()
+{
     sLog.outString( "Loading Vendors..." );
-    sObjectMgr.LoadVendorTemplates();                       // must be after load ItemTemplate
-    sObjectMgr.LoadVendors();                               // must be after load CreatureTemplate, VendorTemplate, and ItemTemplate
+    sObjectMgr.LoadVendorTemplates();
+    sObjectMgr.LoadVendors();
+}
 
+static void LoadStepTrainers()
+{
     sLog.outString( "Loading Trainers..." );
-    sObjectMgr.LoadTrainerTemplates();                      // must be after load CreatureTemplate
-    sObjectMgr.LoadTrainers();                              // must be after load CreatureTemplate, TrainerTemplate
+    sObjectMgr.LoadTrainerTemplates();
+    sObjectMgr.LoadTrainers();
+}
 
-    sLog.outString( "Loading Waypoint scripts..." );        // before loading from creature_movement
+static void LoadStepCreatureMovementScripts()
+{
+    sLog.outString( "Loading Waypoint scripts..." );
     sScriptMgr.LoadCreatureMovementScripts();
+}
 
+static void LoadStepWaypoints()
+{
     sLog.outString( "Loading Waypoints..." );
     sLog.outString();
     sWaypointMgr.Load();
+}
 
-    ///- Loading localization data
+static void LoadStepLocalization()
+{
     sLog.outString( "Loading Localization strings..." );
-    sObjectMgr.LoadCreatureLocales();                       // must be after CreatureInfo loading
-    sObjectMgr.LoadGameObjectLocales();                     // must be after GameobjectInfo loading
-    sObjectMgr.LoadItemLocales();                           // must be after ItemPrototypes loading
-    sObjectMgr.LoadQuestLocales();                          // must be after QuestTemplates loading
-    sObjectMgr.LoadGossipTextLocales();                     // must be after LoadGossipText
-    sObjectMgr.LoadPageTextLocales();                       // must be after PageText loading
-    sObjectMgr.LoadGossipMenuItemsLocales();                // must be after gossip menu items loading
-    sObjectMgr.LoadPointOfInterestLocales();                // must be after POI loading
+    sObjectMgr.LoadCreatureLocales();
+    sObjectMgr.LoadGameObjectLocales();
+    sObjectMgr.LoadItemLocales();
+    sObjectMgr.LoadQuestLocales();
+    sObjectMgr.LoadGossipTextLocales();
+    sObjectMgr.LoadPageTextLocales();
+    sObjectMgr.LoadGossipMenuItemsLocales();
+    sObjectMgr.LoadPointOfInterestLocales();
     sLog.outString( ">>> Localization strings loaded" );
     sLog.outString();
+}
+
+void World::SetInitialWorldSettings()
+{
+    ///- Initialize the random number generator
+    srand((unsigned int)time(NULL));
+
+    ///- Time server startup
+    uint32 uStartTime = WorldTimer::getMSTime();
+
+    ///- Initialize detour memory management
+    dtAllocSetCustom(dtCustomAlloc, dtCustomFree);
+
+    ///- Initialize config settings
+    LoadConfigSettings();
+
+    ///- Check the existence of the map files for all races start areas.
+    if (!MapManager::ExistMapAndVMap(0,-6240.32f, 331.033f) ||
+        !MapManager::ExistMapAndVMap(0,-8949.95f,-132.493f) ||
+        !MapManager::ExistMapAndVMap(0,-8949.95f,-132.493f) ||
+        !MapManager::ExistMapAndVMap(1,-618.518f,-4251.67f) ||
+        !MapManager::ExistMapAndVMap(0, 1676.35f, 1677.45f) ||
+        !MapManager::ExistMapAndVMap(1, 10311.3f, 832.463f) ||
+        !MapManager::ExistMapAndVMap(1,-2917.58f,-257.98f) ||
+        (m_configUint32Values[CONFIG_UINT32_EXPANSION] >= EXPANSION_TBC &&
+        (!MapManager::ExistMapAndVMap(530,10349.6f,-6357.29f) || !MapManager::ExistMapAndVMap(530,-3961.64f,-13931.2f))) ||
+        (m_configUint32Values[CONFIG_UINT32_EXPANSION] >= EXPANSION_WOTLK &&
+        !MapManager::ExistMapAndVMap(609,2355.84f,-5664.77f)))
+    {
+        sLog.outError("Correct *.map files not found in path '%smaps' or *.vmtree/*.vmtile files in '%svmaps'. Please place *.map and vmap files in appropriate directories or correct the DataDir value in the mangosd.conf file.",m_dataPath.c_str(),m_dataPath.c_str());
+        Log::WaitBeforeContinueIfNeed();
+        exit(1);
+    }
+
+    ///- Loading strings. Getting no records means core load has to be canceled because no error message can be output.
+    sLog.outString();
+    sLog.outString("Loading MaNGOS strings...");
+    if (!sObjectMgr.LoadMangosStrings())
+    {
+        Log::WaitBeforeContinueIfNeed();
+        exit(1);                                            // Error message displayed in function already
+    }
+
+    ///- Update the realm entry in the database with the realm type from the config file
+    //No SQL injection as values are treated as integers
+
+    // not send custom type REALM_FFA_PVP to realm list
+    uint32 server_type = IsFFAPvPRealm() ? REALM_TYPE_PVP : getConfig(CONFIG_UINT32_GAME_TYPE);
+    uint32 realm_zone = getConfig(CONFIG_UINT32_REALM_ZONE);
+    LoginDatabase.PExecute("UPDATE realmlist SET icon = %u, timezone = %u WHERE id = '%u'", server_type, realm_zone, getConfig(CONFIG_UINT32_REALMID));
+
+    ///- Remove the bones (they should not exist in DB though) and old corpses after a restart
+    CharacterDatabase.PExecute("DELETE FROM corpse WHERE corpse_type = '0' OR time < (UNIX_TIMESTAMP()-'%u')", 3*DAY);
+
+    ///- Load the DBC files
+    sLog.outString("Initialize data stores...");
+    LoadDBCStores(m_dataPath);
+    DetectDBCLang();
+    sObjectMgr.SetDBCLocaleIndex(GetDefaultDbcLocale());    // Get once for all the locale index of DBC language (console/broadcasts)
+
+    sLog.outString("Loading opcodes for realm (client build %u)...",CLIENT_VERSION);
+    sObjectMgr.LoadOpcodes();
+
+    sLog.outString("Loading GameObject models...");
+    LoadGameObjectModelList();
+
+    sLog.outString( "Loading SpellDbc..." );
+    sSpellMgr.LoadSpellDbc();
+
+    sLog.outString( "Loading SpellTemplate..." );
+    sObjectMgr.LoadSpellTemplate();
+
+    sLog.outString( "Loading Script Names...");
+    sScriptMgr.LoadScriptNames();
+
+    sLog.outString( "Loading WorldTemplate..." );
+    sObjectMgr.LoadWorldTemplate();
+
+    sLog.outString( "Loading InstanceTemplate..." );
+    sObjectMgr.LoadInstanceTemplate();
+
+    sLog.outString("Loading SkillLineAbilityMultiMap Data...");
+    sSpellMgr.LoadSkillLineAbilityMap();
+
+    sLog.outString("Loading SkillRaceClassInfoMultiMap Data...");
+    sSpellMgr.LoadSkillRaceClassInfoMap();
+
+    ///- Clean up and pack instances
+    sLog.outString( "Cleaning up instances..." );
+    sMapPersistentStateMgr.CleanupInstances();              // must be called before `creature_respawn`/`gameobject_respawn` tables
+
+    sLog.outString( "Packing instances..." );
+    sMapPersistentStateMgr.PackInstances();
+
+    sLog.outString( "Packing groups..." );
+    sObjectMgr.PackGroupIds();                              // must be after CleanupInstances
+
+    ///- Init highest guids before any guid using table loading to prevent using not initialized guids in some code.
+    sObjectMgr.SetHighestGuids();                           // must be after PackInstances() and PackGroupIds()
+    sLog.outString();
+
+    ///- Load static data, independent loaders can run in parallel (Loading.Threads)
+    // singletons are created without lock, so create all used by loaders here
+    sCreatureLinkingMgr;
+    sPoolMgr;
+    sGameEventMgr;
+    sAchievementMgr;
+    sWaypointMgr;
+
+    WorldLoadGraph loadGraph;
+    uint32 pageTexts = loadGraph.AddStep("Page Texts", &LoadStepPageTexts);
+    uint32 gameObjectTemplates = loadGraph.AddStep("GameObject Templates", &LoadStepGameObjectTemplates, pageTexts);
+    uint32 spellChains = loadGraph.AddStep("Spell Chains", &LoadStepSpellChains);
+    loadGraph.AddStep("Spell Elixirs", &LoadStepSpellElixirs, spellChains);
+    uint32 spellLearnSkills = loadGraph.AddStep("Spell Learn Skills", &LoadStepSpellLearnSkills, spellChains);
+    uint32 spellLearnSpells = loadGraph.AddStep("Spell Learn Spells", &LoadStepSpellLearnSpells, spellLearnSkills);
+    loadGraph.AddStep("Spell Proc Events", &LoadStepSpellProcEvents, spellChains);
+    loadGraph.AddStep("Spell Bonuses", &LoadStepSpellBonuses, spellChains);
+    loadGraph.AddStep("Spell Proc Item Enchant", &LoadStepSpellProcItemEnchant, spellChains);
+    loadGraph.AddStep("Spell Linked", &LoadStepSpellLinked, spellChains);
+    loadGraph.AddStep("Spell Threats", &LoadStepSpellThreats, spellChains);
+    uint32 gossipText = loadGraph.AddStep("NPC Texts", &LoadStepGossipText);
+    uint32 randomEnchantments = loadGraph.AddStep("Item Random Enchantments", &LoadStepRandomEnchantments);
+    uint32 items = loadGraph.AddStep("Items", &LoadStepItems, randomEnchantments, pageTexts);
+    loadGraph.AddStep("Item Converts", &LoadStepItemConverts, items);
+    loadGraph.AddStep("Item Expire Converts", &LoadStepItemExpireConverts, items);
+    uint32 creatureModelInfo = loadGraph.AddStep("Creature Model Info", &LoadStepCreatureModelInfo);
+    uint32 equipmentTemplates = loadGraph.AddStep("Equipment Templates", &LoadStepEquipmentTemplates, items);
+    uint32 creatureSpells = loadGraph.AddStep("Creature Spells", &LoadStepCreatureSpells);
+    uint32 creatureTemplates = loadGraph.AddStep("Creature Templates", &LoadStepCreatureTemplates, creatureSpells, creatureModelInfo, equipmentTemplates);
+    loadGraph.AddStep("Creature Model Race", &LoadStepCreatureModelRace, creatureTemplates);
+    loadGraph.AddStep("Spell Script Targets", &LoadStepSpellScriptTarget, creatureTemplates, gameObjectTemplates, spellChains);
+    loadGraph.AddStep("Vehicle Accessory", &LoadStepVehicleAccessory, creatureTemplates);
+    loadGraph.AddStep("Item Required Targets", &LoadStepItemRequiredTarget, items, creatureTemplates);
+    loadGraph.AddStep("Reputation Reward Rates", &LoadStepReputationRewardRate);
+    loadGraph.AddStep("Reputation OnKill", &LoadStepReputationOnKill, creatureTemplates);
+    loadGraph.AddStep("Reputation Spillover", &LoadStepReputationSpillover);
+    uint32 pointsOfInterest = loadGraph.AddStep("Points Of Interest", &LoadStepPointsOfInterest);
+    uint32 creatures = loadGraph.AddStep("Creatures", &LoadStepCreatures, creatureTemplates);
+    uint32 petLevelupSpells = loadGraph.AddStep("Pet Levelup Spells", &LoadStepPetLevelupSpells, spellChains);
+    loadGraph.AddStep("Pet Default Spells", &LoadStepPetDefaultSpells, petLevelupSpells, creatureTemplates);
+    loadGraph.AddStep("Creature Addons", &LoadStepCreatureAddons, creatures);
+    // creatures and gameobjects share per cell guid storage
+    uint32 gameObjects = loadGraph.AddStep("GameObjects", &LoadStepGameObjects, gameObjectTemplates, creatures);
+    loadGraph.AddStep("GameObject Addons", &LoadStepGameObjectAddons, gameObjects);
+    loadGraph.AddStep("Creature Linking", &LoadStepCreatureLinking, creatures);
+    uint32 pools = loadGraph.AddStep("Pools", &LoadStepPools, creatures, gameObjects);
+    loadGraph.AddStep("Weather", &LoadStepWeather);
+    // quest templates are changed by quest area triggers loading, done in same step before other quest users
+    uint32 quests = loadGraph.AddStep("Quests", &LoadStepQuests, creatureTemplates, gameObjectTemplates, items, spellLearnSpells);
+    uint32 questPOI = loadGraph.AddStep("Quest POI", &LoadStepQuestPOI, quests);
+    // changes npc flags of creature templates, so later npc flag checks depend on it
+    uint32 npcSpellClickSpells = loadGraph.AddStep("NPC SpellClick Spells", &LoadStepNPCSpellClickSpells, creatureTemplates, quests);
+    uint32 questRelations = loadGraph.AddStep("Quest Relations", &LoadStepQuestRelations, quests, npcSpellClickSpells);
+    // must be after pools and quests to properly load pool events and quests for events
+    uint32 gameEvents = loadGraph.AddStep("Game Events", &LoadStepGameEvents, pools, questRelations);
+    uint32 conditions = loadGraph.AddStep("Conditions", &LoadStepConditions, quests, items, gameEvents);
+    // pools of world maps are spawned here, so it must be after pools and game events
+    uint32 worldMaps = loadGraph.AddStep("World Map States", &LoadStepWorldMaps, pools, gameEvents);
+    uint32 creatureRespawn = loadGraph.AddStep("Creature Respawn", &LoadStepCreatureRespawn, worldMaps);
+    // both respawn loaders can create instance persistent states
+    loadGraph.AddStep("GameObject Respawn", &LoadStepGameObjectRespawn, creatureRespawn);
+    loadGraph.AddStep("Spell Areas", &LoadStepSpellAreas, quests);
+    loadGraph.AddStep("AreaTrigger Teleports", &LoadStepAreaTriggerTeleports, items, quests);
+    loadGraph.AddStep("Tavern Area Triggers", &LoadStepTavernAreaTriggers);
+    uint32 areaTriggerScripts = loadGraph.AddStep("AreaTrigger Scripts", &LoadStepAreaTriggerScripts);
+    uint32 eventIdScripts = loadGraph.AddStep("Event Id Scripts", &LoadStepEventIdScripts, areaTriggerScripts);
+    loadGraph.AddStep("Graveyard Zones", &LoadStepGraveyardZones);
+    loadGraph.AddStep("Spell Target Positions", &LoadStepSpellTargetPositions);
+    loadGraph.AddStep("Spell Pet Auras", &LoadStepSpellPetAuras, spellChains);
+    loadGraph.AddStep("Player Create Info", &LoadStepPlayerInfo, items, spellLearnSpells);
+    loadGraph.AddStep("Exploration BaseXP", &LoadStepExplorationBaseXP);
+    loadGraph.AddStep("Pet Names", &LoadStepPetNames);
+    uint32 characterDatabaseCleaner = loadGraph.AddStep("Character DB Cleanup", &LoadStepCharacterDatabaseCleaner);
+    loadGraph.AddStep("Pet Number", &LoadStepPetNumber);
+    loadGraph.AddStep("Pet Level Stats", &LoadStepPetLevelInfo, creatureTemplates);
+    loadGraph.AddStep("Pet Scaling Data", &LoadStepPetScalingData);
+    // corpses are added to per cell guid storage too
+    loadGraph.AddStep("Corpses", &LoadStepCorpses, gameObjects, worldMaps);
+    loadGraph.AddStep("Mail Level Rewards", &LoadStepMailLevelRewards, creatureTemplates);
+    loadGraph.AddStep("Spell Disabled", &LoadStepSpellDisabled);
+    loadGraph.AddStep("Loot Tables", &LoadStepLootTables, items, creatureTemplates, gameObjectTemplates, conditions);
+    loadGraph.AddStep("Skill Discovery", &LoadStepSkillDiscovery, spellChains);
+    loadGraph.AddStep("Skill Extra Item", &LoadStepSkillExtraItem, spellChains);
+    loadGraph.AddStep("Fishing Base Skill", &LoadStepFishingBaseSkill);
+    // character achievements must be loaded after character DB cleanup
+    uint32 achievements = loadGraph.AddStep("Achievements", &LoadStepAchievements, items, creatureTemplates, quests, characterDatabaseCleaner);
+    loadGraph.AddStep("Instance Encounters", &LoadStepInstanceEncounters, creatureTemplates);
+    // scripts are checked against creature/gameobject data and quests
+    uint32 gossipScripts = loadGraph.AddStep("Gossip Scripts", &LoadStepGossipScripts, eventIdScripts, quests, pools);
+    uint32 gossipMenus = loadGraph.AddStep("Gossip Menus", &LoadStepGossipMenus, gossipScripts, gossipText, pointsOfInterest, conditions);
+    loadGraph.AddRequire(gossipMenus, npcSpellClickSpells);
+    loadGraph.AddStep("Vendors", &LoadStepVendors, items, conditions, npcSpellClickSpells);
+    loadGraph.AddStep("Trainers", &LoadStepTrainers, spellLearnSpells, npcSpellClickSpells);
+    uint32 creatureMovementScripts = loadGraph.AddStep("Waypoint Scripts", &LoadStepCreatureMovementScripts, gossipScripts);
+    loadGraph.AddStep("Waypoints", &LoadStepWaypoints, creatureMovementScripts);
+    // locale index list is shared with achievement reward locales
+    loadGraph.AddStep("Localization Strings", &LoadStepLocalization, gossipMenus, achievements, questPOI);
+
+    loadGraph.Run(getConfig(CONFIG_UINT32_LOADING_THREADS));
 
     sLog.outString("Loading LFG rewards...");               // After load all static data
     sLFGMgr.LoadRewards();
@@ -1673,6 +2056,8 @@ void World::SetInitialWorldSettings()
     sLog.outString("Initialize AuctionHouseBot...");
     sAuctionBot.Initialize();
 
+    loadGraph.PrintReport();
+
     sLog.outString( "WORLD: World initialized" );
 
     uint32 uStartInterval = WorldTimer::getMSTimeDiff(uStartTime, WorldTimer::getMSTime());
@@ -1730,6 +2115,12 @@ void World::Update(uint32 diff)
 {
     m_updateTime = diff;
 
+    // update duration is measured for packet replay benchmark
+    uint64 updateStartTime = sPacketReplayMgr.IsRunning() ? WorldTimer::getMicroTime() : 0;
+
+    // packets sent by session handlers and world managers use same tick budget as map updates
+    UpdateData::SetCompressionDeadline(WorldTimer::getMicroTime() + uint64(getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE)) * 1000);
+
     ///- Update the different timers
     for(int i = 0; i < WUPDATE_COUNT; ++i)
     {
@@ -1787,6 +2178,9 @@ void World::Update(uint32 diff)
     /// <li> Handle session updates
     UpdateSessions(diff);
 
+    ///- Replay recorded client packets of benchmark sessions
+    sPacketReplayMgr.Update(diff);
+
     /// <li> Handle weather updates when the timer has passed
     if (m_timers[WUPDATE_WEATHERS].Passed())
     {
@@ -1888,6 +2282,11 @@ void World::Update(uint32 diff)
 
     //cleanup unused GridMap objects as well as VMaps
     sTerrainMgr.Update(diff);
+
+    UpdateData::SetCompressionDeadline(0);
+
+    if (updateStartTime)
+        sPacketReplayMgr.AddTickTime(uint32(WorldTimer::getMicroTime() - updateStartTime));
 }
 
 /// Send a packet to all players (except self if mentioned)
@@ -222,6 +222,15 @@ enum eConfigUInt32Values
     CONFIG_UINT32_OBJECTLOADINGSPLITTER_ALLOWEDTIME,
     CONFIG_UINT32_POSITION_UPDATE_DELAY,
     CONFIG_UINT32_RESIST_CALC_METHOD,
+    CONFIG_UINT32_MAPUPDATE_PARALLEL_CELLS_THREADS,
+    CONFIG_UINT32_COMPRESSION_LARGE_PACKET_SIZE,
+    CONFIG_UINT32_LOADING_THREADS,
+    CONFIG_UINT32_TERRAIN_LOAD_THREADS,
+    CONFIG_UINT32_TERRAIN_PREFETCH_TIME,
+    CONFIG_UINT32_VMAP_QUERY_CACHE_SIZE,
+    CONFIG_UINT32_OBJECT_PREPARE_THREADS,
+    CONFIG_UINT32_OBJECT_WARMUP_TIME,
+    CONFIG_UINT32_PATHFINDING_THREADS,
     CONFIG_UINT32_VALUE_COUNT
 };
 
@@ -421,6 +430,11 @@ enum eConfigBoolValues
     CONFIG_BOOL_FACTION_AND_RACE_CHANGE_WITHOUT_RENAMING,
     CONFIG_BOOL_RESIST_ADD_BY_OVER_LEVEL,
     CONFIG_BOOL_DYNAMIC_VMAP_DOUBLE_CHECK,
+    CONFIG_BOOL_MAPUPDATE_PARALLEL_CELLS,
+    CONFIG_BOOL_MAPUPDATE_PARALLEL_CELLS_CHECK,
+    CONFIG_BOOL_COMPRESSION_ADAPTIVE,
+    CONFIG_BOOL_TERRAIN_MAPPED_FILES,
+    CONFIG_BOOL_MAPUPDATE_OBJECT_POOLS,
     CONFIG_BOOL_VALUE_COUNT
 };
 
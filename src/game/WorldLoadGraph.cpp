@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "WorldLoadGraph.h"
+#include "Database/DatabaseEnv.h"
+#include "ProgressBar.h"
+#include "Timer.h"
+#include <ace/Guard_T.h>
+
+// steps ordered by start time for report
+struct WorldLoadStepStartOrder
+{
+    WorldLoadStepStartOrder(WorldLoadStepList const& steps) : m_steps(steps) {}
+
+    bool operator() (uint32 left, uint32 right) const
+    {
+        return m_steps[left].startTime < m_steps[right].startTime;
+    }
+
+    WorldLoadStepList const& m_steps;
+};
+
+WorldLoadGraph::WorldLoadGraph()
+    : m_readyCond(m_lock), m_finished(0), m_nextWorker(0), m_nextOutput(0), m_startTime(0), m_totalTime(0), m_threads(0)
+{
+}
+
+WorldLoadGraph::~WorldLoadGraph()
+{
+}
+
+uint32 WorldLoadGraph::AddStep(char const* name, WorldLoadFunction function, uint32 req1, uint32 req2, uint32 req3, uint32 req4)
+{
+    uint32 stepId = uint32(m_steps.size());
+    m_steps.push_back(WorldLoadStep(name, function));
+
+    AddRequire(stepId, req1);
+    AddRequire(stepId, req2);
+    AddRequire(stepId, req3);
+    AddRequire(stepId, req4);
+
+    return stepId;
+}
+
+void WorldLoadGraph::AddRequire(uint32 step, uint32 required)
+{
+    if (required == WORLD_LOAD_NO_STEP)
+        return;
+
+    // only already added steps can be required, so there can be no cycles
+    MANGOS_ASSERT(step < m_steps.size() && required < step);
+
+    WorldLoadStep& loadStep = m_steps[step];
+    if (std::find(loadStep.requires.begin(), loadStep.requires.end(), required) != loadStep.requires.end())
+        return;
+
+    loadStep.requires.push_back(required);
+    ++loadStep.pendingRequires;
+    m_steps[required].unlocks.push_back(step);
+}
+
+void WorldLoadGraph::Run(uint32 threads)
+{
+    m_startTime = WorldTimer::getMicroTime();
+    m_threads = threads > 1 ? threads : 1;
+    m_finished = 0;
+
+    if (m_threads == 1)
+    {
+        for (uint32 i = 0; i < m_steps.size(); ++i)
+            RunStep(i, 0);
+    }
+    else
+    {
+        for (uint32 i = 0; i < m_steps.size(); ++i)
+            if (!m_steps[i].pendingRequires)
+                m_ready.insert(i);
+
+        // progress bars of parallel steps would be mixed in one console line
+        bool showBars = BarGoLink::GetOutputState();
+        BarGoLink::SetOutputState(false);
+
+        m_nextWorker = 0;
+        m_nextOutput = 0;
+        if (activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, int(m_threads)) == -1)
+        {
+            sLog.outError("WorldLoadGraph: can't start %u loading threads, loading in one thread", m_threads);
+            m_threads = 1;
+            m_ready.clear();
+            for (uint32 i = 0; i < m_steps.size(); ++i)
+                RunStep(i, 0);
+        }
+        else
+            wait();
+
+        BarGoLink::SetOutputState(showBars);
+    }
+
+    m_totalTime = WorldTimer::getMicroTime() - m_startTime;
+}
+
+int WorldLoadGraph::svc()
+{
+    uint32 worker;
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+        worker = m_nextWorker++;
+    }
+
+    WorldDatabase.ThreadStart();
+    CharacterDatabase.ThreadStart();
+    LoginDatabase.ThreadStart();
+
+    while (true)
+    {
+        uint32 stepId;
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+            while (m_ready.empty() && m_finished < m_steps.size())
+                m_readyCond.wait();
+
+            if (m_ready.empty())
+                break;
+
+            stepId = *m_ready.begin();
+            m_ready.erase(m_ready.begin());
+        }
+
+        // output of steps running at the same time would be mixed line by line
+        sLog.StartCapture(&m_steps[stepId].output);
+        RunStep(stepId, worker);
+        sLog.StopCapture();
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+        FinishStep(stepId);
+        WriteFinishedOutput();
+        m_readyCond.broadcast();
+    }
+
+    LoginDatabase.ThreadEnd();
+    CharacterDatabase.ThreadEnd();
+    WorldDatabase.ThreadEnd();
+
+    return 0;
+}
+
+void WorldLoadGraph::RunStep(uint32 stepId, uint32 worker)
+{
+    WorldLoadStep& step = m_steps[stepId];
+    step.worker = worker;
+    step.startTime = WorldTimer::getMicroTime() - m_startTime;
+    step.function();
+    step.endTime = WorldTimer::getMicroTime() - m_startTime;
+}
+
+// must be called under m_lock
+void WorldLoadGraph::FinishStep(uint32 stepId)
+{
+    ++m_finished;
+
+    WorldLoadStep& step = m_steps[stepId];
+    step.finished = true;
+    for (std::vector<uint32>::const_iterator itr = step.unlocks.begin(); itr != step.unlocks.end(); ++itr)
+        if (!--m_steps[*itr].pendingRequires)
+            m_ready.insert(*itr);
+}
+
+// must be called under m_lock, output is written in serial load order
+void WorldLoadGraph::WriteFinishedOutput()
+{
+    for (; m_nextOutput < m_steps.size() && m_steps[m_nextOutput].finished; ++m_nextOutput)
+    {
+        LogCapture& output = m_steps[m_nextOutput].output;
+        sLog.WriteCapture(output);
+        LogCapture().swap(output);
+    }
+}
+
+void WorldLoadGraph::PrintReport() const
+{
+    if (m_steps.empty())
+        return;
+
+    std::vector<uint32> order(m_steps.size());
+    uint64 workTime = 0;
+    uint32 lastStep = 0;
+    for (uint32 i = 0; i < m_steps.size(); ++i)
+    {
+        order[i] = i;
+        workTime += m_steps[i].GetDuration();
+        if (m_steps[i].endTime > m_steps[lastStep].endTime)
+            lastStep = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(), WorldLoadStepStartOrder(m_steps));
+
+    sLog.outString();
+    sLog.outString("World loading steps (%u threads):", m_threads);
+    for (uint32 i = 0; i < order.size(); ++i)
+    {
+        WorldLoadStep const& step = m_steps[order[i]];
+        sLog.outString("  %-32s start %7u ms  time %7u ms  thread %u", step.name,
+            uint32(step.startTime / IN_MILLISECONDS), uint32(step.GetDuration() / IN_MILLISECONDS), step.worker);
+    }
+
+    // walk back from the last finished step, every time through the required step which finished last:
+    // this chain can't be shortened by more threads, only by faster loaders
+    std::vector<uint32> path;
+    uint64 pathTime = 0;
+    for (uint32 stepId = lastStep; stepId != WORLD_LOAD_NO_STEP;)
+    {
+        WorldLoadStep const& step = m_steps[stepId];
+        path.push_back(stepId);
+        pathTime += step.GetDuration();
+
+        uint32 prevId = WORLD_LOAD_NO_STEP;
+        for (std::vector<uint32>::const_iterator itr = step.requires.begin(); itr != step.requires.end(); ++itr)
+            if (prevId == WORLD_LOAD_NO_STEP || m_steps[*itr].endTime > m_steps[prevId].endTime)
+                prevId = *itr;
+
+        stepId = prevId;
+    }
+
+    sLog.outString("World loading: total %u ms, sum of steps %u ms, critical path %u ms:",
+        uint32(m_totalTime / IN_MILLISECONDS), uint32(workTime / IN_MILLISECONDS), uint32(pathTime / IN_MILLISECONDS));
+    for (std::vector<uint32>::const_reverse_iterator itr = path.rbegin(); itr != path.rend(); ++itr)
+        sLog.outString("  > %-30s %7u ms", m_steps[*itr].name, uint32(m_steps[*itr].GetDuration() / IN_MILLISECONDS));
+    sLog.outString();
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _WORLD_LOAD_GRAPH_H_INCLUDED
+#define _WORLD_LOAD_GRAPH_H_INCLUDED
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include "Common.h"
+#include "Log.h"
+
+#include <set>
+#include <vector>
+
+typedef void (*WorldLoadFunction)();
+
+#define WORLD_LOAD_NO_STEP  uint32(-1)
+
+struct WorldLoadStep
+{
+    WorldLoadStep(char const* _name, WorldLoadFunction _function)
+        : name(_name), function(_function), pendingRequires(0), startTime(0), endTime(0), worker(0), finished(false) {}
+
+    uint64 GetDuration() const { return endTime - startTime; }
+
+    char const* name;
+    WorldLoadFunction function;
+    std::vector<uint32> requires;                           // steps which must be finished before this one starts
+    std::vector<uint32> unlocks;                            // steps which wait for this one
+    uint32 pendingRequires;
+    uint64 startTime;                                       // microseconds since graph start
+    uint64 endTime;
+    uint32 worker;
+    bool finished;
+    LogCapture output;                                      // log text of step run in parallel, written in step order
+};
+
+typedef std::vector<WorldLoadStep> WorldLoadStepList;
+
+// Startup loaders with declared dependencies. Steps can require only already added steps,
+// so declaration order is always valid serial order (used with one thread).
+// With more threads every step starts as soon as all its required steps are finished.
+class WorldLoadGraph : protected ACE_Task_Base
+{
+    public:
+
+        WorldLoadGraph();
+        virtual ~WorldLoadGraph();
+
+        uint32 AddStep(char const* name, WorldLoadFunction function,
+            uint32 req1 = WORLD_LOAD_NO_STEP, uint32 req2 = WORLD_LOAD_NO_STEP,
+            uint32 req3 = WORLD_LOAD_NO_STEP, uint32 req4 = WORLD_LOAD_NO_STEP);
+        void AddRequire(uint32 step, uint32 required);
+
+        // run all steps and block until they are finished
+        void Run(uint32 threads);
+
+        // timings of all steps and the chain of steps which defined total load time
+        void PrintReport() const;
+
+        virtual int svc();
+
+    private:
+
+        void RunStep(uint32 stepId, uint32 worker);
+        void FinishStep(uint32 stepId);
+        void WriteFinishedOutput();
+
+        WorldLoadStepList m_steps;
+
+        ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_readyCond;
+        std::set<uint32> m_ready;                           // steps without pending requires, lowest id goes first
+        uint32 m_finished;
+        uint32 m_nextWorker;
+        uint32 m_nextOutput;                                // first step with not written log output
+
+        uint64 m_startTime;
+        uint64 m_totalTime;
+        uint32 m_threads;
+};
+
+#endif
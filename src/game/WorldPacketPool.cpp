@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "WorldPacketPool.h"
+#include <ace/TSS_T.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Guard_T.h>
+
+typedef std::vector<WorldPacket*> WorldPacketList;
+
+struct WorldPacketCache
+{
+    // thread exit
+    ~WorldPacketCache()
+    {
+        for (WorldPacketList::const_iterator itr = packets.begin(); itr != packets.end(); ++itr)
+            delete *itr;
+    }
+
+    WorldPacketList packets;
+};
+
+static ACE_TSS<WorldPacketCache> s_packetCache;
+
+static ACE_Thread_Mutex s_batchesLock;
+static std::vector<WorldPacketList> s_batches;              // full batches of free packets
+static uint32 s_maxBatches = 0;
+
+void WorldPacketPool::Initialize(uint32 maxPackets)
+{
+    s_maxBatches = maxPackets / WORLD_PACKET_POOL_BATCH;
+}
+
+WorldPacket* WorldPacketPool::Acquire(Opcodes opcode, size_t size)
+{
+    if (!s_maxBatches)
+        return new WorldPacket(opcode, size);
+
+    WorldPacketList& cache = s_packetCache->packets;
+    if (cache.empty())
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, s_batchesLock, new WorldPacket(opcode, size));
+        if (!s_batches.empty())
+        {
+            cache.swap(s_batches.back());
+            s_batches.pop_back();
+        }
+    }
+
+    if (cache.empty())
+        return new WorldPacket(opcode, size);
+
+    WorldPacket* packet = cache.back();
+    cache.pop_back();
+
+    packet->Initialize(opcode, size);
+    return packet;
+}
+
+void WorldPacketPool::Release(WorldPacket* packet)
+{
+    if (!packet)
+        return;
+
+    if (!s_maxBatches || packet->capacity() > WORLD_PACKET_POOL_MAX_BUFFER)
+    {
+        delete packet;
+        return;
+    }
+
+    WorldPacketList& cache = s_packetCache->packets;
+    cache.push_back(packet);
+
+    // keep one batch for own Acquire calls, give away the other
+    if (cache.size() < 2 * WORLD_PACKET_POOL_BATCH)
+        return;
+
+    WorldPacketList batch(cache.end() - WORLD_PACKET_POOL_BATCH, cache.end());
+    cache.resize(cache.size() - WORLD_PACKET_POOL_BATCH);
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, s_batchesLock);
+        if (s_batches.size() < s_maxBatches)
+        {
+            s_batches.push_back(WorldPacketList());
+            s_batches.back().swap(batch);
+        }
+    }
+
+    // pool is full
+    for (WorldPacketList::const_iterator itr = batch.begin(); itr != batch.end(); ++itr)
+        delete *itr;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef MANGOS_WORLDPACKETPOOL_H
+#define MANGOS_WORLDPACKETPOOL_H
+
+#include "Common.h"
+#include "WorldPacket.h"
+
+#define WORLD_PACKET_POOL_BATCH         32                  // packets moved between thread cache and shared list at once
+#define WORLD_PACKET_POOL_MAX_BUFFER    4096                // bigger buffers are freed, not kept in pool
+
+// Received packets recycled between network threads, which read them, and threads which process
+// them in WorldSession::Update. Every thread keeps a small cache of free packets and exchanges whole
+// batches with the shared list, so the shared lock is taken once per batch, not per packet.
+// Packets from Acquire can be freed by delete too, Release accepts any heap allocated packet.
+class MANGOS_DLL_DECL WorldPacketPool
+{
+    public:
+        // maxPackets 0 disables the pool: Acquire allocates, Release deletes
+        static void Initialize(uint32 maxPackets);
+
+        static WorldPacket* Acquire(Opcodes opcode, size_t size);
+        static void Release(WorldPacket* packet);
+};
+
+// ACE_Auto_Ptr like holder which returns packet to pool
+class WorldPacketHolder
+{
+    public:
+        explicit WorldPacketHolder(WorldPacket* packet) : m_packet(packet) {}
+        ~WorldPacketHolder() { WorldPacketPool::Release(m_packet); }
+
+        WorldPacket* release() { WorldPacket* packet = m_packet; m_packet = NULL; return packet; }
+
+    private:
+        WorldPacketHolder(WorldPacketHolder const&);
+        WorldPacketHolder& operator=(WorldPacketHolder const&);
+
+        WorldPacket* m_packet;
+};
+
+#endif
@@ -26,6 +26,7 @@
 #include "Log.h"
 #include "Opcodes.h"
 #include "WorldPacket.h"
+#include "WorldPacketPool.h"
 #include "WorldSession.h"
 #include "Player.h"
 #include "ObjectMgr.h"
@@ -39,6 +40,7 @@
 #include "LFGMgr.h"
 #include "Auth/AuthCrypt.h"
 #include "Auth/HMACSHA1.h"
+#include "WorldSocketMgr.h"
 #include "zlib/zlib.h"
 #include "warden/WardenWin.h"
 #include "warden/WardenMac.h"
@@ -122,7 +124,7 @@ WorldSession::~WorldSession()
     ///- empty incoming packet queue
     WorldPacket* packet = NULL;
     while(_recvQueue.next(packet))
-        delete packet;
+        WorldPacketPool::Release(packet);
 }
 
 void WorldSession::SizeError(WorldPacket const& packet, uint32 size) const
@@ -137,8 +139,7 @@ char const* WorldSession::GetPlayerName() const
     return GetPlayer() ? GetPlayer()->GetName() : "<none>";
 }
 
-/// Send a packet to the client
-void WorldSession::SendPacket(WorldPacket const* packet)
+void WorldSession::SendPacketToBot(WorldPacket const* packet)
 {
     // Playerbot mod: send packet to bot AI
     if (!sWorld.getConfig(CONFIG_BOOL_PLAYERBOT_DISABLE))
@@ -151,6 +152,12 @@ void WorldSession::SendPacket(WorldPacket const* packet)
                 GetPlayer()->GetPlayerbotMgr()->HandleMasterOutgoingPacket(*packet);
         }
     }
+}
+
+/// Send a packet to the client
+void WorldSession::SendPacket(WorldPacket const* packet)
+{
+    SendPacketToBot(packet);
 
     if (!m_Socket)
         return;
@@ -195,6 +202,40 @@ void WorldSession::SendPacket(WorldPacket const* packet)
         m_Socket->CloseSocket ();
 }
 
+/// Send a packet to the client, without payload copy if it is shared with other receivers
+void WorldSession::SendPacket(SharedPacket& packet)
+{
+    SendPacketToBot(packet.GetPacket());
+
+    if (!m_Socket)
+        return;
+
+    ACE_Message_Block* payload = packet.GetPayload();
+
+    if ((payload ? m_Socket->SendPacket(*packet.GetPacket(), payload) : m_Socket->SendPacket(*packet.GetPacket())) == -1)
+        m_Socket->CloseSocket();
+}
+
+SharedPacket::~SharedPacket()
+{
+    if (m_payload)
+        m_payload->release();
+}
+
+ACE_Message_Block* SharedPacket::GetPayload()
+{
+    if (!m_prepared)
+    {
+        m_prepared = true;
+
+        size_t minSize = sWorldSocketMgr->GetSharedPacketMinSize();
+        if (minSize && m_packet->size() >= minSize)
+            m_payload = WorldSocket::CreateSharedPayload(*m_packet);
+    }
+
+    return m_payload;
+}
+
 /// Add an incoming packet to the queue
 void WorldSession::QueuePacket(WorldPacket* new_packet)
 {
@@ -324,7 +365,7 @@ bool WorldSession::Update(PacketFilter& updater)
             }
         }
 
-        delete packet;
+        WorldPacketPool::Release(packet);
     }
 
     // Playerbot mod - Process player bot packets
@@ -349,7 +390,7 @@ bool WorldSession::Update(PacketFilter& updater)
                     {
                         OpcodeHandler& opHandle = opcodeTable[packet->GetOpcode()];
                         (pBotWorldSession->*opHandle.handler)(*packet);
-                        delete packet;
+                        WorldPacketPool::Release(packet);
                     }
                 }
             }
@@ -392,6 +433,9 @@ void WorldSession::LogoutPlayer(bool Save)
     m_playerLogout = true;
     m_playerSave = Save;
 
+    // character writes of account are executed in order by one writer connection
+    SqlAsyncPartition partition(CharacterDatabase, GetAccountId());
+
     if (_player)
     {
         // Playerbot mod: log out all player bots owned by this toon
@@ -24,7 +24,7 @@
 #define __WORLDSESSION_H
 
 #include "Common.h"
-#include "LockedQueue.h"
+#include "MPSCQueue.h"
 #include "SharedDefines.h"
 #include "ObjectGuid.h"
 #include "LFG.h"
@@ -35,6 +35,7 @@
 
 struct ItemPrototype;
 struct AuctionEntry;
+class AuctionSorter;
 struct AuctionHouseEntry;
 struct DeclinedName;
 
@@ -56,6 +57,8 @@ class Quest;
 
 struct OpcodeHandler;
 
+class ACE_Message_Block;
+
 enum AccountDataType
 {
     GLOBAL_CONFIG_CACHE             = 0,                    // 0x01 g
@@ -151,6 +154,25 @@ enum TutorialDataState
     TUTORIALDATA_NEW       = 2
 };
 
+// packet sent to many sessions, payload big enough is serialized once and shared by all receiver sockets
+class MANGOS_DLL_SPEC SharedPacket
+{
+    public:
+        explicit SharedPacket(WorldPacket const* packet) : m_packet(packet), m_payload(NULL), m_prepared(false) {}
+        ~SharedPacket();
+
+        WorldPacket const* GetPacket() const { return m_packet; }
+        ACE_Message_Block* GetPayload();                    // NULL if packet is sent by copy
+
+    private:
+        SharedPacket(SharedPacket const&);
+        SharedPacket& operator=(SharedPacket const&);
+
+        WorldPacket const* m_packet;
+        ACE_Message_Block* m_payload;
+        bool m_prepared;
+};
+
 //class to deal with packet processing
 //allows to determine if next packet is safe to be processed
 class PacketFilter
@@ -193,6 +215,7 @@ class WorldSessionFilter : public PacketFilter
 class MANGOS_DLL_SPEC WorldSession
 {
         friend class CharacterHandler;
+        friend class PacketReplayMgr;
 
     public:
         WorldSession(uint32 id, WorldSocket *sock, AccountTypes sec, uint8 expansion, time_t mute_time, LocaleConstant locale);
@@ -208,6 +231,7 @@ class MANGOS_DLL_SPEC WorldSession
         void SendAddonsInfo();
 
         void SendPacket(WorldPacket const* packet);
+        void SendPacket(SharedPacket& packet);
         void SendNotification(const char *format,...) ATTR_PRINTF(2,3);
         void SendNotification(int32 string_id,...);
         void SendPetNameInvalid(uint32 error, const std::string& name, DeclinedName *declinedName);
@@ -324,8 +348,8 @@ class MANGOS_DLL_SPEC WorldSession
         void SendAuctionRemovedNotification(AuctionEntry* auction);
         static void SendAuctionOutbiddedMail(AuctionEntry *auction);
         void SendAuctionCancelledToBidderMail(AuctionEntry *auction);
-        void BuildListAuctionItems(std::vector<AuctionEntry*> const& auctions, WorldPacket& data, std::wstring const& searchedname, uint32 listfrom, uint32 levelmin,
-            uint32 levelmax, uint32 usable, uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality, uint32& count, uint32& totalcount, bool isFull);
+        void BuildListAuctionItems(std::vector<AuctionEntry*>& auctions, WorldPacket& data, AuctionSorter const& sorter, uint32 listfrom,
+            uint32 usable, uint32& count, uint32& totalcount, bool isFull);
 
         AuctionHouseEntry const* GetCheckedAuctionHouseForAuctioneer(ObjectGuid guid);
 
@@ -891,6 +915,9 @@ class MANGOS_DLL_SPEC WorldSession
 
         void ExecuteOpcode( OpcodeHandler const& opHandle, WorldPacket* packet );
 
+        // Playerbot mod: outgoing packets seen by bot AI
+        void SendPacketToBot(WorldPacket const* packet);
+
         // logging helper
         void LogUnexpectedOpcode(WorldPacket *packet, const char * reason);
         void LogUnprocessedTail(WorldPacket *packet);
@@ -917,7 +944,7 @@ class MANGOS_DLL_SPEC WorldSession
         uint32 m_Tutorials[8];
         TutorialDataState m_tutorialState;
         AddonsList m_addonsList;
-        ACE_Based::LockedQueue<WorldPacket*, ACE_Thread_Mutex> _recvQueue;
+        ACE_Based::MPSCQueue<WorldPacket> _recvQueue;
 
         // Warden
         WardenBase *m_Warden;
@@ -26,6 +26,8 @@
 #include <ace/OS_NS_string.h>
 #include <ace/Reactor.h>
 #include <ace/Auto_Ptr.h>
+#include <ace/Lock_Adapter_T.h>
+#include <ace/OS_NS_sys_socket.h>
 
 #include "WorldSocket.h"
 #include "Common.h"
@@ -33,6 +35,7 @@
 #include "Util.h"
 #include "World.h"
 #include "WorldPacket.h"
+#include "WorldPacketPool.h"
 #include "SharedDefines.h"
 #include "ByteBuffer.h"
 #include "ObjectMgr.h"
@@ -97,6 +100,9 @@ struct ClientPktHeader
 #pragma pack(pop)
 #endif
 
+/// Max queued blocks sent by one system call
+#define OUTPUT_QUEUE_GATHER_COUNT 64
+
 WorldSocket::WorldSocket(void) :
 WorldHandler(),
 m_LastPingTime(ACE_Time_Value::zero),
@@ -108,6 +114,7 @@ m_Header(sizeof(ClientPktHeader)),
 m_OutBuffer(0),
 m_OutBufferSize(65536),
 m_OutActive(false),
+m_OutCopiedBytes(0),
 m_Seed(static_cast<uint32>(rand32()))
 {
     reference_counting_policy().value(ACE_Event_Handler::Reference_Counting_Policy::ENABLED);
@@ -119,7 +126,7 @@ m_Seed(static_cast<uint32>(rand32()))
 WorldSocket::~WorldSocket(void)
 {
     if (m_RecvWPct)
-        delete m_RecvWPct;
+        WorldPacketPool::Release(m_RecvWPct);
 
     if (m_OutBuffer)
         m_OutBuffer->release();
@@ -158,13 +165,8 @@ const std::string& WorldSocket::GetRemoteAddress(void) const
     return m_Address;
 }
 
-int WorldSocket::SendPacket(const WorldPacket& pct)
+uint16 WorldSocket::PrepareOutgoing(const WorldPacket& pct)
 {
-    ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
-
-    if (closing_)
-        return -1;
-
     uint16 realOpcode = sObjectMgr.GetOpcodeValue(pct.GetOpcode());
     if (realOpcode == 0)
     {
@@ -173,11 +175,28 @@ int WorldSocket::SendPacket(const WorldPacket& pct)
     }
 
     // Dump outgoing packet.
-    sLog.outWorldPacketDump(uint32(get_handle()), pct.GetOpcode(), LookupOpcodeName(pct.GetOpcode()), &pct, false);
+    if (sLog.HasWorldPacketDump())
+        sLog.outWorldPacketDump(uint32(get_handle()), pct.GetOpcode(), LookupOpcodeName(pct.GetOpcode()), &pct, false);
+
+    return realOpcode;
+}
+
+int WorldSocket::SendPacket(const WorldPacket& pct)
+{
+    ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
+
+    if (closing_)
+        return -1;
+
+    uint16 realOpcode = PrepareOutgoing(pct);
+    if (realOpcode == 0)
+        return 0;
 
     ServerPktHeader header(pct.size()+2, realOpcode);
     m_Crypt.EncryptSend((uint8*)header.header, header.getHeaderLength());
 
+    m_OutCopiedBytes += pct.size();
+
     if (m_OutBuffer->space() >= pct.size() + header.getHeaderLength() && msg_queue()->is_empty())
     {
         // Put the packet on the buffer.
@@ -211,6 +230,150 @@ int WorldSocket::SendPacket(const WorldPacket& pct)
     return 0;
 }
 
+int WorldSocket::SendPacket(const WorldPacket& pct, ACE_Message_Block* payload)
+{
+    ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
+
+    if (closing_)
+        return -1;
+
+    uint16 realOpcode = PrepareOutgoing(pct);
+    if (realOpcode == 0)
+        return 0;
+
+    ServerPktHeader header(pct.size()+2, realOpcode);
+    m_Crypt.EncryptSend((uint8*)header.header, header.getHeaderLength());
+
+    // The header goes to the buffer if possible, the payload is queued after it without copy:
+    // the buffer is always sent before the queue, and nothing is added to the buffer while the queue isn't empty.
+    if (m_OutBuffer->space() >= header.getHeaderLength() && msg_queue()->is_empty())
+    {
+        if (m_OutBuffer->copy((char*)header.header, header.getHeaderLength()) == -1)
+            MANGOS_ASSERT(false);
+    }
+    else
+    {
+        ACE_Message_Block* mb;
+
+        ACE_NEW_RETURN(mb, ACE_Message_Block(header.getHeaderLength()), -1);
+
+        mb->copy((char*)header.header, header.getHeaderLength());
+
+        if (msg_queue()->enqueue_tail(mb, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
+        {
+            sLog.outError("WorldSocket::SendPacket enqueue_tail");
+            mb->release();
+            return -1;
+        }
+    }
+
+    ACE_Message_Block* mb = payload->duplicate();
+
+    if (msg_queue()->enqueue_tail(mb, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
+    {
+        // header already queued, stream can't be continued
+        sLog.outError("WorldSocket::SendPacket enqueue_tail");
+        mb->release();
+        return -1;
+    }
+
+    return 0;
+}
+
+/// Data block of shared payload, reference counter is changed from map and network threads.
+/// Every payload has own lock, so sends of different packets don't wait each other.
+class SharedPayloadBlock : public ACE_Data_Block
+{
+    public:
+        explicit SharedPayloadBlock(size_t size)
+            : ACE_Data_Block(size, ACE_Message_Block::MB_DATA, 0, 0, &m_lock, 0, 0) {}
+
+    private:
+        // released by ACE_Data_Block before block is destroyed
+        ACE_Lock_Adapter<ACE_Thread_Mutex> m_lock;
+};
+
+ACE_Message_Block* WorldSocket::CreateSharedPayload(const WorldPacket& pct)
+{
+    // allocated same way as ACE_Message_Block allocates its data blocks, it is freed by ACE
+    ACE_Allocator* allocator = ACE_Allocator::instance();
+    SharedPayloadBlock* block;
+    ACE_NEW_MALLOC_RETURN(block, static_cast<SharedPayloadBlock*>(allocator->malloc(sizeof(SharedPayloadBlock))),
+        SharedPayloadBlock(pct.size()), NULL);
+
+    ACE_Message_Block* mb;
+    ACE_NEW_NORETURN(mb, ACE_Message_Block(block));
+    if (!mb)
+    {
+        block->release();
+        return NULL;
+    }
+
+    if (!pct.empty())
+        mb->copy((const char*)pct.contents(), pct.size());
+
+    return mb;
+}
+
+void WorldSocket::BenchmarkBroadcast(uint32 receivers, uint32 size, uint32 count,
+    uint64& copiedBytes, uint64& copiedTime, uint64& sharedBytes, uint64& sharedTime)
+{
+    std::vector<WorldSocket*> sockets(receivers);
+    for (uint32 i = 0; i < receivers; ++i)
+    {
+        sockets[i] = new WorldSocket;
+        ACE_NEW(sockets[i]->m_OutBuffer, ACE_Message_Block(sockets[i]->m_OutBufferSize));
+    }
+
+    WorldPacket packet(SMSG_MESSAGECHAT, size);
+    packet.resize(size);
+
+    for (int shared = 0; shared < 2; ++shared)
+    {
+        uint64 bytes = 0;
+        uint64 startTime = WorldTimer::getMicroTime();
+
+        for (uint32 n = 0; n < count; ++n)
+        {
+            ACE_Message_Block* payload = shared ? CreateSharedPayload(packet) : NULL;
+            if (payload)
+                bytes += packet.size();
+
+            for (uint32 i = 0; i < receivers; ++i)
+            {
+                if (payload)
+                    sockets[i]->SendPacket(packet, payload);
+                else
+                    sockets[i]->SendPacket(packet);
+            }
+
+            if (payload)
+                payload->release();
+
+            // sockets are not connected, drop data as if it was sent
+            for (uint32 i = 0; i < receivers; ++i)
+            {
+                sockets[i]->m_OutBuffer->reset();
+                sockets[i]->msg_queue()->flush();
+            }
+        }
+
+        uint64 usedTime = WorldTimer::getMicroTime() - startTime;
+
+        for (uint32 i = 0; i < receivers; ++i)
+        {
+            bytes += sockets[i]->m_OutCopiedBytes;
+            sockets[i]->m_OutCopiedBytes = 0;
+        }
+
+        (shared ? sharedBytes : copiedBytes) = count ? bytes / count : 0;
+        (shared ? sharedTime : copiedTime) = count ? usedTime / count : 0;
+    }
+
+    for (uint32 i = 0; i < receivers; ++i)
+        sockets[i]->remove_reference();
+}
+
 long WorldSocket::AddReference(void)
 {
     return static_cast<long>(add_reference());
@@ -377,60 +540,75 @@ int WorldSocket::handle_output_queue(GuardType& g)
     if (msg_queue()->is_empty())
         return cancel_wakeup_output(g);
 
-    ACE_Message_Block *mblk;
+    // Gather queued blocks to one call, shared packets are queued as separate header and payload blocks.
+    iovec iov[OUTPUT_QUEUE_GATHER_COUNT];
+    int iovcnt = 0;
+    size_t send_len = 0;
 
-    if (msg_queue()->dequeue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
+    ACE_Message_Queue_Iterator<ACE_NULL_SYNCH> itr(*msg_queue());
+    for (ACE_Message_Block* mblk; iovcnt < OUTPUT_QUEUE_GATHER_COUNT && itr.next(mblk); itr.advance())
     {
-        sLog.outError("WorldSocket::handle_output_queue dequeue_head");
-        return -1;
+        iov[iovcnt].iov_base = mblk->rd_ptr();
+        iov[iovcnt].iov_len = mblk->length();
+        send_len += mblk->length();
+        ++iovcnt;
     }
 
-    const size_t send_len = mblk->length();
-
 #ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send (mblk->rd_ptr(), send_len, MSG_NOSIGNAL);
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    ssize_t n = ACE_OS::sendmsg(get_handle(), &msg, MSG_NOSIGNAL);
 #else
-    ssize_t n = peer().send (mblk->rd_ptr(), send_len);
+    ssize_t n = peer().sendv(iov, iovcnt);
 #endif // MSG_NOSIGNAL
 
     if (n == 0)
-    {
-        mblk->release();
-
         return -1;
-    }
     else if (n == -1)
     {
         if (errno == EWOULDBLOCK || errno == EAGAIN)
-        {
-            msg_queue()->enqueue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero);
             return schedule_wakeup_output(g);
-        }
 
-        mblk->release();
         return -1;
     }
-    else if (n < (ssize_t)send_len) //now n > 0
+
+    // release sent blocks, the partially sent one stays at queue head
+    size_t sent = static_cast<size_t>(n);
+    while (sent > 0)
     {
-        mblk->rd_ptr (static_cast<size_t> (n));
+        ACE_Message_Block* mblk;
 
-        if (msg_queue()->enqueue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
+        if (msg_queue()->dequeue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
         {
-            sLog.outError("WorldSocket::handle_output_queue enqueue_head");
-            mblk->release();
+            sLog.outError("WorldSocket::handle_output_queue dequeue_head");
             return -1;
         }
 
-        return schedule_wakeup_output(g);
-    }
-    else //now n == send_len
-    {
-        mblk->release();
+        if (mblk->length() > sent)
+        {
+            mblk->rd_ptr(sent);
 
-        return msg_queue()->is_empty() ? cancel_wakeup_output(g) : ACE_Event_Handler::WRITE_MASK;
+            if (msg_queue()->enqueue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
+            {
+                sLog.outError("WorldSocket::handle_output_queue enqueue_head");
+                mblk->release();
+                return -1;
+            }
+
+            break;
+        }
+
+        sent -= mblk->length();
+        mblk->release();
     }
 
-    ACE_NOTREACHED(return -1);
+    if (static_cast<size_t>(n) < send_len)
+        return schedule_wakeup_output(g);
+
+    return msg_queue()->is_empty() ? cancel_wakeup_output(g) : ACE_Event_Handler::WRITE_MASK;
 }
 
 int WorldSocket::handle_close(ACE_HANDLE h, ACE_Reactor_Mask)
@@ -504,7 +682,7 @@ int WorldSocket::handle_input_header(void)
         return -1;
     }
 
-    ACE_NEW_RETURN(m_RecvWPct, WorldPacket(internalOpcode, header.size), -1);
+    m_RecvWPct = WorldPacketPool::Acquire(internalOpcode, header.size);
 
     if (header.size > 0)
     {
@@ -666,7 +844,7 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
     MANGOS_ASSERT(new_pct);
 
     // manage memory ;)
-    ACE_Auto_Ptr<WorldPacket> aptr(new_pct);
+    WorldPacketHolder aptr(new_pct);
 
     const ACE_UINT16 opcode = new_pct->GetOpcode();
 
@@ -680,7 +858,8 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
         return -1;
 
     // Dump received packet.
-    sLog.outWorldPacketDump(uint32(get_handle()), new_pct->GetOpcode(), LookupOpcodeName(new_pct->GetOpcode()), new_pct, true);
+    if (sLog.HasWorldPacketDump())
+        sLog.outWorldPacketDump(uint32(get_handle()), new_pct->GetOpcode(), LookupOpcodeName(new_pct->GetOpcode()), new_pct, true);
 
     try
     {
@@ -116,6 +116,21 @@ class WorldSocket : protected WorldHandler
         /// @return -1 of failure
         int SendPacket (const WorldPacket& pct);
 
+        /// Send a packet which payload is shared with other sockets,
+        /// only the header is built and encrypted for this socket.
+        /// @param pct packet to send
+        /// @param payload pct contents created by CreateSharedPayload()
+        /// @return -1 of failure
+        int SendPacket (const WorldPacket& pct, ACE_Message_Block* payload);
+
+        /// Copy the packet contents once to a buffer which can be queued to many sockets.
+        static ACE_Message_Block* CreateSharedPayload (const WorldPacket& pct);
+
+        /// Queue the same packet to not connected sockets, by copy and as shared payload.
+        /// @return bytes copied and time used per broadcast for each way
+        static void BenchmarkBroadcast (uint32 receivers, uint32 size, uint32 count,
+            uint64& copiedBytes, uint64& copiedTime, uint64& sharedBytes, uint64& sharedTime);
+
         /// Add reference to this object.
         long AddReference (void);
 
@@ -163,6 +178,10 @@ class WorldSocket : protected WorldHandler
         /// Drain the queue if its not empty.
         int handle_output_queue (GuardType& g);
 
+        /// Check and dump outgoing packet.
+        /// @return client opcode value, 0 if packet must not be sent
+        uint16 PrepareOutgoing (const WorldPacket& pct);
+
         /// process one incoming packet.
         /// @param new_pct received packet ,note that you need to delete it.
         int ProcessIncoming (WorldPacket* new_pct);
@@ -215,6 +234,9 @@ class WorldSocket : protected WorldHandler
         /// True if the socket is registered with the reactor for output
         bool m_OutActive;
 
+        /// Packet contents bytes copied to output buffers, shared payloads not included.
+        uint64 m_OutCopiedBytes;
+
         uint32 m_Seed;
 
         BigNumber m_s;
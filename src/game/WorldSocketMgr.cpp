@@ -43,6 +43,7 @@
 #include "Config/Config.h"
 #include "Database/DatabaseEnv.h"
 #include "WorldSocket.h"
+#include "WorldPacketPool.h"
 
 /**
 * This is a helper class to WorldSocketMgr ,that manages
@@ -210,6 +211,7 @@ WorldSocketMgr::WorldSocketMgr():
     m_SockOutKBuff(-1),
     m_SockOutUBuff(65536),
     m_UseNoDelay(true),
+    m_SharedPacketMinSize(0),
     m_Acceptor(0)
 {
 }
@@ -252,6 +254,12 @@ int WorldSocketMgr::StartReactiveIO (ACE_UINT16 port, const char* address)
         return -1;
     }
 
+    int sharedPacketMinSize = sConfig.GetIntDefault("Network.SharedPacketMinSize", 512);
+    m_SharedPacketMinSize = sharedPacketMinSize > 0 ? static_cast<size_t> (sharedPacketMinSize) : 0;
+
+    int packetPoolSize = sConfig.GetIntDefault("Network.PacketPool.Size", 0);
+    WorldPacketPool::Initialize(packetPoolSize > 0 ? static_cast<uint32> (packetPoolSize) : 0);
+
     WorldSocket::Acceptor* acc = new WorldSocket::Acceptor;
     m_Acceptor = acc;
 
@@ -54,6 +54,9 @@ class WorldSocketMgr
         std::string& GetBindAddress() { return m_addr; }
         ACE_UINT16 GetBindPort() { return m_port; }
 
+        /// Minimal payload size of broadcast packet shared between sockets without copy, 0 if disabled.
+        size_t GetSharedPacketMinSize() const { return m_SharedPacketMinSize; }
+
         /// Make this class singleton .
         static WorldSocketMgr* Instance();
 
@@ -70,6 +73,7 @@ class WorldSocketMgr
         int m_SockOutKBuff;
         int m_SockOutUBuff;
         bool m_UseNoDelay;
+        size_t m_SharedPacketMinSize;
 
         std::string m_addr;
         ACE_UINT16 m_port;
@@ -27,13 +27,61 @@
 #include "BattleGround/BattleGroundMgr.h"
 #include "GridNotifiers.h"
 #include "CellImpl.h"
+#include "ObjectMgr.h"
+
+#include <ace/Atomic_Op.h>
 
 INSTANTIATE_SINGLETON_1(WorldStateMgr);
 
+// state lists are sorted by state id for binary search
+struct WorldStateIdCompare
+{
+    bool operator() (WorldState const* left, WorldState const* right) const { return left->GetId() < right->GetId(); }
+    bool operator() (WorldState const* left, uint32 right) const { return left->GetId() < right; }
+    bool operator() (uint32 left, WorldState const* right) const { return left < right->GetId(); }
+};
+
+WorldStateBounds WorldStatePartition::GetStates(uint32 stateId) const
+{
+    WorldStateList const& states = GetStates();
+    return std::equal_range(states.begin(), states.end(), stateId, WorldStateIdCompare());
+}
+
+WorldStateList* WorldStatePartition::Add(WorldState* state)
+{
+    WorldStateList* states = new WorldStateList(GetStates());
+    states->insert(std::upper_bound(states->begin(), states->end(), state, WorldStateIdCompare()), state);
+    return m_states.exchange(states);
+}
+
+WorldStateList* WorldStatePartition::Remove(WorldState* state)
+{
+    WorldStateList* states = new WorldStateList(GetStates());
+    WorldStateList::iterator itr = std::find(states->begin(), states->end(), state);
+    if (itr != states->end())
+        states->erase(itr);
+    return m_states.exchange(states);
+}
+
+WorldStateMgr::~WorldStateMgr()
+{
+    ClearStates();
+    delete m_partitions.load();
+}
+
 void WorldStateMgr::Initialize()
 {
     // For reload case - cleanup states first
     m_worldStateTemplates.clear();
+
+    m_zoneMaps.clear();
+    for (uint32 i = 1; i < sAreaStore.GetNumRows(); ++i)
+    {
+        if (AreaTableEntry const* areaEntry = sAreaStore.LookupEntry(i))
+            if (areaEntry->zone && m_zoneMaps.find(areaEntry->zone) == m_zoneMaps.end())
+                m_zoneMaps[areaEntry->zone] = areaEntry->mapid;
+    }
+
     // Load some template types
     LoadTemplatesFromDB();
     LoadTemplatesFromObjectTemplateDB();
@@ -47,13 +95,18 @@ void WorldStateMgr::Initialize()
 
 void WorldStateMgr::Update()
 {
+    // called between map updates, nobody can use replaced lists now
+    FreeRetired();
+
+    // Update part 1 - calculating (and mark for cleanup)
+    WorldStatePartitionMap const& partitions = GetPartitions();
+    for (WorldStatePartitionMap::const_iterator partItr = partitions.begin(); partItr != partitions.end(); ++partItr)
     {
-        // Update part 1 - calculating (and mark for cleanup)
-        ReadGuard guard(GetLock());
-        for (WorldStateMap::iterator itr = m_worldState.begin(); itr != m_worldState.end(); ++itr)
+        WorldStateList const& states = partItr->second->GetStates();
+        for (WorldStateList::const_iterator itr = states.begin(); itr != states.end(); ++itr)
         {
-            WorldState* state = &itr->second;
-            if (!state || state->HasFlag(WORLD_STATE_FLAG_DELETED))
+            WorldState* state = *itr;
+            if (state->HasFlag(WORLD_STATE_FLAG_DELETED))
                 continue;
 
             switch (state->GetType())
@@ -65,10 +118,9 @@ void WorldStateMgr::Update()
                         BattlemasterListEntry const* bl = sBattlemasterListStore.LookupEntry(i);
                         if (bl && bl->HolidayWorldStateId == state->GetId())
                         {
-                            if (BattleGroundMgr::IsBGWeekend(BattleGroundTypeId(bl->id)))
-                                state->SetValue(WORLD_STATE_ADD);
-                            else
-                                state->SetValue(WORLD_STATE_REMOVE);
+                            uint32 value = BattleGroundMgr::IsBGWeekend(BattleGroundTypeId(bl->id)) ? WORLD_STATE_ADD : WORLD_STATE_REMOVE;
+                            if (state->GetValue() != value)
+                                state->SetValue(value);
                         }
                     }
                     break;
@@ -97,29 +149,55 @@ void WorldStateMgr::Update()
                 if (state->HasFlag(WORLD_STATE_FLAG_INITIAL_STATE))
                 {
                     state->Initialize();
+                    MarkForSave(state);
                     continue;
                 }
 
                 state->RemoveFlag(WORLD_STATE_FLAG_ACTIVE);
                 state->AddFlag(WORLD_STATE_FLAG_DELETED);
+                state->RemoveFlag(WORLD_STATE_FLAG_SAVED);
+                MarkForSave(state);
             }
         }
     }
 
-    // Saving data (and DB cleanup)
+    // Saving changed data (and DB cleanup)
     SaveToDB();
 
+    // Update part 2 - remove states with WORLD_STATE_FLAG_DELETED flag and empty partitions
+    WorldStatePartitionMap* cleaned = NULL;
+    for (WorldStatePartitionMap::const_iterator partItr = partitions.begin(); partItr != partitions.end(); ++partItr)
     {
-        // Update part 2 - remove states with WORLD_STATE_FLAG_DELETED flag
-        WriteGuard guard(GetLock());
-        for (WorldStateMap::iterator itr = m_worldState.begin(); itr != m_worldState.end();)
+        WorldStatePartition* partition = partItr->second;
+
+        WorldStateList deleted;
+        WorldStateList const& states = partition->GetStates();
+        for (WorldStateList::const_iterator itr = states.begin(); itr != states.end(); ++itr)
+            if ((*itr)->HasFlag(WORLD_STATE_FLAG_DELETED) && (*itr)->m_saveQueued.value() == 0)
+                deleted.push_back(*itr);
+
+        for (WorldStateList::const_iterator itr = deleted.begin(); itr != deleted.end(); ++itr)
         {
-            if (itr->second.HasFlag(WORLD_STATE_FLAG_DELETED))
-                m_worldState.erase(itr++);
-            else
-                ++itr;
+            delete partition->Remove(*itr);
+            delete *itr;
+        }
+
+        if (partition->GetStates().empty())
+        {
+            if (!cleaned)
+                cleaned = new WorldStatePartitionMap(partitions);
+            cleaned->erase(partition->GetKey());
         }
     }
+
+    if (cleaned)
+    {
+        WorldStatePartitionMap* replaced = m_partitions.exchange(cleaned);
+        for (WorldStatePartitionMap::const_iterator partItr = replaced->begin(); partItr != replaced->end(); ++partItr)
+            if (cleaned->find(partItr->first) == cleaned->end())
+                delete partItr->second;
+        delete replaced;
+    }
 }
 
 void WorldStateMgr::LoadTemplatesFromDBC()
@@ -375,7 +453,7 @@ void WorldStateMgr::LoadTemplatesFromObjectTemplateDB()
 void WorldStateMgr::LoadFromDB()
 {
     // cannot be reloaded!
-    m_worldState.clear();
+    ClearStates();
     //                                                            0           1       2            3        4        5            6
     QueryResult* result = CharacterDatabase.Query("SELECT `state_id`, `instance`, `type`, `condition`, `flags`, `value`, `renewtime` FROM `worldstate_data`");
 
@@ -411,14 +489,20 @@ void WorldStateMgr::LoadFromDB()
                 if (state->GetValue() != _value)
                     const_cast<WorldState*>(state)->SetValue(_value);
             }
-            else
-                m_worldState.insert(WorldStateMap::value_type(stateId, WorldState(tmpl, instanceId, flags, _value, renewtime)));
+            else if (WorldState* state = AddState(new WorldState(tmpl, instanceId, flags, _value, renewtime)))
+            {
+                // template flags replace loaded, resave if saved state lost
+                if (!state->HasFlag(WORLD_STATE_FLAG_SAVED))
+                    MarkForSave(state);
+            }
         }
         else if (type == WORLD_STATE_TYPE_CUSTOM)
         {
             DEBUG_FILTER_LOG(LOG_FILTER_DB_STRICTED_CHECK,"WorldStateMgr::LoadFromDB loaded custom state %u (%u %u %u %u %u %ld)",
                 stateId, instanceId, type, condition, flags, _value, renewtime);
-            m_worldState.insert(WorldStateMap::value_type(stateId, WorldState(stateId, instanceId, flags, _value, renewtime)));
+            if (WorldState* state = AddState(new WorldState(stateId, instanceId, flags, _value, renewtime)))
+                if (!state->HasFlag(WORLD_STATE_FLAG_SAVED))
+                    MarkForSave(state);
         }
         else
         {
@@ -429,7 +513,7 @@ void WorldStateMgr::LoadFromDB()
     while (result->NextRow());
 
     sLog.outString();
-    sLog.outString(">> Loaded data for "SIZEFMTD" WorldStates", m_worldState.size());
+    sLog.outString(">> Loaded data for %u WorldStates in "SIZEFMTD" partitions", GetWorldStatesCount(), GetPartitions().size());
     delete result;
 }
 
@@ -581,19 +665,23 @@ void WorldStateMgr::CreateLinkedWorldStatesIfNeed(WorldObject* object)
 
 void WorldStateMgr::SaveToDB()
 {
+    if (m_saveQueue.empty())
+        return;
+
     CharacterDatabase.BeginTransaction();
-    for (WorldStateMap::iterator iter = m_worldState.begin(); iter != m_worldState.end(); ++iter)
+    WorldState* state;
+    while (m_saveQueue.next(state))
     {
-        if (!iter->second.HasFlag(WORLD_STATE_FLAG_SAVED))
-            Save(&iter->second);
+        // state changed after this point will be queued again
+        state->m_saveQueued = 0;
+        if (!state->HasFlag(WORLD_STATE_FLAG_SAVED))
+            Save(state);
     }
     CharacterDatabase.CommitTransaction();
 }
 
 void WorldStateMgr::Save(WorldState const* state)
 {
-    ReadGuard guard(GetLock());
-
     static SqlStatementID wsDel;
     SqlStatement stmt = CharacterDatabase.CreateStatement(wsDel, "DELETE FROM `worldstate_data` WHERE `state_id` = ? AND `instance` = ?");
     stmt.PExecute(state->GetId(), state->GetInstance());
@@ -616,6 +704,22 @@ void WorldStateMgr::Save(WorldState const* state)
     }
 }
 
+void WorldStateMgr::MarkForSave(WorldState* state)
+{
+    // only first mark after save puts state to queue, so it is queued once
+    if (++state->m_saveQueued == 1)
+        m_saveQueue.add(state);
+}
+
+uint32 WorldStateMgr::GetWorldStatesCount() const
+{
+    uint32 count = 0;
+    WorldStatePartitionMap const& partitions = GetPartitions();
+    for (WorldStatePartitionMap::const_iterator itr = partitions.begin(); itr != partitions.end(); ++itr)
+        count += itr->second->GetStates().size();
+    return count;
+}
+
 void WorldStateMgr::DeleteWorldState(WorldState* state)
 {
     if (!state)
@@ -625,26 +729,13 @@ void WorldStateMgr::DeleteWorldState(WorldState* state)
     SqlStatement stmt = CharacterDatabase.CreateStatement(wsDel, "DELETE FROM `worldstate_data` WHERE `state_id` = ? AND `instance` = ?");
     stmt.PExecute(state->GetId(), state->GetInstance());
 
-    WriteGuard guard(GetLock());
-    for (WorldStateMap::iterator iter = m_worldState.begin(); iter != m_worldState.end();)
-    {
-        if (&iter->second == state)
-        {
-            // currently not need remove states immediately, remove his in World update cycle.
-            //m_worldState.erase(iter++);
-            iter->second.RemoveFlag(WORLD_STATE_FLAG_ACTIVE);
-            iter->second.AddFlag(WORLD_STATE_FLAG_DELETED);
-            break;
-        }
-        else
-            ++iter;
-    }
+    // currently not need remove states immediately, remove his in World update cycle.
+    state->RemoveFlag(WORLD_STATE_FLAG_ACTIVE);
+    state->AddFlag(WORLD_STATE_FLAG_DELETED);
 }
 
 WorldStateTemplate const* WorldStateMgr::FindTemplate(uint32 stateId, uint32 type, uint32 condition, uint32 linkedId)
 {
-    ReadGuard guard(GetLock());
-
     if (type == WORLD_STATE_TYPE_MAX && condition == 0 && linkedId == 0 && ((int)m_worldStateTemplates.count(stateId) > 1))
     {
         sLog.outError("WorldStateMgr::FindTemplate tru find template with simple rules, but in DB not one template Id %u!", stateId);
@@ -676,62 +767,72 @@ void WorldStateMgr::MapUpdate(Map* map)
     if (true)
         return;
 
-    for (WorldStateMap::iterator itr = m_worldState.begin(); itr != m_worldState.end(); ++itr)
+    uint64 keys[MAX_WORLD_STATE_LOCATION_PARTITIONS];
+    uint32 keysCount = GetLocationPartitionKeys(map->GetId(), map->GetInstanceId(), 0, 0, keys);
+    for (uint32 i = 0; i < keysCount; ++i)
     {
-        WorldState* state = &itr->second;
-        if (!state || state->HasFlag(WORLD_STATE_FLAG_DELETED) || !IsFitToCondition(map, state))
+        WorldStatePartition const* partition = FindPartition(keys[i]);
+        if (!partition)
             continue;
 
-        switch (state->GetType())
+        WorldStateList const& states = partition->GetStates();
+        for (WorldStateList::const_iterator stateItr = states.begin(); stateItr != states.end(); ++stateItr)
         {
-            case WORLD_STATE_TYPE_CAPTURE_POINT:
-            {
-                break;
-            }
-            case WORLD_STATE_TYPE_MAP:
-            case WORLD_STATE_TYPE_BATTLEGROUND:
-            {
-                break;
-            }
-            case WORLD_STATE_TYPE_ZONE:
-            case WORLD_STATE_TYPE_AREA:
+            WorldState* state = *stateItr;
+            if (state->HasFlag(WORLD_STATE_FLAG_DELETED) || !IsFitToCondition(map, state))
+                continue;
+
+            switch (state->GetType())
             {
-                for (GuidSet::const_iterator itr = state->GetClients().begin(); itr != state->GetClients().end();)
+                case WORLD_STATE_TYPE_CAPTURE_POINT:
                 {
-                    Player* player = map->GetPlayer(*itr);
-                    if (!player || !player->IsInWorld())
-                    {
-                        state->RemoveClient(*itr);
-                    }
-                    else
+                    break;
+                }
+                case WORLD_STATE_TYPE_MAP:
+                case WORLD_STATE_TYPE_BATTLEGROUND:
+                {
+                    break;
+                }
+                case WORLD_STATE_TYPE_ZONE:
+                case WORLD_STATE_TYPE_AREA:
+                {
+                    for (GuidSet::const_iterator itr = state->GetClients().begin(); itr != state->GetClients().end();)
                     {
-                        uint32 zone, area;
-                        player->GetZoneAndAreaId(zone, area);
-                        if (state->GetType() == WORLD_STATE_TYPE_ZONE && state->GetCondition() != zone)
+                        Player* player = map->GetPlayer(*itr);
+                        if (!player || !player->IsInWorld())
                         {
-                            // send state clean here
                             state->RemoveClient(*itr);
                         }
-                        else if (state->GetType() == WORLD_STATE_TYPE_AREA && state->GetCondition() != area)
+                        else
                         {
-                            // send state clean here
-                            state->RemoveClient(*itr);
+                            uint32 zone, area;
+                            player->GetZoneAndAreaId(zone, area);
+                            if (state->GetType() == WORLD_STATE_TYPE_ZONE && state->GetCondition() != zone)
+                            {
+                                // send state clean here
+                                state->RemoveClient(*itr);
+                            }
+                            else if (state->GetType() == WORLD_STATE_TYPE_AREA && state->GetCondition() != area)
+                            {
+                                // send state clean here
+                                state->RemoveClient(*itr);
+                            }
+                            else
+                                ++itr;
                         }
-                        else
-                            ++itr;
                     }
+                    break;
                 }
-                break;
-            }
 /*
-            case WORLD_STATE_TYPE_EVENT:
-            case WORLD_STATE_TYPE_BGWEEKEND:
-            case WORLD_STATE_TYPE_CUSTOM:
-            case WORLD_STATE_TYPE_WORLD:
-            case WORLD_STATE_TYPE_WORLD_UNCOMMON:
+                case WORLD_STATE_TYPE_EVENT:
+                case WORLD_STATE_TYPE_BGWEEKEND:
+                case WORLD_STATE_TYPE_CUSTOM:
+                case WORLD_STATE_TYPE_WORLD:
+                case WORLD_STATE_TYPE_WORLD_UNCOMMON:
 */
-            default:
-                break;
+                default:
+                    break;
+            }
         }
     }
 }
@@ -740,40 +841,77 @@ WorldStateSet* WorldStateMgr::GetWorldStatesFor(Player* player, uint32 flags)
 {
     WorldStateSet* stateSet = NULL;
 
-    bool bFull = player ? !player->IsInWorld() : true;
+    if (!player || !player->IsInWorld())
+    {
+        WorldStatePartitionMap const& partitions = GetPartitions();
+        for (WorldStatePartitionMap::const_iterator partItr = partitions.begin(); partItr != partitions.end(); ++partItr)
+        {
+            WorldStateList const& states = partItr->second->GetStates();
+            for (WorldStateList::const_iterator itr = states.begin(); itr != states.end(); ++itr)
+            {
+                WorldState* state = *itr;
+                if (!state->HasFlag(WORLD_STATE_FLAG_DELETED) && (state->GetFlags() & flags))
+                    AddToWorldStateSet(&stateSet, state);
+            }
+        }
+        return stateSet;
+    }
 
-    ReadGuard guard(GetLock());
-    for (WorldStateMap::iterator itr = m_worldState.begin(); itr != m_worldState.end(); ++itr)
+    uint64 keys[MAX_WORLD_STATE_LOCATION_PARTITIONS];
+    uint32 keysCount = GetLocationPartitionKeys(player->GetMapId(), player->GetInstanceId(), player->GetZoneId(), player->GetAreaId(), keys);
+    for (uint32 i = 0; i < keysCount; ++i)
     {
-        WorldState* state = &itr->second;
-        if (!state || state->HasFlag(WORLD_STATE_FLAG_DELETED))
+        WorldStatePartition const* partition = FindPartition(keys[i]);
+        if (!partition)
             continue;
 
-        if (state->GetFlags() & flags)
+        WorldStateList const& states = partition->GetStates();
+        for (WorldStateList::const_iterator itr = states.begin(); itr != states.end(); ++itr)
         {
-            if (bFull || IsFitToCondition(player, state))
+            WorldState* state = *itr;
+            if (state->HasFlag(WORLD_STATE_FLAG_DELETED))
+                continue;
+
+            if ((state->GetFlags() & flags) && IsFitToCondition(player, state))
                 AddToWorldStateSet(&stateSet, state);
         }
     }
     return stateSet;
 }
 
-WorldStateSet* WorldStateMgr::GetUpdatedWorldStatesFor(Player* player, time_t updateTime)
+WorldStateSet* WorldStateMgr::GetUpdatedWorldStatesFor(Player* player, uint64 lastVersion)
 {
+    // Nothing renewed since last sync - not need scan anything
+    if (lastVersion && lastVersion >= WorldState::GetLastVersion())
+        return NULL;
+
     WorldStateSet* stateSet = NULL;
 
-    ReadGuard guard(GetLock());
+    // Check only states from partitions, in which player may be placed
+    uint64 keys[MAX_WORLD_STATE_LOCATION_PARTITIONS];
+    uint32 keysCount = GetLocationPartitionKeys(player->GetMapId(), player->GetInstanceId(), player->GetZoneId(), player->GetAreaId(), keys);
+    for (uint32 i = 0; i < keysCount; ++i)
+        AddUpdatedFromPartition(&stateSet, player, keys[i], lastVersion);
+
+    return stateSet;
+}
+
+void WorldStateMgr::AddUpdatedFromPartition(WorldStateSet** stateSet, Player* player, uint64 partitionKey, uint64 lastVersion)
+{
+    WorldStatePartition const* partition = FindPartition(partitionKey);
+    if (!partition)
+        return;
 
-    for (WorldStateMap::iterator itr = m_worldState.begin(); itr != m_worldState.end(); ++itr)
+    WorldStateList const& states = partition->GetStates();
+    for (WorldStateList::const_iterator itr = states.begin(); itr != states.end(); ++itr)
     {
-        WorldState* state = &itr->second;
+        WorldState* state = *itr;
 
-        if (!state || state->HasFlag(WORLD_STATE_FLAG_DELETED))
+        if (state->HasFlag(WORLD_STATE_FLAG_DELETED))
             continue;
 
         if (state->HasFlag(WORLD_STATE_FLAG_ACTIVE) &&
-            state->GetRenewTime() >= updateTime &&
-            state->GetRenewTime() != time(NULL) &&
+            state->GetVersion() > lastVersion &&
             IsFitToCondition(player, state))
         {
             // Always send UpLinked worldstate with own chains
@@ -781,12 +919,173 @@ WorldStateSet* WorldStateMgr::GetUpdatedWorldStatesFor(Player* player, time_t up
             if (state->GetTemplate() && state->GetTemplate()->m_linkedId)
                 if (WorldStateTemplate const* tmpl = FindTemplate(state->GetTemplate()->m_linkedId, state->GetType(), state->GetCondition()))
                     if (WorldState const* state1 = GetWorldState(tmpl, state->GetInstance()))
-                        AddToWorldStateSet(&stateSet, state1);
+                        AddToWorldStateSet(stateSet, state1);
 
-            AddToWorldStateSet(&stateSet, state);
+            AddToWorldStateSet(stateSet, state);
         }
     }
-    return stateSet;
+}
+
+uint64 WorldStateMgr::MakePartitionKey(WorldStateScope scope, uint32 condition, uint32 instanceId)
+{
+    return (uint64(scope) << 56) | (uint64(condition & 0x00FFFFFF) << 32) | uint64(instanceId);
+}
+
+uint64 WorldStateMgr::GetPartitionKey(uint32 type, uint32 condition, uint32 instanceId) const
+{
+    switch (type)
+    {
+        case WORLD_STATE_TYPE_MAP:
+        case WORLD_STATE_TYPE_BATTLEGROUND:
+            return MakePartitionKey(WORLD_STATE_SCOPE_MAP, condition, instanceId);
+        case WORLD_STATE_TYPE_ZONE:
+            return MakePartitionKey(WORLD_STATE_SCOPE_ZONE, condition, instanceId);
+        case WORLD_STATE_TYPE_AREA:
+            return MakePartitionKey(WORLD_STATE_SCOPE_AREA, condition, instanceId);
+        // instance of destructible object and capture point states is guid of linked object
+        case WORLD_STATE_TYPE_DESTRUCTIBLE_OBJECT:
+            return MakePartitionKey(WORLD_STATE_SCOPE_DESTRUCTIBLE, GetMapIdByZoneId(condition), 0);
+        case WORLD_STATE_TYPE_CAPTURE_POINT:
+            if (GameObjectData const* data = sObjectMgr.GetGOData(instanceId))
+                return MakePartitionKey(WORLD_STATE_SCOPE_CAPTURE_POINT, data->mapid, 0);
+            break;
+        case WORLD_STATE_TYPE_CUSTOM:
+            if (condition)
+                return MakePartitionKey(WORLD_STATE_SCOPE_CUSTOM, condition, instanceId);
+            break;
+        default:
+            break;
+    }
+    return MakePartitionKey(WORLD_STATE_SCOPE_GLOBAL, 0, 0);
+}
+
+uint32 WorldStateMgr::GetLocationPartitionKeys(uint32 mapId, uint32 instanceId, uint32 zoneId, uint32 areaId, uint64* keys)
+{
+    uint32 count = 0;
+    keys[count++] = MakePartitionKey(WORLD_STATE_SCOPE_GLOBAL, 0, 0);
+    keys[count++] = MakePartitionKey(WORLD_STATE_SCOPE_MAP, mapId, instanceId);
+    keys[count++] = MakePartitionKey(WORLD_STATE_SCOPE_DESTRUCTIBLE, mapId, 0);
+    keys[count++] = MakePartitionKey(WORLD_STATE_SCOPE_CAPTURE_POINT, mapId, 0);
+    if (zoneId)
+        keys[count++] = MakePartitionKey(WORLD_STATE_SCOPE_ZONE, zoneId, instanceId);
+    if (areaId)
+        keys[count++] = MakePartitionKey(WORLD_STATE_SCOPE_AREA, areaId, instanceId);
+
+    // Custom states may be conditioned by map, zone or area - prevent double adding on equal ids
+    keys[count++] = MakePartitionKey(WORLD_STATE_SCOPE_CUSTOM, mapId, instanceId);
+    if (zoneId && zoneId != mapId)
+        keys[count++] = MakePartitionKey(WORLD_STATE_SCOPE_CUSTOM, zoneId, instanceId);
+    if (areaId && areaId != mapId && areaId != zoneId)
+        keys[count++] = MakePartitionKey(WORLD_STATE_SCOPE_CUSTOM, areaId, instanceId);
+
+    MANGOS_ASSERT(count <= MAX_WORLD_STATE_LOCATION_PARTITIONS);
+    return count;
+}
+
+WorldStatePartition* WorldStateMgr::FindPartition(uint64 key) const
+{
+    WorldStatePartitionMap const& partitions = GetPartitions();
+    WorldStatePartitionMap::const_iterator itr = partitions.find(key);
+    return itr != partitions.end() ? itr->second : NULL;
+}
+
+WorldStatePartition* WorldStateMgr::GetOrCreatePartition(uint64 key)
+{
+    if (WorldStatePartition* partition = FindPartition(key))
+        return partition;
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_partitionsLock, NULL);
+
+    // can be added by other thread while we waited
+    WorldStatePartitionMap* partitions = m_partitions.load();
+    WorldStatePartitionMap::const_iterator itr = partitions->find(key);
+    if (itr != partitions->end())
+        return itr->second;
+
+    WorldStatePartition* partition = new WorldStatePartition(key);
+    WorldStatePartitionMap* newPartitions = new WorldStatePartitionMap(*partitions);
+    (*newPartitions)[key] = partition;
+    m_retiredPartitionMaps.push_back(m_partitions.exchange(newPartitions));
+    return partition;
+}
+
+WorldState* WorldStateMgr::FindState(WorldStatePartition const* partition, WorldStateTemplate const* tmpl, uint32 instanceId) const
+{
+    WorldStateBounds bounds = partition->GetStates(tmpl->m_stateId);
+    for (WorldStateList::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+    {
+        if ((*itr)->GetInstance() == instanceId && (*itr)->GetTemplate() == tmpl)
+            return *itr;
+    }
+    return NULL;
+}
+
+WorldState* WorldStateMgr::FindState(WorldStatePartition const* partition, uint32 stateId, uint32 instanceId, Player* player)
+{
+    WorldStateBounds bounds = partition->GetStates(stateId);
+    for (WorldStateList::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+    {
+        if ((*itr)->GetInstance() == instanceId && (!player || IsFitToCondition(player, *itr)))
+            return *itr;
+    }
+    return NULL;
+}
+
+WorldState* WorldStateMgr::AddState(WorldState* state)
+{
+    WorldStatePartition* partition = GetOrCreatePartition(GetPartitionKey(state));
+    if (!partition)
+    {
+        delete state;
+        return NULL;
+    }
+
+    WorldStateList* replaced;
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, partition->GetWriteLock(), NULL);
+        replaced = partition->Add(state);
+    }
+    RetireStateList(replaced);
+    return state;
+}
+
+void WorldStateMgr::RetireStateList(WorldStateList* states)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_partitionsLock);
+    m_retiredStateLists.push_back(states);
+}
+
+void WorldStateMgr::FreeRetired()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_partitionsLock);
+
+    for (std::vector<WorldStateList*>::const_iterator itr = m_retiredStateLists.begin(); itr != m_retiredStateLists.end(); ++itr)
+        delete *itr;
+    m_retiredStateLists.clear();
+
+    for (std::vector<WorldStatePartitionMap*>::const_iterator itr = m_retiredPartitionMaps.begin(); itr != m_retiredPartitionMaps.end(); ++itr)
+        delete *itr;
+    m_retiredPartitionMaps.clear();
+}
+
+void WorldStateMgr::ClearStates()
+{
+    // drop queued states, they will be deleted
+    WorldState* queued;
+    while (m_saveQueue.next(queued))
+        queued->m_saveQueued = 0;
+
+    FreeRetired();
+
+    WorldStatePartitionMap* partitions = m_partitions.exchange(new WorldStatePartitionMap);
+    for (WorldStatePartitionMap::const_iterator partItr = partitions->begin(); partItr != partitions->end(); ++partItr)
+    {
+        WorldStateList const& states = partItr->second->GetStates();
+        for (WorldStateList::const_iterator itr = states.begin(); itr != states.end(); ++itr)
+            delete *itr;
+        delete partItr->second;
+    }
+    delete partitions;
 }
 
 bool WorldStateMgr::IsFitToCondition(Player* player, WorldState const* state)
@@ -948,13 +1247,62 @@ bool WorldStateMgr::IsFitToCondition(uint32 mapId, uint32 instanceId, uint32 zon
 
 uint32 WorldStateMgr::GetWorldStateValue(uint32 stateId)
 {
-    ReadGuard guard(GetLock());
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
+    // mostly used for global states
+    if (WorldStatePartition const* partition = FindPartition(MakePartitionKey(WORLD_STATE_SCOPE_GLOBAL, 0, 0)))
+    {
+        WorldStateBounds bounds = partition->GetStates(stateId);
+        if (bounds.first != bounds.second)
+            return (*bounds.first)->GetValue();
+    }
 
-    if (bounds.first == bounds.second)
-        return UINT32_MAX;
+    WorldStatePartitionMap const& partitions = GetPartitions();
+    for (WorldStatePartitionMap::const_iterator itr = partitions.begin(); itr != partitions.end(); ++itr)
+    {
+        WorldStateBounds bounds = itr->second->GetStates(stateId);
+        if (bounds.first != bounds.second)
+            return (*bounds.first)->GetValue();
+    }
+    return UINT32_MAX;
+}
+
+WorldState* WorldStateMgr::FindStateFor(Player* player, uint32 stateId)
+{
+    uint64 keys[MAX_WORLD_STATE_LOCATION_PARTITIONS];
+    uint32 keysCount = GetLocationPartitionKeys(player->GetMapId(), player->GetInstanceId(), player->GetZoneId(), player->GetAreaId(), keys);
+    for (uint32 i = 0; i < keysCount; ++i)
+    {
+        WorldStatePartition const* partition = FindPartition(keys[i]);
+        if (!partition)
+            continue;
+
+        WorldStateBounds bounds = partition->GetStates(stateId);
+        for (WorldStateList::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+        {
+            if (IsFitToCondition(player, *itr))
+                return *itr;
+        }
+    }
+    return NULL;
+}
+
+WorldState* WorldStateMgr::FindStateAt(uint32 mapId, uint32 instanceId, uint32 zoneId, uint32 areaId, uint32 stateId)
+{
+    uint64 keys[MAX_WORLD_STATE_LOCATION_PARTITIONS];
+    uint32 keysCount = GetLocationPartitionKeys(mapId, instanceId, zoneId, areaId, keys);
+    for (uint32 i = 0; i < keysCount; ++i)
+    {
+        WorldStatePartition const* partition = FindPartition(keys[i]);
+        if (!partition)
+            continue;
 
-    return bounds.first->second.GetValue();
+        WorldStateBounds bounds = partition->GetStates(stateId);
+        for (WorldStateList::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+        {
+            if (IsFitToCondition(mapId, instanceId, zoneId, areaId, *itr))
+                return *itr;
+        }
+    }
+    return NULL;
 }
 
 uint32 WorldStateMgr::GetWorldStateValueFor(Player* player, uint32 stateId)
@@ -962,17 +1310,8 @@ uint32 WorldStateMgr::GetWorldStateValueFor(Player* player, uint32 stateId)
     if (!player)
         return UINT32_MAX;
 
-    ReadGuard guard(GetLock());
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-    if (bounds.first == bounds.second)
-        return UINT32_MAX;
-
-    for (WorldStateMap::const_iterator iter = bounds.first; iter != bounds.second; ++iter)
-    {
-        if (IsFitToCondition(player, &iter->second))
-            return iter->second.GetValue();
-    }
-    return UINT32_MAX;
+    WorldState const* state = FindStateFor(player, stateId);
+    return state ? state->GetValue() : UINT32_MAX;
 }
 
 uint32 WorldStateMgr::GetWorldStateValueFor(Map* map, uint32 stateId)
@@ -980,32 +1319,14 @@ uint32 WorldStateMgr::GetWorldStateValueFor(Map* map, uint32 stateId)
     if (!map)
         return UINT32_MAX;
 
-    ReadGuard guard(GetLock());
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-    if (bounds.first == bounds.second)
-        return UINT32_MAX;
-
-    for (WorldStateMap::const_iterator iter = bounds.first; iter != bounds.second; ++iter)
-    {
-        if (IsFitToCondition(map, &iter->second))
-            return iter->second.GetValue();
-    }
-    return UINT32_MAX;
+    WorldState const* state = FindStateAt(map->GetId(), map->GetInstanceId(), 0, 0, stateId);
+    return state ? state->GetValue() : UINT32_MAX;
 }
 
 uint32 WorldStateMgr::GetWorldStateValueFor(uint32 mapId, uint32 instanceId, uint32 zoneId, uint32 areaId, uint32 stateId)
 {
-    ReadGuard guard(GetLock());
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-    if (bounds.first == bounds.second)
-        return UINT32_MAX;
-
-    for (WorldStateMap::const_iterator iter = bounds.first; iter != bounds.second; ++iter)
-    {
-        if (IsFitToCondition(mapId, instanceId, zoneId, areaId, &iter->second))
-            return iter->second.GetValue();
-    }
-    return UINT32_MAX;
+    WorldState const* state = FindStateAt(mapId, instanceId, zoneId, areaId, stateId);
+    return state ? state->GetValue() : UINT32_MAX;
 }
 
 uint32 WorldStateMgr::GetWorldStateValueFor(WorldObject* object, uint32 stateId)
@@ -1021,18 +1342,8 @@ uint32 WorldStateMgr::GetWorldStateValueFor(WorldObject* object, uint32 stateId)
     if (!goInfo || goInfo->type != GAMEOBJECT_TYPE_CAPTURE_POINT)
         return GetWorldStateValueFor(object->GetMap(), stateId);
 
-    ReadGuard guard(GetLock());
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-
-    if (bounds.first != bounds.second)
-    {
-        for (WorldStateMap::const_iterator iter = bounds.first; iter != bounds.second; ++iter)
-        {
-            if (IsFitToCondition(object->GetMap()->GetId(), object->GetObjectGuid().GetCounter(), 0, 0, &iter->second))
-                return iter->second.GetValue();
-        }
-    }
-    return UINT32_MAX;
+    WorldState const* state = FindStateAt(object->GetMap()->GetId(), object->GetObjectGuid().GetCounter(), 0, 0, stateId);
+    return state ? state->GetValue() : UINT32_MAX;
 }
 
 uint32 WorldStateMgr::GetWorldStateValueFor(uint32 zoneId, uint32 stateId)
@@ -1050,18 +1361,11 @@ void WorldStateMgr::SetWorldStateValueFor(Player* player, uint32 stateId, uint32
     if (!player)
         return;
 
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-    if (bounds.first != bounds.second)
+    if (WorldState* state = FindStateFor(player, stateId))
     {
-        for (WorldStateMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-        {
-            if (IsFitToCondition(player, &itr->second))
-            {
-                if ((&itr->second)->GetValue() != value)
-                    const_cast<WorldState*>(&itr->second)->SetValue(value);
-                return;
-            }
-        }
+        if (state->GetValue() != value)
+            state->SetValue(value);
+        return;
     }
 
     CreateWorldState(stateId, player->GetInstanceId(), value);
@@ -1072,18 +1376,11 @@ void WorldStateMgr::SetWorldStateValueFor(Map* map, uint32 stateId, uint32 value
     if (!map)
         return;
 
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-    if (bounds.first != bounds.second)
+    if (WorldState* state = FindStateAt(map->GetId(), map->GetInstanceId(), 0, 0, stateId))
     {
-        for (WorldStateMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-        {
-            if (IsFitToCondition(map, &itr->second))
-            {
-                if ((&itr->second)->GetValue() != value)
-                    const_cast<WorldState*>(&itr->second)->SetValue(value);
-                return;
-            }
-        }
+        if (state->GetValue() != value)
+            state->SetValue(value);
+        return;
     }
 
     CreateWorldState(stateId, map->GetInstanceId(), value);
@@ -1096,18 +1393,11 @@ void WorldStateMgr::SetWorldStateValueFor(uint32 zoneId, uint32 stateId, uint32
 
     uint32 mapId = GetMapIdByZoneId(zoneId);
 
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-    if (bounds.first != bounds.second)
+    if (WorldState* state = FindStateAt(mapId, 0, zoneId, 0, stateId))
     {
-        for (WorldStateMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-        {
-            if (IsFitToCondition(mapId, 0, zoneId, 0, &itr->second))
-            {
-                if ((&itr->second)->GetValue() != value)
-                    const_cast<WorldState*>(&itr->second)->SetValue(value);
-                return;
-            }
-        }
+        if (state->GetValue() != value)
+            state->SetValue(value);
+        return;
     }
 
     CreateWorldState(stateId, 0, value);
@@ -1135,29 +1425,18 @@ void WorldStateMgr::SetWorldStateValueFor(WorldObject* object, uint32 stateId, u
         return;
     }
 
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-    if (bounds.first != bounds.second)
+    if (WorldState* _state = FindStateAt(object->GetMap()->GetId(), object->GetObjectGuid().GetCounter(), 0, 0, stateId))
     {
-        for (WorldStateMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-        {
-            WorldState const* _state = &itr->second;
-            if (!_state)
-                continue;
-
-            if (IsFitToCondition(object->GetMap()->GetId(), object->GetObjectGuid().GetCounter(), 0, 0, _state))
-            {
-                if (_state->GetValue() != value)
-                    const_cast<WorldState*>(_state)->SetValue(value);
+        if (_state->GetValue() != value)
+            _state->SetValue(value);
 
-                DEBUG_LOG("WorldStateMgr::SetWorldStateValueFor tru set state %u instance %u, type %u  value %u (%u)  for %s",
-                    _state->GetId(), _state->GetInstance(),
-                    _state->GetType(),
-                    value, _state->GetValue(),
-                    object->GetGuidStr().c_str());
+        DEBUG_LOG("WorldStateMgr::SetWorldStateValueFor tru set state %u instance %u, type %u  value %u (%u)  for %s",
+            _state->GetId(), _state->GetInstance(),
+            _state->GetType(),
+            value, _state->GetValue(),
+            object->GetGuidStr().c_str());
 
-                return;
-            }
-        }
+        return;
     }
 
     CreateWorldState(stateId, object->GetObjectGuid().GetCounter(), value);
@@ -1193,16 +1472,40 @@ WorldState const* WorldStateMgr::CreateWorldState(WorldStateTemplate const* tmpl
     }
 
     // Store the state data
+    WorldStatePartition* partition = GetOrCreatePartition(GetPartitionKey(tmpl->m_stateType, tmpl->m_condition, instanceId));
+    if (!partition)
+        return NULL;
+
+    WorldState* _state = NULL;
+    WorldStateList* replaced = NULL;
     {
-        WriteGuard guard(GetLock());
-        m_worldState.insert(WorldStateMap::value_type(tmpl->m_stateId, WorldState(tmpl, instanceId)));
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, partition->GetWriteLock(), NULL);
+
+        // can be created by other thread after check
+        _state = FindState(partition, tmpl, instanceId);
+        if (!_state)
+        {
+            _state = new WorldState(tmpl, instanceId);
+            replaced = partition->Add(_state);
+        }
     }
-    WorldState* _state  = const_cast<WorldState*>(GetWorldState(tmpl, instanceId));
+
+    if (!replaced)
+    {
+        if (value != UINT32_MAX && _state->GetValue() != value)
+            _state->SetValue(value);
+        return _state;
+    }
+
+    RetireStateList(replaced);
 
     if (value != UINT32_MAX)
         _state->SetValue(value);
     else
+    {
         _state->RemoveFlag(WORLD_STATE_FLAG_SAVED);
+        MarkForSave(_state);
+    }
 
     if (!tmpl->HasFlag(WORLD_STATE_FLAG_PASSIVE_AT_CREATE))
         _state->AddFlag(WORLD_STATE_FLAG_ACTIVE);
@@ -1218,34 +1521,39 @@ WorldState const* WorldStateMgr::CreateWorldState(WorldStateTemplate const* tmpl
 
 WorldState const* WorldStateMgr::GetWorldState(uint32 stateId, uint32 instanceId, WorldStateType type, uint32 condition)
 {
-    ReadGuard guard(GetLock());
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-    if (bounds.first == bounds.second)
+    WorldStatePartition const* partition = FindPartition(GetPartitionKey(type, condition, instanceId));
+    if (!partition)
         return NULL;
 
-    for (WorldStateMap::const_iterator iter = bounds.first; iter != bounds.second; ++iter)
+    WorldStateBounds bounds = partition->GetStates(stateId);
+    for (WorldStateList::const_iterator iter = bounds.first; iter != bounds.second; ++iter)
     {
-        if (iter->second.GetInstance() == instanceId
-            && type == iter->second.GetType()
-            && condition == iter->second.GetCondition())
-            return &iter->second;
+        if ((*iter)->GetInstance() == instanceId
+            && type == (*iter)->GetType()
+            && condition == (*iter)->GetCondition())
+            return *iter;
     }
     return NULL;
 }
 
 WorldState const* WorldStateMgr::GetWorldState(uint32 stateId, uint32 instanceId, Player* player)
 {
-    ReadGuard guard(GetLock());
-    WorldStateBounds bounds = m_worldState.equal_range(stateId);
-    if (bounds.first == bounds.second)
-        return NULL;
-
-    for (WorldStateMap::const_iterator iter = bounds.first; iter != bounds.second; ++iter)
+    if (player)
     {
-        if (iter->second.GetInstance() == instanceId
-            && (!player || IsFitToCondition(player, &iter->second)))
-            return &iter->second;
+        uint64 keys[MAX_WORLD_STATE_LOCATION_PARTITIONS];
+        uint32 keysCount = GetLocationPartitionKeys(player->GetMapId(), player->GetInstanceId(), player->GetZoneId(), player->GetAreaId(), keys);
+        for (uint32 i = 0; i < keysCount; ++i)
+            if (WorldStatePartition const* partition = FindPartition(keys[i]))
+                if (WorldState const* state = FindState(partition, stateId, instanceId, player))
+                    return state;
+        return NULL;
     }
+
+    // without player state can be in any partition
+    WorldStatePartitionMap const& partitions = GetPartitions();
+    for (WorldStatePartitionMap::const_iterator itr = partitions.begin(); itr != partitions.end(); ++itr)
+        if (WorldState const* state = FindState(itr->second, stateId, instanceId, NULL))
+            return state;
     return NULL;
 }
 
@@ -1254,17 +1562,8 @@ WorldState const* WorldStateMgr::GetWorldState(WorldStateTemplate const* tmpl, u
     if (!tmpl)
         return NULL;
 
-    ReadGuard guard(GetLock());
-    WorldStateBounds bounds = m_worldState.equal_range(tmpl->m_stateId);
-    if (bounds.first == bounds.second)
-        return NULL;
-
-    for (WorldStateMap::const_iterator iter = bounds.first; iter != bounds.second; ++iter)
-    {
-        if (iter->second.GetInstance() == instanceId && iter->second.GetTemplate() == tmpl)
-            return &iter->second;
-    }
-    return NULL;
+    WorldStatePartition const* partition = FindPartition(GetPartitionKey(tmpl->m_stateType, tmpl->m_condition, instanceId));
+    return partition ? FindState(partition, tmpl, instanceId) : NULL;
 }
 
 void WorldStateMgr::AddWorldStateFor(Player* player, uint32 stateId, uint32 instanceId)
@@ -1405,25 +1704,35 @@ WorldStateSet* WorldStateMgr::GetInstanceStates(uint32 mapId, uint32 instanceId,
 {
     WorldStateSet* stateSet = NULL;
 
-    ReadGuard guard(GetLock());
-    for (WorldStateMap::iterator itr = m_worldState.begin(); itr != m_worldState.end(); ++itr)
+    uint64 keys[MAX_WORLD_STATE_LOCATION_PARTITIONS];
+    uint32 keysCount = full ? GetLocationPartitionKeys(mapId, instanceId, 0, 0, keys) : 0;
+    if (!full)
+        keys[keysCount++] = MakePartitionKey(WORLD_STATE_SCOPE_MAP, mapId, instanceId);
+
+    Map* map = full ? sMapMgr.FindMap(mapId, instanceId) : NULL;
+
+    for (uint32 i = 0; i < keysCount; ++i)
     {
-        WorldState* state = &itr->second;
-        if (!state || state->HasFlag(WORLD_STATE_FLAG_DELETED))
+        WorldStatePartition const* partition = FindPartition(keys[i]);
+        if (!partition)
             continue;
 
-        if (!flags || (state->GetFlags() & flags))
+        WorldStateList const& states = partition->GetStates();
+        for (WorldStateList::const_iterator itr = states.begin(); itr != states.end(); ++itr)
         {
-            if (state->GetType() == WORLD_STATE_TYPE_MAP &&
-                state->GetCondition() == mapId &&
-                state->GetInstance() == instanceId)
-            {
-                AddToWorldStateSet(&stateSet, state);
-            }
-            else if (full)
+            WorldState* state = *itr;
+            if (state->HasFlag(WORLD_STATE_FLAG_DELETED))
+                continue;
+
+            if (!flags || (state->GetFlags() & flags))
             {
-                Map* map = sMapMgr.FindMap(mapId, instanceId);
-                if (IsFitToCondition(map, state))
+                if (state->GetType() == WORLD_STATE_TYPE_MAP &&
+                    state->GetCondition() == mapId &&
+                    state->GetInstance() == instanceId)
+                {
+                    AddToWorldStateSet(&stateSet, state);
+                }
+                else if (full && IsFitToCondition(map, state))
                     AddToWorldStateSet(&stateSet, state);
             }
         }
@@ -1435,28 +1744,37 @@ WorldStateSet* WorldStateMgr::GetInitWorldStates(uint32 mapId, uint32 instanceId
 {
     WorldStateSet* stateSet = NULL;
 
-    ReadGuard guard(GetLock());
-    for (WorldStateMap::const_iterator itr = m_worldState.begin(); itr != m_worldState.end(); ++itr)
+    uint64 keys[MAX_WORLD_STATE_LOCATION_PARTITIONS];
+    uint32 keysCount = GetLocationPartitionKeys(mapId, instanceId, zoneId, areaId, keys);
+    for (uint32 i = 0; i < keysCount; ++i)
     {
-        WorldState const* state = &itr->second;
-        if (!state || state->HasFlag(WORLD_STATE_FLAG_DELETED))
+        WorldStatePartition const* partition = FindPartition(keys[i]);
+        if (!partition)
             continue;
 
-        if ((state->HasFlag(WORLD_STATE_FLAG_INITIAL_STATE) ||
-            state->HasFlag(WORLD_STATE_FLAG_ACTIVE)) &&
-            IsFitToCondition(mapId, instanceId, zoneId, areaId, state))
+        WorldStateList const& states = partition->GetStates();
+        for (WorldStateList::const_iterator itr = states.begin(); itr != states.end(); ++itr)
         {
-            // DownLinked states sended always before main!
-            if (state->HasDownLink())
+            WorldState const* state = *itr;
+            if (state->HasFlag(WORLD_STATE_FLAG_DELETED))
+                continue;
+
+            if ((state->HasFlag(WORLD_STATE_FLAG_INITIAL_STATE) ||
+                state->HasFlag(WORLD_STATE_FLAG_ACTIVE)) &&
+                IsFitToCondition(mapId, instanceId, zoneId, areaId, state))
             {
-                if (WorldStateSet* linkedStateSet = GetDownLinkedWorldStates(state))
+                // DownLinked states sended always before main!
+                if (state->HasDownLink())
                 {
-                    for (uint8 i = 0; i < linkedStateSet->count(); ++i)
-                        AddToWorldStateSet(&stateSet, (*linkedStateSet)[i]);
-                    delete linkedStateSet;
+                    if (WorldStateSet* linkedStateSet = GetDownLinkedWorldStates(state))
+                    {
+                        for (uint8 j = 0; j < linkedStateSet->count(); ++j)
+                            AddToWorldStateSet(&stateSet, (*linkedStateSet)[j]);
+                        delete linkedStateSet;
+                    }
                 }
+                AddToWorldStateSet(&stateSet, state);
             }
-            AddToWorldStateSet(&stateSet, &itr->second);
         }
     }
     return stateSet;
@@ -1496,6 +1814,10 @@ WorldState const* WorldStateMgr::GetUpLinkWorldState(WorldState const* state)
 
 uint32 WorldStateMgr::GetMapIdByZoneId(uint32 zoneId) const
 {
+    ZoneMapIndex::const_iterator itr = m_zoneMaps.find(zoneId);
+    if (itr != m_zoneMaps.end())
+        return itr->second;
+
     if (zoneId)
     {
         for (uint32 i = 1; i < sAreaStore.GetNumRows(); ++i)
@@ -1509,6 +1831,26 @@ uint32 WorldStateMgr::GetMapIdByZoneId(uint32 zoneId) const
     return 451; /*Programmers Isle. possible need assert here.*/
 }
 
+static ACE_Atomic_Op<ACE_Thread_Mutex, uint64> s_worldStateVersion;
+
+uint64 WorldState::GenerateVersion()
+{
+    return ++s_worldStateVersion;
+}
+
+uint64 WorldState::GetLastVersion()
+{
+    return s_worldStateVersion.value();
+}
+
+void WorldState::SetValue(uint32 value)
+{
+    m_value = value;
+    RemoveFlag(WORLD_STATE_FLAG_SAVED);
+    Renew();
+    sWorldStateMgr.MarkForSave(this);
+}
+
 bool WorldState::IsExpired() const
 {
     return time(NULL) > time_t(m_renewTime + sWorld.getConfig(CONFIG_UINT32_WORLD_STATE_EXPIRETIME));
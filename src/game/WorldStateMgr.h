@@ -22,6 +22,12 @@
 
 #include "Common.h"
 #include "World.h"
+#include "AtomicPointer.h"
+#include "MPSCQueue.h"
+
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+#include <vector>
 
 class Player;
 
@@ -149,14 +155,14 @@ struct WorldState
     public:
     // For create new state
     WorldState(WorldStateTemplate const* _state, uint32 _instance)
-        : m_pState(_state), m_stateId(m_pState->m_stateId), m_instanceId(_instance), m_type(m_pState->m_stateType)
+        : m_queueNext(NULL), m_pState(_state), m_stateId(m_pState->m_stateId), m_instanceId(_instance), m_type(m_pState->m_stateType), m_saveQueued(0)
     {
         Initialize();
     }
 
     // For load
     WorldState(WorldStateTemplate const* _state, uint32 _instance, uint32 _flags, uint32 _value, time_t _renewtime)
-        : m_pState(_state), m_stateId(m_pState->m_stateId), m_instanceId(_instance), m_type(m_pState->m_stateType), m_flags(_flags), m_value(_value), m_renewTime(_renewtime)
+        : m_queueNext(NULL), m_pState(_state), m_stateId(m_pState->m_stateId), m_instanceId(_instance), m_type(m_pState->m_stateType), m_flags(_flags), m_value(_value), m_renewTime(_renewtime), m_version(GenerateVersion()), m_saveQueued(0)
     {
         m_linkedGuid.Clear();
         m_clientGuids.clear();
@@ -165,14 +171,14 @@ struct WorldState
 
     // For load custom state
     WorldState(uint32 _stateid, uint32 _instance, uint32 _flags, uint32 _value, time_t _renewtime)
-        : m_pState(NULL), m_stateId(_stateid), m_instanceId(_instance), m_type(WORLD_STATE_TYPE_CUSTOM), m_flags(_flags), m_value(_value), m_renewTime(_renewtime)
+        : m_queueNext(NULL), m_pState(NULL), m_stateId(_stateid), m_instanceId(_instance), m_type(WORLD_STATE_TYPE_CUSTOM), m_flags(_flags), m_value(_value), m_renewTime(_renewtime), m_saveQueued(0)
     {
         Initialize();
     }
 
     // For create new custom state
     WorldState(uint32 _stateid, uint32 _instance, uint32 value)
-        : m_pState(NULL), m_stateId(_stateid), m_instanceId(_instance), m_type(WORLD_STATE_TYPE_CUSTOM), m_value(value)
+        : m_queueNext(NULL), m_pState(NULL), m_stateId(_stateid), m_instanceId(_instance), m_type(WORLD_STATE_TYPE_CUSTOM), m_value(value), m_saveQueued(0)
     {
         Initialize();
     }
@@ -261,19 +267,24 @@ struct WorldState
     uint32 const& GetPhaseMask() const { return m_phasemask; }
 
     uint32 const& GetValue()     const { return m_value; }
-    void          SetValue(uint32 value)
-    {
-        m_value = value;
-        RemoveFlag(WORLD_STATE_FLAG_SAVED);
-        Renew();
-    }
+    void          SetValue(uint32 value);
     void          Renew()
     {
         AddFlag(WORLD_STATE_FLAG_UPDATED);
         m_renewTime = time(NULL);
+        m_version   = GenerateVersion();
     }
 
+    // Change version - increased on every renew, used for delta distribution
+    uint64 const& GetVersion()   const { return m_version; }
+    static uint64 GenerateVersion();
+    static uint64 GetLastVersion();
+
+    WorldState*                        m_queueNext;     // link in WorldStateMgr save queue
+
     private:
+    friend class WorldStateMgr;
+
     // const parameters (must be setted in constructor)
     const WorldStateTemplate*          m_pState;        // pointer to template (may be NULL for custom states)
     const uint32                       m_stateId;       // state id  (not unique, 0 for custom and BG states)
@@ -284,13 +295,60 @@ struct WorldState
     uint32                             m_value;         // current value (NU for BG states)
     uint32                             m_condition;     // condition (for custom states)
     time_t                             m_renewTime;     // time of last renew
+    uint64                             m_version;       // global change counter value at last renew
     ObjectGuid                         m_linkedGuid;    // Guid of GO/creature/etc, which linked to WorldState (CapturePoint mostly)
     GuidSet                            m_clientGuids;   // List of player Guids, wich already received this WorldState update
     uint32                             m_phasemask;     // Phase mask for this state
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> m_saveQueued; // not 0 while state is in save queue
 };
 
-typedef UNORDERED_MULTIMAP<uint32 /* state id */, WorldState> WorldStateMap;
-typedef std::pair<WorldStateMap::const_iterator, WorldStateMap::const_iterator> WorldStateBounds;
+// Scope of WorldState visibility, used as part of partition key
+enum WorldStateScope
+{
+    WORLD_STATE_SCOPE_GLOBAL        = 0,                    // world, event, BG weekend and unconditional custom states
+    WORLD_STATE_SCOPE_MAP           = 1,                    // map and battleground states (condition = map id)
+    WORLD_STATE_SCOPE_ZONE          = 2,                    // zone states (condition = zone id)
+    WORLD_STATE_SCOPE_AREA          = 3,                    // area states (condition = area id)
+    WORLD_STATE_SCOPE_DESTRUCTIBLE  = 4,                    // destructible object states (condition = map id of zone, any instance)
+    WORLD_STATE_SCOPE_CUSTOM        = 5,                    // custom states (condition = map, zone or area id)
+    WORLD_STATE_SCOPE_CAPTURE_POINT = 6,                    // capture point states (condition = map id of point, any instance)
+};
+
+// max partitions, in which states visible at some place can be stored
+#define MAX_WORLD_STATE_LOCATION_PARTITIONS 9
+
+typedef std::vector<WorldState*> WorldStateList;
+typedef std::pair<WorldStateList::const_iterator, WorldStateList::const_iterator> WorldStateBounds;
+
+// States of one owner: map instance, zone or area of it, or global states.
+// Owner map thread is usual writer, so writers of different maps never wait each other.
+// Readers get published state list without any lock. Replaced lists and deleted states are freed
+// only in WorldStateMgr::Update, which is called by world thread when no map is updated.
+class WorldStatePartition
+{
+    public:
+        explicit WorldStatePartition(uint64 key) : m_key(key), m_states(new WorldStateList) {}
+        ~WorldStatePartition() { delete m_states.load(); }
+
+        uint64 GetKey() const { return m_key; }
+
+        // sorted by state id
+        WorldStateList const& GetStates() const { return *m_states.load(); }
+        WorldStateBounds GetStates(uint32 stateId) const;
+
+        // must be called under write lock, return replaced list
+        WorldStateList* Add(WorldState* state);
+        WorldStateList* Remove(WorldState* state);
+
+        ACE_Thread_Mutex& GetWriteLock() { return m_writeLock; }
+
+    private:
+        uint64 const m_key;
+        ACE_Thread_Mutex m_writeLock;
+        ACE_Based::AtomicPointer<WorldStateList> m_states;
+};
+
+typedef UNORDERED_MAP<uint64 /* partition key */, WorldStatePartition*> WorldStatePartitionMap;
 
 #define MAX_WORD_STATE_SET_COUNT 254
 
@@ -323,7 +381,8 @@ inline void AddToWorldStateSet(WorldStateSet** wss, WorldState const* wState)
 class MANGOS_DLL_DECL WorldStateMgr
 {
     public:
-        WorldStateMgr() {}
+        WorldStateMgr() : m_partitions(new WorldStatePartitionMap) {}
+        ~WorldStateMgr();
 
     public:
         void Initialize();
@@ -334,11 +393,12 @@ class MANGOS_DLL_DECL WorldStateMgr
         void LoadTemplatesFromDBC();
         void LoadFromDB();
         uint32 GetWorldStateTemplatesCount() const { return m_worldStateTemplates.size(); };
-        uint32 GetWorldStatesCount() const         { return m_worldState.size(); };
+        uint32 GetWorldStatesCount() const;
 
         // Save
         void SaveToDB();
         void Save(WorldState const* state);
+        void MarkForSave(WorldState* state);
 
         // create state operation
         void CreateWorldStatesIfNeed();
@@ -381,7 +441,7 @@ class MANGOS_DLL_DECL WorldStateMgr
         WorldStateSet* GetWorldStatesFor(Player* player, WorldStateFlags flag) { return GetWorldStatesFor(player, (1 << flag)); };
         WorldStateSet* GetWorldStatesFor(Player* player, uint32 flags = UINT32_MAX);
 
-        WorldStateSet* GetUpdatedWorldStatesFor(Player* player, time_t lastUpdateTime = 0);
+        WorldStateSet* GetUpdatedWorldStatesFor(Player* player, uint64 lastVersion = 0);
 
         WorldStateSet* GetInstanceStates(Map* map, uint32 flags = 0, bool full = false);
         WorldStateSet* GetInstanceStates(uint32 mapId, uint32 instanceId, uint32 flags = 0, bool full = false);
@@ -403,15 +463,35 @@ class MANGOS_DLL_DECL WorldStateMgr
         uint32 GetMapIdByZoneId(uint32 zoneId) const;
 
     private:
-        // multithread locking
-        typedef   MANGOSR2_MUTEX_MODEL              LockType;
-        typedef   ACE_Read_Guard<LockType>     ReadGuard;
-        typedef   ACE_Write_Guard<LockType>    WriteGuard;
-        LockType& GetLock() { return i_lock; }
+        // partition operations
+        static uint64 MakePartitionKey(WorldStateScope scope, uint32 condition, uint32 instanceId);
+        uint64 GetPartitionKey(uint32 type, uint32 condition, uint32 instanceId) const;
+        uint64 GetPartitionKey(WorldState const* state) const { return GetPartitionKey(state->GetType(), state->GetCondition(), state->GetInstance()); }
+        static uint32 GetLocationPartitionKeys(uint32 mapId, uint32 instanceId, uint32 zoneId, uint32 areaId, uint64* keys);
+        WorldStatePartitionMap const& GetPartitions() const { return *m_partitions.load(); }
+        WorldStatePartition* FindPartition(uint64 key) const;
+        WorldStatePartition* GetOrCreatePartition(uint64 key);
+        WorldState* FindState(WorldStatePartition const* partition, WorldStateTemplate const* tmpl, uint32 instanceId) const;
+        WorldState* FindState(WorldStatePartition const* partition, uint32 stateId, uint32 instanceId, Player* player);
+        WorldState* FindStateFor(Player* player, uint32 stateId);
+        WorldState* FindStateAt(uint32 mapId, uint32 instanceId, uint32 zoneId, uint32 areaId, uint32 stateId);
+        WorldState* AddState(WorldState* state);
+        void RetireStateList(WorldStateList* states);
+        void FreeRetired();
+        void ClearStates();
+        void AddUpdatedFromPartition(WorldStateSet** stateSet, Player* player, uint64 partitionKey, uint64 lastVersion);
 
         WorldStateTemplateMap   m_worldStateTemplates;    // templates storage
-        WorldStateMap           m_worldState;             // data storage
-        LockType                i_lock;
+
+        ACE_Based::AtomicPointer<WorldStatePartitionMap> m_partitions;  // data storage, replaced at partition add
+        ACE_Thread_Mutex        m_partitionsLock;         // partition add and retired data lists
+        std::vector<WorldStatePartitionMap*> m_retiredPartitionMaps;
+        std::vector<WorldStateList*>         m_retiredStateLists;
+
+        ACE_Based::MPSCQueue<WorldState> m_saveQueue;     // states changed after last save
+
+        typedef UNORDERED_MAP<uint32 /* zone id */, uint32 /* map id */> ZoneMapIndex;
+        ZoneMapIndex            m_zoneMaps;               // filled at Initialize, read only later
 };
 
 #define sWorldStateMgr MaNGOS::Singleton<WorldStateMgr>::Instance()
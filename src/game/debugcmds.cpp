@@ -16,6 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include "WorldSocket.h"                                   // must be first to make ACE happy with ACE includes in it
 #include "Common.h"
 #include "Database/DatabaseEnv.h"
 #include "WorldPacket.h"
@@ -31,6 +32,11 @@
 #include "ObjectMgr.h"
 #include "ObjectGuid.h"
 #include "SpellMgr.h"
+#include "WorldSocketMgr.h"
+#include "AuctionHouseMgr.h"
+#include "VMapFactory.h"
+#include "Timer.h"
+#include "PacketReplay.h"
 
 bool ChatHandler::HandleDebugSendSpellFailCommand(char* args)
 {
@@ -1173,3 +1179,221 @@ bool ChatHandler::HandleDebugEnterVehicleCommand(char* args)
     m_session->GetPlayer()->EnterVehicle(target->GetVehicleKit(), seat);
     return true;
 }
+
+bool ChatHandler::HandleDebugBenchAuctionCommand(char* args)
+{
+    uint32 auctions, queries;
+    if (!ExtractOptUInt32(&args, auctions, 20000) || !ExtractOptUInt32(&args, queries, 100))
+        return false;
+
+    if (!auctions || auctions > 500000 || !queries)
+        return false;
+
+    uint64 sortedTime, indexedTime, foundCount;
+    uint32 mismatches;
+    AuctionHouseObject::BenchmarkSearch(m_session->GetPlayer(), auctions, queries, sortedTime, indexedTime, foundCount, mismatches);
+
+    PSendSysMessage("Browse of %u auctions, %u queries:", auctions, queries);
+    PSendSysMessage("Full sort and filter: " UI64FMTD " us per query", sortedTime);
+    PSendSysMessage("Indexed filter and page sort: " UI64FMTD " us per query, " UI64FMTD " auctions found, %u result mismatches", indexedTime, foundCount, mismatches);
+    return true;
+}
+
+bool ChatHandler::HandleDebugBenchLosCommand(char* args)
+{
+    uint32 rays, radius, count;
+    if (!ExtractOptUInt32(&args, rays, 32) || !ExtractOptUInt32(&args, radius, 40) || !ExtractOptUInt32(&args, count, 100))
+        return false;
+
+    if (!rays || rays > 1024 || !radius || radius > 200 || !count)
+        return false;
+
+    Player* player = m_session->GetPlayer();
+    VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
+
+    // rays from eye level to points around in all directions and at different heights,
+    // like area spell target checks, traced in tiles loaded around player
+    float srcX = player->GetPositionX();
+    float srcY = player->GetPositionY();
+    float srcZ = player->GetPositionZ() + 2.0f;
+
+    std::vector<float> dest(rays * 3);
+    for (uint32 i = 0; i < rays; ++i)
+    {
+        float angle = 2 * M_PI_F * i / rays;
+        float dist = radius * frand(0.25f, 1.0f);
+        dest[i * 3 + 0] = srcX + dist * cos(angle);
+        dest[i * 3 + 1] = srcY + dist * sin(angle);
+        dest[i * 3 + 2] = srcZ + frand(-4.0f, 8.0f);
+    }
+
+    std::vector<bool> scalarResults(rays);
+    uint64 scalarTime = WorldTimer::getMicroTime();
+    for (uint32 c = 0; c < count; ++c)
+        for (uint32 i = 0; i < rays; ++i)
+            scalarResults[i] = vmgr->isInLineOfSight(player->GetMapId(), srcX, srcY, srcZ, dest[i * 3], dest[i * 3 + 1], dest[i * 3 + 2]);
+    scalarTime = WorldTimer::getMicroTime() - scalarTime;
+
+    bool* packetResults = new bool[rays];
+    uint64 packetTime = WorldTimer::getMicroTime();
+    for (uint32 c = 0; c < count; ++c)
+        vmgr->isInLineOfSight(player->GetMapId(), srcX, srcY, srcZ, &dest[0], rays, packetResults);
+    packetTime = WorldTimer::getMicroTime() - packetTime;
+
+    uint32 blocked = 0;
+    uint32 mismatches = 0;
+    for (uint32 i = 0; i < rays; ++i)
+    {
+        if (!scalarResults[i])
+            ++blocked;
+        if (scalarResults[i] != packetResults[i])
+            ++mismatches;
+    }
+    delete[] packetResults;
+
+    PSendSysMessage("Line of sight of %u rays up to %u yards (%u blocked), %u times:", rays, radius, blocked, count);
+    PSendSysMessage("Single rays: " UI64FMTD " us total, %.3f us per ray", scalarTime, float(scalarTime) / (rays * count));
+    PSendSysMessage("Ray packets: " UI64FMTD " us total, %.3f us per ray, %u result mismatches", packetTime, float(packetTime) / (rays * count), mismatches);
+    return true;
+}
+
+bool ChatHandler::HandleDebugBenchReplayStartCommand(char* args)
+{
+    char* fileName = ExtractQuotedOrLiteralArg(&args);
+    if (!fileName)
+        return false;
+
+    uint32 sessions;
+    float speed;
+    if (!ExtractOptUInt32(&args, sessions, 10) || !ExtractOptFloat(&args, speed, 1.0f))
+        return false;
+
+    char* prefix = ExtractLiteralArg(&args);
+
+    std::string error;
+    if (!sPacketReplayMgr.Start(fileName, sessions, speed, prefix ? prefix : "Bench", error))
+    {
+        PSendSysMessage("Packet replay not started: %s", error.c_str());
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    PacketReplayStatistics stats = sPacketReplayMgr.GetStatistics();
+    PSendSysMessage("Packet replay of %u recorded sessions by %u characters started, speed %.2f",
+        sPacketReplayMgr.GetRecordedSessionCount(), stats.sessions, sPacketReplayMgr.GetSpeed());
+    return true;
+}
+
+bool ChatHandler::HandleDebugBenchReplayStatsCommand(char* args)
+{
+    uint32 opcodes;
+    if (!ExtractOptUInt32(&args, opcodes, 10))
+        return false;
+
+    PacketReplayStatistics stats = sPacketReplayMgr.GetStatistics();
+    PSendSysMessage("Packet replay %s: %u characters, %u logged in, %u finished, %u failed",
+        sPacketReplayMgr.IsRunning() ? "running" : "stopped", stats.sessions, stats.loggedIn, stats.finished, stats.failed);
+    PSendSysMessage("Packets: %u executed, %u skipped", stats.packets, stats.skippedPackets);
+    PSendSysMessage("World update of %u ticks (us): min %u, avg %u, 50%% %u, 90%% %u, 99%% %u, max %u",
+        stats.ticks, stats.tickMin, stats.tickAvg, stats.tickP50, stats.tickP90, stats.tickP99, stats.tickMax);
+
+    if (stats.startMemory && stats.currentMemory)
+        PSendSysMessage("Memory: %u KB at start, %u KB now, growth %i KB", stats.startMemory, stats.currentMemory, int32(stats.currentMemory - stats.startMemory));
+
+    std::vector<PacketReplayOpcodeStatistics> opcodeStats;
+    sPacketReplayMgr.GetOpcodeStatistics(opcodeStats);
+    for (size_t i = 0; i < opcodeStats.size() && i < opcodes; ++i)
+    {
+        PacketReplayOpcodeStatistics const& opcode = opcodeStats[i];
+        PSendSysMessage("%s (0x%.4X): %u packets, " UI64FMTD " us total, %.1f us avg, %u us max", LookupOpcodeName(opcode.opcode), opcode.opcode,
+            opcode.count, opcode.totalTime, float(opcode.totalTime) / opcode.count, opcode.maxTime);
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleDebugBenchReplayStopCommand(char* /*args*/)
+{
+    if (!sPacketReplayMgr.IsRunning())
+    {
+        SendSysMessage("Packet replay is not running");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    sPacketReplayMgr.Stop();
+    SendSysMessage("Packet replay stopped, replay characters logged out");
+    return true;
+}
+
+bool ChatHandler::HandleDebugBenchValuesCommand(char* args)
+{
+    uint32 observers, step, count;
+    if (!ExtractOptUInt32(&args, observers, 200) || !ExtractOptUInt32(&args, step, 4) || !ExtractOptUInt32(&args, count, 100))
+        return false;
+
+    if (!observers || observers > 5000 || !step || !count)
+        return false;
+
+    Player* player = m_session->GetPlayer();
+    Unit* target = getSelectedUnit();
+    if (!target)
+        target = player;
+
+    // distinct players of target's map, those with own visibility class (target itself, owner, group members) first
+    std::vector<Player*> candidates;
+    if (target->GetTypeId() == TYPEID_PLAYER)
+        candidates.push_back((Player*)target);
+
+    Player* ownerPlayer = target->GetCharmerOrOwnerPlayerOrPlayerItself();
+    if (ownerPlayer && ownerPlayer->IsInMap(target))
+        candidates.push_back(ownerPlayer);
+
+    if (Group* group = ownerPlayer ? ownerPlayer->GetGroup() : NULL)
+        for (GroupReference* itr = group->GetFirstMember(); itr != NULL; itr = itr->next())
+            if (Player* member = itr->getSource())
+                if (member->IsInMap(target))
+                    candidates.push_back(member);
+
+    candidates.push_back(player);
+
+    Map::PlayerList const& mapPlayers = target->GetMap()->GetPlayers();
+    for (Map::PlayerList::const_iterator itr = mapPlayers.begin(); itr != mapPlayers.end(); ++itr)
+        if (Player* mapPlayer = itr->getSource())
+            candidates.push_back(mapPlayer);
+
+    std::vector<Player*> observerList;
+    std::set<Player*> added;
+    for (std::vector<Player*>::const_iterator itr = candidates.begin(); itr != candidates.end() && observerList.size() < observers; ++itr)
+        if (added.insert(*itr).second)
+            observerList.push_back(*itr);
+
+    uint64 perTargetTime, sharedTime;
+    uint32 fields, classes, mismatches;
+    target->BenchmarkValuesUpdate(observerList, step, count, perTargetTime, sharedTime, fields, classes, mismatches);
+
+    uint32 used = observerList.size();
+    PSendSysMessage("Values update of %u fields of %s for %u observers (%u visibility classes), %u times:", fields, target->GetGuidStr().c_str(), used, classes, count);
+    PSendSysMessage("Block per observer: " UI64FMTD " us total, %.3f us per observer", perTargetTime, float(perTargetTime) / (used * count));
+    PSendSysMessage("Shared blocks: " UI64FMTD " us total, %.3f us per observer, %u block mismatches", sharedTime, float(sharedTime) / (used * count), mismatches);
+    return true;
+}
+
+bool ChatHandler::HandleDebugBenchBroadcastCommand(char* args)
+{
+    uint32 receivers, size, count;
+    if (!ExtractOptUInt32(&args, receivers, 40) || !ExtractOptUInt32(&args, size, 1024) || !ExtractOptUInt32(&args, count, 1000))
+        return false;
+
+    if (!receivers || receivers > 1000 || size > 65535 || !count)
+        return false;
+
+    uint64 copiedBytes, copiedTime, sharedBytes, sharedTime;
+    WorldSocket::BenchmarkBroadcast(receivers, size, count, copiedBytes, copiedTime, sharedBytes, sharedTime);
+
+    PSendSysMessage("Broadcast of %u bytes packet to %u receivers, %u times:", size, receivers, count);
+    PSendSysMessage("Copy to each socket: " UI64FMTD " bytes copied, " UI64FMTD " us per broadcast", copiedBytes, copiedTime);
+    PSendSysMessage("Shared payload: " UI64FMTD " bytes copied, " UI64FMTD " us per broadcast", sharedBytes, sharedTime);
+    PSendSysMessage("Network.SharedPacketMinSize is %u", uint32(sWorldSocketMgr->GetSharedPacketMinSize()));
+    return true;
+}
@@ -72,6 +72,49 @@ struct AABound
     Vector3 lo, hi;
 };
 
+#define BIH_PACKET_SIZE 4
+
+/** Up to BIH_PACKET_SIZE rays traversed together through BIH.
+    Stored as structure of arrays, so primitive tests can check all rays of packet at once.
+    Rays of one packet don't need common origin or direction, but packets of coherent rays
+    (like from one caster to its targets) share most of the visited nodes.
+*/
+struct RayPacket
+{
+    RayPacket() : count(0), active(0)
+    {
+        for (int i = 0; i < 3; ++i)
+            for (int r = 0; r < BIH_PACKET_SIZE; ++r)
+                org[i][r] = dir[i][r] = invDir[i][r] = 0.f;
+        for (int r = 0; r < BIH_PACKET_SIZE; ++r)
+            maxDist[r] = 0.f;
+    }
+
+    void setRay(uint32 index, const Ray& ray, float dist)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            org[i][index] = ray.origin()[i];
+            dir[i][index] = ray.direction()[i];
+            invDir[i][index] = 1.f / dir[i][index];
+        }
+        maxDist[index] = dist;
+    }
+
+    Ray getRay(uint32 index) const
+    {
+        return Ray::fromOriginAndDirection(Vector3(org[0][index], org[1][index], org[2][index]),
+            Vector3(dir[0][index], dir[1][index], dir[2][index]));
+    }
+
+    float org[3][BIH_PACKET_SIZE];
+    float dir[3][BIH_PACKET_SIZE];
+    float invDir[3][BIH_PACKET_SIZE];
+    float maxDist[BIH_PACKET_SIZE];                         // shortened by hits, like maxDist of intersectRay
+    uint32 count;                                           // used rays, indexes 0..count-1
+    uint32 active;                                          // mask of rays still traced (cleared by stopAtFirst hits)
+};
+
 /** Bounding Interval Hierarchy Class.
     Building and Ray-Intersection functions based on BIH from
     Sunflow, a Java Raytracer, released under MIT/X11 License
@@ -274,6 +317,193 @@ class BIH
             }
         }
 
+        /** Packet version of intersectRay for rays of mask (and packet.active).
+            Callback is called as callback(packet, mask, entry, stopAtFirst) for rays of mask reaching
+            the leaf and must return mask of rays hit (with their packet.maxDist shortened).
+        */
+        template<typename PacketCallback>
+        void intersectPacket(RayPacket& packet, uint32 mask, PacketCallback& intersectCallback, bool stopAtFirst = false) const
+        {
+            float intervalMin[BIH_PACKET_SIZE];
+            float intervalMax[BIH_PACKET_SIZE];
+            uint32 signBit[3][BIH_PACKET_SIZE];
+
+            mask &= packet.active;
+            for (uint32 r = 0; r < packet.count; ++r)
+            {
+                if (!(mask & (1 << r)))
+                    continue;
+
+                for (int i = 0; i < 3; ++i)
+                    signBit[i][r] = floatToRawIntBits(packet.dir[i][r]) >> 31;
+
+                if (!clipToBounds(packet, r, intervalMin[r], intervalMax[r]))
+                    mask &= ~(1 << r);
+            }
+
+            if (!mask)
+                return;
+
+            PacketStackNode stack[MAX_STACK_SIZE];
+            int stackPos = 0;
+            int node = 0;
+
+            while (true)
+            {
+                while (true)
+                {
+                    uint32 tn = tree[node];
+                    uint32 axis = (tn & (3 << 30)) >> 30;
+                    bool BVH2 = tn & (1 << 29);
+                    int offset = tn & ~(7 << 29);
+                    if (!BVH2)
+                    {
+                        if (axis < 3)
+                        {
+                            // "normal" interior node, same decisions as intersectRay made per ray
+                            uint32 childMask[2] = { 0, 0 };     // left, right
+                            float childMin[2][BIH_PACKET_SIZE];
+                            float childMax[2][BIH_PACKET_SIZE];
+                            uint32 nearChild = 2;
+
+                            for (uint32 r = 0; r < packet.count; ++r)
+                            {
+                                if (!(mask & (1 << r)))
+                                    continue;
+
+                                uint32 front = signBit[axis][r];            // 0 - left child is near
+                                float tf = (intBitsToFloat(tree[node + 1 + front]) - packet.org[axis][r]) * packet.invDir[axis][r];
+                                float tb = (intBitsToFloat(tree[node + 2 - front]) - packet.org[axis][r]) * packet.invDir[axis][r];
+
+                                if (!(tf < intervalMin[r]))
+                                {
+                                    childMask[front] |= 1 << r;
+                                    childMin[front][r] = intervalMin[r];
+                                    childMax[front][r] = (tf <= intervalMax[r]) ? tf : intervalMax[r];
+                                }
+                                if (!(tb > intervalMax[r]))
+                                {
+                                    childMask[front ^ 1] |= 1 << r;
+                                    childMin[front ^ 1][r] = (tb >= intervalMin[r]) ? tb : intervalMin[r];
+                                    childMax[front ^ 1][r] = intervalMax[r];
+                                }
+
+                                // near child of first ray goes first
+                                if (nearChild == 2)
+                                    nearChild = front;
+                            }
+
+                            if (!childMask[0] && !childMask[1])
+                                break;
+
+                            uint32 first = childMask[nearChild] ? nearChild : nearChild ^ 1;
+                            uint32 second = first ^ 1;
+                            if (childMask[second])
+                            {
+                                PacketStackNode& entry = stack[stackPos];
+                                entry.node = offset + second * 3;
+                                entry.mask = childMask[second];
+                                for (uint32 r = 0; r < packet.count; ++r)
+                                {
+                                    if (entry.mask & (1 << r))
+                                    {
+                                        entry.tnear[r] = childMin[second][r];
+                                        entry.tfar[r] = childMax[second][r];
+                                    }
+                                }
+                                ++stackPos;
+                            }
+
+                            node = offset + first * 3;
+                            mask = childMask[first];
+                            for (uint32 r = 0; r < packet.count; ++r)
+                            {
+                                if (mask & (1 << r))
+                                {
+                                    intervalMin[r] = childMin[first][r];
+                                    intervalMax[r] = childMax[first][r];
+                                }
+                            }
+                            continue;
+                        }
+                        else
+                        {
+                            // leaf - test some objects
+                            int n = tree[node + 1];
+                            while (n > 0)
+                            {
+                                uint32 hits = intersectCallback(packet, mask, objects[offset], stopAtFirst);
+                                if (stopAtFirst && hits)
+                                {
+                                    packet.active &= ~hits;
+                                    mask &= ~hits;
+                                    if (!packet.active)
+                                        return;
+                                    if (!mask)
+                                        break;
+                                }
+                                --n;
+                                ++offset;
+                            }
+                            break;
+                        }
+                    }
+                    else
+                    {
+                        if (axis > 2)
+                            return; // should not happen
+
+                        for (uint32 r = 0; r < packet.count; ++r)
+                        {
+                            if (!(mask & (1 << r)))
+                                continue;
+
+                            uint32 front = signBit[axis][r];
+                            float tf = (intBitsToFloat(tree[node + 1 + front]) - packet.org[axis][r]) * packet.invDir[axis][r];
+                            float tb = (intBitsToFloat(tree[node + 2 - front]) - packet.org[axis][r]) * packet.invDir[axis][r];
+                            intervalMin[r] = (tf >= intervalMin[r]) ? tf : intervalMin[r];
+                            intervalMax[r] = (tb <= intervalMax[r]) ? tb : intervalMax[r];
+                            if (intervalMin[r] > intervalMax[r])
+                                mask &= ~(1 << r);
+                        }
+
+                        node = offset;
+                        if (!mask)
+                            break;
+                        continue;
+                    }
+                } // traversal loop
+                do
+                {
+                    // stack is empty?
+                    if (stackPos == 0)
+                        return;
+                    // move back up the stack
+                    --stackPos;
+                    PacketStackNode const& entry = stack[stackPos];
+                    mask = entry.mask & packet.active;
+                    for (uint32 r = 0; r < packet.count; ++r)
+                    {
+                        if (!(mask & (1 << r)))
+                            continue;
+
+                        if (packet.maxDist[r] < entry.tnear[r])
+                            mask &= ~(1 << r);
+                        else
+                        {
+                            intervalMin[r] = entry.tnear[r];
+                            intervalMax[r] = entry.tfar[r];
+                        }
+                    }
+                    if (!mask)
+                        continue;
+                    node = entry.node;
+                    break;
+                }
+                while (true);
+            }
+        }
+
         template<typename IsectCallback>
         void intersectPoint(const Vector3& p, IsectCallback& intersectCallback) const
         {
@@ -377,6 +607,42 @@ class BIH
             float tnear;
             float tfar;
         };
+        struct PacketStackNode
+        {
+            uint32 node;
+            uint32 mask;
+            float tnear[BIH_PACKET_SIZE];
+            float tfar[BIH_PACKET_SIZE];
+        };
+
+        // ray interval inside tree bounds, false if ray misses them (same as start of intersectRay)
+        bool clipToBounds(const RayPacket& packet, uint32 r, float& intervalMin, float& intervalMax) const
+        {
+            intervalMin = -1.f;
+            intervalMax = -1.f;
+            for (int i = 0; i < 3; ++i)
+            {
+                if (G3D::fuzzyNe(packet.dir[i][r], 0.0f))
+                {
+                    float t1 = (bounds.low()[i]  - packet.org[i][r]) * packet.invDir[i][r];
+                    float t2 = (bounds.high()[i] - packet.org[i][r]) * packet.invDir[i][r];
+                    if (t1 > t2)
+                        std::swap(t1, t2);
+                    if (t1 > intervalMin)
+                        intervalMin = t1;
+                    if (t2 < intervalMax || intervalMax < 0.f)
+                        intervalMax = t2;
+                    if (intervalMax <= 0 || intervalMin >= packet.maxDist[r])
+                        return false;
+                }
+            }
+
+            if (intervalMin > intervalMax)
+                return false;
+            intervalMin = std::max(intervalMin, 0.f);
+            intervalMax = std::min(intervalMax, packet.maxDist[r]);
+            return true;
+        }
 
         class BuildStats
         {
@@ -48,6 +48,22 @@ namespace VMAP
             bool hit;
     };
 
+    class MapPacketCallback
+    {
+        public:
+            MapPacketCallback(ModelInstance* val): prims(val), hits(0) {}
+            uint32 operator()(RayPacket& packet, uint32 mask, uint32 entry, bool pStopAtFirstHit)
+            {
+                uint32 result = prims[entry].intersectPacket(packet, mask, pStopAtFirstHit);
+                hits |= result;
+                return result;
+            }
+            uint32 getHits() const { return hits; }
+        protected:
+            ModelInstance* prims;
+            uint32 hits;
+    };
+
     class AreaInfoCallback
     {
         public:
@@ -167,6 +183,39 @@ namespace VMAP
         return true;
     }
     //=========================================================
+
+    void StaticMapTree::isInLineOfSight(const Vector3& pos1, const Vector3* pos2, uint32 count, bool* results) const
+    {
+        for (uint32 start = 0; start < count; start += BIH_PACKET_SIZE)
+        {
+            RayPacket packet;
+            packet.count = std::min<uint32>(BIH_PACKET_SIZE, count - start);
+            for (uint32 r = 0; r < packet.count; ++r)
+            {
+                results[start + r] = true;
+
+                float maxDist = (pos2[start + r] - pos1).magnitude();
+                // valid map coords should *never ever* produce float overflow, but this would produce NaNs too:
+                MANGOS_ASSERT(maxDist < std::numeric_limits<float>::max());
+                // prevent NaN values which can cause BIH intersection to enter infinite loop
+                if (maxDist < 1e-10f)
+                    continue;
+
+                packet.setRay(r, G3D::Ray::fromOriginAndDirection(pos1, (pos2[start + r] - pos1) / maxDist), maxDist);
+                packet.active |= 1 << r;
+            }
+
+            if (!packet.active)
+                continue;
+
+            MapPacketCallback intersectionCallBack(iTreeValues);
+            iTree.intersectPacket(packet, packet.active, intersectionCallBack, true);
+            for (uint32 r = 0; r < packet.count; ++r)
+                if (intersectionCallBack.getHits() & (1 << r))
+                    results[start + r] = false;
+        }
+    }
+    //=========================================================
     /**
     When moving from pos1 to pos2 check if we hit an object. Return true and the position if we hit one
     Return the hit pos or the original dest pos
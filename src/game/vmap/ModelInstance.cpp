@@ -62,6 +62,38 @@ namespace VMAP
         return hit;
     }
 
+    uint32 ModelInstance::intersectPacket(RayPacket& pPacket, uint32 pMask, bool pStopAtFirstHit) const
+    {
+        if (!iModel)
+            return 0;
+
+        // child bounds are defined in object space, rays keep their packet indexes
+        RayPacket modPacket;
+        modPacket.count = pPacket.count;
+        for (uint32 r = 0; r < pPacket.count; ++r)
+        {
+            if (!(pMask & (1 << r)))
+                continue;
+
+            Ray ray = pPacket.getRay(r);
+            if (ray.intersectionTime(iBound) == G3D::inf())
+                continue;
+
+            Vector3 p = iInvRot * (ray.origin() - iPos) * iInvScale;
+            modPacket.setRay(r, Ray(p, iInvRot * ray.direction()), pPacket.maxDist[r] * iInvScale);
+            modPacket.active |= 1 << r;
+        }
+
+        if (!modPacket.active)
+            return 0;
+
+        uint32 hits = iModel->IntersectPacket(modPacket, modPacket.active, pStopAtFirstHit);
+        for (uint32 r = 0; r < pPacket.count; ++r)
+            if (hits & (1 << r))
+                pPacket.maxDist[r] = modPacket.maxDist[r] * iScale;
+        return hits;
+    }
+
     void ModelInstance::intersectPoint(const G3D::Vector3& p, AreaInfo& info) const
     {
         if (!iModel)
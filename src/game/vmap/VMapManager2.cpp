@@ -160,6 +160,60 @@ namespace VMAP
         return result;
     }
     //=========================================================
+
+    void VMapManager2::isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, const float* pDest, unsigned int pCount, bool* pResults)
+    {
+        for (unsigned int i = 0; i < pCount; ++i)
+            pResults[i] = true;
+
+        if (!isLineOfSightCalcEnabled() || !pCount)
+            return;
+
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        if (!VMAP::CheckPosition(x1, y1, z1))
+        {
+            for (unsigned int i = 0; i < pCount; ++i)
+                pResults[i] = false;
+            return;
+        }
+
+        Vector3 pos1 = convertPositionToInternalRep(x1, y1, z1);
+
+        // only points which need ray test go to tree, same checks as single ray version
+        std::vector<Vector3> targets;
+        std::vector<unsigned int> indexes;
+        targets.reserve(pCount);
+        indexes.reserve(pCount);
+        for (unsigned int i = 0; i < pCount; ++i)
+        {
+            const float* dest = pDest + i * 3;
+            if (!VMAP::CheckPosition(dest[0], dest[1], dest[2]))
+            {
+                pResults[i] = false;
+                continue;
+            }
+
+            Vector3 pos2 = convertPositionToInternalRep(dest[0], dest[1], dest[2]);
+            if (pos1 == pos2)
+                continue;
+
+            targets.push_back(pos2);
+            indexes.push_back(i);
+        }
+
+        if (targets.empty())
+            return;
+
+        bool* results = new bool[targets.size()];
+        instanceTree->second->isInLineOfSight(pos1, &targets[0], targets.size(), results);
+        for (size_t i = 0; i < targets.size(); ++i)
+            pResults[indexes[i]] = results[i];
+        delete[] results;
+    }
+    //=========================================================
     /**
     get the hit position and return true if we hit something
     otherwise the result pos will be the dest pos
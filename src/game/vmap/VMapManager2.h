@@ -85,6 +85,7 @@ namespace VMAP
             void unloadMap(unsigned int pMapId);
 
             bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) ;
+            void isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, const float* pDest, unsigned int pCount, bool* pResults);
             /**
             fill the hit pos and return true, if an object was hit
             */
@@ -20,6 +20,11 @@
 #include "VMapDefinitions.h"
 #include "MapTree.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define VMAP_PACKET_SSE
+#include <xmmintrin.h>
+#endif
+
 using G3D::Vector3;
 using G3D::Ray;
 
@@ -83,6 +88,75 @@ namespace VMAP
         return false;
     }
 
+    /** Same test as IntersectTriangle for rays of mask, returns mask of rays which hit the triangle
+        closer than their packet.maxDist (shortened to hit distance). With SSE all 4 rays are tested at once.
+    */
+    uint32 IntersectTrianglePacket(const MeshTriangle& tri, std::vector<Vector3>::const_iterator points, RayPacket& packet, uint32 mask)
+    {
+#if defined(VMAP_PACKET_SSE) && BIH_PACKET_SIZE == 4
+        const Vector3& p0 = points[tri.idx0];
+        const Vector3 e1 = points[tri.idx1] - p0;
+        const Vector3 e2 = points[tri.idx2] - p0;
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        const __m128 dx = _mm_loadu_ps(packet.dir[0]);
+        const __m128 dy = _mm_loadu_ps(packet.dir[1]);
+        const __m128 dz = _mm_loadu_ps(packet.dir[2]);
+        const __m128 e1x = _mm_set1_ps(e1.x), e1y = _mm_set1_ps(e1.y), e1z = _mm_set1_ps(e1.z);
+        const __m128 e2x = _mm_set1_ps(e2.x), e2y = _mm_set1_ps(e2.y), e2z = _mm_set1_ps(e2.z);
+
+        // p = dir x e2, a = e1 . p
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        const __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+        // |a| >= EPS, otherwise determinant is ill-conditioned
+        const __m128 absA = _mm_max_ps(a, _mm_sub_ps(zero, a));
+        __m128 valid = _mm_cmpge_ps(absA, _mm_set1_ps(1e-5f));
+        if (!(_mm_movemask_ps(valid) & mask))
+            return 0;
+
+        const __m128 f = _mm_div_ps(one, a);
+        const __m128 sx = _mm_sub_ps(_mm_loadu_ps(packet.org[0]), _mm_set1_ps(p0.x));
+        const __m128 sy = _mm_sub_ps(_mm_loadu_ps(packet.org[1]), _mm_set1_ps(p0.y));
+        const __m128 sz = _mm_sub_ps(_mm_loadu_ps(packet.org[2]), _mm_set1_ps(p0.z));
+
+        const __m128 u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+
+        // q = s x e1
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+        const __m128 v = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+
+        const __m128 t = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, _mm_loadu_ps(packet.maxDist))));
+
+        uint32 hits = uint32(_mm_movemask_ps(valid)) & mask;
+        if (hits)
+        {
+            float dist[4];
+            _mm_storeu_ps(dist, t);
+            for (uint32 r = 0; r < 4; ++r)
+                if (hits & (1 << r))
+                    packet.maxDist[r] = dist[r];
+        }
+        return hits;
+#else
+        uint32 hits = 0;
+        for (uint32 r = 0; r < packet.count; ++r)
+            if ((mask & (1 << r)) && IntersectTriangle(tri, points, packet.getRay(r), packet.maxDist[r]))
+                hits |= 1 << r;
+        return hits;
+#endif
+    }
+
     class TriBoundFunc
     {
         public:
@@ -368,6 +442,30 @@ namespace VMAP
         return callback.hit;
     }
 
+    struct GModelPacketCallback
+    {
+        GModelPacketCallback(const std::vector<MeshTriangle>& tris, const std::vector<Vector3>& vert):
+            vertices(vert.begin()), triangles(tris.begin()), hits(0) {}
+        uint32 operator()(RayPacket& packet, uint32 mask, uint32 entry, bool /*pStopAtFirstHit*/)
+        {
+            uint32 result = IntersectTrianglePacket(triangles[entry], vertices, packet, mask);
+            hits |= result;
+            return result;
+        }
+        std::vector<Vector3>::const_iterator vertices;
+        std::vector<MeshTriangle>::const_iterator triangles;
+        uint32 hits;
+    };
+
+    uint32 GroupModel::IntersectPacket(RayPacket& packet, uint32 mask, bool stopAtFirstHit) const
+    {
+        if (triangles.empty())
+            return 0;
+        GModelPacketCallback callback(triangles, vertices);
+        meshTree.intersectPacket(packet, mask, callback, stopAtFirstHit);
+        return callback.hits;
+    }
+
     bool GroupModel::IsInsideObject(const Vector3& pos, const Vector3& down, float& z_dist) const
     {
         if (triangles.empty() || !iBound.contains(pos))
@@ -429,6 +527,29 @@ namespace VMAP
         return isc.hit;
     }
 
+    struct WModelPacketCallback
+    {
+        WModelPacketCallback(const std::vector<GroupModel>& mod): models(mod.begin()), hits(0) {}
+        uint32 operator()(RayPacket& packet, uint32 mask, uint32 entry, bool pStopAtFirstHit)
+        {
+            uint32 result = models[entry].IntersectPacket(packet, mask, pStopAtFirstHit);
+            hits |= result;
+            return result;
+        }
+        std::vector<GroupModel>::const_iterator models;
+        uint32 hits;
+    };
+
+    uint32 WorldModel::IntersectPacket(RayPacket& packet, uint32 mask, bool stopAtFirstHit) const
+    {
+        if (groupModels.size() == 1)
+            return groupModels[0].IntersectPacket(packet, mask, stopAtFirstHit);
+
+        WModelPacketCallback isc(groupModels);
+        groupTree.intersectPacket(packet, mask, isc, stopAtFirstHit);
+        return isc.hits;
+    }
+
     class WModelAreaCallback
     {
         public:
@@ -86,6 +86,8 @@ namespace VMAP
             void setMeshData(std::vector<Vector3>& vert, std::vector<MeshTriangle>& tri);
             void setLiquidData(WmoLiquid*& liquid) { iLiquid = liquid; liquid = NULL; }
             bool IntersectRay(const G3D::Ray& ray, float& distance, bool stopAtFirstHit) const;
+            //! packet version of IntersectRay for rays of mask, returns mask of rays hit
+            uint32 IntersectPacket(RayPacket& packet, uint32 mask, bool stopAtFirstHit) const;
             bool IsInsideObject(const Vector3& pos, const Vector3& down, float& z_dist) const;
             bool GetLiquidLevel(const Vector3& pos, float& liqHeight) const;
             uint32 GetLiquidType() const;
@@ -118,6 +120,7 @@ namespace VMAP
             void setGroupModels(std::vector<GroupModel>& models);
             void setRootWmoID(uint32 id) { RootWMOID = id; }
             bool IntersectRay(const G3D::Ray& ray, float& distance, bool stopAtFirstHit) const;
+            uint32 IntersectPacket(RayPacket& packet, uint32 mask, bool stopAtFirstHit) const;
             bool IntersectPoint(const G3D::Vector3& p, const G3D::Vector3& down, float& dist, AreaInfo& info) const;
             bool GetLocationInfo(const G3D::Vector3& p, const G3D::Vector3& down, float& dist, LocationInfo& info) const;
             bool writeFile(const std::string& filename);
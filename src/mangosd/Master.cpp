@@ -96,6 +96,7 @@ public:
             else if (WorldTimer::getMSTimeDiff(w_lastchange, curtime) > _delaytime)
             {
                 sLog.outError("World Thread hangs, kicking out server!");
+                sLog.Flush();
                 *((uint32 volatile*)NULL) = 0;              // bang crash
             }
         }
@@ -421,6 +422,9 @@ int Master::Run()
         delete cliThread;
     }
 
+    ///- Write rest of queued log output
+    sLog.StopWriter();
+
     ///- Exit the process with specified return value
     return World::GetExitCode();
 }
@@ -462,6 +466,7 @@ bool Master::_StartDB()
 
     dbstring = sConfig.GetStringDefault("CharacterDatabaseInfo", "");
     nConnections = sConfig.GetIntDefault("CharacterDatabaseConnections", 1);
+    int nWriteConnections = sConfig.GetIntDefault("CharacterDatabaseWriteConnections", 0);
     if(dbstring.empty())
     {
         sLog.outError("Character Database not specified in configuration file");
@@ -470,7 +475,6 @@ bool Master::_StartDB()
         WorldDatabase.HaltDelayThread();
         return false;
     }
-    sLog.outString("Character Database total connections: %i", nConnections + 1);
 
 #ifdef MANGOSR2_SINGLE_THREAD
     if (nConnections > 1)
@@ -478,10 +482,21 @@ bool Master::_StartDB()
         sLog.outError(" Your OS (%s) not support set CharacterDatabaseConnections > 1! Resetted to 1", MANGOSR2_SINGLE_THREAD);
         nConnections = 1;
     }
+
+    if (nWriteConnections > 0)
+    {
+        sLog.outError(" Your OS (%s) not support set CharacterDatabaseWriteConnections > 0! Resetted to 0", MANGOSR2_SINGLE_THREAD);
+        nWriteConnections = 0;
+    }
 #endif
 
+    if (nWriteConnections < 0)
+        nWriteConnections = 0;
+
+    sLog.outString("Character Database total connections: %i", nConnections + nWriteConnections + 1);
+
     ///- Initialise the Character database
-    if(!CharacterDatabase.Initialize(dbstring.c_str(), nConnections))
+    if(!CharacterDatabase.Initialize(dbstring.c_str(), nConnections, nWriteConnections))
     {
         sLog.outError("Cannot connect to Character database %s",dbstring.c_str());
 
@@ -637,6 +652,7 @@ void Master::_OnSignal(int s)
                     if (counter > sWorld.getConfig(CONFIG_UINT32_VMSS_MAXTHREADBREAKS))
                     {
                         sLog.outError("VMSS:: Limit of map restarting (map %u instance %u) exceeded. Stopping world!",mapPair->nMapId, mapPair->nInstanceId);
+                        sLog.Flush();
                         signal(s, SIG_DFL);
                         ACE_OS::kill(getpid(), s);
                     }
@@ -663,12 +679,14 @@ void Master::_OnSignal(int s)
                         found = next+1;
                     }
                     sLog.outError("VMSS:: /BackTrace");
+                    sLog.Flush();
                     signal(s, SIG_DFL);
                     ACE_OS::kill(getpid(), s);
                 }
             }
             else
             {
+                sLog.Flush();
                 signal(s, SIG_DFL);
                 ACE_OS::kill(getpid(), s);
             }
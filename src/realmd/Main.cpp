@@ -367,6 +367,7 @@ extern int main(int argc, char **argv)
     UnhookSignals();
 
     sLog.outString( "Halting process..." );
+    sLog.StopWriter();
     return 0;
 }
 
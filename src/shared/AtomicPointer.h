@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2009-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ATOMICPOINTER_H
+#define ATOMICPOINTER_H
+
+#include "Common.h"
+
+namespace ACE_Based
+{
+    // Pointer with atomic exchange operations, used for publishing data to other threads without locks.
+    // Data written before store/exchange/compareExchange is visible to thread, which got the pointer by load.
+    template <class T>
+        class AtomicPointer
+    {
+        T* volatile _value;
+
+        public:
+
+            AtomicPointer(T* value = NULL)
+                : _value(value)
+            {
+            }
+
+            //! Reads the pointer, later reads of pointed data can't be reordered before it.
+            T* load() const
+            {
+                T* value = _value;
+#if defined(_MSC_VER)
+                _ReadWriteBarrier();                        // volatile read already has acquire semantics
+#elif defined(__GNUC__)
+                __sync_synchronize();
+#else
+#  error "AtomicPointer needs memory barrier of this compiler"
+#endif
+                return value;
+            }
+
+            //! Publishes the pointer, all earlier writes are visible before it.
+            void store(T* value)
+            {
+                exchange(value);
+            }
+
+            //! Sets the pointer and returns old value, full barrier.
+            T* exchange(T* value)
+            {
+#if defined(_MSC_VER)
+                return static_cast<T*>(InterlockedExchangePointer((PVOID volatile*)&_value, value));
+#elif defined(__GNUC__)
+                T* old;
+                do
+                {
+                    old = _value;
+                }
+                while (__sync_val_compare_and_swap(&_value, old, value) != old);
+
+                return old;
+#else
+#  error "AtomicPointer needs atomic compare and exchange of this compiler"
+#endif
+            }
+
+            //! Sets the pointer if it is equal to comparand and returns old value, full barrier.
+            T* compareExchange(T* comparand, T* value)
+            {
+#if defined(_MSC_VER)
+                return static_cast<T*>(InterlockedCompareExchangePointer((PVOID volatile*)&_value, value, comparand));
+#elif defined(__GNUC__)
+                return __sync_val_compare_and_swap(&_value, comparand, value);
+#else
+#  error "AtomicPointer needs atomic compare and exchange of this compiler"
+#endif
+            }
+
+        private:
+
+            AtomicPointer(AtomicPointer const&);
+            AtomicPointer& operator=(AtomicPointer const&);
+    };
+}
+#endif
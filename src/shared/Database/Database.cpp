@@ -90,13 +90,26 @@ bool SqlConnection::ExecuteStmt(int nIndex, const SqlStmtParameters& id )
     return pStmt->execute();
 }
 
+QueryResult* SqlConnection::QueryStmt(int nIndex, const SqlStmtParameters& id )
+{
+    if(nIndex == -1)
+        return NULL;
+
+    //get prepared statement object
+    SqlPreparedStatement * pStmt = GetStmt(nIndex);
+    //bind parameters
+    pStmt->bind(id);
+    //execute statement and fetch result set
+    return pStmt->query();
+}
+
 //////////////////////////////////////////////////////////////////////////
 Database::~Database()
 {
     StopServer();
 }
 
-bool Database::Initialize(const char * infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char * infoString, int nConns /*= 1*/, int nWriters /*= 0*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -110,6 +123,9 @@ bool Database::Initialize(const char * infoString, int nConns /*= 1*/)
 
     m_pingIntervallms = sConfig.GetIntDefault ("MaxPingTime", 30) * (MINUTE * 1000);
 
+    int groupCommitSize = sConfig.GetIntDefault("DatabaseGroupCommitSize", 0);
+    m_groupCommitSize = groupCommitSize > 1 ? uint32(groupCommitSize) : 0;
+
     //create DB connections
 
     //setup connection pool size
@@ -138,6 +154,22 @@ bool Database::Initialize(const char * infoString, int nConns /*= 1*/)
     if(!m_pAsyncConn->Initialize(infoString))
         return false;
 
+    //create connections for partitioned writers
+    if(nWriters > MAX_CONNECTION_POOL_SIZE)
+        nWriters = MAX_CONNECTION_POOL_SIZE;
+
+    for (int i = 0; i < nWriters; ++i)
+    {
+        SqlConnection * pConn = CreateConnection();
+        if(!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_pWriterConns.push_back(pConn);
+    }
+
     m_pResultQueue = new SqlResultQueue;
 
     InitDelayThread();
@@ -160,6 +192,11 @@ void Database::StopServer()
         m_pAsyncConn = NULL;
     }
 
+    for (size_t i = 0; i < m_pWriterConns.size(); ++i)
+        delete m_pWriterConns[i];
+
+    m_pWriterConns.clear();
+
     for (size_t i = 0; i < m_pQueryConnections.size(); ++i)
         delete m_pQueryConnections[i];
 
@@ -167,23 +204,46 @@ void Database::StopServer()
 
 }
 
-SqlDelayThread * Database::CreateDelayThread()
+SqlDelayThread * Database::CreateDelayThread(SqlConnection * conn, uint32 writerIndex)
 {
-    assert(m_pAsyncConn);
-    return new SqlDelayThread(this, m_pAsyncConn);
+    assert(conn);
+    //default writer also pings all other connections
+    return new SqlDelayThread(this, conn, writerIndex == 0, m_groupCommitSize, m_writeOrder, writerIndex);
 }
 
 void Database::InitDelayThread()
 {
     assert(!m_delayThread);
 
+    if(!m_pWriterConns.empty())
+        m_writeOrder = new SqlWriteOrder(m_pWriterConns.size() + 1);
+
     //New delay thread for delay execute
-    m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
+    m_threadBody = CreateDelayThread(m_pAsyncConn, 0);      // will deleted at m_delayThread delete
     m_delayThread = new ACE_Based::Thread(m_threadBody);
+
+    for (size_t i = 0; i < m_pWriterConns.size(); ++i)
+    {
+        SqlDelayThread * pBody = CreateDelayThread(m_pWriterConns[i], i + 1);
+        m_writerBodies.push_back(pBody);
+        m_writerThreads.push_back(new ACE_Based::Thread(pBody));
+    }
 }
 
 void Database::HaltDelayThread()
 {
+    for (size_t i = 0; i < m_writerBodies.size(); ++i)
+        m_writerBodies[i]->Stop();
+
+    for (size_t i = 0; i < m_writerThreads.size(); ++i)
+    {
+        m_writerThreads[i]->wait();
+        delete m_writerThreads[i];
+    }
+
+    m_writerThreads.clear();
+    m_writerBodies.clear();
+
     if (!m_threadBody || !m_delayThread) return;
 
     m_threadBody->Stop();                                   //Stop event
@@ -191,6 +251,30 @@ void Database::HaltDelayThread()
     delete m_delayThread;                                   //This also deletes m_threadBody
     m_delayThread = NULL;
     m_threadBody = NULL;
+
+    delete m_writeOrder;
+    m_writeOrder = NULL;
+}
+
+SqlDelayThread * Database::getAsyncWriter()
+{
+    uint32 key = m_TransStorage->getPartition();
+    if (!key || m_writerBodies.empty())
+        return m_threadBody;
+
+    return m_writerBodies[key % m_writerBodies.size()];
+}
+
+void Database::GetAsyncStats(std::vector<SqlAsyncStats>& stats, bool reset)
+{
+    stats.clear();
+    if (!m_threadBody)
+        return;
+
+    stats.resize(m_writerBodies.size() + 1);
+    m_threadBody->GetStats(stats[0], reset);
+    for (size_t i = 0; i < m_writerBodies.size(); ++i)
+        m_writerBodies[i]->GetStats(stats[i + 1], reset);
 }
 
 void Database::ThreadStart()
@@ -245,6 +329,12 @@ void Database::Ping()
         SqlConnection::Lock guard(m_pQueryConnections[i]);
         delete guard->Query(sql);
     }
+
+    for (size_t i = 0; i < m_pWriterConns.size(); ++i)
+    {
+        SqlConnection::Lock guard(m_pWriterConns[i]);
+        delete guard->Query(sql);
+    }
 }
 
 bool Database::PExecuteLog(const char * format,...)
@@ -347,7 +437,7 @@ bool Database::Execute(const char *sql)
             return DirectExecute(sql);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPlainRequest(sql));
+        getAsyncWriter()->Delay(new SqlPlainRequest(sql));
     }
 
     return true;
@@ -418,7 +508,7 @@ bool Database::CommitTransaction()
         return CommitTransactionDirect();
 
     //add SqlTransaction to the async queue
-    m_threadBody->Delay(m_TransStorage->detach());
+    getAsyncWriter()->Delay(m_TransStorage->detach());
     return true;
 }
 
@@ -559,7 +649,7 @@ bool Database::ExecuteStmt( const SqlStatementID& id, SqlStmtParameters * params
             return DirectExecuteStmt(id, params);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPreparedRequest(id.ID(), params));
+        getAsyncWriter()->Delay(new SqlPreparedRequest(id.ID(), params));
     }
 
     return true;
@@ -574,6 +664,15 @@ bool Database::DirectExecuteStmt( const SqlStatementID& id, SqlStmtParameters *
     return _guard->ExecuteStmt(id.ID(), *params);
 }
 
+QueryResult* Database::QueryStmt( const SqlStatementID& id, SqlStmtParameters * params )
+{
+    MANGOS_ASSERT(params);
+    std::auto_ptr<SqlStmtParameters> p(params);
+    //execute statement on one of query connections
+    SqlConnection::Lock _guard(getQueryConnection());
+    return _guard->QueryStmt(id.ID(), *params);
+}
+
 SqlStatement Database::CreateStatement(SqlStatementID& index, const char * fmt )
 {
     int nId = -1;
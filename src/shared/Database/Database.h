@@ -63,6 +63,7 @@ class MANGOS_DLL_SPEC SqlConnection
 
         //methods to work with prepared statements
         bool ExecuteStmt(int nIndex, const SqlStmtParameters& id);
+        QueryResult* QueryStmt(int nIndex, const SqlStmtParameters& id);
 
         //SqlConnection object lock
         class Lock
@@ -105,7 +106,8 @@ class MANGOS_DLL_SPEC Database
     public:
         virtual ~Database();
 
-        virtual bool Initialize(const char *infoString, int nConns = 1);
+        // nWriters - additional connections for async requests made inside of SqlAsyncPartition scope
+        virtual bool Initialize(const char *infoString, int nConns = 1, int nWriters = 0);
         //start worker thread for async DB request execution
         virtual void InitDelayThread();
         //stop worker thread
@@ -221,9 +223,16 @@ class MANGOS_DLL_SPEC Database
         //NO ASYNC TRANSACTIONS DURING SERVER STARTUP - ONLY DURING RUNTIME!!!
         void AllowAsyncTransactions() { m_bAllowAsyncTransactions = true; }
 
+        //async requests of current thread go to writer selected by key, 0 - default writer (see SqlAsyncPartition)
+        void SetAsyncPartition(uint32 key) { m_TransStorage->setPartition(key); }
+        uint32 GetAsyncPartition() { return m_TransStorage->getPartition(); }
+
+        //statistics of async writers, default writer first
+        void GetAsyncStats(std::vector<SqlAsyncStats>& stats, bool reset);
+
     protected:
         Database(): m_nQueryConnPoolSize(1), m_pAsyncConn(NULL), m_pResultQueue(NULL), m_threadBody(NULL), m_delayThread(NULL),
-            m_bAllowAsyncTransactions(false), m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
+            m_writeOrder(NULL), m_groupCommitSize(0), m_bAllowAsyncTransactions(false), m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
         {
             m_nQueryCounter = -1;
         }
@@ -233,12 +242,12 @@ class MANGOS_DLL_SPEC Database
         //factory method to create SqlConnection objects
         virtual SqlConnection * CreateConnection() = 0;
         //factory method to create SqlDelayThread objects
-        virtual SqlDelayThread * CreateDelayThread();
+        virtual SqlDelayThread * CreateDelayThread(SqlConnection * conn, uint32 writerIndex);
 
         class MANGOS_DLL_SPEC TransHelper
         {
             public:
-                TransHelper() : m_pTrans(NULL) {}
+                TransHelper() : m_pTrans(NULL), m_partition(0) {}
                 ~TransHelper();
 
                 //initializes new SqlTransaction object
@@ -252,8 +261,13 @@ class MANGOS_DLL_SPEC Database
                 //destroyes SqlTransaction allocated by init() function
                 void reset();
 
+                //partition key for async requests of this thread
+                void setPartition(uint32 key) { m_partition = key; }
+                uint32 getPartition() const { return m_partition; }
+
             private:
                 SqlTransaction * m_pTrans;
+                uint32 m_partition;
         };
 
         //per-thread based storage for SqlTransaction object initialization - no locking is required
@@ -266,12 +280,15 @@ class MANGOS_DLL_SPEC Database
         SqlConnection * getQueryConnection();
         //for now return one single connection for async requests
         SqlConnection * getAsyncConnection() const { return m_pAsyncConn; }
+        //delay thread for async requests of current thread partition
+        SqlDelayThread * getAsyncWriter();
 
         friend class SqlStatement;
         //PREPARED STATEMENT API
         //query function for prepared statements
         bool ExecuteStmt(const SqlStatementID& id, SqlStmtParameters * params);
         bool DirectExecuteStmt(const SqlStatementID& id, SqlStmtParameters * params);
+        QueryResult* QueryStmt(const SqlStatementID& id, SqlStmtParameters * params);
 
         //connection helper counters
         int m_nQueryConnPoolSize;                               //current size of query connection pool
@@ -288,6 +305,13 @@ class MANGOS_DLL_SPEC Database
         SqlDelayThread *    m_threadBody;                    ///< Pointer to delay sql executer (owned by m_delayThread)
         ACE_Based::Thread * m_delayThread;                   ///< Pointer to executer thread
 
+        //partitioned writers, requests with same partition key always go to same one and keep their order
+        SqlConnectionContainer m_pWriterConns;
+        std::vector<SqlDelayThread *> m_writerBodies;        ///< owned by m_writerThreads
+        std::vector<ACE_Based::Thread *> m_writerThreads;
+        SqlWriteOrder * m_writeOrder;                        ///< order of requests between default and partitioned writers
+        uint32 m_groupCommitSize;                            ///< max statements committed together by one writer
+
         bool m_bAllowAsyncTransactions;                      ///< flag which specifies if async transactions are enabled
 
         //PREPARED STATEMENT REGISTRY
@@ -307,4 +331,22 @@ class MANGOS_DLL_SPEC Database
         std::string m_logsDir;
         uint32 m_pingIntervallms;
 };
+
+// Async requests of database made by current thread inside of this scope are executed by writer
+// selected by key (for example account id), so all requests with same key keep their order
+// while requests with different keys are written in parallel.
+class MANGOS_DLL_SPEC SqlAsyncPartition
+{
+    public:
+        SqlAsyncPartition(Database& db, uint32 key) : m_db(db), m_prevKey(db.GetAsyncPartition())
+        {
+            m_db.SetAsyncPartition(key);
+        }
+
+        ~SqlAsyncPartition() { m_db.SetAsyncPartition(m_prevKey); }
+
+    private:
+        Database& m_db;
+        uint32 m_prevKey;
+};
 #endif
@@ -386,7 +386,9 @@ bool MySqlPreparedStatement::prepare()
         /* Get total columns in the query */
         m_nColumns = mysql_num_fields(m_pResultMetadata);
 
-        //bind output buffers
+        //let mysql_stmt_store_result() calculate max_length for output buffers
+        my_bool bUpdateMaxLength = 1;
+        mysql_stmt_attr_set(m_stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &bUpdateMaxLength);
     }
 
     m_bPrepared = true;
@@ -482,6 +484,46 @@ bool MySqlPreparedStatement::execute()
     return true;
 }
 
+QueryResult* MySqlPreparedStatement::query()
+{
+    if(!isPrepared() || !isQuery())
+        return NULL;
+
+    if(mysql_stmt_execute(m_stmt))
+    {
+        sLog.outError("SQL: cannot execute '%s'", m_szFmt.c_str());
+        sLog.outError("SQL ERROR: %s", mysql_stmt_error(m_stmt));
+        return NULL;
+    }
+
+    //buffer whole result set on client side
+    if(mysql_stmt_store_result(m_stmt))
+    {
+        sLog.outError("SQL: cannot store result of '%s'", m_szFmt.c_str());
+        sLog.outError("SQL ERROR: %s", mysql_stmt_error(m_stmt));
+        return NULL;
+    }
+
+    uint64 rowCount = mysql_stmt_num_rows(m_stmt);
+    if(!rowCount)
+    {
+        mysql_stmt_free_result(m_stmt);
+        return NULL;
+    }
+
+    //rows are copied into result object, so statement buffers can be released at once
+    QueryResultMysqlBinary * queryResult = new QueryResultMysqlBinary(m_stmt, rowCount, m_nColumns);
+    mysql_stmt_free_result(m_stmt);
+
+    if(!queryResult->NextRow())
+    {
+        delete queryResult;
+        return NULL;
+    }
+
+    return queryResult;
+}
+
 enum_field_types MySqlPreparedStatement::ToMySQLType( const SqlStmtFieldData &data, my_bool &bUnsigned )
 {
     bUnsigned = 0;
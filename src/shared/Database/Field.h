@@ -34,28 +34,47 @@ class Field
             DB_TYPE_BOOL    = 0x04
         };
 
-        Field() : mValue(NULL), mType(DB_TYPE_UNKNOWN) {}
-        Field(const char* value, enum DataTypes type) : mValue(value), mType(type) {}
+        Field() : mValue(NULL), mType(DB_TYPE_UNKNOWN), mNumberType(NUMBER_NONE) {}
+        Field(const char* value, enum DataTypes type) : mValue(value), mType(type), mNumberType(NUMBER_NONE) {}
 
         ~Field() {}
 
         enum DataTypes GetType() const { return mType; }
-        bool IsNULL() const { return mValue == NULL; }
+        bool IsNULL() const { return mValue == NULL && mNumberType == NUMBER_NONE; }
 
-        const char *GetString() const { return mValue; }
+        const char *GetString() const
+        {
+            if (!mValue && mNumberType != NUMBER_NONE)
+                FormatNumber();
+            return mValue;
+        }
         std::string GetCppString() const
         {
-            return mValue ? mValue : "";                    // std::string s = 0 have undefine result in C++
+            const char* value = GetString();
+            return value ? value : "";                      // std::string s = 0 have undefine result in C++
         }
-        float GetFloat() const { return mValue ? static_cast<float>(atof(mValue)) : 0.0f; }
-        bool GetBool() const { return mValue ? atoi(mValue) > 0 : false; }
-        int32 GetInt32() const { return mValue ? static_cast<int32>(atol(mValue)) : int32(0); }
-        uint8 GetUInt8() const { return mValue ? static_cast<uint8>(atol(mValue)) : uint8(0); }
-        uint16 GetUInt16() const { return mValue ? static_cast<uint16>(atol(mValue)) : uint16(0); }
-        int16 GetInt16() const { return mValue ? static_cast<int16>(atol(mValue)) : int16(0); }
-        uint32 GetUInt32() const { return mValue ? static_cast<uint32>(atol(mValue)) : uint32(0); }
+        float GetFloat() const
+        {
+            if (mNumberType != NUMBER_NONE)
+                return mNumberType == NUMBER_DOUBLE ? static_cast<float>(mNumber.d) : static_cast<float>(GetNumberAsInt64());
+            return mValue ? static_cast<float>(atof(mValue)) : 0.0f;
+        }
+        bool GetBool() const
+        {
+            if (mNumberType != NUMBER_NONE)
+                return mNumberType == NUMBER_UINT64 ? mNumber.ui64 > 0 : GetNumberAsInt64() > 0;
+            return mValue ? atoi(mValue) > 0 : false;
+        }
+        int32 GetInt32() const { return mNumberType != NUMBER_NONE ? static_cast<int32>(GetNumberAsInt64()) : (mValue ? static_cast<int32>(atol(mValue)) : int32(0)); }
+        uint8 GetUInt8() const { return mNumberType != NUMBER_NONE ? static_cast<uint8>(GetNumberAsInt64()) : (mValue ? static_cast<uint8>(atol(mValue)) : uint8(0)); }
+        uint16 GetUInt16() const { return mNumberType != NUMBER_NONE ? static_cast<uint16>(GetNumberAsInt64()) : (mValue ? static_cast<uint16>(atol(mValue)) : uint16(0)); }
+        int16 GetInt16() const { return mNumberType != NUMBER_NONE ? static_cast<int16>(GetNumberAsInt64()) : (mValue ? static_cast<int16>(atol(mValue)) : int16(0)); }
+        uint32 GetUInt32() const { return mNumberType != NUMBER_NONE ? static_cast<uint32>(GetNumberAsInt64()) : (mValue ? static_cast<uint32>(atol(mValue)) : uint32(0)); }
         uint64 GetUInt64() const
         {
+            if (mNumberType != NUMBER_NONE)
+                return mNumberType == NUMBER_UINT64 ? mNumber.ui64 : static_cast<uint64>(GetNumberAsInt64());
+
             uint64 value = 0;
             if(!mValue || sscanf(mValue,UI64FMTD,&value) == -1)
                 return 0;
@@ -66,13 +85,55 @@ class Field
         void SetType(enum DataTypes type) { mType = type; }
         //no need for memory allocations to store resultset field strings
         //all we need is to cache pointers returned by different DBMS APIs
-        void SetValue(const char* value) { mValue = value; };
+        void SetValue(const char* value) { mValue = value; mNumberType = NUMBER_NONE; }
+        //binary protocol results keep numbers in native form, text is only produced on GetString() request
+        void SetInt64(int64 value) { mValue = NULL; mNumberType = NUMBER_INT64; mNumber.i64 = value; }
+        void SetUInt64(uint64 value) { mValue = NULL; mNumberType = NUMBER_UINT64; mNumber.ui64 = value; }
+        void SetDouble(double value) { mValue = NULL; mNumberType = NUMBER_DOUBLE; mNumber.d = value; }
 
     private:
         Field(Field const&);
         Field& operator=(Field const&);
 
-        const char* mValue;
+        enum NumberTypes
+        {
+            NUMBER_NONE   = 0,
+            NUMBER_INT64  = 1,
+            NUMBER_UINT64 = 2,
+            NUMBER_DOUBLE = 3
+        };
+
+        int64 GetNumberAsInt64() const
+        {
+            switch (mNumberType)
+            {
+                case NUMBER_UINT64: return static_cast<int64>(mNumber.ui64);
+                case NUMBER_DOUBLE: return static_cast<int64>(mNumber.d);
+                default:            return mNumber.i64;
+            }
+        }
+
+        void FormatNumber() const
+        {
+            switch (mNumberType)
+            {
+                case NUMBER_INT64:  snprintf(mText, sizeof(mText), SI64FMTD, mNumber.i64); break;
+                case NUMBER_UINT64: snprintf(mText, sizeof(mText), UI64FMTD, mNumber.ui64); break;
+                default:            snprintf(mText, sizeof(mText), "%.9g", mNumber.d); break;
+            }
+            mValue = mText;
+        }
+
+        mutable const char* mValue;
         enum DataTypes mType;
+
+        enum NumberTypes mNumberType;
+        union
+        {
+            int64 i64;
+            uint64 ui64;
+            double d;
+        } mNumber;
+        mutable char mText[32];
 };
 #endif
@@ -72,7 +72,7 @@ void QueryResultMysql::EndQuery()
     }
 }
 
-enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysqlType) const
+enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysqlType)
 {
     switch (mysqlType)
     {
@@ -102,4 +102,167 @@ enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysql
             return Field::DB_TYPE_UNKNOWN;
     }
 }
+
+//////////////////////////////////////////////////////////////////////////
+QueryResultMysqlBinary::QueryResultMysqlBinary(MYSQL_STMT *stmt, uint64 rowCount, uint32 fieldCount) :
+    QueryResult(rowCount, fieldCount), mRow(0)
+{
+    mCurrentRow = new Field[mFieldCount];
+    MANGOS_ASSERT(mCurrentRow);
+
+    //max_length is filled by mysql_stmt_store_result() with STMT_ATTR_UPDATE_MAX_LENGTH set
+    MYSQL_RES* metadata = mysql_stmt_result_metadata(stmt);
+    MYSQL_FIELD* fields = mysql_fetch_fields(metadata);
+
+    std::vector<MYSQL_BIND> binds(mFieldCount);
+    std::vector<uint64> numbers(mFieldCount);
+    std::vector<unsigned long> lengths(mFieldCount);
+    std::vector<my_bool> nulls(mFieldCount);
+    std::vector<size_t> bufferOffsets(mFieldCount);
+
+    memset(&binds[0], 0, sizeof(MYSQL_BIND) * mFieldCount);
+    mKinds.resize(mFieldCount);
+
+    //integers are fetched as 64 bit, floats as double, everything else (including DECIMAL) as text
+    size_t bufferSize = 0;
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        mCurrentRow[i].SetType(QueryResultMysql::ConvertNativeType(fields[i].type));
+
+        switch (fields[i].type)
+        {
+            case MYSQL_TYPE_TINY:
+            case MYSQL_TYPE_SHORT:
+            case MYSQL_TYPE_LONG:
+            case MYSQL_TYPE_INT24:
+            case MYSQL_TYPE_LONGLONG:
+                mKinds[i] = (fields[i].flags & UNSIGNED_FLAG) ? CELL_UINT64 : CELL_INT64;
+                break;
+            case MYSQL_TYPE_FLOAT:
+            case MYSQL_TYPE_DOUBLE:
+                mKinds[i] = CELL_DOUBLE;
+                break;
+            default:
+                mKinds[i] = CELL_STRING;
+                bufferOffsets[i] = bufferSize;
+                bufferSize += fields[i].max_length + 1;
+                break;
+        }
+    }
+
+    std::vector<char> buffer(bufferSize + 1);
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        MYSQL_BIND& bind = binds[i];
+        switch (mKinds[i])
+        {
+            case CELL_INT64:
+            case CELL_UINT64:
+                bind.buffer_type = MYSQL_TYPE_LONGLONG;
+                bind.is_unsigned = mKinds[i] == CELL_UINT64;
+                bind.buffer = &numbers[i];
+                break;
+            case CELL_DOUBLE:
+                bind.buffer_type = MYSQL_TYPE_DOUBLE;
+                bind.buffer = &numbers[i];
+                break;
+            default:
+                bind.buffer_type = MYSQL_TYPE_STRING;
+                bind.buffer = &buffer[bufferOffsets[i]];
+                bind.buffer_length = fields[i].max_length + 1;
+                break;
+        }
+        bind.length = &lengths[i];
+        bind.is_null = &nulls[i];
+    }
+
+    mysql_free_result(metadata);
+
+    if (mysql_stmt_bind_result(stmt, &binds[0]))
+    {
+        sLog.outError("SQL ERROR: mysql_stmt_bind_result() failed");
+        sLog.outError("SQL ERROR: %s", mysql_stmt_error(stmt));
+        mRowCount = 0;
+        return;
+    }
+
+    mCells.resize(size_t(mRowCount * mFieldCount));
+
+    Cell* cell = mCells.empty() ? NULL : &mCells[0];
+    uint64 fetched = 0;
+    int fetchResult;
+    while (fetched < mRowCount && ((fetchResult = mysql_stmt_fetch(stmt)) == 0 || fetchResult == MYSQL_DATA_TRUNCATED))
+    {
+        for (uint32 i = 0; i < mFieldCount; ++i, ++cell)
+        {
+            cell->isNull = nulls[i] != 0;
+            if (cell->isNull)
+                continue;
+
+            if (mKinds[i] == CELL_STRING)
+            {
+                const char* value = &buffer[bufferOffsets[i]];
+                cell->value.offset = mStrings.size();
+                mStrings.insert(mStrings.end(), value, value + lengths[i]);
+                mStrings.push_back('\0');
+            }
+            else
+                memcpy(&cell->value, &numbers[i], sizeof(uint64));
+        }
+        ++fetched;
+    }
+
+    mRowCount = fetched;
+}
+
+QueryResultMysqlBinary::~QueryResultMysqlBinary()
+{
+    EndQuery();
+}
+
+bool QueryResultMysqlBinary::NextRow()
+{
+    if (!mCurrentRow)
+        return false;
+
+    if (mRow >= mRowCount)
+    {
+        EndQuery();
+        return false;
+    }
+
+    Cell const* cell = &mCells[size_t(mRow * mFieldCount)];
+    for (uint32 i = 0; i < mFieldCount; ++i, ++cell)
+    {
+        Field& field = mCurrentRow[i];
+        if (cell->isNull)
+        {
+            field.SetValue(NULL);
+            continue;
+        }
+
+        switch (mKinds[i])
+        {
+            case CELL_INT64:  field.SetInt64(cell->value.i64);                  break;
+            case CELL_UINT64: field.SetUInt64(cell->value.ui64);                break;
+            case CELL_DOUBLE: field.SetDouble(cell->value.d);                   break;
+            default:          field.SetValue(&mStrings[cell->value.offset]);    break;
+        }
+    }
+
+    ++mRow;
+    return true;
+}
+
+void QueryResultMysqlBinary::EndQuery()
+{
+    if (mCurrentRow)
+    {
+        delete [] mCurrentRow;
+        mCurrentRow = 0;
+    }
+
+    std::vector<Cell>().swap(mCells);
+    std::vector<char>().swap(mStrings);
+}
 #endif
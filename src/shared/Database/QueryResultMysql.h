@@ -39,11 +39,53 @@ class QueryResultMysql : public QueryResult
 
         bool NextRow();
 
+        static enum Field::DataTypes ConvertNativeType(enum_field_types mysqlType);
+
     private:
-        enum Field::DataTypes ConvertNativeType(enum_field_types mysqlType) const;
         void EndQuery();
 
         MYSQL_RES *mResult;
 };
+
+//result set received by prepared statement (binary protocol)
+//all rows are copied into own storage on creation, numbers are kept in native form
+//so Field accessors do not need to parse text, and statement can be executed again right away
+class QueryResultMysqlBinary : public QueryResult
+{
+    public:
+        QueryResultMysqlBinary(MYSQL_STMT *stmt, uint64 rowCount, uint32 fieldCount);
+
+        ~QueryResultMysqlBinary();
+
+        bool NextRow();
+
+    private:
+        enum CellKind
+        {
+            CELL_INT64  = 0,
+            CELL_UINT64 = 1,
+            CELL_DOUBLE = 2,
+            CELL_STRING = 3
+        };
+
+        struct Cell
+        {
+            union
+            {
+                int64 i64;
+                uint64 ui64;
+                double d;
+                size_t offset;                              // CELL_STRING: position in mStrings
+            } value;
+            bool isNull;
+        };
+
+        void EndQuery();
+
+        std::vector<uint8> mKinds;                          // CellKind per column
+        std::vector<Cell> mCells;                           // mRowCount * mFieldCount
+        std::vector<char> mStrings;                         // zero terminated string/blob values
+        uint64 mRow;
+};
 #endif
 #endif
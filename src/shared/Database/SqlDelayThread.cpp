@@ -19,8 +19,83 @@
 #include "Database/SqlDelayThread.h"
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
+#include "Timer.h"
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_sys_time.h>
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+void SqlAsyncStats::Add(SqlAsyncStats const& stats)
+{
+    queueSize += stats.queueSize;
+    operations += stats.operations;
+    groupCommits += stats.groupCommits;
+    groupedOperations += stats.groupedOperations;
+    totalLatency += stats.totalLatency;
+    if (stats.maxLatency > maxLatency)
+        maxLatency = stats.maxLatency;
+}
+
+uint64 SqlWriteOrder::Register(uint32 writer, SqlWaitList& waitFor)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, 0);
+
+    for (uint32 i = 0; i < m_writers.size(); ++i)
+    {
+        // partitioned writers wait only for default writer, default writer waits for all
+        if (i == writer || (writer != 0 && i != 0))
+            continue;
+
+        WriterState const& state = m_writers[i];
+        if (state.active && state.lastQueued > state.lastDone)
+            waitFor.push_back(std::make_pair(i, state.lastQueued));
+    }
+
+    m_writers[writer].lastQueued = ++m_sequence;
+    return m_sequence;
+}
+
+void SqlWriteOrder::SetDone(uint32 writer, uint64 sequence)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_writers[writer].lastDone = sequence;
+    m_doneCond.broadcast();
+}
+
+void SqlWriteOrder::SetInactive(uint32 writer)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_writers[writer].active = false;
+    m_doneCond.broadcast();
+}
+
+bool SqlWriteOrder::IsReadyLocked(SqlWaitList const& waitFor) const
+{
+    for (SqlWaitList::const_iterator itr = waitFor.begin(); itr != waitFor.end(); ++itr)
+    {
+        WriterState const& state = m_writers[itr->first];
+        if (state.active && state.lastDone < itr->second)
+            return false;
+    }
+
+    return true;
+}
+
+bool SqlWriteOrder::IsReady(SqlWaitList const& waitFor)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, true);
+    return IsReadyLocked(waitFor);
+}
+
+void SqlWriteOrder::WaitReady(SqlWaitList const& waitFor)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    while (!IsReadyLocked(waitFor))
+        m_doneCond.wait();
+}
+
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase, uint32 groupCommitSize,
+    SqlWriteOrder* order, uint32 writerIndex)
+    : m_queueCond(m_queueLock), m_queueSize(0), m_dbEngine(db), m_dbConnection(conn), m_order(order),
+    m_writerIndex(writerIndex), m_pingDatabase(pingDatabase), m_groupCommitSize(groupCommitSize), m_running(true)
 {
 }
 
@@ -30,32 +105,65 @@ SqlDelayThread::~SqlDelayThread()
     ProcessRequests();
 }
 
+bool SqlDelayThread::Delay(SqlOperation* sql)
+{
+    SqlDelayedOperation delayed(sql, WorldTimer::getMicroTime());
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_queueLock, false);
+
+    // registered under queue lock, so sequence numbers in queue are always ascending
+    if (m_order)
+        delayed.sequence = m_order->Register(m_writerIndex, delayed.waitFor);
+
+    ++m_queueSize;
+    m_sqlQueue.push_back(delayed);
+
+    // thread waits only at empty queue
+    if (m_sqlQueue.size() == 1)
+        m_queueCond.signal();
+
+    return true;
+}
+
 void SqlDelayThread::run()
 {
     #ifndef DO_POSTGRESQL
     mysql_thread_init();
     #endif
 
-    const uint32 loopSleepms = 10;
-
-    const uint32 pingEveryLoop = m_dbEngine->GetPingIntervall() / loopSleepms;
+    // wake up at least once per second to check ping time even without requests
+    const ACE_Time_Value maxWaitTime(1);
+    const uint64 pingInterval = uint64(m_dbEngine->GetPingIntervall()) * 1000;
 
-    uint32 loopCounter = 0;
+    uint64 nextPingTime = WorldTimer::getMicroTime() + pingInterval;
     while (m_running)
     {
-        // if the running state gets turned off while sleeping
-        // empty the queue before exiting
-        ACE_Based::Thread::Sleep(loopSleepms);
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_queueLock);
+            if (m_sqlQueue.empty() && m_running)
+            {
+                ACE_Time_Value waitUntil = ACE_OS::gettimeofday() + maxWaitTime;
+                m_queueCond.wait(&waitUntil);
+            }
+        }
 
+        // if the running state gets turned off while waiting
+        // empty the queue before exiting
         ProcessRequests();
 
-        if((loopCounter++) >= pingEveryLoop)
+        uint64 now = WorldTimer::getMicroTime();
+        if (now >= nextPingTime)
         {
-            loopCounter = 0;
-            m_dbEngine->Ping();
+            nextPingTime = now + pingInterval;
+            if (m_pingDatabase)
+                m_dbEngine->Ping();
         }
     }
 
+    // requests queued after this point are executed at thread object delete without waiting for other writers
+    if (m_order)
+        m_order->SetInactive(m_writerIndex);
+
     #ifndef DO_POSTGRESQL
     mysql_thread_end();
     #endif
@@ -63,15 +171,117 @@ void SqlDelayThread::run()
 
 void SqlDelayThread::Stop()
 {
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_queueLock);
     m_running = false;
+    m_queueCond.signal();
 }
 
 void SqlDelayThread::ProcessRequests()
 {
-    SqlOperation* s = NULL;
-    while (m_sqlQueue.next(s))
+    SqlQueue queue;
     {
-        s->Execute(m_dbConnection);
-        delete s;
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_queueLock);
+        queue.swap(m_sqlQueue);
     }
+
+    while (!queue.empty())
+    {
+        if (m_order && !queue.front().waitFor.empty())
+            m_order->WaitReady(queue.front().waitFor);
+
+        // commit sequence of small transactions together, in queue order
+        size_t count = 0;
+        uint32 statements = 0;
+        if (m_groupCommitSize)
+        {
+            for (; count < queue.size(); ++count)
+            {
+                SqlDelayedOperation const& delayed = queue[count];
+                uint32 size = delayed.operation->GroupSize();
+                if (!size || statements + size > m_groupCommitSize)
+                    break;
+
+                // transaction which waits for other writer can't be committed together with ones before it
+                if (count && m_order && !delayed.waitFor.empty() && !m_order->IsReady(delayed.waitFor))
+                    break;
+
+                statements += size;
+            }
+        }
+
+        if (count > 1)
+            ExecuteGroup(queue, count);
+        else
+        {
+            count = 1;
+            queue.front().operation->Execute(m_dbConnection);
+        }
+
+        FinishOperations(queue, count, count > 1);
+    }
+}
+
+void SqlDelayThread::ExecuteGroup(SqlQueue const& queue, size_t count)
+{
+    SqlConnection::Lock guard(m_dbConnection);
+
+    bool result = m_dbConnection->BeginTransaction();
+    for (size_t i = 0; result && i < count; ++i)
+        result = queue[i].operation->ExecuteInGroup(m_dbConnection);
+
+    if (result && m_dbConnection->CommitTransaction())
+        return;
+
+    // all transactions of group are rolled back, so each one can be repeated alone:
+    // only the failed one is lost, as it would be without grouping
+    m_dbConnection->RollbackTransaction();
+    sLog.outError("SqlDelayThread: group commit of %u transactions failed, executing them one by one", uint32(count));
+
+    for (size_t i = 0; i < count; ++i)
+        queue[i].operation->Execute(m_dbConnection);
+}
+
+void SqlDelayThread::FinishOperations(SqlQueue& queue, size_t count, bool grouped)
+{
+    uint64 now = WorldTimer::getMicroTime();
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_statsLock);
+        m_stats.operations += count;
+        if (grouped)
+        {
+            ++m_stats.groupCommits;
+            m_stats.groupedOperations += count;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint64 latency = now > queue[i].queueTime ? now - queue[i].queueTime : 0;
+            m_stats.totalLatency += latency;
+            if (latency > m_stats.maxLatency)
+                m_stats.maxLatency = latency;
+        }
+    }
+
+    uint64 lastSequence = queue[count - 1].sequence;
+    for (size_t i = 0; i < count; ++i)
+    {
+        delete queue.front().operation;
+        queue.pop_front();
+        --m_queueSize;
+    }
+
+    if (m_order)
+        m_order->SetDone(m_writerIndex, lastSequence);
+}
+
+void SqlDelayThread::GetStats(SqlAsyncStats& stats, bool reset)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_statsLock);
+
+    stats = m_stats;
+    stats.queueSize = uint32(m_queueSize.value());
+
+    if (reset)
+        m_stats = SqlAsyncStats();
 }
@@ -19,34 +19,120 @@
 #ifndef __SQLDELAYTHREAD_H
 #define __SQLDELAYTHREAD_H
 
+#include "Common.h"
 #include "ace/Thread_Mutex.h"
-#include "LockedQueue.h"
+#include "ace/Condition_Thread_Mutex.h"
+#include "ace/Atomic_Op.h"
 #include "Threading.h"
+#include <deque>
+#include <vector>
 
 
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+// statistics of one async writer, latency is time from Delay() call to end of execution in microseconds
+struct SqlAsyncStats
+{
+    SqlAsyncStats() : queueSize(0), operations(0), groupCommits(0), groupedOperations(0), totalLatency(0), maxLatency(0) {}
+
+    void Add(SqlAsyncStats const& stats);
+
+    uint32 queueSize;                                       ///< operations waiting for execution
+    uint64 operations;                                      ///< executed operations
+    uint64 groupCommits;                                    ///< commits of several transactions together
+    uint64 groupedOperations;                               ///< transactions executed in group commits
+    uint64 totalLatency;
+    uint64 maxLatency;
+};
+
+// writer index and sequence number of request which must be finished first
+typedef std::vector<std::pair<uint32, uint64> > SqlWaitList;
+
+// Order of async requests between writers of one database. Partitioned writers (index > 0) don't wait
+// for each other, but request of partitioned writer is executed only after all requests queued
+// to default writer (index 0) before it, and request of default writer - after all requests
+// queued before it to partitioned writers.
+class SqlWriteOrder
+{
+    struct WriterState
+    {
+        WriterState() : lastQueued(0), lastDone(0), active(true) {}
+
+        uint64 lastQueued;
+        uint64 lastDone;
+        bool active;                                        ///< writer thread still executes requests
+    };
+
+    public:
+        SqlWriteOrder(uint32 writers) : m_doneCond(m_lock), m_sequence(0), m_writers(writers) {}
+
+        // give sequence number to request queued to writer and collect requests it has to wait for
+        uint64 Register(uint32 writer, SqlWaitList& waitFor);
+        void SetDone(uint32 writer, uint64 sequence);
+        // requests of stopped writer are not waited for anymore
+        void SetInactive(uint32 writer);
+
+        bool IsReady(SqlWaitList const& waitFor);
+        void WaitReady(SqlWaitList const& waitFor);
+
+    private:
+        bool IsReadyLocked(SqlWaitList const& waitFor) const;
+
+        ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_doneCond;
+        uint64 m_sequence;
+        std::vector<WriterState> m_writers;
+};
+
 class SqlDelayThread : public ACE_Based::Runnable
 {
-    typedef ACE_Based::LockedQueue<SqlOperation*, ACE_Thread_Mutex> SqlQueue;
+    struct SqlDelayedOperation
+    {
+        SqlDelayedOperation(SqlOperation* _operation, uint64 _queueTime) : operation(_operation), queueTime(_queueTime), sequence(0) {}
+
+        SqlOperation* operation;
+        uint64 queueTime;
+        uint64 sequence;
+        SqlWaitList waitFor;
+    };
+
+    typedef std::deque<SqlDelayedOperation> SqlQueue;
 
     private:
         SqlQueue m_sqlQueue;                                ///< Queue of SQL statements
+        ACE_Thread_Mutex m_queueLock;
+        ACE_Condition_Thread_Mutex m_queueCond;             ///< signaled when queue gets work or thread is stopped
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_queueSize;  ///< queued and not yet finished operations
         Database* m_dbEngine;                               ///< Pointer to used Database engine
         SqlConnection * m_dbConnection;                     ///< Pointer to DB connection
+        SqlWriteOrder * m_order;                            ///< order between writers of database, NULL if it has only one
+        uint32 m_writerIndex;
+        bool m_pingDatabase;                                ///< ping all database connections, not only own one
+        uint32 m_groupCommitSize;                           ///< max statements in one group commit, 0 - disabled
         volatile bool m_running;
 
+        ACE_Thread_Mutex m_statsLock;
+        SqlAsyncStats m_stats;
+
         //process all enqueued requests
         void ProcessRequests();
+        //execute first count operations of queue in one transaction
+        void ExecuteGroup(SqlQueue const& queue, size_t count);
+        //update statistics and free first count operations of queue
+        void FinishOperations(SqlQueue& queue, size_t count, bool grouped);
 
     public:
-        SqlDelayThread(Database* db, SqlConnection* conn);
+        SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase = true, uint32 groupCommitSize = 0,
+            SqlWriteOrder* order = NULL, uint32 writerIndex = 0);
         ~SqlDelayThread();
 
         ///< Put sql statement to delay queue
-        bool Delay(SqlOperation* sql) { m_sqlQueue.add(sql); return true; }
+        bool Delay(SqlOperation* sql);
+
+        //current statistics, latency values are restarted if reset is set
+        void GetStats(SqlAsyncStats& stats, bool reset);
 
         virtual void Stop();                                ///< Stop event
         virtual void run();                                 ///< Main Thread loop
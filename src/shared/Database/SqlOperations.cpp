@@ -65,6 +65,20 @@ bool SqlTransaction::Execute(SqlConnection *conn)
     return conn->CommitTransaction();
 }
 
+bool SqlTransaction::ExecuteInGroup(SqlConnection *conn)
+{
+    LOCK_DB_CONN(conn);
+
+    const int nItems = m_queue.size();
+    for (int i = 0; i < nItems; ++i)
+    {
+        if(!m_queue[i]->Execute(conn))
+            return false;
+    }
+
+    return true;
+}
+
 SqlPreparedRequest::SqlPreparedRequest(int nIndex, SqlStmtParameters * arg ) : m_nIndex(nIndex), m_param(arg)
 {
 }
@@ -127,10 +141,10 @@ bool SqlQueryHolder::SetQuery(size_t index, const char *sql)
         return false;
     }
 
-    if(m_queries[index].first != NULL)
+    if(IsIndexUsed(index))
     {
         sLog.outError("Attempt assign query to holder index (" SIZEFMTD ") where other query stored (Old: [%s] New: [%s])",
-            index,m_queries[index].first,sql);
+            index,m_queries[index].first ? m_queries[index].first : "prepared statement",sql);
         return false;
     }
 
@@ -162,16 +176,54 @@ bool SqlQueryHolder::SetPQuery(size_t index, const char *format, ...)
     return SetQuery(index,szQuery);
 }
 
+bool SqlQueryHolder::SetStmtQuery(size_t index, SqlStatement& stmt)
+{
+    if(m_stmts.size() <= index)
+    {
+        sLog.outError("Query index (" SIZEFMTD ") out of range (size: " SIZEFMTD ") for statement %i", index, m_stmts.size(), stmt.ID());
+        return false;
+    }
+
+    if(IsIndexUsed(index))
+    {
+        sLog.outError("Attempt assign statement %i to holder index (" SIZEFMTD ") where other query stored", stmt.ID(), index);
+        return false;
+    }
+
+    SqlStmtParameters * params = stmt.detach();
+    if(params->boundParams() != stmt.arguments())
+    {
+        sLog.outError("SQL ERROR: wrong amount of parameters (%i instead of %i) for statement %i", params->boundParams(), stmt.arguments(), stmt.ID());
+        delete params;
+        return false;
+    }
+
+    /// not executed yet, parameters are kept until the delay thread runs the statement
+    m_stmts[index] = SqlStmtPair(stmt.ID(), params);
+    return true;
+}
+
+void SqlQueryHolder::FreeQuery(size_t index)
+{
+    if(m_queries[index].first != NULL)
+    {
+        delete [] (const_cast<char*>(m_queries[index].first));
+        m_queries[index].first = NULL;
+    }
+
+    if(m_stmts[index].second != NULL)
+    {
+        delete m_stmts[index].second;
+        m_stmts[index].second = NULL;
+    }
+}
+
 QueryResult* SqlQueryHolder::GetResult(size_t index)
 {
     if(index < m_queries.size())
     {
         /// the query strings are freed on the first GetResult or in the destructor
-        if(m_queries[index].first != NULL)
-        {
-            delete [] (const_cast<char*>(m_queries[index].first));
-            m_queries[index].first = NULL;
-        }
+        FreeQuery(index);
         /// when you get a result aways remember to delete it!
         return m_queries[index].second;
     }
@@ -192,9 +244,9 @@ SqlQueryHolder::~SqlQueryHolder()
     {
         /// if the result was never used, free the resources
         /// results used already (getresult called) are expected to be deleted
-        if(m_queries[i].first != NULL)
+        if(IsIndexUsed(i))
         {
-            delete [] (const_cast<char*>(m_queries[i].first));
+            FreeQuery(i);
             if(m_queries[i].second)
                 delete m_queries[i].second;
         }
@@ -205,6 +257,7 @@ void SqlQueryHolder::SetSize(size_t size)
 {
     /// to optimize push_back, reserve the number of queries about to be executed
     m_queries.resize(size);
+    m_stmts.resize(size, SqlStmtPair(-1, (SqlStmtParameters*)NULL));
 }
 
 bool SqlQueryHolderEx::Execute(SqlConnection *conn)
@@ -220,6 +273,8 @@ bool SqlQueryHolderEx::Execute(SqlConnection *conn)
         /// execute all queries in the holder and pass the results
         char const *sql = queries[i].first;
         if(sql) m_holder->SetResult(i, conn->Query(sql));
+        else if(SqlStmtParameters const* params = m_holder->m_stmts[i].second)
+            m_holder->SetResult(i, conn->QueryStmt(m_holder->m_stmts[i].first, *params));
     }
 
     /// sync with the caller thread
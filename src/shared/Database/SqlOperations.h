@@ -32,6 +32,7 @@ class Database;
 class SqlConnection;
 class SqlDelayThread;
 class SqlStmtParameters;
+class SqlStatement;
 
 class SqlOperation
 {
@@ -39,6 +40,11 @@ class SqlOperation
         virtual void OnRemove() { delete this; }
         virtual bool Execute(SqlConnection *conn) = 0;
         virtual ~SqlOperation() {}
+
+        // statements count if operation can be committed together with other transactions, 0 if not
+        virtual uint32 GroupSize() const { return 0; }
+        // execute inside of transaction already started on conn
+        virtual bool ExecuteInGroup(SqlConnection *conn) { return Execute(conn); }
 };
 
 /// ---- ASYNC STATEMENTS / TRANSACTIONS ----
@@ -65,6 +71,9 @@ class SqlTransaction : public SqlOperation
         void DelayExecute(SqlOperation * sql)   {   m_queue.push_back(sql); }
 
         bool Execute(SqlConnection *conn);
+
+        uint32 GroupSize() const { return m_queue.size(); }
+        bool ExecuteInGroup(SqlConnection *conn);
 };
 
 class SqlPreparedRequest : public SqlOperation
@@ -114,11 +123,19 @@ class SqlQueryHolder
     private:
         typedef std::pair<const char*, QueryResult*> SqlResultPair;
         std::vector<SqlResultPair> m_queries;
+        /// prepared statement queries, stored under same index as their results
+        typedef std::pair<int, SqlStmtParameters*> SqlStmtPair;
+        std::vector<SqlStmtPair> m_stmts;
+
+        bool IsIndexUsed(size_t index) const { return m_queries[index].first != NULL || m_stmts[index].second != NULL; }
+        void FreeQuery(size_t index);
     public:
         SqlQueryHolder() {}
         ~SqlQueryHolder();
         bool SetQuery(size_t index, const char *sql);
         bool SetPQuery(size_t index, const char *format, ...) ATTR_PRINTF(3,4);
+        /// takes over bound parameters, results are fetched by binary protocol
+        bool SetStmtQuery(size_t index, SqlStatement& stmt);
         void SetSize(size_t size);
         QueryResult* GetResult(size_t index);
         void SetResult(size_t index, QueryResult *result);
@@ -206,6 +206,8 @@ class MANGOS_DLL_SPEC SqlStatement
 
         bool Execute();
         bool DirectExecute();
+        //synchronous SELECT through prepared statement, result rows keep numbers in native form
+        QueryResult* Query();
 
         //templates to simplify 1-4 parameter bindings
         template<typename ParamType1>
@@ -242,6 +244,30 @@ class MANGOS_DLL_SPEC SqlStatement
             return Execute();
         }
 
+        template<typename ParamType1>
+        QueryResult* PQuery(ParamType1 param1)
+        {
+            arg(param1);
+            return Query();
+        }
+
+        template<typename ParamType1, typename ParamType2>
+        QueryResult* PQuery(ParamType1 param1, ParamType2 param2)
+        {
+            arg(param1);
+            arg(param2);
+            return Query();
+        }
+
+        template<typename ParamType1, typename ParamType2, typename ParamType3>
+        QueryResult* PQuery(ParamType1 param1, ParamType2 param2, ParamType3 param3)
+        {
+            arg(param1);
+            arg(param2);
+            arg(param3);
+            return Query();
+        }
+
         //bind parameters with specified type
         void addBool(bool var) { arg(var); }
         void addUInt8(uint8 var) { arg(var); }
@@ -261,6 +287,8 @@ class MANGOS_DLL_SPEC SqlStatement
     protected:
         //don't allow anyone except Database class to create static SqlStatement objects
         friend class Database;
+        //query holders take over bound parameters for delayed execution
+        friend class SqlQueryHolder;
         SqlStatement(const SqlStatementID& index, Database& db) : m_index(index), m_pDB(&db), m_pParams(NULL) {}
 
     private:
@@ -314,6 +342,8 @@ class MANGOS_DLL_SPEC SqlPreparedStatement
 
         //execute statement w/o result set
         virtual bool execute() = 0;
+        //execute statement and fetch its result set, NULL if there are no rows
+        virtual QueryResult* query() = 0;
 
     protected:
         SqlPreparedStatement(const std::string& fmt, SqlConnection& conn):
@@ -341,6 +371,7 @@ class MANGOS_DLL_SPEC SqlPlainPreparedStatement : public SqlPreparedStatement
         virtual void bind(const SqlStmtParameters& holder);
 
         virtual bool execute();
+        virtual QueryResult* query();
 
     protected:
         void DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt);
@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "ace/OS_NS_unistd.h"
+#include "ace/TSS_T.h"
 
 INSTANTIATE_SINGLETON_1( Log );
 
@@ -66,9 +67,38 @@ enum LogType
 
 const int LogType_count = int(LogError) +1;
 
+// targets of one message, decided by logging thread
+enum LogOutputs
+{
+    LOG_OUTPUT_STDOUT           = 0x0001,
+    LOG_OUTPUT_STDERR           = 0x0002,
+    LOG_OUTPUT_FILE             = 0x0004,
+    LOG_OUTPUT_DB_ERRORS        = 0x0008,
+    LOG_OUTPUT_EVENTAI_ERRORS   = 0x0010,
+    LOG_OUTPUT_SCRIPT_ERRORS    = 0x0020,
+    LOG_OUTPUT_GM               = 0x0040,
+    LOG_OUTPUT_GM_PER_ACCOUNT   = 0x0080,
+    LOG_OUTPUT_CHAR             = 0x0100,
+    LOG_OUTPUT_CHAR_DUMP        = 0x0200,                   // char log without timestamp and line end
+    LOG_OUTPUT_RA               = 0x0400
+};
+
+// prefix of message in main log file
+enum LogFilePrefix
+{
+    LOG_PREFIX_NONE             = 0,
+    LOG_PREFIX_ERROR            = 1,
+    LOG_PREFIX_EVENTAI          = 2,
+    LOG_PREFIX_SCRIPTLIB        = 3
+};
+
+// longer messages are formatted into allocated buffer
+#define LOG_MESSAGE_BUFFER_SIZE     2048
+
 Log::Log() :
     raLogfile(NULL), logfile(NULL), gmLogfile(NULL), charLogfile(NULL),
-    dberLogfile(NULL), eventAiErLogfile(NULL), scriptErrLogFile(NULL), worldLogfile(NULL), m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(NULL)
+    dberLogfile(NULL), eventAiErLogfile(NULL), scriptErrLogFile(NULL), worldLogfile(NULL), m_worldLogBinary(false),
+    m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(NULL)
 {
     Initialize();
 }
@@ -266,10 +296,13 @@ void Log::Initialize()
     dberLogfile = openLogFile("DBErrorLogFile", NULL, "a");
     eventAiErLogfile = openLogFile("EventAIErrorLogFile", NULL, "a");
     raLogfile = openLogFile("RaLogFile", NULL, "a");
-    worldLogfile = openLogFile("WorldLogFile", "WorldLogTimestamp", "a");
+    openWorldLogFile();
 
     ReloadConfigDefaults();
 
+    if (sConfig.GetBoolDefault("LogAsync", false))
+        m_writer.Start(this, sConfig.GetIntDefault("LogAsyncBufferSize", 256) * 1024);
+
 }
 
 void Log::ReloadConfigDefaults()
@@ -314,6 +347,36 @@ FILE* Log::openLogFile(char const* configFileName,char const* configTimeStampFla
     return fopen((m_logsDir+logfn).c_str(), mode);
 }
 
+// binary world log is written in little endian order
+static void writeLE(FILE* file, uint64 value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i)
+        fputc(int((value >> (i * 8)) & 0xFF), file);
+}
+
+void Log::openWorldLogFile()
+{
+    m_worldLogBinary = sConfig.GetBoolDefault("WorldLogBinary", false);
+    if (!m_worldLogBinary)
+    {
+        worldLogfile = openLogFile("WorldLogFile", "WorldLogTimestamp", "a");
+        return;
+    }
+
+    worldLogfile = openLogFile("WorldLogFile", "WorldLogTimestamp", "ab");
+    if (!worldLogfile)
+        return;
+
+    // header only at file start, records of later runs are appended after previous ones
+    fseek(worldLogfile, 0, SEEK_END);
+    if (ftell(worldLogfile) == 0)
+    {
+        fwrite(PACKET_LOG_MAGIC, 1, 4, worldLogfile);
+        writeLE(worldLogfile, PACKET_LOG_VERSION, 2);
+        fflush(worldLogfile);
+    }
+}
+
 FILE* Log::openGmlogPerAccount(uint32 account)
 {
     if (m_gmlog_filename_format.empty())
@@ -326,7 +389,11 @@ FILE* Log::openGmlogPerAccount(uint32 account)
 
 void Log::outTimestamp(FILE* file)
 {
-    time_t t = time(NULL);
+    outTimestamp(file, time(NULL));
+}
+
+void Log::outTimestamp(FILE* file, time_t t)
+{
     tm* aTm = localtime(&t);
     //       YYYY   year
     //       MM     month (2 digits 01-12)
@@ -339,7 +406,11 @@ void Log::outTimestamp(FILE* file)
 
 void Log::outTime()
 {
-    time_t t = time(NULL);
+    outTime(time(NULL));
+}
+
+void Log::outTime(time_t t)
+{
     tm* aTm = localtime(&t);
     //       YYYY   year
     //       MM     month (2 digits 01-12)
@@ -365,243 +436,370 @@ std::string Log::GetTimestampStr()
     return std::string(buf);
 }
 
-void Log::outString()
+static uint64 GetLogTimeMs()
 {
-    if (m_includeTime)
-        outTime();
-    printf( "\n" );
-    if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "\n" );
-        fflush(logfile);
-    }
-
-    fflush(stdout);
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    return uint64(now.sec()) * 1000 + now.usec() / 1000;
 }
 
-void Log::outString( const char * str, ... )
+// log capture of current thread, NULL if text is written
+struct LogCaptureSlot
 {
-    if (!str)
-        return;
+    LogCaptureSlot() : capture(NULL) {}
 
-    if (m_colored)
-        SetColor(true,m_colors[LogNormal]);
+    LogCapture* capture;
+};
 
-    if (m_includeTime)
-        outTime();
+static ACE_TSS<LogCaptureSlot> s_logCapture;
 
+static void consolePrint(FILE* out, const char* str, ...)
+{
     va_list ap;
-
     va_start(ap, str);
-    vutf8printf(stdout, str, &ap);
+    vutf8printf(out, str, &ap);
     va_end(ap);
+}
 
-    if (m_colored)
-        ResetColor(true);
+void Log::outMessage(uint32 outputs, uint8 type, uint16 prefix, uint32 account, const char* str, va_list ap)
+{
+    // message filtered by log level or written only to not opened files is not formatted at all
+    outputs = GetOpenOutputs(outputs);
+    if (!outputs)
+        return;
 
-    printf( "\n" );
+    char buf[LOG_MESSAGE_BUFFER_SIZE];
 
-    if (logfile)
-    {
-        outTimestamp(logfile);
+    va_list copy;
+    va_copy(copy, ap);
+    int length = vsnprintf(buf, LOG_MESSAGE_BUFFER_SIZE, str, copy);
+    va_end(copy);
 
-        va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n" );
-        va_end(ap);
+    if (length < 0)
+        return;
 
-        fflush(logfile);
+    if (length < LOG_MESSAGE_BUFFER_SIZE)
+    {
+        outText(outputs, type, prefix, account, buf, length);
+        return;
     }
 
-    fflush(stdout);
+    std::vector<char> longBuf(length + 1);
+    vsnprintf(&longBuf[0], length + 1, str, ap);
+    outText(outputs, type, prefix, account, &longBuf[0], length);
 }
 
-void Log::outError( const char * err, ... )
+uint32 Log::GetOpenOutputs(uint32 outputs) const
 {
-    if (!err)
-        return;
-
-    if (m_colored)
-        SetColor(false,m_colors[LogError]);
-
-    if (m_includeTime)
-        outTime();
+    // outputs without open file are dropped before formatting and queueing
+    if (!logfile)
+        outputs &= ~LOG_OUTPUT_FILE;
+    if (!dberLogfile)
+        outputs &= ~LOG_OUTPUT_DB_ERRORS;
+    if (!eventAiErLogfile)
+        outputs &= ~LOG_OUTPUT_EVENTAI_ERRORS;
+    if (!scriptErrLogFile)
+        outputs &= ~LOG_OUTPUT_SCRIPT_ERRORS;
+    if (!gmLogfile)
+        outputs &= ~LOG_OUTPUT_GM;
+    if (!charLogfile)
+        outputs &= ~(LOG_OUTPUT_CHAR | LOG_OUTPUT_CHAR_DUMP);
+    if (!raLogfile)
+        outputs &= ~LOG_OUTPUT_RA;
+    return outputs;
+}
 
-    va_list ap;
+void Log::outText(uint32 outputs, uint8 type, uint16 prefix, uint32 account, const char* text, size_t length, uint64 timeMs)
+{
+    outputs = GetOpenOutputs(outputs);
+    if (!outputs)
+        return;
 
-    va_start(ap, err);
-    vutf8printf(stderr, err, &ap);
-    va_end(ap);
+    if (!timeMs)
+        timeMs = GetLogTimeMs();
 
-    if (m_colored)
-        ResetColor(false);
+    if (LogCapture* capture = s_logCapture->capture)
+    {
+        LogCapturedLine line;
+        line.outputs = outputs;
+        line.type = type;
+        line.prefix = prefix;
+        line.account = account;
+        line.timeMs = timeMs;
+        capture->push_back(line);
+        capture->back().text.assign(text, length);
+        return;
+    }
 
-    fprintf( stderr, "\n" );
-    if (logfile)
+    // text is stored with terminating zero
+    LogRecord* record = m_writer.Reserve(length + 1);
+    LogRecord local;
+    if (!record)
     {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR:" );
+        local.externalData = const_cast<char*>(text);
+        record = &local;
+    }
 
-        va_start(ap, err);
-        vfprintf(logfile, err, ap);
-        va_end(ap);
+    record->kind = LOG_RECORD_TEXT;
+    record->type = type;
+    record->prefix = prefix;
+    record->outputs = outputs;
+    record->param = account;
+    record->opcode = 0;
+    record->opcodeName = NULL;
+    record->timeMs = timeMs;
 
-        fprintf(logfile, "\n" );
-        fflush(logfile);
+    if (record == &local)
+    {
+        local.dataSize = length + 1;
+        WriteRecord(local);
+        FlushOutputs(outputs);
+        return;
     }
 
-    fflush(stderr);
+    memcpy(record->GetData(), text, length + 1);
+    m_writer.Commit();
 }
 
-void Log::outErrorDb()
+void Log::StartCapture(LogCapture* capture)
 {
-    if (m_includeTime)
-        outTime();
+    s_logCapture->capture = capture;
+}
 
-    fprintf( stderr, "\n" );
+void Log::StopCapture()
+{
+    s_logCapture->capture = NULL;
+}
 
-    if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR:\n" );
-        fflush(logfile);
-    }
+void Log::WriteCapture(LogCapture const& capture)
+{
+    for (LogCapture::const_iterator itr = capture.begin(); itr != capture.end(); ++itr)
+        outText(itr->outputs, itr->type, itr->prefix, itr->account, itr->text.c_str(), itr->text.size(), itr->timeMs);
+}
 
-    if (dberLogfile)
+void Log::WriteRecord(LogRecord const& record)
+{
+    switch (record.kind)
     {
-        outTimestamp(dberLogfile);
-        fprintf(dberLogfile, "\n" );
-        fflush(dberLogfile);
+        case LOG_RECORD_TEXT:
+            WriteText(record);
+            break;
+        case LOG_RECORD_PACKET:
+            WriteWorldPacket(record);
+            break;
+        default:
+            break;
     }
-
-    fflush(stderr);
 }
 
-void Log::outErrorDb( const char * err, ... )
+void Log::WriteText(LogRecord const& record)
 {
-    if (!err)
-        return;
+    char const* text = record.GetData();
+    time_t t = time_t(record.timeMs / 1000);
 
-    if (m_colored)
-        SetColor(false,m_colors[LogError]);
+    if (record.outputs & (LOG_OUTPUT_STDOUT | LOG_OUTPUT_STDERR))
+    {
+        bool stdout_stream = record.outputs & LOG_OUTPUT_STDOUT;
+        FILE* out = stdout_stream ? stdout : stderr;
 
-    if (m_includeTime)
-        outTime();
+        if (m_colored)
+            SetColor(stdout_stream, m_colors[record.type]);
 
-    va_list ap;
+        if (m_includeTime)
+            outTime(t);
 
-    va_start(ap, err);
-    vutf8printf(stderr, err, &ap);
-    va_end(ap);
+        consolePrint(out, "%s", text);
 
-    if (m_colored)
-        ResetColor(false);
+        if (m_colored)
+            ResetColor(stdout_stream);
 
-    fprintf( stderr, "\n" );
+        fprintf(out, "\n");
+    }
 
-    if (logfile)
+    if (record.outputs & LOG_OUTPUT_FILE)
     {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR:" );
-
-        va_start(ap, err);
-        vfprintf(logfile, err, ap);
-        va_end(ap);
-
-        fprintf(logfile, "\n" );
-        fflush(logfile);
+        outTimestamp(logfile, t);
+        switch (record.prefix)
+        {
+            case LOG_PREFIX_ERROR:
+                fprintf(logfile, "ERROR:");
+                break;
+            case LOG_PREFIX_EVENTAI:
+                fprintf(logfile, "ERROR CreatureEventAI: ");
+                break;
+            case LOG_PREFIX_SCRIPTLIB:
+                if (m_scriptLibName)
+                    fprintf(logfile, "<%s ERROR>: ", m_scriptLibName);
+                else
+                    fprintf(logfile, "<Scripting Library ERROR>: ");
+                break;
+            default:
+                break;
+        }
+        fprintf(logfile, "%s\n", text);
     }
 
-    if (dberLogfile)
+    FILE* files[] = { dberLogfile, eventAiErLogfile, scriptErrLogFile, gmLogfile, charLogfile, raLogfile };
+    uint32 fileOutputs[] = { LOG_OUTPUT_DB_ERRORS, LOG_OUTPUT_EVENTAI_ERRORS, LOG_OUTPUT_SCRIPT_ERRORS, LOG_OUTPUT_GM, LOG_OUTPUT_CHAR, LOG_OUTPUT_RA };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
     {
-        outTimestamp(dberLogfile);
+        if (record.outputs & fileOutputs[i])
+        {
+            outTimestamp(files[i], t);
+            fprintf(files[i], "%s\n", text);
+        }
+    }
 
-        va_list ap;
-        va_start(ap, err);
-        vfprintf(dberLogfile, err, ap);
-        va_end(ap);
+    if (record.outputs & LOG_OUTPUT_CHAR_DUMP)
+        fprintf(charLogfile, "%s", text);
 
-        fprintf(dberLogfile, "\n" );
-        fflush(dberLogfile);
+    if (record.outputs & LOG_OUTPUT_GM_PER_ACCOUNT)
+    {
+        if (FILE* per_file = openGmlogPerAccount(record.param))
+        {
+            outTimestamp(per_file, t);
+            fprintf(per_file, "%s\n", text);
+            fclose(per_file);
+        }
     }
-
-    fflush(stderr);
 }
 
-void Log::outErrorEventAI()
+void Log::WriteWorldPacket(LogRecord const& record)
 {
-    if (m_includeTime)
-        outTime();
-
-    fprintf(stderr, "\n");
+    uint8 const* data = (uint8 const*)record.GetData();
 
-    if (logfile)
+    if (m_worldLogBinary)
     {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR CreatureEventAI\n");
-        fflush(logfile);
+        // opcode names are stored once, so converter doesn't need opcode table of server
+        if (record.opcodeName && m_worldLogOpcodeNames.insert(record.opcode).second)
+        {
+            size_t nameLength = std::min<size_t>(strlen(record.opcodeName), 255);
+            writeLE(worldLogfile, PACKET_LOG_RECORD_OPCODE_NAME, 1);
+            writeLE(worldLogfile, record.opcode, 2);
+            writeLE(worldLogfile, nameLength, 1);
+            fwrite(record.opcodeName, 1, nameLength, worldLogfile);
+        }
+
+        writeLE(worldLogfile, PACKET_LOG_RECORD_PACKET, 1);
+        writeLE(worldLogfile, record.timeMs, 8);
+        writeLE(worldLogfile, record.param, 4);
+        writeLE(worldLogfile, record.opcode, 2);
+        writeLE(worldLogfile, record.type, 1);
+        writeLE(worldLogfile, record.dataSize, 4);
+        fwrite(data, 1, record.dataSize, worldLogfile);
+        return;
     }
 
-    if (eventAiErLogfile)
+    outTimestamp(worldLogfile, time_t(record.timeMs / 1000));
+
+    fprintf(worldLogfile,"\n%s:\nSOCKET: %u\nLENGTH: %u\nOPCODE: %s (0x%.4X)\nDATA:\n",
+        record.type == PACKET_LOG_CLIENT_TO_SERVER ? "CLIENT" : "SERVER",
+        record.param, record.dataSize, record.opcodeName ? record.opcodeName : "UNKNOWN", record.opcode);
+
+    uint32 p = 0;
+    while (p < record.dataSize)
     {
-        outTimestamp(eventAiErLogfile);
-        fprintf(eventAiErLogfile, "\n");
-        fflush(eventAiErLogfile);
+        for (size_t j = 0; j < 16 && p < record.dataSize; ++j)
+            fprintf(worldLogfile, "%.2X ", data[p++]);
+
+        fprintf(worldLogfile, "\n");
     }
 
+    fprintf(worldLogfile, "\n\n");
+}
+
+void Log::FlushOutputs(uint32 outputs)
+{
+    if (outputs & LOG_OUTPUT_STDOUT)
+        fflush(stdout);
+    if (outputs & LOG_OUTPUT_STDERR)
+        fflush(stderr);
+
+    // per account GM logs are closed after every line
+    FILE* files[] = { logfile, dberLogfile, eventAiErLogfile, scriptErrLogFile, gmLogfile, charLogfile, raLogfile };
+    uint32 fileOutputs[] = { LOG_OUTPUT_FILE, LOG_OUTPUT_DB_ERRORS, LOG_OUTPUT_EVENTAI_ERRORS, LOG_OUTPUT_SCRIPT_ERRORS, LOG_OUTPUT_GM, LOG_OUTPUT_CHAR | LOG_OUTPUT_CHAR_DUMP, LOG_OUTPUT_RA };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+        if (outputs & fileOutputs[i])
+            fflush(files[i]);
+}
+
+void Log::FlushFiles()
+{
+    fflush(stdout);
     fflush(stderr);
+
+    FILE* files[] = { logfile, gmLogfile, charLogfile, dberLogfile, eventAiErLogfile, scriptErrLogFile, raLogfile, worldLogfile };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i)
+        if (files[i])
+            fflush(files[i]);
 }
 
-void Log::outErrorEventAI(const char* err, ...)
+void Log::outString()
 {
-    if (!err)
+    outText(LOG_OUTPUT_STDOUT | LOG_OUTPUT_FILE, LogNormal, LOG_PREFIX_NONE, 0, "", 0);
+}
+
+void Log::outString( const char * str, ... )
+{
+    if (!str)
         return;
 
-    if (m_colored)
-        SetColor(false, m_colors[LogError]);
+    va_list ap;
+    va_start(ap, str);
+    outMessage(LOG_OUTPUT_STDOUT | LOG_OUTPUT_FILE, LogNormal, LOG_PREFIX_NONE, 0, str, ap);
+    va_end(ap);
+}
 
-    if (m_includeTime)
-        outTime();
+void Log::outError( const char * err, ... )
+{
+    if (!err)
+        return;
 
     va_list ap;
-
     va_start(ap, err);
-    vutf8printf(stderr, err, &ap);
+    outMessage(LOG_OUTPUT_STDERR | LOG_OUTPUT_FILE, LogError, LOG_PREFIX_ERROR, 0, err, ap);
     va_end(ap);
+}
 
-    if (m_colored)
-        ResetColor(false);
-
-    fprintf(stderr, "\n");
-
-    if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR CreatureEventAI: ");
+void Log::outErrorDb()
+{
+    outText(LOG_OUTPUT_STDERR | LOG_OUTPUT_FILE | LOG_OUTPUT_DB_ERRORS, LogError, LOG_PREFIX_ERROR, 0, "", 0);
+}
 
-        va_start(ap, err);
-        vfprintf(logfile, err, ap);
-        va_end(ap);
+void Log::outErrorDb( const char * err, ... )
+{
+    if (!err)
+        return;
 
-        fprintf(logfile, "\n");
-        fflush(logfile);
-    }
+    va_list ap;
+    va_start(ap, err);
+    outMessage(LOG_OUTPUT_STDERR | LOG_OUTPUT_FILE | LOG_OUTPUT_DB_ERRORS, LogError, LOG_PREFIX_ERROR, 0, err, ap);
+    va_end(ap);
+}
 
-    if (eventAiErLogfile)
-    {
-        outTimestamp(eventAiErLogfile);
+void Log::outErrorEventAI()
+{
+    outText(LOG_OUTPUT_STDERR | LOG_OUTPUT_FILE | LOG_OUTPUT_EVENTAI_ERRORS, LogError, LOG_PREFIX_EVENTAI, 0, "", 0);
+}
 
-        va_list ap;
-        va_start(ap, err);
-        vfprintf(eventAiErLogfile, err, ap);
-        va_end(ap);
+void Log::outErrorEventAI(const char* err, ...)
+{
+    if (!err)
+        return;
 
-        fprintf(eventAiErLogfile, "\n");
-        fflush(eventAiErLogfile);
-    }
+    va_list ap;
+    va_start(ap, err);
+    outMessage(LOG_OUTPUT_STDERR | LOG_OUTPUT_FILE | LOG_OUTPUT_EVENTAI_ERRORS, LogError, LOG_PREFIX_EVENTAI, 0, err, ap);
+    va_end(ap);
+}
 
-    fflush(stderr);
+uint32 Log::GetLevelOutputs(LogLevel level) const
+{
+    uint32 outputs = 0;
+    if (m_logLevel >= level)
+        outputs |= LOG_OUTPUT_STDOUT;
+    if (m_logFileLevel >= level)
+        outputs |= LOG_OUTPUT_FILE;
+    return outputs;
 }
 
 void Log::outBasic(const char* str, ...)
@@ -609,37 +807,10 @@ void Log::outBasic(const char* str, ...)
     if (!str)
         return;
 
-    if (m_logLevel >= LOG_LVL_BASIC)
-    {
-        if (m_colored)
-            SetColor(true,m_colors[LogDetails]);
-
-        if (m_includeTime)
-            outTime();
-
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
-
-        if (m_colored)
-            ResetColor(true);
-
-        printf( "\n" );
-    }
-
-    if (logfile && m_logFileLevel >= LOG_LVL_BASIC)
-    {
-        va_list ap;
-        outTimestamp(logfile);
-        va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n" );
-        va_end(ap);
-        fflush(logfile);
-    }
-
-    fflush(stdout);
+    va_list ap;
+    va_start(ap, str);
+    outMessage(GetLevelOutputs(LOG_LVL_BASIC), LogDetails, LOG_PREFIX_NONE, 0, str, ap);
+    va_end(ap);
 }
 
 void Log::outDetail( const char * str, ... )
@@ -647,40 +818,10 @@ void Log::outDetail( const char * str, ... )
     if (!str)
         return;
 
-    if (m_logLevel >= LOG_LVL_DETAIL)
-    {
-
-        if (m_colored)
-            SetColor(true,m_colors[LogDetails]);
-
-        if (m_includeTime)
-            outTime();
-
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
-
-        if (m_colored)
-            ResetColor(true);
-
-        printf( "\n" );
-    }
-
-    if (logfile && m_logFileLevel >= LOG_LVL_DETAIL)
-    {
-        outTimestamp(logfile);
-
-        va_list ap;
-        va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        va_end(ap);
-
-        fprintf(logfile, "\n" );
-        fflush(logfile);
-    }
-
-    fflush(stdout);
+    va_list ap;
+    va_start(ap, str);
+    outMessage(GetLevelOutputs(LOG_LVL_DETAIL), LogDetails, LOG_PREFIX_NONE, 0, str, ap);
+    va_end(ap);
 }
 
 void Log::outDebug( const char * str, ... )
@@ -688,39 +829,10 @@ void Log::outDebug( const char * str, ... )
     if (!str)
         return;
 
-    if (m_logLevel >= LOG_LVL_DEBUG)
-    {
-        if (m_colored)
-            SetColor(true,m_colors[LogDebug]);
-
-        if (m_includeTime)
-            outTime();
-
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
-
-        if (m_colored)
-            ResetColor(true);
-
-        printf( "\n" );
-    }
-
-    if (logfile && m_logFileLevel >= LOG_LVL_DEBUG)
-    {
-        outTimestamp(logfile);
-
-        va_list ap;
-        va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        va_end(ap);
-
-        fprintf(logfile, "\n" );
-        fflush(logfile);
-    }
-
-    fflush(stdout);
+    va_list ap;
+    va_start(ap, str);
+    outMessage(GetLevelOutputs(LOG_LVL_DEBUG), LogDebug, LOG_PREFIX_NONE, 0, str, ap);
+    va_end(ap);
 }
 
 void Log::outCommand( uint32 account, const char * str, ... )
@@ -728,106 +840,32 @@ void Log::outCommand( uint32 account, const char * str, ... )
     if (!str)
         return;
 
-    if (m_logLevel >= LOG_LVL_DETAIL)
-    {
-        if (m_colored)
-            SetColor(true,m_colors[LogDetails]);
-
-        if (m_includeTime)
-            outTime();
-
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
-
-        if (m_colored)
-            ResetColor(true);
-
-        printf( "\n" );
-    }
-
-    if (logfile && m_logFileLevel >= LOG_LVL_DETAIL)
-    {
-        va_list ap;
-        outTimestamp(logfile);
-        va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n" );
-        va_end(ap);
-        fflush(logfile);
-    }
-
+    uint32 outputs = GetLevelOutputs(LOG_LVL_DETAIL);
     if (m_gmlog_per_account)
-    {
-        if (FILE* per_file = openGmlogPerAccount (account))
-        {
-            va_list ap;
-            outTimestamp(per_file);
-            va_start(ap, str);
-            vfprintf(per_file, str, ap);
-            fprintf(per_file, "\n" );
-            va_end(ap);
-            fclose(per_file);
-        }
-    }
-    else if (gmLogfile)
-    {
-        va_list ap;
-        outTimestamp(gmLogfile);
-        va_start(ap, str);
-        vfprintf(gmLogfile, str, ap);
-        fprintf(gmLogfile, "\n" );
-        va_end(ap);
-        fflush(gmLogfile);
-    }
+        outputs |= LOG_OUTPUT_GM_PER_ACCOUNT;
+    else
+        outputs |= LOG_OUTPUT_GM;
 
-    fflush(stdout);
+    va_list ap;
+    va_start(ap, str);
+    outMessage(outputs, LogDetails, LOG_PREFIX_NONE, account, str, ap);
+    va_end(ap);
 }
 
 void Log::outChar(const char * str, ... )
 {
-
     if (!str)
         return;
 
-    if (charLogfile)
-    {
-        va_list ap;
-        outTimestamp(charLogfile);
-        va_start(ap, str);
-        vfprintf(charLogfile, str, ap);
-        fprintf(charLogfile, "\n" );
-        va_end(ap);
-        fflush(charLogfile);
-    }
+    va_list ap;
+    va_start(ap, str);
+    outMessage(LOG_OUTPUT_CHAR, LogNormal, LOG_PREFIX_NONE, 0, str, ap);
+    va_end(ap);
 }
 
 void Log::outErrorScriptLib()
 {
-    if (m_includeTime)
-        outTime();
-
-    fprintf(stderr, "\n");
-
-    if (logfile)
-    {
-        outTimestamp(logfile);
-        if (m_scriptLibName)
-            fprintf(logfile, "<%s ERROR:> ", m_scriptLibName);
-        else
-            fprintf(logfile, "<Scripting Library ERROR>: ");
-        fflush(logfile);
-    }
-
-    if (scriptErrLogFile)
-    {
-        outTimestamp(scriptErrLogFile);
-        fprintf(scriptErrLogFile, "\n");
-        fflush(scriptErrLogFile);
-    }
-
-    fflush(stderr);
+    outText(LOG_OUTPUT_STDERR | LOG_OUTPUT_FILE | LOG_OUTPUT_SCRIPT_ERRORS, LogError, LOG_PREFIX_SCRIPTLIB, 0, "", 0);
 }
 
 void Log::outErrorScriptLib(const char* err, ...)
@@ -835,53 +873,10 @@ void Log::outErrorScriptLib(const char* err, ...)
     if (!err)
         return;
 
-    if (m_colored)
-        SetColor(false, m_colors[LogError]);
-
-    if (m_includeTime)
-        outTime();
-
     va_list ap;
-
     va_start(ap, err);
-    vutf8printf(stderr, err, &ap);
+    outMessage(LOG_OUTPUT_STDERR | LOG_OUTPUT_FILE | LOG_OUTPUT_SCRIPT_ERRORS, LogError, LOG_PREFIX_SCRIPTLIB, 0, err, ap);
     va_end(ap);
-
-    if (m_colored)
-        ResetColor(false);
-
-    fprintf(stderr, "\n");
-
-    if (logfile)
-    {
-        outTimestamp(logfile);
-        if (m_scriptLibName)
-            fprintf(logfile, "<%s ERROR>: ", m_scriptLibName);
-        else
-            fprintf(logfile, "<Scripting Library ERROR>: ");
-
-        va_start(ap, err);
-        vfprintf(logfile, err, ap);
-        va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
-    }
-
-    if (scriptErrLogFile)
-    {
-        outTimestamp(scriptErrLogFile);
-
-        va_list ap;
-        va_start(ap, err);
-        vfprintf(scriptErrLogFile, err, ap);
-        va_end(ap);
-
-        fprintf(scriptErrLogFile, "\n");
-        fflush(scriptErrLogFile);
-    }
-
-    fflush(stderr);
 }
 
 void Log::outWorldPacketDump(uint32 socket, uint32 opcode, char const* opcodeName, ByteBuffer const* packet, bool incoming)
@@ -889,34 +884,49 @@ void Log::outWorldPacketDump(uint32 socket, uint32 opcode, char const* opcodeNam
     if (!worldLogfile)
         return;
 
-    ACE_GUARD(ACE_Thread_Mutex, GuardObj, m_worldLogMtx);
+    uint32 size = packet->size();
+    char const* contents = size ? (char const*)packet->contents() : "";
 
-    outTimestamp(worldLogfile);
+    // packet is copied as is, it is formatted by writer thread or offline converter
+    LogRecord* record = m_writer.Reserve(size);
+    LogRecord local;
+    if (!record)
+    {
+        local.externalData = const_cast<char*>(contents);
+        local.dataSize = size;
+        record = &local;
+    }
 
-    fprintf(worldLogfile,"\n%s:\nSOCKET: %u\nLENGTH: " SIZEFMTD "\nOPCODE: %s (0x%.4X)\nDATA:\n",
-        incoming ? "CLIENT" : "SERVER",
-        socket, packet->size(), opcodeName, opcode);
+    record->kind = LOG_RECORD_PACKET;
+    record->type = incoming ? PACKET_LOG_CLIENT_TO_SERVER : PACKET_LOG_SERVER_TO_CLIENT;
+    record->prefix = 0;
+    record->outputs = 0;
+    record->param = socket;
+    record->opcode = opcode;
+    record->opcodeName = opcodeName;
+    record->timeMs = GetLogTimeMs();
 
-    size_t p = 0;
-    while (p < packet->size())
+    if (record == &local)
     {
-        for (size_t j = 0; j < 16 && p < packet->size(); ++j)
-            fprintf(worldLogfile, "%.2X ", (*packet)[p++]);
-
-        fprintf(worldLogfile, "\n");
+        ACE_GUARD(ACE_Thread_Mutex, GuardObj, m_worldLogMtx);
+        WriteWorldPacket(local);
+        fflush(worldLogfile);
+        return;
     }
 
-    fprintf(worldLogfile, "\n\n");
-    fflush(worldLogfile);
+    memcpy(record->GetData(), contents, size);
+    m_writer.Commit();
 }
 
 void Log::outCharDump( const char * str, uint32 account_id, uint32 guid, const char * name )
 {
-    if (charLogfile)
-    {
-        fprintf(charLogfile, "== START DUMP == (account: %u guid: %u name: %s )\n%s\n== END DUMP ==\n",account_id,guid,name,str );
-        fflush(charLogfile);
-    }
+    if (!charLogfile)
+        return;
+
+    std::ostringstream ss;
+    ss << "== START DUMP == (account: " << account_id << " guid: " << guid << " name: " << name << " )\n" << str << "\n== END DUMP ==\n";
+    std::string dump = ss.str();
+    outText(LOG_OUTPUT_CHAR_DUMP, LogNormal, LOG_PREFIX_NONE, 0, dump.c_str(), dump.size());
 }
 
 void Log::outRALog(    const char * str, ... )
@@ -924,18 +934,10 @@ void Log::outRALog(    const char * str, ... )
     if (!str)
         return;
 
-    if (raLogfile)
-    {
-        va_list ap;
-        outTimestamp(raLogfile);
-        va_start(ap, str);
-        vfprintf(raLogfile, str, ap);
-        fprintf(raLogfile, "\n" );
-        va_end(ap);
-        fflush(raLogfile);
-    }
-
-    fflush(stdout);
+    va_list ap;
+    va_start(ap, str);
+    outMessage(LOG_OUTPUT_RA, LogNormal, LOG_PREFIX_NONE, 0, str, ap);
+    va_end(ap);
 }
 
 void Log::WaitBeforeContinueIfNeed()
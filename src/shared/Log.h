@@ -21,6 +21,7 @@
 
 #include "Common.h"
 #include "Policies/Singleton.h"
+#include "LogWriter.h"
 
 class Config;
 class ByteBuffer;
@@ -90,15 +91,53 @@ enum Color
 
 const int Color_count = int(WHITE)+1;
 
+// Binary world packet log (WorldLogBinary = 1), all values little endian:
+//   header:             "MPKT", uint16 version
+//   opcode name record: uint8 PACKET_LOG_RECORD_OPCODE_NAME, uint16 opcode, uint8 length, name
+//                       written before first packet of the opcode
+//   packet record:      uint8 PACKET_LOG_RECORD_PACKET, uint64 time (ms since epoch), uint32 socket,
+//                       uint16 opcode, uint8 direction, uint32 length, packet data
+// contrib/packet_log_converter converts it to text format of WorldLogFile.
+#define PACKET_LOG_MAGIC            "MPKT"
+#define PACKET_LOG_VERSION          1
+
+enum PacketLogRecordType
+{
+    PACKET_LOG_RECORD_OPCODE_NAME   = 1,
+    PACKET_LOG_RECORD_PACKET        = 2
+};
+
+enum PacketLogDirection
+{
+    PACKET_LOG_SERVER_TO_CLIENT     = 0,
+    PACKET_LOG_CLIENT_TO_SERVER     = 1
+};
+
+// Text line kept by log capture of a thread, see Log::StartCapture
+struct LogCapturedLine
+{
+    uint32 outputs;
+    uint8 type;
+    uint16 prefix;
+    uint32 account;
+    uint64 timeMs;
+    std::string text;
+};
+
+typedef std::vector<LogCapturedLine> LogCapture;
+
 class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Thread_Mutex> >
 {
         friend class MaNGOS::OperatorNew<Log>;
+        friend class LogWriter;
 
     public:
         Log();
 
         ~Log()
         {
+            m_writer.Stop();
+
             if (logfile != NULL)
                 fclose(logfile);
             logfile = NULL;
@@ -164,6 +203,7 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
         // any log level
         void outErrorScriptLib(const char* str, ...)     ATTR_PRINTF(2, 3);
 
+        bool HasWorldPacketDump() const { return worldLogfile != NULL; }
         void outWorldPacketDump(uint32 socket, uint32 opcode, char const* opcodeName, ByteBuffer const* packet, bool incoming);
         // any log level
         void outCharDump(const char* str, uint32 account_id, uint32 guid, const char* name);
@@ -185,12 +225,37 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
 
         static void WaitBeforeContinueIfNeed();
 
+        // async writer control, output of logging threads is written by writer thread when LogAsync is enabled
+        void StopWriter() { m_writer.Stop(); }
+        void Flush() { m_writer.Flush(); }
+
+        // text logged by current thread is kept in capture instead of written until StopCapture,
+        // so output of tasks running in parallel can be written one task after another by WriteCapture
+        void StartCapture(LogCapture* capture);
+        void StopCapture();
+        void WriteCapture(LogCapture const& capture);
+
         // Set filename for scriptlibrary error output
         void setScriptLibraryErrorFile(char const* fname, char const* libName);
 
     private:
         FILE* openLogFile(char const* configFileName,char const* configTimeStampFlag, char const* mode);
         FILE* openGmlogPerAccount(uint32 account);
+        void openWorldLogFile();
+
+        // formats message once and gives it to writer thread, or writes it at once if writer is not running
+        void outMessage(uint32 outputs, uint8 type, uint16 prefix, uint32 account, const char* str, va_list ap);
+        // timeMs 0 is current time
+        void outText(uint32 outputs, uint8 type, uint16 prefix, uint32 account, const char* text, size_t length, uint64 timeMs = 0);
+        void WriteRecord(LogRecord const& record);
+        void WriteText(LogRecord const& record);
+        void WriteWorldPacket(LogRecord const& record);
+        void FlushOutputs(uint32 outputs);                  // only streams written by record of these outputs
+        void FlushFiles();
+        void outTime(time_t t);
+        static void outTimestamp(FILE* file, time_t t);
+        uint32 GetLevelOutputs(LogLevel level) const;
+        uint32 GetOpenOutputs(uint32 outputs) const;
 
         FILE* raLogfile;
         FILE* logfile;
@@ -201,6 +266,10 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
         FILE* scriptErrLogFile;
         FILE* worldLogfile;
         ACE_Thread_Mutex m_worldLogMtx;
+        bool m_worldLogBinary;
+        std::set<uint32> m_worldLogOpcodeNames;             // opcodes with name record in binary world log
+
+        LogWriter m_writer;
 
         // log/console control
         LogLevel m_logLevel;
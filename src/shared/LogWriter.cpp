@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "LogWriter.h"
+#include "Log.h"
+
+#include <ace/Guard_T.h>
+#include <ace/TSS_T.h>
+#include <ace/OS_NS_unistd.h>
+
+// writer checks buffers with this period when there is nothing to write
+#define LOG_WRITER_IDLE_SLEEP_MS    5
+#define LOG_RECORD_ALIGN            8
+
+// full barrier, ring buffer data must be written before index which publishes it, and read after it
+static inline void LogMemoryBarrier()
+{
+#if defined(_MSC_VER)
+    _ReadWriteBarrier();                                    // x86 keeps order of stores and of loads
+#elif defined(__GNUC__)
+    __sync_synchronize();
+#else
+#  error "LogWriter needs memory barrier of this compiler"
+#endif
+}
+
+static void LogSleep(uint32 ms)
+{
+    ACE_OS::sleep(ACE_Time_Value(0, ms * 1000));
+}
+
+LogRingBuffer::LogRingBuffer(uint32 capacity) : m_reserved(0), m_head(0), m_tail(0), m_abandoned(false)
+{
+    m_capacity = 1024;
+    while (m_capacity < capacity)
+        m_capacity <<= 1;
+
+    m_data = new char[m_capacity];
+}
+
+LogRingBuffer::~LogRingBuffer()
+{
+    while (LogRecord* record = Peek())
+        Release(record);
+
+    delete[] m_data;
+}
+
+LogRecord* LogRingBuffer::Reserve(uint32 dataSize)
+{
+    uint32 size = (sizeof(LogRecord) + dataSize + LOG_RECORD_ALIGN - 1) & ~(LOG_RECORD_ALIGN - 1);
+    uint32 tail = m_tail;
+    LogMemoryBarrier();
+
+    uint32 pos = m_head & (m_capacity - 1);
+    uint32 contiguous = m_capacity - pos;
+
+    // record is never split, rest of buffer is skipped by padding record
+    uint32 needed = size > contiguous ? size + contiguous : size;
+    if (needed > m_capacity - (m_head - tail))
+        return NULL;
+
+    m_reserved = m_head;
+    if (size > contiguous)
+    {
+        LogRecord* padding = (LogRecord*)(m_data + pos);
+        padding->size = contiguous;
+        padding->kind = LOG_RECORD_PADDING;
+        m_reserved += contiguous;
+        pos = 0;
+    }
+
+    LogRecord* record = (LogRecord*)(m_data + pos);
+    record->size = size;
+    record->dataSize = dataSize;
+    record->externalData = NULL;
+    m_reserved += size;
+    return record;
+}
+
+void LogRingBuffer::Commit()
+{
+    LogMemoryBarrier();
+    m_head = m_reserved;
+}
+
+LogRecord* LogRingBuffer::Peek()
+{
+    while (true)
+    {
+        uint32 head = m_head;
+        LogMemoryBarrier();
+
+        if (m_tail == head)
+            return NULL;
+
+        LogRecord* record = (LogRecord*)(m_data + (m_tail & (m_capacity - 1)));
+        if (record->kind != LOG_RECORD_PADDING)
+            return record;
+
+        LogMemoryBarrier();
+        m_tail += record->size;
+    }
+}
+
+void LogRingBuffer::Release(LogRecord* record)
+{
+    uint32 size = record->size;
+    delete[] record->externalData;
+
+    LogMemoryBarrier();
+    m_tail += size;
+}
+
+// buffer of logging thread is given to writer at thread end
+struct LogThreadBuffer
+{
+    LogThreadBuffer() : buffer(NULL) {}
+    ~LogThreadBuffer()
+    {
+        if (buffer)
+            buffer->Abandon();
+    }
+
+    LogRingBuffer* buffer;
+};
+
+static ACE_TSS<LogThreadBuffer> s_threadBuffer;
+
+LogWriter::LogWriter() : m_log(NULL), m_bufferSize(0), m_running(false), m_stop(false), m_writtenPasses(0)
+{
+}
+
+LogWriter::~LogWriter()
+{
+    Stop();
+
+    for (RingBuffers::const_iterator itr = m_buffers.begin(); itr != m_buffers.end(); ++itr)
+        delete *itr;
+}
+
+void LogWriter::Start(Log* log, uint32 bufferSize)
+{
+    if (m_running)
+        return;
+
+    m_log = log;
+    m_bufferSize = bufferSize;
+    m_stop = false;
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, 1) == -1)
+    {
+        fprintf(stderr, "LogWriter: can't start thread, logs will be written by logging threads\n");
+        return;
+    }
+
+    m_running = true;
+}
+
+void LogWriter::Stop()
+{
+    if (!m_running)
+        return;
+
+    // new records are written directly by logging threads, writer ends after writing queued ones
+    m_running = false;
+    m_stop = true;
+    wait();
+}
+
+LogRingBuffer* LogWriter::GetThreadBuffer()
+{
+    LogThreadBuffer* threadBuffer = s_threadBuffer.ts_object();
+    if (!threadBuffer)
+        return NULL;
+
+    if (!threadBuffer->buffer)
+    {
+        threadBuffer->buffer = new LogRingBuffer(m_bufferSize);
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_buffersLock, threadBuffer->buffer);
+        m_buffers.push_back(threadBuffer->buffer);
+    }
+
+    return threadBuffer->buffer;
+}
+
+LogRecord* LogWriter::Reserve(uint32 dataSize)
+{
+    if (!m_running)
+        return NULL;
+
+    LogRingBuffer* buffer = GetThreadBuffer();
+    if (!buffer)
+        return NULL;
+
+    uint32 inlineSize = dataSize > buffer->GetMaxInlineData() ? 0 : dataSize;
+
+    // writer is behind, logging thread waits instead of losing the record
+    LogRecord* record;
+    while (!(record = buffer->Reserve(inlineSize)))
+    {
+        if (!m_running)
+            return NULL;
+
+        LogSleep(1);
+    }
+
+    if (inlineSize != dataSize)
+    {
+        record->externalData = new char[dataSize];
+        record->dataSize = dataSize;
+    }
+
+    return record;
+}
+
+void LogWriter::Commit()
+{
+    if (LogThreadBuffer* threadBuffer = s_threadBuffer.ts_object())
+        if (threadBuffer->buffer)
+            threadBuffer->buffer->Commit();
+}
+
+void LogWriter::Flush(uint32 maxWaitMs)
+{
+    if (!m_running)
+        return;
+
+    // second finished pass started after the call, so it has seen all records committed before
+    uint32 passes = m_writtenPasses;
+    for (uint32 waited = 0; m_running && m_writtenPasses - passes < 2 && waited < maxWaitMs; ++waited)
+        LogSleep(1);
+}
+
+bool LogWriter::WriteAll()
+{
+    RingBuffers buffers;
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_buffersLock, false);
+        buffers = m_buffers;
+    }
+
+    bool written = false;
+    for (RingBuffers::const_iterator itr = buffers.begin(); itr != buffers.end(); ++itr)
+    {
+        LogRingBuffer* buffer = *itr;
+        bool abandoned = buffer->IsAbandoned();
+
+        while (LogRecord* record = buffer->Peek())
+        {
+            m_log->WriteRecord(*record);
+            buffer->Release(record);
+            written = true;
+        }
+
+        // thread ended before last check, so nothing can be added anymore
+        if (abandoned)
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_buffersLock, written);
+            m_buffers.erase(std::find(m_buffers.begin(), m_buffers.end(), buffer));
+            delete buffer;
+        }
+    }
+
+    if (written)
+        m_log->FlushFiles();
+
+    ++m_writtenPasses;
+    return written;
+}
+
+int LogWriter::svc()
+{
+    while (!m_stop)
+    {
+        if (!WriteAll())
+            LogSleep(LOG_WRITER_IDLE_SLEEP_MS);
+    }
+
+    // records committed before stop
+    WriteAll();
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOSSERVER_LOG_WRITER_H
+#define MANGOSSERVER_LOG_WRITER_H
+
+#include "Common.h"
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+
+class Log;
+
+enum LogRecordKind
+{
+    LOG_RECORD_PADDING  = 0,                                // skipped end of ring buffer
+    LOG_RECORD_TEXT     = 1,
+    LOG_RECORD_PACKET   = 2
+};
+
+// Message or packet as it is passed from logging thread to writer thread.
+// Data follows the record in ring buffer or is allocated separately when too big for it.
+struct LogRecord
+{
+    uint32 size;                                            // record with inline data, aligned, used for ring buffer only
+    uint8 kind;                                             // LogRecordKind
+    uint8 type;                                             // console color type for text, direction for packet
+    uint16 prefix;                                          // log file prefix of text
+    uint32 outputs;                                         // LogOutputs mask of text
+    uint32 param;                                           // account for gm log, socket for packet
+    uint32 opcode;
+    char const* opcodeName;                                 // static name from opcode table
+    uint64 timeMs;                                          // milliseconds since epoch
+    uint32 dataSize;
+    char* externalData;                                     // not NULL if data is not stored in record
+
+    char* GetData() { return externalData ? externalData : (char*)(this + 1); }
+    char const* GetData() const { return externalData ? externalData : (char const*)(this + 1); }
+};
+
+// Ring buffer of one logging thread, read only by writer thread, without locks.
+// Indexes only grow, so free space is capacity - (head - tail).
+class LogRingBuffer
+{
+    public:
+        explicit LogRingBuffer(uint32 capacity);
+        ~LogRingBuffer();
+
+        // logging thread: returns NULL if record doesn't fit now, record is visible to writer after Commit
+        LogRecord* Reserve(uint32 dataSize);
+        void Commit();
+
+        // writer thread
+        LogRecord* Peek();
+        void Release(LogRecord* record);
+
+        bool IsEmpty() const { return m_head == m_tail; }
+        uint32 GetMaxInlineData() const { return m_capacity / 4; }
+
+        void Abandon() { m_abandoned = true; }
+        bool IsAbandoned() const { return m_abandoned; }
+
+    private:
+        char* m_data;
+        uint32 m_capacity;                                  // power of 2
+        uint32 m_reserved;                                  // head after not committed record, logging thread only
+        volatile uint32 m_head;                             // written by logging thread
+        volatile uint32 m_tail;                             // written by writer thread
+        volatile bool m_abandoned;                          // logging thread ended, buffer is deleted when empty
+};
+
+// Thread which writes logs and packet dumps queued by other threads, so they don't wait for
+// console and disk and don't flush after every line. Each logging thread gets own ring buffer.
+class LogWriter : protected ACE_Task_Base
+{
+    public:
+        LogWriter();
+        virtual ~LogWriter();
+
+        void Start(Log* log, uint32 bufferSize);
+        void Stop();
+        bool IsRunning() const { return m_running; }
+
+        // record of calling thread, NULL if writer is stopped, must be filled and committed at once
+        LogRecord* Reserve(uint32 dataSize);
+        void Commit();
+
+        // waits until all committed records are written, limited by time for crash handlers
+        void Flush(uint32 maxWaitMs = 1000);
+
+        virtual int svc();
+
+    private:
+        typedef std::vector<LogRingBuffer*> RingBuffers;
+
+        LogRingBuffer* GetThreadBuffer();
+        bool WriteAll();
+
+        Log* m_log;
+        uint32 m_bufferSize;
+        volatile bool m_running;
+        volatile bool m_stop;
+        volatile uint32 m_writtenPasses;
+
+        ACE_Thread_Mutex m_buffersLock;
+        RingBuffers m_buffers;
+};
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2009-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include "Common.h"
+#include "AtomicPointer.h"
+
+namespace ACE_Based
+{
+    // Default link of MPSCQueue items: public member m_queueNext of item type
+    template <class T>
+        struct MPSCQueueLink
+    {
+        static T*& Next(T* item) { return item->m_queueNext; }
+    };
+
+    // Intrusive queue with many producer threads and one consumer thread.
+    // Producers push to a lock-free stack, consumer takes the whole stack with one atomic exchange
+    // and keeps it in arrival order in own list, so it pays one atomic operation per batch of items.
+    // Only one thread may consume at a time, consumers of different threads must be synchronized by caller.
+    template <class T, class Link = MPSCQueueLink<T> >
+        class MPSCQueue
+    {
+        //! Stack of added items, newest first.
+        AtomicPointer<T> _pushed;
+
+        //! Consumer owned items in arrival order.
+        T* _first;
+        T* _last;
+
+        public:
+
+            //! Create a MPSCQueue.
+            MPSCQueue()
+                : _first(NULL), _last(NULL)
+            {
+            }
+
+            //! Adds an item to the queue, can be called by any thread.
+            void add(T* item)
+            {
+                T* head;
+                do
+                {
+                    head = _pushed.load();
+                    Link::Next(item) = head;
+                }
+                while (_pushed.compareExchange(head, item) != head);
+            }
+
+            //! Gets the next item in the queue, if any. Consumer only.
+            bool next(T*& result)
+            {
+                if (!_first && !drain())
+                    return false;
+
+                result = pop();
+                return true;
+            }
+
+            //! Gets the next item in the queue, if checker accepts it. Consumer only.
+            template<class Checker>
+            bool next(T*& result, Checker& check)
+            {
+                if (!_first && !drain())
+                    return false;
+
+                if (!check.Process(_first))
+                    return false;
+
+                result = pop();
+                return true;
+            }
+
+            //! Checks if we're empty or not. Consumer only.
+            bool empty() const
+            {
+                return !_first && !_pushed.load();
+            }
+
+        private:
+
+            T* pop()
+            {
+                T* item = _first;
+                _first = Link::Next(item);
+                if (!_first)
+                    _last = NULL;
+
+                Link::Next(item) = NULL;
+                return item;
+            }
+
+            //! Moves all added items to consumer list.
+            bool drain()
+            {
+                T* pushed = _pushed.exchange(NULL);
+                if (!pushed)
+                    return false;
+
+                // reverse the stack to arrival order
+                T* first = NULL;
+                T* last = pushed;
+                while (pushed)
+                {
+                    T* next = Link::Next(pushed);
+                    Link::Next(pushed) = first;
+                    first = pushed;
+                    pushed = next;
+                }
+
+                if (_last)
+                    Link::Next(_last) = first;
+                else
+                    _first = first;
+
+                _last = last;
+                return true;
+            }
+    };
+}
+#endif
@@ -29,6 +29,9 @@ class WorldTimer
         //get current server time
         static MANGOS_DLL_SPEC uint32 getMSTime();
 
+        //get current system time in microseconds, only usable for measuring intervals
+        static MANGOS_DLL_SPEC uint64 getMicroTime();
+
         //get time difference between two timestamps
         static inline uint32 getMSTimeDiff(const uint32& oldMSTime, const uint32& newMSTime)
         {
@@ -52,6 +52,13 @@ uint32 WorldTimer::getMSTime()
     return getMSTime_internal();
 }
 
+uint64 WorldTimer::getMicroTime()
+{
+    uint64 usec = 0;
+    ACE_OS::gettimeofday().to_usec(usec);
+    return usec;
+}
+
 uint32 WorldTimer::getMSTime_internal(bool savetime /*= false*/)
 {
     //get current time
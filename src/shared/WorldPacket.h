@@ -29,12 +29,12 @@ class WorldPacket : public ByteBuffer
 {
     public:
                                                             // just container for later use
-        WorldPacket()                                       : ByteBuffer(0), m_opcode(MSG_NULL_ACTION)
+        WorldPacket()                                       : ByteBuffer(0), m_opcode(MSG_NULL_ACTION), m_queueNext(NULL)
         {
         }
-        explicit WorldPacket(Opcodes opcode, size_t res=200) : ByteBuffer(res), m_opcode(opcode) {}
+        explicit WorldPacket(Opcodes opcode, size_t res=200) : ByteBuffer(res), m_opcode(opcode), m_queueNext(NULL) {}
                                                             // copy constructor
-        WorldPacket(const WorldPacket &packet)              : ByteBuffer(packet), m_opcode(packet.m_opcode)
+        WorldPacket(const WorldPacket &packet)              : ByteBuffer(packet), m_opcode(packet.m_opcode), m_queueNext(NULL)
         {
         }
 
@@ -50,5 +50,8 @@ class WorldPacket : public ByteBuffer
 
     protected:
         Opcodes m_opcode;
+
+    public:
+        WorldPacket* m_queueNext;                           // link in received packets queue of session
 };
 #endif